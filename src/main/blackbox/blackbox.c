@@ -29,9 +29,11 @@
 
 #include "common/axis.h"
 #include "common/encoding.h"
+#include "common/maths.h"
 #include "common/utils.h"
 
 #include "blackbox.h"
+#include "blackbox_encoding.h"
 #include "blackbox_io.h"
 
 #include "drivers/sensor.h"
@@ -43,12 +45,15 @@
 #include "fc/rc_controls.h"
 #include "fc/runtime_config.h"
 
+#include "flight/failsafe.h"
+#include "flight/mixer.h"
 #include "flight/pid.h"
 
 #include "io/beeper.h"
 
 #include "sensors/sensors.h"
 #include "sensors/compass.h"
+#include "sensors/esc_sensor.h"
 #include "sensors/sonar.h"
 
 #include "config/config_profile.h"
@@ -220,6 +225,35 @@ static const blackboxSimpleFieldDefinition_t blackboxGpsHFields[] = {
 };
 #endif
 
+/*
+ * High rate gyro frame, logged every "gyro_rate_denom" gyro samples when enabled. Every field is predicted from the
+ * previous "F" frame, which is taken to be all zeros again after each "I" frame.
+ */
+static const blackboxConditionalFieldDefinition_t blackboxGyroFields[] = {
+    {"gyroRaw",            0, SIGNED,   PREDICT(PREVIOUS),   ENCODING(TAG8_8SVB),   CONDITION(ALWAYS)},
+    {"gyroRaw",            1, SIGNED,   PREDICT(PREVIOUS),   ENCODING(TAG8_8SVB),   CONDITION(ALWAYS)},
+    {"gyroRaw",            2, SIGNED,   PREDICT(PREVIOUS),   ENCODING(TAG8_8SVB),   CONDITION(ALWAYS)},
+    {"gyroADC",            0, SIGNED,   PREDICT(PREVIOUS),   ENCODING(TAG8_8SVB),   CONDITION(ALWAYS)},
+    {"gyroADC",            1, SIGNED,   PREDICT(PREVIOUS),   ENCODING(TAG8_8SVB),   CONDITION(ALWAYS)},
+    {"gyroADC",            2, SIGNED,   PREDICT(PREVIOUS),   ENCODING(TAG8_8SVB),   CONDITION(ALWAYS)},
+    {"motor",              0, UNSIGNED, PREDICT(PREVIOUS),   ENCODING(TAG8_8SVB),   CONDITION(AT_LEAST_MOTORS_1)},
+    {"motor",              1, UNSIGNED, PREDICT(PREVIOUS),   ENCODING(TAG8_8SVB),   CONDITION(AT_LEAST_MOTORS_2)},
+    {"motor",              2, UNSIGNED, PREDICT(PREVIOUS),   ENCODING(TAG8_8SVB),   CONDITION(AT_LEAST_MOTORS_3)},
+    {"motor",              3, UNSIGNED, PREDICT(PREVIOUS),   ENCODING(TAG8_8SVB),   CONDITION(AT_LEAST_MOTORS_4)},
+    {"motor",              4, UNSIGNED, PREDICT(PREVIOUS),   ENCODING(TAG8_8SVB),   CONDITION(AT_LEAST_MOTORS_5)},
+    {"motor",              5, UNSIGNED, PREDICT(PREVIOUS),   ENCODING(TAG8_8SVB),   CONDITION(AT_LEAST_MOTORS_6)},
+    {"motor",              6, UNSIGNED, PREDICT(PREVIOUS),   ENCODING(TAG8_8SVB),   CONDITION(AT_LEAST_MOTORS_7)},
+    {"motor",              7, UNSIGNED, PREDICT(PREVIOUS),   ENCODING(TAG8_8SVB),   CONDITION(AT_LEAST_MOTORS_8)}
+};
+
+#define BLACKBOX_GYRO_FIELD_COUNT ARRAY_LENGTH(blackboxGyroFields)
+#define BLACKBOX_GYRO_FIELD_GYRO_ADC_0 3
+#define BLACKBOX_GYRO_FIELD_MOTOR_0 6
+
+// Fixed point scale of the cross field predictor weights
+#define BLACKBOX_MIXER_WEIGHT_SHIFT 12
+#define BLACKBOX_GYRO_RAW_GAIN_SHIFT 8
+
 // Rarely-updated fields
 static const blackboxSimpleFieldDefinition_t blackboxSlowFields[] = {
     {"flightModeFlags",       -1, UNSIGNED, PREDICT(0),      ENCODING(UNSIGNED_VB)},
@@ -234,8 +268,10 @@ typedef enum BlackboxState {
     BLACKBOX_STATE_DISABLED = 0,
     BLACKBOX_STATE_STOPPED,
     BLACKBOX_STATE_PREPARE_LOG_FILE,
+    BLACKBOX_STATE_SEND_CACHED_HEADER,
     BLACKBOX_STATE_SEND_HEADER,
     BLACKBOX_STATE_SEND_MAIN_FIELD_HEADER,
+    BLACKBOX_STATE_SEND_GYRO_HEADER,
     BLACKBOX_STATE_SEND_GPS_H_HEADER,
     BLACKBOX_STATE_SEND_GPS_G_HEADER,
     BLACKBOX_STATE_SEND_SLOW_HEADER,
@@ -245,7 +281,7 @@ typedef enum BlackboxState {
     BLACKBOX_STATE_SHUTTING_DOWN
 } BlackboxState;
 
-#define BLACKBOX_FIRST_HEADER_SENDING_STATE BLACKBOX_STATE_SEND_HEADER
+#define BLACKBOX_FIRST_HEADER_SENDING_STATE BLACKBOX_STATE_SEND_CACHED_HEADER
 #define BLACKBOX_LAST_HEADER_SENDING_STATE BLACKBOX_STATE_SEND_SYSINFO
 
 typedef struct blackboxMainState_s {
@@ -322,6 +358,16 @@ static uint32_t blackboxIteration;
 static uint16_t blackboxPFrameIndex, blackboxIFrameIndex;
 static uint16_t blackboxSlowFrameIterationTimer;
 static bool blackboxLoggedAnyFrames;
+static uint8_t blackboxPEncoding;
+
+/*
+ * Cross field predictors, fixed for the log when it starts. Each motor is predicted from its previous value plus the
+ * change in the logged PID sums and throttle, weighted by how the mixer combines them. Filtered gyro in "F" frames is
+ * predicted by moving its previous value towards the raw gyro of the same frame by the gyro lowpass gain.
+ */
+static bool blackboxCrossFieldPredictors;
+static int32_t blackboxMixerWeights[MAX_SUPPORTED_MOTORS][4]; // roll, pitch, yaw, throttle
+static int32_t blackboxGyroRawGain;
 
 /*
  * We store voltages in I-frames relative to this, which was the voltage when the blackbox was activated.
@@ -339,8 +385,132 @@ static blackboxMainState_t blackboxHistoryRing[3];
 // These point into blackboxHistoryRing, use them to know where to store history of a given age (0, 1 or 2 generations old)
 static blackboxMainState_t* blackboxHistory[3];
 
+/*
+ * The PID loop snapshots the main state of every iteration it wants logged into this ring, and the blackbox task
+ * encodes and writes them out. The PID loop is the only writer of the head and the task the only writer of the tail.
+ *
+ * At 8kHz with every iteration logged the 1kHz blackbox task finds 8 samples waiting each time it runs.
+ */
+#ifdef STM32F10X
+#define BLACKBOX_SAMPLE_RING_SIZE 8
+#else
+#define BLACKBOX_SAMPLE_RING_SIZE 16
+#endif
+
+#define BLACKBOX_SAMPLE_INTRAFRAME  (1 << 0)
+#define BLACKBOX_SAMPLE_RESUME      (1 << 1)    // first iteration logged after a pause
+#define BLACKBOX_SAMPLE_RATE_CHANGE (1 << 2)    // "I" frame from which the "P" frames are logged at a new rate
+
+typedef struct blackboxSample_s {
+    blackboxMainState_t state;
+    uint32_t iteration;
+    uint8_t flags;
+    uint8_t pRateShift;     // the "P" frame rate shift in use from this iteration
+} blackboxSample_t;
+
+static blackboxSample_t blackboxSampleRing[BLACKBOX_SAMPLE_RING_SIZE];
+static volatile uint8_t blackboxSampleHead;
+static volatile uint8_t blackboxSampleTail;
+
+/*
+ * High rate gyro samples are queued from the gyro loop in a ring of their own, the task merges both rings back into
+ * loop order using the iteration each sample was taken in.
+ */
+#ifdef STM32F10X
+#define BLACKBOX_GYRO_SAMPLE_RING_SIZE 16
+#else
+#define BLACKBOX_GYRO_SAMPLE_RING_SIZE 32
+#endif
+
+typedef struct blackboxGyroSample_s {
+    uint32_t iteration;
+    int16_t values[BLACKBOX_GYRO_FIELD_COUNT];
+} blackboxGyroSample_t;
+
+static blackboxGyroSample_t blackboxGyroSampleRing[BLACKBOX_GYRO_SAMPLE_RING_SIZE];
+static volatile uint8_t blackboxGyroSampleHead;
+static volatile uint8_t blackboxGyroSampleTail;
+
+/*
+ * The ring is drained by the blackbox task every BLACKBOX_TASK_PERIOD_US, so at most a quarter of it is filled per task
+ * period to leave room for the task running late. That limits "F" frames to 8kHz (4kHz on the F1) with the 1kHz task,
+ * faster gyro loops have gyro_rate_denom raised to match.
+ */
+#define BLACKBOX_GYRO_SAMPLES_PER_TASK_PERIOD (BLACKBOX_GYRO_SAMPLE_RING_SIZE / 4)
+
+/*
+ * Each time the blackbox task runs it encodes at most twice the frames the rings fill with per task period, so that a
+ * run which finds them backed up after the task was held off can't take long enough to hold off the PID loop. The
+ * frames left over are caught up with over the next runs. Events and finishing the log still write out everything
+ * queued before them.
+ */
+#define BLACKBOX_ALL_QUEUED_FRAMES (BLACKBOX_SAMPLE_RING_SIZE + BLACKBOX_GYRO_SAMPLE_RING_SIZE)
+
+static uint8_t blackboxMaxFramesPerTaskRun;
+
+static uint8_t blackboxGyroSampleCountdown;
+static uint8_t blackboxGyroFieldCount;
+// Set when a gyro sample could not be queued, no more are queued until the next "I" frame resets the prediction
+static bool blackboxGyroSampleResync;
+
+static int16_t blackboxGyroHistory[BLACKBOX_GYRO_FIELD_COUNT];
+
+#ifdef GPS
+// Set by the PID loop when the periodic GPS home frame is due
+static bool blackboxGpsHomeDue;
+#endif
+
 static bool blackboxModeActivationConditionPresent = false;
 
+static uint8_t blackboxStreamIntraframeCountdown;
+
+/*
+ * Rate control. When the logging device's buffers run low the blackbox task raises the target shift, and the PID loop
+ * logs "P" frames at 1 / (1 << shift) of the configured rate from the next "I" frame, so a slow device gets a log of a
+ * lower rate instead of one with frames dropped from the middle of the prediction chain. The rate is raised a step at
+ * a time once the device has kept up for a while.
+ */
+#define BLACKBOX_RATE_LOW_HEADROOM      25      // percent of the device buffers free
+#define BLACKBOX_RATE_HIGH_HEADROOM     75
+#define BLACKBOX_RATE_DOWN_HOLD_MS      100     // gives the lower rate time to take effect before lowering it again
+#define BLACKBOX_RATE_UP_HOLD_MS        2000
+
+static uint8_t blackboxPRateShift;
+static volatile uint8_t blackboxPRateShiftTarget;
+static timeMs_t blackboxRateLowerTime;
+static timeMs_t blackboxRateHeadroomTime;   // when the headroom was last below BLACKBOX_RATE_HIGH_HEADROOM
+
+#ifdef USE_BLACKBOX_PREROLL
+/*
+ * In pre-roll mode the frames are held in RAM by blackbox_io.c, and written to the log when a trigger fires. Logging
+ * then goes on until preroll_hold_seconds after the last trigger. How far back the pre-roll reaches is set by the size
+ * of the RAM ring and the logging rate, not by a setting.
+ */
+static bool blackboxPrerollEnabled;
+static bool blackboxPrerollTriggered;   // something has been committed to this log
+static timeMs_t blackboxPrerollTriggerTime;
+
+static void blackboxLogQueuedIterations(uint8_t maxFrames);
+#endif
+
+#ifdef USE_BLACKBOX_HEADER_CACHE
+/*
+ * The whole log header is rendered into this buffer when the config is activated, so that arming only has to patch in
+ * the battery voltage reference before the header is written out in bulk. The header is rendered again on arming if
+ * the config has changed without being activated since, eg by in-flight adjustments, and a header which doesn't fit
+ * is sent line by line as without the cache.
+ */
+#define BLACKBOX_HEADER_CACHE_SIZE (8 * 1024)
+#define BLACKBOX_HEADER_VBATREF_DIGITS 4
+
+static struct {
+    uint8_t data[BLACKBOX_HEADER_CACHE_SIZE];
+    int32_t length;             // 0 while there is no header rendered
+    int32_t vbatRefOffset;      // of the digits of the vbatref value, -1 if the header doesn't have one
+    uint32_t configChecksum;
+} blackboxHeaderCache;
+#endif
+
 /**
  * Return true if it is safe to edit the Blackbox configuration in the emasterConfig.
  */
@@ -442,12 +612,14 @@ static void blackboxSetState(BlackboxState newState)
         case BLACKBOX_STATE_PREPARE_LOG_FILE:
             blackboxLoggedAnyFrames = false;
         break;
+        case BLACKBOX_STATE_SEND_CACHED_HEADER:
         case BLACKBOX_STATE_SEND_HEADER:
             blackboxHeaderBudget = 0;
             xmitState.headerIndex = 0;
             xmitState.u.startTime = millis();
         break;
         case BLACKBOX_STATE_SEND_MAIN_FIELD_HEADER:
+        case BLACKBOX_STATE_SEND_GYRO_HEADER:
         case BLACKBOX_STATE_SEND_GPS_G_HEADER:
         case BLACKBOX_STATE_SEND_GPS_H_HEADER:
         case BLACKBOX_STATE_SEND_SLOW_HEADER:
@@ -469,13 +641,13 @@ static void blackboxSetState(BlackboxState newState)
     blackboxState = newState;
 }
 
-static void writeIntraframe(void)
+static void writeIntraframe(uint32_t iteration)
 {
     blackboxMainState_t *blackboxCurrent = blackboxHistory[0];
 
     blackboxWrite('I');
 
-    blackboxWriteUnsignedVB(blackboxIteration);
+    blackboxWriteUnsignedVB(iteration);
     blackboxWriteUnsignedVB(blackboxCurrent->time);
 
     blackboxWriteSignedVBArray(blackboxCurrent->axisPID_P, XYZ_AXIS_COUNT);
@@ -552,6 +724,20 @@ static void writeIntraframe(void)
         blackboxWriteSignedVB(blackboxCurrent->servo[5] - 1500);
     }
 
+    // The stream is decimated to every stream_rate_denom'th "I" frame, it gets none of the frames predicted from others
+    if (blackboxStreamIntraframeCountdown == 0) {
+        blackboxStreamIntraframeCountdown = blackboxConfig()->stream_rate_denom - 1;
+        blackboxFlushFrame();
+    } else {
+        blackboxStreamIntraframeCountdown--;
+        blackboxFlushFrameTo(BLACKBOX_SINK_MASK(BLACKBOX_SINK_PRIMARY));
+    }
+
+    // "F" frames start over from zero after every "I" frame
+    memset(blackboxGyroHistory, 0, sizeof(blackboxGyroHistory));
+    // and so do the statistics of the "P" frame residual coder
+    blackboxResidualCoderReset();
+
     //Rotate our history buffers:
 
     //The current state becomes the new "before" state
@@ -578,6 +764,45 @@ static void blackboxWriteMainStateArrayUsingAveragePredictor(int arrOffsetInHist
     }
 }
 
+static int32_t pidSumDelta(int axis)
+{
+    const blackboxMainState_t *blackboxCurrent = blackboxHistory[0];
+    const blackboxMainState_t *blackboxLast = blackboxHistory[1];
+    int32_t delta = (blackboxCurrent->axisPID_P[axis] - blackboxLast->axisPID_P[axis])
+        + (blackboxCurrent->axisPID_I[axis] - blackboxLast->axisPID_I[axis]);
+
+    // The decoder only knows the D terms which are logged
+    if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_NONZERO_PID_D_0 + axis)) {
+        delta += blackboxCurrent->axisPID_D[axis] - blackboxLast->axisPID_D[axis];
+    }
+
+    return delta;
+}
+
+static void writeMotorsUsingMixerPredictor(void)
+{
+    const blackboxMainState_t *blackboxCurrent = blackboxHistory[0];
+    const blackboxMainState_t *blackboxLast = blackboxHistory[1];
+    const int32_t deltas[4] = {
+        pidSumDelta(ROLL),
+        pidSumDelta(PITCH),
+        pidSumDelta(YAW),
+        blackboxCurrent->rcCommand[THROTTLE] - blackboxLast->rcCommand[THROTTLE]
+    };
+
+    for (int i = 0; i < getMotorCount(); i++) {
+        int32_t change = 0;
+
+        for (int j = 0; j < 4; j++) {
+            change += blackboxMixerWeights[i][j] * deltas[j];
+        }
+
+        const int32_t predicted = blackboxLast->motor[i] + (change >> BLACKBOX_MIXER_WEIGHT_SHIFT);
+
+        blackboxWriteSignedVB(blackboxCurrent->motor[i] - predicted);
+    }
+}
+
 static void writeInterframe(void)
 {
     int x;
@@ -588,6 +813,10 @@ static void writeInterframe(void)
 
     blackboxWrite('P');
 
+    if (blackboxPEncoding == BLACKBOX_P_ENCODING_GOLOMB_RICE) {
+        blackboxResidualCoderBegin();
+    }
+
     //No need to store iteration count since its delta is always 1
 
     /*
@@ -667,12 +896,22 @@ static void writeInterframe(void)
     blackboxWriteMainStateArrayUsingAveragePredictor(offsetof(blackboxMainState_t, gyroADC),   XYZ_AXIS_COUNT);
     blackboxWriteMainStateArrayUsingAveragePredictor(offsetof(blackboxMainState_t, accSmooth), XYZ_AXIS_COUNT);
     blackboxWriteMainStateArrayUsingAveragePredictor(offsetof(blackboxMainState_t, debug), 4);
-    blackboxWriteMainStateArrayUsingAveragePredictor(offsetof(blackboxMainState_t, motor),     getMotorCount());
+    if (blackboxCrossFieldPredictors) {
+        writeMotorsUsingMixerPredictor();
+    } else {
+        blackboxWriteMainStateArrayUsingAveragePredictor(offsetof(blackboxMainState_t, motor),     getMotorCount());
+    }
 
     if (testBlackboxCondition(FLIGHT_LOG_FIELD_CONDITION_TRICOPTER)) {
         blackboxWriteSignedVB(blackboxCurrent->servo[5] - blackboxLast->servo[5]);
     }
 
+    if (blackboxPEncoding == BLACKBOX_P_ENCODING_GOLOMB_RICE) {
+        blackboxResidualCoderEnd();
+    }
+
+    blackboxFlushFrameTo(BLACKBOX_SINK_MASK(BLACKBOX_SINK_PRIMARY));
+
     //Rotate our history buffers
     blackboxHistory[2] = blackboxHistory[1];
     blackboxHistory[1] = blackboxHistory[0];
@@ -700,9 +939,39 @@ static void writeSlowFrame(void)
     values[2] = slowHistory.rxFlightChannelsValid ? 1 : 0;
     blackboxWriteTag2_3S32(values);
 
+    blackboxFlushFrame();
+
     blackboxSlowFrameIterationTimer = 0;
 }
 
+static void writeGyroFrame(const blackboxGyroSample_t *sample)
+{
+    int32_t deltas[8];
+
+    blackboxWrite('F');
+
+    // All the fields are TAG8_8SVB encoded, in groups of up to 8
+    for (int i = 0; i < blackboxGyroFieldCount; i += 8) {
+        const int count = MIN(blackboxGyroFieldCount - i, 8);
+
+        for (int j = 0; j < count; j++) {
+            const int field = i + j;
+            int32_t predicted = blackboxGyroHistory[field];
+
+            if (blackboxCrossFieldPredictors && field >= BLACKBOX_GYRO_FIELD_GYRO_ADC_0 && field < BLACKBOX_GYRO_FIELD_MOTOR_0) {
+                const int32_t raw = sample->values[field - BLACKBOX_GYRO_FIELD_GYRO_ADC_0];
+                predicted += ((raw - predicted) * blackboxGyroRawGain) >> BLACKBOX_GYRO_RAW_GAIN_SHIFT;
+            }
+
+            deltas[j] = sample->values[field] - predicted;
+            blackboxGyroHistory[field] = sample->values[field];
+        }
+        blackboxWriteTag8_8SVB(deltas, count);
+    }
+
+    blackboxFlushFrameTo(BLACKBOX_SINK_MASK(BLACKBOX_SINK_PRIMARY));
+}
+
 /**
  * Load rarely-changing values from the FC into the given structure
  */
@@ -755,6 +1024,39 @@ static int gcd(int num, int denom)
     return gcd(denom, num % denom);
 }
 
+// gyro_rate_denom, raised where needed to keep the "F" frame rate within what the gyro sample ring can hold
+static uint8_t blackboxGyroRateDenom(void)
+{
+    if (!blackboxConfig()->gyro_rate_denom || !gyro.targetLooptime) {
+        return blackboxConfig()->gyro_rate_denom;
+    }
+
+    const uint32_t minIntervalUs = BLACKBOX_TASK_PERIOD_US / BLACKBOX_GYRO_SAMPLES_PER_TASK_PERIOD;
+    const uint32_t minDenom = (minIntervalUs + gyro.targetLooptime - 1) / gyro.targetLooptime;
+
+    return MAX(blackboxConfig()->gyro_rate_denom, minDenom);
+}
+
+// The number of main and "F" frames queued per blackbox task period at the configured rates, rounded up
+static uint8_t blackboxFramesPerTaskPeriod(void)
+{
+    const uint32_t pidLooptime = gyro.targetLooptime * MAX(pidConfig()->pid_process_denom, 1);
+    uint32_t frames = 1;
+
+    if (pidLooptime) {
+        const uint32_t pFrameIntervalUs = pidLooptime * blackboxConfig()->rate_denom;
+
+        frames = (BLACKBOX_TASK_PERIOD_US * blackboxConfig()->rate_num + pFrameIntervalUs - 1) / pFrameIntervalUs;
+    }
+    if (blackboxConfig()->gyro_rate_denom && gyro.targetLooptime) {
+        const uint32_t gyroFrameIntervalUs = gyro.targetLooptime * blackboxGyroRateDenom();
+
+        frames += (BLACKBOX_TASK_PERIOD_US + gyroFrameIntervalUs - 1) / gyroFrameIntervalUs;
+    }
+
+    return MIN(frames, BLACKBOX_ALL_QUEUED_FRAMES);
+}
+
 static void validateBlackboxConfig()
 {
     int div;
@@ -788,6 +1090,91 @@ static void validateBlackboxConfig()
         default:
             blackboxConfig()->device = BLACKBOX_DEVICE_SERIAL;
     }
+
+    // The stream needs a supported device of its own
+    switch (blackboxConfig()->stream_device) {
+#ifdef USE_FLASHFS
+        case BLACKBOX_DEVICE_FLASH:
+#endif
+#ifdef USE_SDCARD
+        case BLACKBOX_DEVICE_SDCARD:
+#endif
+        case BLACKBOX_DEVICE_SERIAL:
+            if (blackboxConfig()->stream_device == blackboxConfig()->device) {
+                blackboxConfig()->stream_device = BLACKBOX_DEVICE_NONE;
+            }
+        break;
+
+        default:
+            blackboxConfig()->stream_device = BLACKBOX_DEVICE_NONE;
+    }
+
+    if (blackboxConfig()->stream_rate_denom == 0) {
+        blackboxConfig()->stream_rate_denom = 1;
+    }
+}
+
+static void blackboxLoadCrossFieldPredictors(void)
+{
+    for (int i = 0; i < getMotorCount(); i++) {
+        motorMixer_t gains;
+        mixerGetMotorGains(i, &gains);
+
+        blackboxMixerWeights[i][ROLL] = lrintf(gains.roll * (1 << BLACKBOX_MIXER_WEIGHT_SHIFT));
+        blackboxMixerWeights[i][PITCH] = lrintf(gains.pitch * (1 << BLACKBOX_MIXER_WEIGHT_SHIFT));
+        blackboxMixerWeights[i][YAW] = lrintf(gains.yaw * (1 << BLACKBOX_MIXER_WEIGHT_SHIFT));
+        blackboxMixerWeights[i][3] = lrintf(gains.throttle * (1 << BLACKBOX_MIXER_WEIGHT_SHIFT));
+    }
+
+    // The same first order lowpass gain as the gyro's PT1 filter, at the "F" frame rate
+    blackboxGyroRawGain = 1 << BLACKBOX_GYRO_RAW_GAIN_SHIFT;
+    if (gyroConfig()->gyro_soft_lpf_hz && blackboxConfig()->gyro_rate_denom) {
+        const float dT = gyro.targetLooptime * blackboxGyroRateDenom() * 1e-6f;
+        const float RC = 1.0f / (2.0f * M_PIf * gyroConfig()->gyro_soft_lpf_hz);
+        blackboxGyroRawGain = lrintf(dT / (RC + dT) * (1 << BLACKBOX_GYRO_RAW_GAIN_SHIFT));
+    }
+}
+
+#ifdef USE_BLACKBOX_HEADER_CACHE
+static uint32_t blackboxConfigChecksum(void)
+{
+    const uint8_t *data = (const uint8_t *) &masterConfig;
+    uint32_t checksum = 0;
+
+    for (unsigned i = 0; i < sizeof(masterConfig); i++) {
+        checksum = ((checksum << 1) | (checksum >> 31)) + data[i];
+    }
+
+    return checksum;
+}
+
+// The vbatref value is rendered at a fixed width, for the reference of this log to be written over it
+static void blackboxPatchHeaderVbatRef(void)
+{
+    if (blackboxHeaderCache.vbatRefOffset < 0) {
+        return;
+    }
+
+    uint16_t value = vbatReference;
+    for (int i = BLACKBOX_HEADER_VBATREF_DIGITS - 1; i >= 0; i--) {
+        blackboxHeaderCache.data[blackboxHeaderCache.vbatRefOffset + i] = '0' + value % 10;
+        value /= 10;
+    }
+}
+#endif
+
+/*
+ * We use conditional tests to decide whether or not certain fields should be logged. Since our headers must always
+ * agree with the logged data, the results of these tests, the encoding and the predictors must not change during
+ * logging. So cache those now.
+ */
+static void blackboxLatchHeaderConfig(void)
+{
+    blackboxBuildConditionCache();
+
+    blackboxPEncoding = blackboxConfig()->p_encoding;
+    blackboxCrossFieldPredictors = blackboxConfig()->cross_field_predictors;
+    blackboxLoadCrossFieldPredictors();
 }
 
 /**
@@ -813,18 +1200,49 @@ void startBlackbox(void)
 
         //No need to clear the content of blackboxHistoryRing since our first frame will be an intra which overwrites it
 
-        /*
-         * We use conditional tests to decide whether or not certain fields should be logged. Since our headers
-         * must always agree with the logged data, the results of these tests must not change during logging. So
-         * cache those now.
-         */
-        blackboxBuildConditionCache();
+        blackboxLatchHeaderConfig();
+
+#ifdef USE_BLACKBOX_HEADER_CACHE
+        if (blackboxConfigChecksum() != blackboxHeaderCache.configChecksum) {
+            blackboxRenderHeader();
+        }
+        blackboxPatchHeaderVbatRef();
+#endif
 
         blackboxModeActivationConditionPresent = isModeActivationConditionPresent(modeActivationProfile()->modeActivationConditions, BOXBLACKBOX);
 
+#ifdef USE_BLACKBOX_PREROLL
+        // The blackbox mode switch triggers the pre-roll instead of pausing the log
+        blackboxPrerollEnabled = blackboxConfig()->preroll_hold_seconds > 0;
+        blackboxPrerollTriggered = false;
+        if (blackboxPrerollEnabled) {
+            blackboxModeActivationConditionPresent = false;
+        }
+#endif
+
         blackboxIteration = 0;
         blackboxPFrameIndex = 0;
         blackboxIFrameIndex = 0;
+        blackboxStreamIntraframeCountdown = 0;
+
+        blackboxPRateShift = 0;
+        blackboxPRateShiftTarget = 0;
+        blackboxRateLowerTime = millis();
+        blackboxRateHeadroomTime = millis();
+
+        blackboxSampleHead = 0;
+        blackboxSampleTail = 0;
+
+        blackboxGyroSampleHead = 0;
+        blackboxGyroSampleTail = 0;
+        blackboxGyroSampleCountdown = 0;
+        blackboxMaxFramesPerTaskRun = MIN(blackboxFramesPerTaskPeriod() * 2, BLACKBOX_ALL_QUEUED_FRAMES);
+        blackboxGyroFieldCount = BLACKBOX_GYRO_FIELD_MOTOR_0 + MIN(getMotorCount(), BLACKBOX_GYRO_FIELD_COUNT - BLACKBOX_GYRO_FIELD_MOTOR_0);
+        // The first gyro sample must follow the first "I" frame
+        blackboxGyroSampleResync = true;
+#ifdef GPS
+        blackboxGpsHomeDue = false;
+#endif
 
         /*
          * Record the beeper's current idea of the last arming beep time, so that we can detect it changing when
@@ -852,6 +1270,14 @@ void finishBlackbox(void)
 
         case BLACKBOX_STATE_RUNNING:
         case BLACKBOX_STATE_PAUSED:
+#ifdef USE_BLACKBOX_PREROLL
+            if (blackboxPrerollIsBuffering()) {
+                // Nothing has triggered since the ring was last written out, so the iterations still queued are dropped too
+                blackboxLogQueuedIterations(BLACKBOX_ALL_QUEUED_FRAMES);
+                blackboxPrerollStop();
+                blackboxLoggedAnyFrames = blackboxPrerollTriggered;
+            }
+#endif
             blackboxLogEvent(FLIGHT_LOG_EVENT_LOG_END, NULL);
 
             // Fall through
@@ -868,7 +1294,7 @@ bool startedLoggingInTestMode = false;
 void startInTestMode(void)
 {
     if(!startedLoggingInTestMode) {
-        if (blackboxConfig()->device == BLACKBOX_DEVICE_SERIAL) {
+        if (blackboxConfig()->device == BLACKBOX_DEVICE_SERIAL || blackboxConfig()->stream_device == BLACKBOX_DEVICE_SERIAL) {
             serialPort_t *sharedBlackboxAndMspPort = findSharedSerialPort(FUNCTION_BLACKBOX, FUNCTION_MSP);
             if (sharedBlackboxAndMspPort) {
                 return; // When in test mode, we cannot share the MSP and serial logger port!
@@ -934,6 +1360,8 @@ static void writeGPSHomeFrame()
     blackboxWriteSignedVB(GPS_home[1]);
     //TODO it'd be great if we could grab the GPS current time and write that too
 
+    blackboxFlushFrame();
+
     gpsHistory.GPS_home[0] = GPS_home[0];
     gpsHistory.GPS_home[1] = GPS_home[1];
 }
@@ -960,6 +1388,9 @@ static void writeGPSFrame(timeUs_t currentTimeUs)
     blackboxWriteUnsignedVB(GPS_speed);
     blackboxWriteUnsignedVB(GPS_ground_course);
 
+    // The time is predicted from the last main frame, which is usually a "P" frame the stream doesn't get
+    blackboxFlushFrameTo(BLACKBOX_SINK_MASK(BLACKBOX_SINK_PRIMARY));
+
     gpsHistory.GPS_numSat = GPS_numSat;
     gpsHistory.GPS_coord[0] = GPS_coord[0];
     gpsHistory.GPS_coord[1] = GPS_coord[1];
@@ -967,11 +1398,10 @@ static void writeGPSFrame(timeUs_t currentTimeUs)
 #endif
 
 /**
- * Fill the current state of the blackbox using values read from the flight controller
+ * Fill the given state of the blackbox using values read from the flight controller
  */
-static void loadMainState(timeUs_t currentTimeUs)
+static void loadMainState(blackboxMainState_t *blackboxCurrent, timeUs_t currentTimeUs)
 {
-    blackboxMainState_t *blackboxCurrent = blackboxHistory[0];
     int i;
 
     blackboxCurrent->time = currentTimeUs;
@@ -1033,6 +1463,21 @@ static void loadMainState(timeUs_t currentTimeUs)
 #endif
 }
 
+/**
+ * Return the predictor a field uses in the given frame type when the cross field predictors are enabled.
+ */
+static int blackboxCrossFieldPredictor(char frameChar, const char *fieldName, int predictor)
+{
+    if (frameChar == 'P' && !strcmp(fieldName, "motor")) {
+        return FLIGHT_LOG_FIELD_PREDICTOR_MIXER;
+    }
+    if (frameChar == 'F' && !strcmp(fieldName, "gyroADC")) {
+        return FLIGHT_LOG_FIELD_PREDICTOR_GYRO_RAW;
+    }
+
+    return predictor;
+}
+
 /**
  * Transmit the header information for the given field definitions. Transmitted header lines look like:
  *
@@ -1133,7 +1578,19 @@ static bool sendFieldDefinition(char mainFrameChar, char deltaFrameChar, const v
                 }
             } else {
                 //The other headers are integers
-                blackboxPrintf("%d", def->arr[xmitState.headerIndex - 1]);
+                int value = def->arr[xmitState.headerIndex - 1];
+
+                if (blackboxCrossFieldPredictors && !strcmp(blackboxFieldHeaderNames[xmitState.headerIndex], "predictor")) {
+                    value = blackboxCrossFieldPredictor(xmitState.headerIndex >= BLACKBOX_SIMPLE_FIELD_HEADER_COUNT ? deltaFrameChar : mainFrameChar, def->name, value);
+                }
+
+                // Every "P" field which is written at all goes through the residual coder when it's selected
+                if (xmitState.headerIndex == BLACKBOX_DELTA_FIELD_HEADER_COUNT - 1
+                    && blackboxPEncoding == BLACKBOX_P_ENCODING_GOLOMB_RICE && value != FLIGHT_LOG_FIELD_ENCODING_NULL) {
+                    value = FLIGHT_LOG_FIELD_ENCODING_GOLOMB_RICE;
+                }
+
+                blackboxPrintf("%d", value);
             }
         }
     }
@@ -1158,6 +1615,16 @@ static bool sendFieldDefinition(char mainFrameChar, char deltaFrameChar, const v
                                                break;
 #endif
 
+// The weights of the mixer predictor for one logged motor, as roll, pitch, yaw and throttle
+static void blackboxPrintMixerWeights(int motorIndex)
+{
+    if (blackboxCrossFieldPredictors && motorIndex < getMotorCount()) {
+        blackboxPrintfHeaderLine("mixerWeights[%d]:%d,%d,%d,%d", motorIndex,
+            blackboxMixerWeights[motorIndex][ROLL], blackboxMixerWeights[motorIndex][PITCH],
+            blackboxMixerWeights[motorIndex][YAW], blackboxMixerWeights[motorIndex][3]);
+    }
+}
+
 /**
  * Transmit a portion of the system information headers. Call the first time with xmitState.headerIndex == 0. Returns
  * true iff transmission is complete, otherwise call again later to continue transmission.
@@ -1177,10 +1644,24 @@ static bool blackboxWriteSysinfo()
         BLACKBOX_PRINT_HEADER_LINE("Firmware date:%s %s",                 buildDate, buildTime);
         BLACKBOX_PRINT_HEADER_LINE("Craft name:%s",                       masterConfig.name);
         BLACKBOX_PRINT_HEADER_LINE("P interval:%d/%d",                    blackboxConfig()->rate_num, blackboxConfig()->rate_denom);
+        BLACKBOX_PRINT_HEADER_LINE("F interval:%d",                       blackboxGyroRateDenom());
         BLACKBOX_PRINT_HEADER_LINE("minthrottle:%d",                      motorConfig()->minthrottle);
         BLACKBOX_PRINT_HEADER_LINE("maxthrottle:%d",                      motorConfig()->maxthrottle);
         BLACKBOX_PRINT_HEADER_LINE("gyro_scale:0x%x",                     castFloatBytesToInt(1.0f));
         BLACKBOX_PRINT_HEADER_LINE("motorOutput:%d,%d",                   motorOutputLow,motorOutputHigh);
+        BLACKBOX_PRINT_HEADER_LINE_CUSTOM(blackboxPrintMixerWeights(0););
+        BLACKBOX_PRINT_HEADER_LINE_CUSTOM(blackboxPrintMixerWeights(1););
+        BLACKBOX_PRINT_HEADER_LINE_CUSTOM(blackboxPrintMixerWeights(2););
+        BLACKBOX_PRINT_HEADER_LINE_CUSTOM(blackboxPrintMixerWeights(3););
+        BLACKBOX_PRINT_HEADER_LINE_CUSTOM(blackboxPrintMixerWeights(4););
+        BLACKBOX_PRINT_HEADER_LINE_CUSTOM(blackboxPrintMixerWeights(5););
+        BLACKBOX_PRINT_HEADER_LINE_CUSTOM(blackboxPrintMixerWeights(6););
+        BLACKBOX_PRINT_HEADER_LINE_CUSTOM(blackboxPrintMixerWeights(7););
+        BLACKBOX_PRINT_HEADER_LINE_CUSTOM(
+            if (blackboxCrossFieldPredictors) {
+                blackboxPrintfHeaderLine("gyroRawGain:%d", blackboxGyroRawGain);
+            }
+            );
         BLACKBOX_PRINT_HEADER_LINE("acc_1G:%u",                           acc.dev.acc_1G);
 
         BLACKBOX_PRINT_HEADER_LINE_CUSTOM(
@@ -1194,7 +1675,7 @@ static bool blackboxWriteSysinfo()
         BLACKBOX_PRINT_HEADER_LINE("vbatcellvoltage:%u,%u,%u",            batteryConfig()->vbatmincellvoltage,
                                                                           batteryConfig()->vbatwarningcellvoltage,
                                                                           batteryConfig()->vbatmaxcellvoltage);
-        BLACKBOX_PRINT_HEADER_LINE("vbatref:%u",                          vbatReference);
+        BLACKBOX_PRINT_HEADER_LINE("vbatref:%04u",                        vbatReference);
 
         BLACKBOX_PRINT_HEADER_LINE_CUSTOM(
             //Note: Log even if this is a virtual current meter, since the virtual meter uses these parameters too:
@@ -1298,16 +1779,98 @@ static bool blackboxWriteSysinfo()
     return false;
 }
 
+#ifdef USE_BLACKBOX_HEADER_CACHE
+// Find where the digits of the vbatref value were rendered
+static int32_t blackboxFindHeaderVbatRef(void)
+{
+    static const char key[] = "H vbatref:";
+    const int keyLength = strlen(key);
+
+    for (int32_t i = 0; i + keyLength + BLACKBOX_HEADER_VBATREF_DIGITS <= blackboxHeaderCache.length; i++) {
+        if (memcmp(&blackboxHeaderCache.data[i], key, keyLength) == 0) {
+            return i + keyLength;
+        }
+    }
+
+    return -1;
+}
+
 /**
- * Write the given event to the log immediately
+ * Render the log header for the current config, to be written out in bulk on arming. Call after activateConfig(), the
+ * header is left as it was if a log is in progress.
  */
-void blackboxLogEvent(FlightLogEvent event, flightLogEventData_t *data)
+void blackboxRenderHeader(void)
 {
-    // Only allow events to be logged after headers have been written
-    if (!(blackboxState == BLACKBOX_STATE_RUNNING || blackboxState == BLACKBOX_STATE_PAUSED)) {
+    if (blackboxState != BLACKBOX_STATE_STOPPED) {
         return;
     }
 
+    validateBlackboxConfig();
+    blackboxLatchHeaderConfig();
+
+    blackboxCaptureBegin(blackboxHeaderCache.data, sizeof(blackboxHeaderCache.data));
+
+    blackboxPrint(blackboxHeader);
+
+    xmitState.headerIndex = 0;
+    xmitState.u.fieldIndex = -1;
+    while (sendFieldDefinition('I', 'P', blackboxMainFields, blackboxMainFields + 1, ARRAY_LENGTH(blackboxMainFields),
+            &blackboxMainFields[0].condition, &blackboxMainFields[1].condition));
+
+    if (blackboxConfig()->gyro_rate_denom) {
+        xmitState.headerIndex = 0;
+        xmitState.u.fieldIndex = -1;
+        while (sendFieldDefinition('F', 0, blackboxGyroFields, blackboxGyroFields + 1, ARRAY_LENGTH(blackboxGyroFields),
+                &blackboxGyroFields[0].condition, &blackboxGyroFields[1].condition));
+    }
+
+#ifdef GPS
+    if (feature(FEATURE_GPS)) {
+        xmitState.headerIndex = 0;
+        xmitState.u.fieldIndex = -1;
+        while (sendFieldDefinition('H', 0, blackboxGpsHFields, blackboxGpsHFields + 1, ARRAY_LENGTH(blackboxGpsHFields),
+                NULL, NULL));
+
+        xmitState.headerIndex = 0;
+        xmitState.u.fieldIndex = -1;
+        while (sendFieldDefinition('G', 0, blackboxGpsGFields, blackboxGpsGFields + 1, ARRAY_LENGTH(blackboxGpsGFields),
+                &blackboxGpsGFields[0].condition, &blackboxGpsGFields[1].condition));
+    }
+#endif
+
+    xmitState.headerIndex = 0;
+    xmitState.u.fieldIndex = -1;
+    while (sendFieldDefinition('S', 0, blackboxSlowFields, blackboxSlowFields + 1, ARRAY_LENGTH(blackboxSlowFields),
+            NULL, NULL));
+
+    xmitState.headerIndex = 0;
+    while (!blackboxWriteSysinfo());
+
+    blackboxHeaderCache.length = MAX(blackboxCaptureEnd(), 0);
+    blackboxHeaderCache.vbatRefOffset = blackboxFindHeaderVbatRef();
+    blackboxHeaderCache.configChecksum = blackboxConfigChecksum();
+}
+#endif
+
+/*
+ * Wait for header buffers to drain completely before data logging begins to ensure reliable header delivery
+ * (overflowing circular buffers causes all data to be discarded, so the first few logged iterations
+ * could wipe out the end of the header if we weren't careful)
+ */
+static void blackboxStartLoggingOnceHeaderDrained(void)
+{
+    if (blackboxDeviceFlushForce()) {
+#ifdef USE_BLACKBOX_PREROLL
+        if (blackboxPrerollEnabled) {
+            blackboxPrerollStart();
+        }
+#endif
+        blackboxSetState(BLACKBOX_STATE_RUNNING);
+    }
+}
+
+static void writeEvent(FlightLogEvent event, flightLogEventData_t *data)
+{
     //Shared header for event frames
     blackboxWrite('E');
     blackboxWrite(event);
@@ -1334,11 +1897,116 @@ void blackboxLogEvent(FlightLogEvent event, flightLogEventData_t *data)
             blackboxWriteUnsignedVB(data->loggingResume.logIteration);
             blackboxWriteUnsignedVB(data->loggingResume.currentTime);
         break;
+        case FLIGHT_LOG_EVENT_PREROLL_TRIGGER:
+            blackboxWriteUnsignedVB(data->prerollTrigger.triggers);
+            blackboxWriteUnsignedVB(data->prerollTrigger.retainedMs);
+        break;
+        case FLIGHT_LOG_EVENT_RATE_CHANGE:
+            blackboxWriteUnsignedVB(data->rateChange.rateNum);
+            blackboxWriteUnsignedVB(data->rateChange.rateDenom);
+        break;
         case FLIGHT_LOG_EVENT_LOG_END:
             blackboxPrint("End of log");
             blackboxWrite(0);
         break;
     }
+
+    blackboxFlushFrame();
+}
+
+/**
+ * Encode and write up to maxFrames of the iterations queued by the PID loop, oldest first.
+ */
+static void blackboxLogQueuedIterations(uint8_t maxFrames)
+{
+    for (; maxFrames > 0 && (blackboxSampleTail != blackboxSampleHead || blackboxGyroSampleTail != blackboxGyroSampleHead); maxFrames--) {
+        if (blackboxSampleTail == blackboxSampleHead
+            || (blackboxGyroSampleTail != blackboxGyroSampleHead
+                && cmp32(blackboxGyroSampleRing[blackboxGyroSampleTail].iteration, blackboxSampleRing[blackboxSampleTail].iteration) < 0)) {
+            writeGyroFrame(&blackboxGyroSampleRing[blackboxGyroSampleTail]);
+            blackboxGyroSampleTail = (blackboxGyroSampleTail + 1) % BLACKBOX_GYRO_SAMPLE_RING_SIZE;
+            continue;
+        }
+
+        const blackboxSample_t *sample = &blackboxSampleRing[blackboxSampleTail];
+
+        memcpy(blackboxHistory[0], &sample->state, sizeof(blackboxMainState_t));
+
+        bool writeResume = sample->flags & BLACKBOX_SAMPLE_RESUME;
+        bool writeRateChange = sample->flags & BLACKBOX_SAMPLE_RATE_CHANGE;
+
+#ifdef USE_BLACKBOX_PREROLL
+        if (blackboxPrerollEnabled && (sample->flags & BLACKBOX_SAMPLE_INTRAFRAME)) {
+            /*
+             * Any "I" frame can become the first one of the pre-roll to be logged, so each one is announced as a resume
+             * for the decoder to accept the skip from the frames before it, and carries a GPS home frame.
+             */
+            blackboxPrerollBeginSegment();
+            writeResume = true;
+            // The rate change may be dropped with the segment it was logged in
+            writeRateChange = writeRateChange || sample->pRateShift;
+#ifdef GPS
+            if (blackboxPrerollIsBuffering()) {
+                blackboxGpsHomeDue = true;
+            }
+#endif
+        }
+#endif
+
+        if (writeResume) {
+            // Write a log entry so the decoder is aware that our large time/iteration skip is intended
+            flightLogEvent_loggingResume_t resume;
+
+            resume.logIteration = sample->iteration;
+            resume.currentTime = sample->state.time;
+
+            writeEvent(FLIGHT_LOG_EVENT_LOGGING_RESUME, (flightLogEventData_t *) &resume);
+        }
+
+        if (writeRateChange) {
+            flightLogEvent_rateChange_t rateChange;
+
+            rateChange.rateNum = blackboxConfig()->rate_num;
+            rateChange.rateDenom = blackboxConfig()->rate_denom << sample->pRateShift;
+
+            writeEvent(FLIGHT_LOG_EVENT_RATE_CHANGE, (flightLogEventData_t *) &rateChange);
+        }
+
+        if (sample->flags & BLACKBOX_SAMPLE_INTRAFRAME) {
+            /*
+             * Don't log a slow frame if the slow data didn't change ("I" frames are already large enough without adding
+             * an additional item to write at the same time). Unless we're *only* logging "I" frames, then we have no choice.
+             */
+            writeSlowFrameIfNeeded(blackboxIsOnlyLoggingIntraframes());
+
+            writeIntraframe(sample->iteration);
+        } else {
+            /*
+             * We assume that slow frames are only interesting in that they aid the interpretation of the main data stream.
+             * So only log slow frames during loop iterations where we log a main frame.
+             */
+            writeSlowFrameIfNeeded(true);
+
+            writeInterframe();
+        }
+
+        blackboxSampleTail = (blackboxSampleTail + 1) % BLACKBOX_SAMPLE_RING_SIZE;
+    }
+}
+
+/**
+ * Write the given event to the log, after the iterations which are still queued
+ */
+void blackboxLogEvent(FlightLogEvent event, flightLogEventData_t *data)
+{
+    // Only allow events to be logged after headers have been written
+    if (!(blackboxState == BLACKBOX_STATE_RUNNING || blackboxState == BLACKBOX_STATE_PAUSED)) {
+        return;
+    }
+
+    blackboxLogQueuedIterations(BLACKBOX_ALL_QUEUED_FRAMES);
+
+    writeEvent(event, data);
 }
 
 /* If an arming beep has played since it was last logged, write the time of the arming beep to the log as a synchronization point */
@@ -1372,15 +2040,17 @@ static void blackboxCheckAndLogFlightMode()
 }
 
 /*
- * Use the user's num/denom settings to decide if the P-frame of the given index should be logged, allowing the user to control
- * the portion of logged loop iterations.
+ * Use the user's num/denom settings, lowered by the rate control, to decide if the P-frame of the given index should be
+ * logged, allowing the user to control the portion of logged loop iterations.
  */
 static bool blackboxShouldLogPFrame(uint32_t pFrameIndex)
 {
+    const uint16_t rateDenom = blackboxConfig()->rate_denom << blackboxPRateShift;
+
     /* Adding a magic shift of "blackboxConfig()->rate_num - 1" in here creates a better spread of
      * recorded / skipped frames when the I frame's position is considered:
      */
-    return (pFrameIndex + blackboxConfig()->rate_num - 1) % blackboxConfig()->rate_denom < blackboxConfig()->rate_num;
+    return (pFrameIndex + blackboxConfig()->rate_num - 1) % rateDenom < blackboxConfig()->rate_num;
 }
 
 static bool blackboxShouldLogIFrame() {
@@ -1400,44 +2070,273 @@ static void blackboxAdvanceIterationTimers()
     }
 }
 
-// Called once every FC loop in order to log the current state
-static void blackboxLogIteration(timeUs_t currentTimeUs)
+/*
+ * Snapshot the current state into the sample ring, returns false if the blackbox task has fallen behind and the ring
+ * is full.
+ */
+static bool blackboxQueueSample(timeUs_t currentTimeUs, uint8_t flags)
 {
+    const uint8_t head = blackboxSampleHead;
+    const uint8_t nextHead = (head + 1) % BLACKBOX_SAMPLE_RING_SIZE;
+
+    if (nextHead == blackboxSampleTail) {
+        return false;
+    }
+
+    blackboxSample_t *sample = &blackboxSampleRing[head];
+
+    // A new rate starts at an "I" frame, which the "P" frames after it are counted from
+    const uint8_t pRateShiftTarget = blackboxPRateShiftTarget;
+    if ((flags & BLACKBOX_SAMPLE_INTRAFRAME) && pRateShiftTarget != blackboxPRateShift) {
+        blackboxPRateShift = pRateShiftTarget;
+        flags |= BLACKBOX_SAMPLE_RATE_CHANGE;
+    }
+
+    loadMainState(&sample->state, currentTimeUs);
+    sample->iteration = blackboxIteration;
+    sample->flags = flags;
+    sample->pRateShift = blackboxPRateShift;
+
+    blackboxSampleHead = nextHead;
+
+    return true;
+}
+
+// Called once every FC loop while running in order to queue the current state for logging
+static void blackboxQueueIteration(timeUs_t currentTimeUs)
+{
+    bool queued = true;
+
     // Write a keyframe every BLACKBOX_I_INTERVAL frames so we can resynchronise upon missing frames
     if (blackboxShouldLogIFrame()) {
-        /*
-         * Don't log a slow frame if the slow data didn't change ("I" frames are already large enough without adding
-         * an additional item to write at the same time). Unless we're *only* logging "I" frames, then we have no choice.
-         */
-        writeSlowFrameIfNeeded(blackboxIsOnlyLoggingIntraframes());
+        queued = blackboxQueueSample(currentTimeUs, BLACKBOX_SAMPLE_INTRAFRAME);
+        if (queued) {
+            blackboxGyroSampleResync = false;
+        }
+    } else if (blackboxShouldLogPFrame(blackboxPFrameIndex)) {
+        queued = blackboxQueueSample(currentTimeUs, 0);
+    }
+
+    if (!queued) {
+        // The frame is dropped, so make the next iteration a keyframe for the decoder to resynchronise on
+        blackboxPFrameIndex = BLACKBOX_I_INTERVAL - 1;
+    }
+
+#ifdef GPS
+    // Write the GPS home position every 128 intraframes (~10 seconds), in case one Home Frame goes missing
+    if (blackboxPFrameIndex == BLACKBOX_I_INTERVAL / 2 && blackboxIFrameIndex % 128 == 0) {
+        blackboxGpsHomeDue = true;
+    }
+#endif
+}
+
+/**
+ * Call each flight loop iteration to queue the flight controller state for the blackbox task to log.
+ */
+void blackboxSampleIteration(timeUs_t currentTimeUs)
+{
+    switch (blackboxState) {
+        case BLACKBOX_STATE_PAUSED:
+            // Only allow resume to occur during an I-frame iteration, so that we have an "I" base to work from
+            if (IS_RC_MODE_ACTIVE(BOXBLACKBOX) && blackboxShouldLogIFrame()
+                && blackboxQueueSample(currentTimeUs, BLACKBOX_SAMPLE_INTRAFRAME | BLACKBOX_SAMPLE_RESUME)) {
+                blackboxGyroSampleResync = false;
+                blackboxSetState(BLACKBOX_STATE_RUNNING);
+            }
+
+            // Keep the logging timers ticking so our log iteration continues to advance
+            blackboxAdvanceIterationTimers();
+        break;
+        case BLACKBOX_STATE_RUNNING:
+            // On entry to this state, blackboxIteration, blackboxPFrameIndex and blackboxIFrameIndex are reset to 0
+            // Prevent the Pausing of the log on the mode switch if in Motor Test Mode
+            if (blackboxModeActivationConditionPresent && !IS_RC_MODE_ACTIVE(BOXBLACKBOX) && !startedLoggingInTestMode) {
+                blackboxSetState(BLACKBOX_STATE_PAUSED);
+            } else {
+                blackboxQueueIteration(currentTimeUs);
+            }
+
+            blackboxAdvanceIterationTimers();
+        break;
+        default:
+        break;
+    }
+}
+
+/**
+ * Call after each gyro update to queue the high rate gyro frame for the blackbox task to log.
+ */
+void blackboxSampleGyro(void)
+{
+    if (blackboxState != BLACKBOX_STATE_RUNNING || !blackboxConfig()->gyro_rate_denom) {
+        return;
+    }
 
-        loadMainState(currentTimeUs);
-        writeIntraframe();
+    if (blackboxGyroSampleCountdown) {
+        blackboxGyroSampleCountdown--;
+        return;
+    }
+    blackboxGyroSampleCountdown = blackboxGyroRateDenom() - 1;
+
+    if (blackboxGyroSampleResync) {
+        return;
+    }
+
+    const uint8_t head = blackboxGyroSampleHead;
+    const uint8_t nextHead = (head + 1) % BLACKBOX_GYRO_SAMPLE_RING_SIZE;
+
+    if (nextHead == blackboxGyroSampleTail) {
+        // Drop the sample and make the next iteration a keyframe, the gyro frames start over after it
+        blackboxGyroSampleResync = true;
+        blackboxPFrameIndex = BLACKBOX_I_INTERVAL - 1;
+        return;
+    }
+
+    blackboxGyroSample_t *sample = &blackboxGyroSampleRing[head];
+
+    sample->iteration = blackboxIteration;
+    for (int i = 0; i < XYZ_AXIS_COUNT; i++) {
+        sample->values[i] = lrintf(gyro.gyroADCRawf[i]);
+        sample->values[XYZ_AXIS_COUNT + i] = lrintf(gyro.gyroADCf[i]);
+    }
+    for (int i = BLACKBOX_GYRO_FIELD_MOTOR_0; i < blackboxGyroFieldCount; i++) {
+        sample->values[i] = motor[i - BLACKBOX_GYRO_FIELD_MOTOR_0];
+    }
+
+    blackboxGyroSampleHead = nextHead;
+}
+
+#ifdef USE_BLACKBOX_PREROLL
+#ifdef USE_ESC_SENSOR
+// A motor driven well above idle whose ESC reports a fraction of the average rpm has lost sync
+static bool blackboxIsMotorDesynced(void)
+{
+    const escSensorData_t *combined = getEscSensorData(ESC_SENSOR_COMBINED);
+    const int drivenMotorOutput = motorOutputLow + (motorOutputHigh - motorOutputLow) / 4;
+
+    for (int i = 0; i < getMotorCount(); i++) {
+        const escSensorData_t *escData = getEscSensorData(i);
+
+        if (escData->dataAge == 0 && motor[i] > drivenMotorOutput && escData->rpm * 4 < combined->rpm) {
+            return true;
+        }
+    }
+
+    return false;
+}
+#endif
+
+static uint32_t blackboxPrerollTriggers(void)
+{
+    uint32_t triggers = 0;
+
+    if (blackboxConfig()->preroll_gyro_trigger) {
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            if (fabsf(gyro.gyroADCf[axis]) >= blackboxConfig()->preroll_gyro_trigger) {
+                triggers |= FLIGHT_LOG_PREROLL_TRIGGER_GYRO;
+            }
+        }
+    }
+    if (failsafeIsActive()) {
+        triggers |= FLIGHT_LOG_PREROLL_TRIGGER_FAILSAFE;
+    }
+    if (IS_RC_MODE_ACTIVE(BOXBLACKBOX)) {
+        triggers |= FLIGHT_LOG_PREROLL_TRIGGER_SWITCH;
+    }
+#ifdef USE_ESC_SENSOR
+    if (feature(FEATURE_ESC_SENSOR) && blackboxIsMotorDesynced()) {
+        triggers |= FLIGHT_LOG_PREROLL_TRIGGER_DESYNC;
+    }
+#endif
+
+    return triggers;
+}
+
+/*
+ * Commit the pre-roll when a trigger fires, and go back to buffering once nothing has triggered for preroll_hold_seconds.
+ */
+static void blackboxUpdatePreroll(void)
+{
+    const uint32_t triggers = blackboxPrerollTriggers();
+    const timeMs_t now = millis();
+
+    if (triggers) {
+        if (blackboxPrerollIsBuffering()) {
+            flightLogEvent_prerollTrigger_t eventData;
+
+            // The time covered by the frames which fitted in the ring
+            eventData.retainedMs = blackboxPrerollCommit();
+            blackboxPrerollTriggered = true;
+
+            // Marks the trigger point, after the frames of the pre-roll
+            eventData.triggers = triggers;
+            blackboxLogEvent(FLIGHT_LOG_EVENT_PREROLL_TRIGGER, (flightLogEventData_t *) &eventData);
+        }
+        blackboxPrerollTriggerTime = now;
+    } else if (!blackboxPrerollIsBuffering() && now - blackboxPrerollTriggerTime >= blackboxConfig()->preroll_hold_seconds * 1000) {
+        blackboxPrerollRelease();
+    }
+}
+#endif
+
+/*
+ * Lower the "P" frame rate a step when the device's buffers run low, and raise it a step each time they have had plenty
+ * of room for BLACKBOX_RATE_UP_HOLD_MS.
+ */
+static void blackboxUpdateRateControl(void)
+{
+    const uint8_t headroom = blackboxDeviceHeadroom();
+    const timeMs_t now = millis();
+    uint8_t target = blackboxPRateShiftTarget;
+
+    if (headroom >= BLACKBOX_RATE_HIGH_HEADROOM) {
+        if (target > 0 && now - blackboxRateHeadroomTime >= BLACKBOX_RATE_UP_HOLD_MS) {
+            target--;
+            blackboxRateHeadroomTime = now;
+        }
     } else {
+        blackboxRateHeadroomTime = now;
+
+        // Stop once only "I" frames would be left
+        if (headroom < BLACKBOX_RATE_LOW_HEADROOM && now - blackboxRateLowerTime >= BLACKBOX_RATE_DOWN_HOLD_MS
+            && (blackboxConfig()->rate_denom << (target + 1)) < BLACKBOX_I_INTERVAL * blackboxConfig()->rate_num) {
+            target++;
+            blackboxRateLowerTime = now;
+        }
+    }
+
+    blackboxPRateShiftTarget = target;
+}
+
+// Called each time the blackbox task runs in order to log the queued iterations
+static void blackboxLogIterations(timeUs_t currentTimeUs)
+{
+#ifndef GPS
+    UNUSED(currentTimeUs);
+#endif
+
+    blackboxLogQueuedIterations(blackboxMaxFramesPerTaskRun);
+
+    // Events and GPS frames refer to the main frames, so wait for the first one to be written
+    if (blackboxState == BLACKBOX_STATE_RUNNING && blackboxLoggedAnyFrames) {
         blackboxCheckAndLogArmingBeep();
         blackboxCheckAndLogFlightMode(); // Check for FlightMode status change event
 
-        if (blackboxShouldLogPFrame(blackboxPFrameIndex)) {
-            /*
-             * We assume that slow frames are only interesting in that they aid the interpretation of the main data stream.
-             * So only log slow frames during loop iterations where we log a main frame.
-             */
-            writeSlowFrameIfNeeded(true);
+        if (blackboxConfig()->rate_control) {
+            blackboxUpdateRateControl();
+        }
 
-            loadMainState(currentTimeUs);
-            writeInterframe();
+#ifdef USE_BLACKBOX_PREROLL
+        if (blackboxPrerollEnabled) {
+            blackboxUpdatePreroll();
         }
+#endif
+
 #ifdef GPS
         if (feature(FEATURE_GPS)) {
-            /*
-             * If the GPS home point has been updated, or every 128 intraframes (~10 seconds), write the
-             * GPS home position.
-             *
-             * We write it periodically so that if one Home Frame goes missing, the GPS coordinates can
-             * still be interpreted correctly.
-             */
-            if (GPS_home[0] != gpsHistory.GPS_home[0] || GPS_home[1] != gpsHistory.GPS_home[1]
-                || (blackboxPFrameIndex == BLACKBOX_I_INTERVAL / 2 && blackboxIFrameIndex % 128 == 0)) {
+            // If the GPS home point has been updated, or periodically, write the GPS home position.
+            if (GPS_home[0] != gpsHistory.GPS_home[0] || GPS_home[1] != gpsHistory.GPS_home[1] || blackboxGpsHomeDue) {
+                blackboxGpsHomeDue = false;
 
                 writeGPSHomeFrame();
                 writeGPSFrame(currentTimeUs);
@@ -1455,7 +2354,8 @@ static void blackboxLogIteration(timeUs_t currentTimeUs)
 }
 
 /**
- * Call each flight loop iteration to perform blackbox logging.
+ * Called by the blackbox task to send the log headers, write the iterations queued by blackboxSampleIteration() and
+ * manage the logging device.
  */
 void handleBlackbox(timeUs_t currentTimeUs)
 {
@@ -1468,9 +2368,33 @@ void handleBlackbox(timeUs_t currentTimeUs)
     switch (blackboxState) {
         case BLACKBOX_STATE_PREPARE_LOG_FILE:
             if (blackboxDeviceBeginLog()) {
-                blackboxSetState(BLACKBOX_STATE_SEND_HEADER);
+#ifdef USE_BLACKBOX_HEADER_CACHE
+                if (blackboxHeaderCache.length > 0) {
+                    blackboxSetState(BLACKBOX_STATE_SEND_CACHED_HEADER);
+                } else
+#endif
+                    blackboxSetState(BLACKBOX_STATE_SEND_HEADER);
             }
         break;
+#ifdef USE_BLACKBOX_HEADER_CACHE
+        case BLACKBOX_STATE_SEND_CACHED_HEADER:
+            //On entry of this state, xmitState.headerIndex is 0 and startTime is intialised
+
+            // Only a serial logger needs time to init, the other devices take the header as fast as they can store it
+            if ((blackboxConfig()->device != BLACKBOX_DEVICE_SERIAL && blackboxConfig()->stream_device != BLACKBOX_DEVICE_SERIAL)
+                || millis() > xmitState.u.startTime + 100) {
+                const int32_t length = MIN(blackboxHeaderCache.length - (int32_t)xmitState.headerIndex, blackboxDeviceHeaderSpace());
+
+                blackboxWriteBuf(&blackboxHeaderCache.data[xmitState.headerIndex], length);
+                blackboxHeaderBudget -= length;
+                xmitState.headerIndex += length;
+
+                if ((int32_t)xmitState.headerIndex == blackboxHeaderCache.length) {
+                    blackboxStartLoggingOnceHeaderDrained();
+                }
+            }
+        break;
+#endif
         case BLACKBOX_STATE_SEND_HEADER:
             //On entry of this state, xmitState.headerIndex is 0 and startTime is intialised
 
@@ -1495,6 +2419,14 @@ void handleBlackbox(timeUs_t currentTimeUs)
             //On entry of this state, xmitState.headerIndex is 0 and xmitState.u.fieldIndex is -1
             if (!sendFieldDefinition('I', 'P', blackboxMainFields, blackboxMainFields + 1, ARRAY_LENGTH(blackboxMainFields),
                     &blackboxMainFields[0].condition, &blackboxMainFields[1].condition)) {
+                blackboxSetState(BLACKBOX_STATE_SEND_GYRO_HEADER);
+            }
+        break;
+        case BLACKBOX_STATE_SEND_GYRO_HEADER:
+            //On entry of this state, xmitState.headerIndex is 0 and xmitState.u.fieldIndex is -1
+            if (!blackboxConfig()->gyro_rate_denom
+                || !sendFieldDefinition('F', 0, blackboxGyroFields, blackboxGyroFields + 1, ARRAY_LENGTH(blackboxGyroFields),
+                    &blackboxGyroFields[0].condition, &blackboxGyroFields[1].condition)) {
 #ifdef GPS
                 if (feature(FEATURE_GPS)) {
                     blackboxSetState(BLACKBOX_STATE_SEND_GPS_H_HEADER);
@@ -1531,45 +2463,13 @@ void handleBlackbox(timeUs_t currentTimeUs)
 
             //Keep writing chunks of the system info headers until it returns true to signal completion
             if (blackboxWriteSysinfo()) {
-
-                /*
-                 * Wait for header buffers to drain completely before data logging begins to ensure reliable header delivery
-                 * (overflowing circular buffers causes all data to be discarded, so the first few logged iterations
-                 * could wipe out the end of the header if we weren't careful)
-                 */
-                if (blackboxDeviceFlushForce()) {
-                    blackboxSetState(BLACKBOX_STATE_RUNNING);
-                }
+                blackboxStartLoggingOnceHeaderDrained();
             }
         break;
         case BLACKBOX_STATE_PAUSED:
-            // Only allow resume to occur during an I-frame iteration, so that we have an "I" base to work from
-            if (IS_RC_MODE_ACTIVE(BOXBLACKBOX) && blackboxShouldLogIFrame()) {
-                // Write a log entry so the decoder is aware that our large time/iteration skip is intended
-                flightLogEvent_loggingResume_t resume;
-
-                resume.logIteration = blackboxIteration;
-                resume.currentTime = currentTimeUs;
-
-                blackboxLogEvent(FLIGHT_LOG_EVENT_LOGGING_RESUME, (flightLogEventData_t *) &resume);
-                blackboxSetState(BLACKBOX_STATE_RUNNING);
-
-                blackboxLogIteration(currentTimeUs);
-            }
-
-            // Keep the logging timers ticking so our log iteration continues to advance
-            blackboxAdvanceIterationTimers();
-        break;
         case BLACKBOX_STATE_RUNNING:
-            // On entry to this state, blackboxIteration, blackboxPFrameIndex and blackboxIFrameIndex are reset to 0
-            // Prevent the Pausing of the log on the mode switch if in Motor Test Mode
-            if (blackboxModeActivationConditionPresent && !IS_RC_MODE_ACTIVE(BOXBLACKBOX) && !startedLoggingInTestMode) {
-                blackboxSetState(BLACKBOX_STATE_PAUSED);
-            } else {
-                blackboxLogIteration(currentTimeUs);
-            }
-
-            blackboxAdvanceIterationTimers();
+            // Iterations queued before a pause are still written out
+            blackboxLogIterations(currentTimeUs);
         break;
         case BLACKBOX_STATE_SHUTTING_DOWN:
             //On entry of this state, startTime is set
@@ -1589,6 +2489,9 @@ void handleBlackbox(timeUs_t currentTimeUs)
         break;
     }
 
+    // Send the header bytes written this iteration
+    blackboxFlushFrame();
+
     // Did we run out of room on the device? Stop!
     if (isBlackboxDeviceFull()) {
         blackboxSetState(BLACKBOX_STATE_STOPPED);
@@ -26,11 +26,27 @@ typedef struct blackboxConfig_s {
     uint8_t rate_denom;
     uint8_t device;
     uint8_t on_motor_test;
+    uint8_t gyro_rate_denom;        // log a high rate gyro frame every this many gyro samples (at most 8kHz, 4kHz on F1), 0 to disable
+    uint8_t p_encoding;             // blackboxPEncoding_e
+    uint8_t cross_field_predictors; // predict motors from the PID sums and filtered gyro from raw gyro
+    uint8_t preroll_hold_seconds;   // 0 to log continuously, else log the frames held in RAM on a trigger and go on until this many seconds after the last one
+    uint16_t preroll_gyro_trigger;  // gyro rate in deg/s which triggers the pre-roll, 0 to disable
+    uint8_t stream_device;          // BlackboxDevice which also gets a decimated copy of the log, BLACKBOX_DEVICE_NONE for none
+    uint8_t stream_rate_denom;      // the stream gets one in this many "I" frames
+    uint8_t rate_control;           // lower the "P" frame rate while the device falls behind
 } blackboxConfig_t;
 
+// the blackbox task writes out the iterations queued by the PID loop at this rate
+#define BLACKBOX_TASK_PERIOD_US 1000
+
 void blackboxLogEvent(FlightLogEvent event, flightLogEventData_t *data);
 
 void initBlackbox(void);
+#ifdef USE_BLACKBOX_HEADER_CACHE
+void blackboxRenderHeader(void);
+#endif
+void blackboxSampleIteration(timeUs_t currentTimeUs);
+void blackboxSampleGyro(void);
 void handleBlackbox(timeUs_t currentTimeUs);
 void startBlackbox(void);
 void finishBlackbox(void);
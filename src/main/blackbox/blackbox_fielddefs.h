@@ -83,7 +83,13 @@ typedef enum FlightLogFieldPredictor {
     FLIGHT_LOG_FIELD_PREDICTOR_LAST_MAIN_FRAME_TIME = 10,
 
     //Predict that this field is the minimum motor output
-    FLIGHT_LOG_FIELD_PREDICTOR_MINMOTOR       = 11
+    FLIGHT_LOG_FIELD_PREDICTOR_MINMOTOR       = 11,
+
+    //Predict the previous motor value plus the change in the PID sums and throttle, times the "mixerWeights" (/4096)
+    FLIGHT_LOG_FIELD_PREDICTOR_MIXER          = 12,
+
+    //Predict the previous filtered gyro moved towards this frame's raw gyro by "gyroRawGain" (/256)
+    FLIGHT_LOG_FIELD_PREDICTOR_GYRO_RAW       = 13
 
 } FlightLogFieldPredictor;
 
@@ -94,7 +100,8 @@ typedef enum FlightLogFieldEncoding {
     FLIGHT_LOG_FIELD_ENCODING_TAG8_8SVB       = 6,
     FLIGHT_LOG_FIELD_ENCODING_TAG2_3S32       = 7,
     FLIGHT_LOG_FIELD_ENCODING_TAG8_4S16       = 8,
-    FLIGHT_LOG_FIELD_ENCODING_NULL            = 9 // Nothing is written to the file, take value to be zero
+    FLIGHT_LOG_FIELD_ENCODING_NULL            = 9, // Nothing is written to the file, take value to be zero
+    FLIGHT_LOG_FIELD_ENCODING_GOLOMB_RICE     = 10 // Adaptive Golomb-Rice bit code, the frame's fields are padded to a whole byte
 } FlightLogFieldEncoding;
 
 typedef enum FlightLogFieldSign {
@@ -106,6 +113,8 @@ typedef enum FlightLogEvent {
     FLIGHT_LOG_EVENT_SYNC_BEEP = 0,
     FLIGHT_LOG_EVENT_INFLIGHT_ADJUSTMENT = 13,
     FLIGHT_LOG_EVENT_LOGGING_RESUME = 14,
+    FLIGHT_LOG_EVENT_PREROLL_TRIGGER = 15,
+    FLIGHT_LOG_EVENT_RATE_CHANGE = 16,
     FLIGHT_LOG_EVENT_FLIGHTMODE = 30, // Add new event type for flight mode status.
     FLIGHT_LOG_EVENT_LOG_END = 255
 } FlightLogEvent;
@@ -131,6 +140,24 @@ typedef struct flightLogEvent_loggingResume_s {
     uint32_t currentTime;
 } flightLogEvent_loggingResume_t;
 
+typedef enum FlightLogPrerollTrigger {
+    FLIGHT_LOG_PREROLL_TRIGGER_GYRO     = 1 << 0,
+    FLIGHT_LOG_PREROLL_TRIGGER_FAILSAFE = 1 << 1,
+    FLIGHT_LOG_PREROLL_TRIGGER_SWITCH   = 1 << 2,
+    FLIGHT_LOG_PREROLL_TRIGGER_DESYNC   = 1 << 3
+} FlightLogPrerollTrigger;
+
+typedef struct flightLogEvent_prerollTrigger_s {
+    uint32_t triggers; // FlightLogPrerollTrigger flags
+    uint32_t retainedMs; // time covered by the pre-roll frames logged before this event
+} flightLogEvent_prerollTrigger_t;
+
+// The "P" frames after the next "I" frame are logged at this rate instead of the "P interval" of the header
+typedef struct flightLogEvent_rateChange_s {
+    uint8_t rateNum;
+    uint16_t rateDenom;
+} flightLogEvent_rateChange_t;
+
 #define FLIGHT_LOG_EVENT_INFLIGHT_ADJUSTMENT_FUNCTION_FLOAT_VALUE_FLAG 128
 
 typedef struct flightLogEvent_gtuneCycleResult_s {
@@ -144,6 +171,8 @@ typedef union flightLogEventData_u {
     flightLogEvent_flightMode_t flightMode; // New event data
     flightLogEvent_inflightAdjustment_t inflightAdjustment;
     flightLogEvent_loggingResume_t loggingResume;
+    flightLogEvent_prerollTrigger_t prerollTrigger;
+    flightLogEvent_rateChange_t rateChange;
     flightLogEvent_gtuneCycleResult_t gtuneCycleResult;
 } flightLogEventData_t;
 
@@ -8,6 +8,7 @@
 
 #ifdef BLACKBOX
 
+#include "blackbox.h"
 #include "blackbox_io.h"
 
 #include "build/version.h"
@@ -16,6 +17,8 @@
 #include "common/encoding.h"
 #include "common/printf.h"
 
+#include "drivers/system.h"
+
 #include "fc/config.h"
 #include "fc/rc_controls.h"
 
@@ -63,414 +66,432 @@ static struct {
 
 #endif
 
-void blackboxWrite(uint8_t value)
+/*
+ * Frames are written to up to two sinks. The primary sink on blackbox_device gets the whole log, the stream sink on
+ * blackbox_stream_device only gets the frames the caller of blackboxFlushFrameTo() picks for it, and a frame it has no
+ * room for is dropped whole. Each device keeps its state above, so a device can only serve one sink.
+ */
+static struct {
+    uint8_t device;     // BlackboxDevice, BLACKBOX_DEVICE_NONE while the sink isn't open
+    bool logEnded;
+} blackboxSinks[BLACKBOX_SINK_COUNT];
+
+/*
+ * The encoders write each frame into this staging buffer, which is handed to the device in a single bulk write by
+ * blackboxFlushFrame() instead of dispatching every byte to the device separately.
+ */
+static uint8_t blackboxFrameBuffer[BLACKBOX_FRAME_BUFFER_SIZE];
+static int blackboxFrameBufferPos = 0;
+
+#ifdef USE_BLACKBOX_HEADER_CACHE
+/*
+ * While a capture buffer is set the staged frames are appended to it instead of being handed to the sinks, which is
+ * how the log header is rendered ahead of arming.
+ */
+static struct {
+    uint8_t *buffer;
+    int32_t size;
+    int32_t length;     // -1 once the buffer has overflowed
+} blackboxCapture;
+#endif
+
+static void blackboxDeviceWrite(uint8_t device, const uint8_t *data, int length)
 {
-    switch (blackboxConfig()->device) {
+    switch (device) {
 #ifdef USE_FLASHFS
         case BLACKBOX_DEVICE_FLASH:
-            flashfsWriteByte(value); // Write byte asynchronously
+            flashfsWrite(data, length, false); // Write asynchronously
         break;
 #endif
 #ifdef USE_SDCARD
         case BLACKBOX_DEVICE_SDCARD:
-            afatfs_fputc(blackboxSDCard.logFile, value);
+            afatfs_fwrite(blackboxSDCard.logFile, data, length); // Ignore failures due to buffers filling up
         break;
 #endif
         case BLACKBOX_DEVICE_SERIAL:
+            if (serialTxBytesFree(blackboxPort) >= (uint32_t)length) {
+                serialWriteBuf(blackboxPort, data, length);
+            } else {
+                // Don't wait for room in the Tx buffer, overrun it as writing byte by byte always did
+                for (int i = 0; i < length; i++) {
+                    serialWrite(blackboxPort, data[i]);
+                }
+            }
+        break;
         default:
-            serialWrite(blackboxPort, value);
         break;
     }
 }
 
-static void _putc(void *p, char c)
+// How many bytes can be handed to the device right now without overflowing its buffers?
+static int32_t blackboxDeviceFreeSpace(uint8_t device)
 {
-    (void)p;
-    blackboxWrite(c);
+    switch (device) {
+        case BLACKBOX_DEVICE_SERIAL:
+            return serialTxBytesFree(blackboxPort);
+#ifdef USE_FLASHFS
+        case BLACKBOX_DEVICE_FLASH:
+            return flashfsGetWriteBufferFreeSpace();
+#endif
+#ifdef USE_SDCARD
+        case BLACKBOX_DEVICE_SDCARD:
+            return afatfs_getFreeBufferSpace();
+#endif
+        default:
+            return 0;
+    }
 }
 
-static int blackboxPrintfv(const char *fmt, va_list va)
+#ifdef USE_BLACKBOX_PREROLL
+
+/*
+ * In pre-roll mode the frames are held in a RAM ring instead of being written to the device. The ring is cut into
+ * segments which each begin at an "I" frame, and the oldest segments are dropped to make room, so the ring holds as much
+ * of the flight before a trigger as fits in it. Committing the ring drains it to the device, and the frames written meanwhile queue up
+ * behind it until it has emptied and can go back to buffering.
+ *
+ * Positions in the ring count bytes since pre-roll started, so head - tail is the number of bytes held.
+ */
+typedef enum {
+    BLACKBOX_PREROLL_OFF = 0,
+    BLACKBOX_PREROLL_BUFFERING,
+    BLACKBOX_PREROLL_COMMITTED
+} blackboxPrerollState_e;
+
+typedef struct blackboxPrerollSegment_s {
+    uint32_t start;
+    timeMs_t time;
+} blackboxPrerollSegment_t;
+
+static struct {
+    uint8_t buffer[BLACKBOX_PREROLL_BUFFER_SIZE];
+    blackboxPrerollSegment_t segments[BLACKBOX_PREROLL_SEGMENT_COUNT];
+    uint32_t head;
+    uint32_t tail;
+    uint16_t segmentHead;
+    uint16_t segmentCount;
+    blackboxPrerollState_e state;
+    bool dropping;      // frames are thrown away until the next segment begins
+} blackboxPreroll;
+
+static blackboxPrerollSegment_t *blackboxPrerollSegment(int age)
 {
-    return tfp_format(NULL, _putc, fmt, va);
+    return &blackboxPreroll.segments[(blackboxPreroll.segmentHead + BLACKBOX_PREROLL_SEGMENT_COUNT - blackboxPreroll.segmentCount + age) % BLACKBOX_PREROLL_SEGMENT_COUNT];
 }
 
+static void blackboxPrerollClear(void)
+{
+    blackboxPreroll.tail = blackboxPreroll.head;
+    blackboxPreroll.segmentCount = 0;
+    blackboxPreroll.dropping = true;
+}
 
-//printf() to the blackbox serial port with no blocking shenanigans (so it's caller's responsibility to not write too fast!)
-int blackboxPrintf(const char *fmt, ...)
+static void blackboxPrerollDropOldestSegment(void)
 {
-    va_list va;
+    blackboxPreroll.segmentCount--;
+    blackboxPreroll.tail = blackboxPrerollSegment(0)->start;
+}
 
-    va_start(va, fmt);
+static void blackboxPrerollAppend(const uint8_t *data, int length)
+{
+    if (blackboxPreroll.dropping) {
+        return;
+    }
 
-    int written = blackboxPrintfv(fmt, va);
+    while (blackboxPreroll.head - blackboxPreroll.tail + length > BLACKBOX_PREROLL_BUFFER_SIZE) {
+        if (blackboxPreroll.state == BLACKBOX_PREROLL_COMMITTED) {
+            // The device isn't keeping up, lose the rest of this segment
+            blackboxPreroll.dropping = true;
+            return;
+        }
+        if (blackboxPreroll.segmentCount <= 1) {
+            // The segment being written doesn't fit in the ring on its own
+            blackboxPrerollClear();
+            return;
+        }
+        blackboxPrerollDropOldestSegment();
+    }
 
-    va_end(va);
+    const uint32_t offset = blackboxPreroll.head % BLACKBOX_PREROLL_BUFFER_SIZE;
+    const int count = MIN(length, BLACKBOX_PREROLL_BUFFER_SIZE - (int)offset);
 
-    return written;
+    memcpy(&blackboxPreroll.buffer[offset], data, count);
+    memcpy(blackboxPreroll.buffer, data + count, length - count);
+    blackboxPreroll.head += length;
 }
 
 /*
- * printf a Blackbox header line with a leading "H " and trailing "\n" added automatically. blackboxHeaderBudget is
- * decreased to account for the number of bytes written.
+ * Write as much of a committed ring to the device as it will take, returns true once nothing is waiting to be written.
  */
-void blackboxPrintfHeaderLine(const char *fmt, ...)
+static bool blackboxPrerollDrain(void)
 {
-    va_list va;
+    if (blackboxPreroll.state != BLACKBOX_PREROLL_COMMITTED) {
+        return true;
+    }
 
-    blackboxWrite('H');
-    blackboxWrite(' ');
+    int32_t budget = BLACKBOX_PREROLL_DRAIN_PER_ITERATION;
 
-    va_start(va, fmt);
+    while (blackboxPreroll.head != blackboxPreroll.tail && budget > 0) {
+        const uint32_t offset = blackboxPreroll.tail % BLACKBOX_PREROLL_BUFFER_SIZE;
+        const int32_t held = blackboxPreroll.head - blackboxPreroll.tail;
+        const int32_t contiguous = BLACKBOX_PREROLL_BUFFER_SIZE - offset;
+        const int32_t length = MIN(MIN(held, contiguous), MIN(budget, blackboxDeviceFreeSpace(blackboxSinks[BLACKBOX_SINK_PRIMARY].device)));
 
-    int written = blackboxPrintfv(fmt, va);
-
-    va_end(va);
+        if (length <= 0) {
+            break;
+        }
 
-    blackboxWrite('\n');
+        blackboxDeviceWrite(blackboxSinks[BLACKBOX_SINK_PRIMARY].device, &blackboxPreroll.buffer[offset], length);
+        blackboxPreroll.tail += length;
+        budget -= length;
+    }
 
-    blackboxHeaderBudget -= written + 3;
+    return blackboxPreroll.head == blackboxPreroll.tail;
 }
 
-// Print the null-terminated string 's' to the blackbox device and return the number of bytes written
-int blackboxPrint(const char *s)
+/**
+ * Hold the frames written from now on in the pre-roll ring.
+ */
+void blackboxPrerollStart(void)
 {
-    int length;
-    const uint8_t *pos;
+    blackboxPreroll.head = 0;
+    blackboxPrerollClear();
+    blackboxPreroll.state = BLACKBOX_PREROLL_BUFFERING;
+}
 
-    switch (blackboxConfig()->device) {
+/**
+ * Throw away the frames held in the ring and write the following ones straight to the device.
+ */
+void blackboxPrerollStop(void)
+{
+    blackboxPrerollClear();
+    blackboxPreroll.state = BLACKBOX_PREROLL_OFF;
+}
 
-#ifdef USE_FLASHFS
-        case BLACKBOX_DEVICE_FLASH:
-            length = strlen(s);
-            flashfsWrite((const uint8_t*) s, length, false); // Write asynchronously
-        break;
-#endif
+/**
+ * Call before writing an "I" frame and anything it should take along when the segments before it are dropped.
+ */
+void blackboxPrerollBeginSegment(void)
+{
+    if (blackboxPreroll.state == BLACKBOX_PREROLL_OFF) {
+        return;
+    }
 
-#ifdef USE_SDCARD
-        case BLACKBOX_DEVICE_SDCARD:
-            length = strlen(s);
-            afatfs_fwrite(blackboxSDCard.logFile, (const uint8_t*) s, length); // Ignore failures due to buffers filling up
-        break;
-#endif
+    blackboxPreroll.dropping = false;
 
-        case BLACKBOX_DEVICE_SERIAL:
-        default:
-            pos = (uint8_t*) s;
-            while (*pos) {
-                serialWrite(blackboxPort, *pos);
-                pos++;
-            }
+    if (blackboxPreroll.state == BLACKBOX_PREROLL_COMMITTED) {
+        return;
+    }
 
-            length = pos - (uint8_t*) s;
-        break;
+    if (blackboxPreroll.segmentCount == BLACKBOX_PREROLL_SEGMENT_COUNT) {
+        blackboxPrerollDropOldestSegment();
     }
 
-    return length;
+    blackboxPreroll.segments[blackboxPreroll.segmentHead].start = blackboxPreroll.head;
+    blackboxPreroll.segments[blackboxPreroll.segmentHead].time = millis();
+    blackboxPreroll.segmentHead = (blackboxPreroll.segmentHead + 1) % BLACKBOX_PREROLL_SEGMENT_COUNT;
+    blackboxPreroll.segmentCount++;
 }
 
 /**
- * Write an unsigned integer to the blackbox serial port using variable byte encoding.
+ * Start writing the frames held in the ring to the device, along with every frame written until the ring is released.
+ *
+ * Returns the time covered by the frames held, which is as much as fitted in the ring.
  */
-void blackboxWriteUnsignedVB(uint32_t value)
+timeMs_t blackboxPrerollCommit(void)
 {
-    //While this isn't the final byte (we can only write 7 bits at a time)
-    while (value > 127) {
-        blackboxWrite((uint8_t) (value | 0x80)); // Set the high bit to mean "more bytes follow"
-        value >>= 7;
+    timeMs_t retained = 0;
+
+    if (blackboxPreroll.state == BLACKBOX_PREROLL_BUFFERING) {
+        if (blackboxPreroll.segmentCount > 0) {
+            retained = millis() - blackboxPrerollSegment(0)->time;
+        }
+        blackboxPreroll.state = BLACKBOX_PREROLL_COMMITTED;
+        blackboxPreroll.segmentCount = 0;
     }
-    blackboxWrite(value);
+
+    return retained;
 }
 
 /**
- * Write a signed integer to the blackbox serial port using ZigZig and variable byte encoding.
+ * Go back to buffering once a committed ring has been written out, returns true if it did.
  */
-void blackboxWriteSignedVB(int32_t value)
-{
-    //ZigZag encode to make the value always positive
-    blackboxWriteUnsignedVB(zigzagEncode(value));
-}
-
-void blackboxWriteSignedVBArray(int32_t *array, int count)
+bool blackboxPrerollRelease(void)
 {
-    for (int i = 0; i < count; i++) {
-        blackboxWriteSignedVB(array[i]);
+    // The frames of this task run are still to be drained, so while logging the ring is only ever empty after a drain
+    if (blackboxPreroll.state != BLACKBOX_PREROLL_COMMITTED || !blackboxPrerollDrain()) {
+        return false;
     }
-}
 
-void blackboxWriteSigned16VBArray(int16_t *array, int count)
-{
-    for (int i = 0; i < count; i++) {
-        blackboxWriteSignedVB(array[i]);
-    }
+    blackboxPrerollClear();
+    blackboxPreroll.state = BLACKBOX_PREROLL_BUFFERING;
+
+    return true;
 }
 
-void blackboxWriteS16(int16_t value)
+bool blackboxPrerollIsBuffering(void)
 {
-    blackboxWrite(value & 0xFF);
-    blackboxWrite((value >> 8) & 0xFF);
+    return blackboxPreroll.state == BLACKBOX_PREROLL_BUFFERING;
 }
 
+#endif
+
 /**
- * Write a 2 bit tag followed by 3 signed fields of 2, 4, 6 or 32 bits
+ * Hand the staged frame to the given sinks (BLACKBOX_SINK_MASK() flags). The primary sink's frames go through the
+ * pre-roll ring while it is in use.
  */
-void blackboxWriteTag2_3S32(int32_t *values) {
-    static const int NUM_FIELDS = 3;
-
-    //Need to be enums rather than const ints if we want to switch on them (due to being C)
-    enum {
-        BITS_2  = 0,
-        BITS_4  = 1,
-        BITS_6  = 2,
-        BITS_32 = 3
-    };
+void blackboxFlushFrameTo(uint8_t sinks)
+{
+    if (blackboxFrameBufferPos == 0) {
+        return;
+    }
 
-    enum {
-        BYTES_1  = 0,
-        BYTES_2  = 1,
-        BYTES_3  = 2,
-        BYTES_4  = 3
-    };
-
-    int x;
-    int selector = BITS_2, selector2;
-
-    /*
-     * Find out how many bits the largest value requires to encode, and use it to choose one of the packing schemes
-     * below:
-     *
-     * Selector possibilities
-     *
-     * 2 bits per field  ss11 2233,
-     * 4 bits per field  ss00 1111 2222 3333
-     * 6 bits per field  ss11 1111 0022 2222 0033 3333
-     * 32 bits per field sstt tttt followed by fields of various byte counts
-     */
-    for (x = 0; x < NUM_FIELDS; x++) {
-        //Require more than 6 bits?
-        if (values[x] >= 32 || values[x] < -32) {
-            selector = BITS_32;
-            break;
+#ifdef USE_BLACKBOX_HEADER_CACHE
+    if (blackboxCapture.buffer) {
+        if (blackboxCapture.length >= 0 && blackboxCapture.length + blackboxFrameBufferPos <= blackboxCapture.size) {
+            memcpy(&blackboxCapture.buffer[blackboxCapture.length], blackboxFrameBuffer, blackboxFrameBufferPos);
+            blackboxCapture.length += blackboxFrameBufferPos;
+        } else {
+            blackboxCapture.length = -1;
         }
+        blackboxFrameBufferPos = 0;
+        return;
+    }
+#endif
 
-        //Require more than 4 bits?
-        if (values[x] >= 8 || values[x] < -8) {
-             if (selector < BITS_6) {
-                 selector = BITS_6;
-             }
-        } else if (values[x] >= 2 || values[x] < -2) { //Require more than 2 bits?
-            if (selector < BITS_4) {
-                selector = BITS_4;
-            }
+    if (sinks & BLACKBOX_SINK_MASK(BLACKBOX_SINK_PRIMARY)) {
+#ifdef USE_BLACKBOX_PREROLL
+        if (blackboxPreroll.state != BLACKBOX_PREROLL_OFF) {
+            blackboxPrerollAppend(blackboxFrameBuffer, blackboxFrameBufferPos);
+        } else
+#endif
+        {
+            blackboxDeviceWrite(blackboxSinks[BLACKBOX_SINK_PRIMARY].device, blackboxFrameBuffer, blackboxFrameBufferPos);
         }
     }
 
-    switch (selector) {
-        case BITS_2:
-            blackboxWrite((selector << 6) | ((values[0] & 0x03) << 4) | ((values[1] & 0x03) << 2) | (values[2] & 0x03));
-        break;
-        case BITS_4:
-            blackboxWrite((selector << 6) | (values[0] & 0x0F));
-            blackboxWrite((values[1] << 4) | (values[2] & 0x0F));
-        break;
-        case BITS_6:
-            blackboxWrite((selector << 6) | (values[0] & 0x3F));
-            blackboxWrite((uint8_t)values[1]);
-            blackboxWrite((uint8_t)values[2]);
-        break;
-        case BITS_32:
-            /*
-             * Do another round to compute a selector for each field, assuming that they are at least 8 bits each
-             *
-             * Selector2 field possibilities
-             * 0 - 8 bits
-             * 1 - 16 bits
-             * 2 - 24 bits
-             * 3 - 32 bits
-             */
-            selector2 = 0;
-
-            //Encode in reverse order so the first field is in the low bits:
-            for (x = NUM_FIELDS - 1; x >= 0; x--) {
-                selector2 <<= 2;
-
-                if (values[x] < 128 && values[x] >= -128) {
-                    selector2 |= BYTES_1;
-                } else if (values[x] < 32768 && values[x] >= -32768) {
-                    selector2 |= BYTES_2;
-                } else if (values[x] < 8388608 && values[x] >= -8388608) {
-                    selector2 |= BYTES_3;
-                } else {
-                    selector2 |= BYTES_4;
-                }
-            }
+    const uint8_t streamDevice = blackboxSinks[BLACKBOX_SINK_STREAM].device;
 
-            //Write the selectors
-            blackboxWrite((selector << 6) | selector2);
-
-            //And now the values according to the selectors we picked for them
-            for (x = 0; x < NUM_FIELDS; x++, selector2 >>= 2) {
-                switch (selector2 & 0x03) {
-                    case BYTES_1:
-                        blackboxWrite(values[x]);
-                    break;
-                    case BYTES_2:
-                        blackboxWrite(values[x]);
-                        blackboxWrite(values[x] >> 8);
-                    break;
-                    case BYTES_3:
-                        blackboxWrite(values[x]);
-                        blackboxWrite(values[x] >> 8);
-                        blackboxWrite(values[x] >> 16);
-                    break;
-                    case BYTES_4:
-                        blackboxWrite(values[x]);
-                        blackboxWrite(values[x] >> 8);
-                        blackboxWrite(values[x] >> 16);
-                        blackboxWrite(values[x] >> 24);
-                    break;
-                }
-            }
-        break;
+    if ((sinks & BLACKBOX_SINK_MASK(BLACKBOX_SINK_STREAM)) && streamDevice != BLACKBOX_DEVICE_NONE
+        && blackboxDeviceFreeSpace(streamDevice) >= blackboxFrameBufferPos) {
+        blackboxDeviceWrite(streamDevice, blackboxFrameBuffer, blackboxFrameBufferPos);
     }
+
+    blackboxFrameBufferPos = 0;
 }
 
 /**
- * Write an 8-bit selector followed by four signed fields of size 0, 4, 8 or 16 bits.
+ * Hand the staged frame to every sink.
  */
-void blackboxWriteTag8_4S16(int32_t *values) {
+void blackboxFlushFrame(void)
+{
+    blackboxFlushFrameTo(BLACKBOX_SINK_MASK_ALL);
+}
 
-    //Need to be enums rather than const ints if we want to switch on them (due to being C)
-    enum {
-        FIELD_ZERO  = 0,
-        FIELD_4BIT  = 1,
-        FIELD_8BIT  = 2,
-        FIELD_16BIT = 3
-    };
-
-    uint8_t selector, buffer;
-    int nibbleIndex;
-    int x;
-
-    selector = 0;
-    //Encode in reverse order so the first field is in the low bits:
-    for (x = 3; x >= 0; x--) {
-        selector <<= 2;
-
-        if (values[x] == 0) {
-            selector |= FIELD_ZERO;
-        } else if (values[x] < 8 && values[x] >= -8) {
-            selector |= FIELD_4BIT;
-        } else if (values[x] < 128 && values[x] >= -128) {
-            selector |= FIELD_8BIT;
-        } else {
-            selector |= FIELD_16BIT;
-        }
+void blackboxWrite(uint8_t value)
+{
+    if (blackboxFrameBufferPos >= BLACKBOX_FRAME_BUFFER_SIZE) {
+        blackboxFlushFrame();
     }
+    blackboxFrameBuffer[blackboxFrameBufferPos++] = value;
+}
 
-    blackboxWrite(selector);
-
-    nibbleIndex = 0;
-    buffer = 0;
-    for (x = 0; x < 4; x++, selector >>= 2) {
-        switch (selector & 0x03) {
-            case FIELD_ZERO:
-                //No-op
-            break;
-            case FIELD_4BIT:
-                if (nibbleIndex == 0) {
-                    //We fill high-bits first
-                    buffer = values[x] << 4;
-                    nibbleIndex = 1;
-                } else {
-                    blackboxWrite(buffer | (values[x] & 0x0F));
-                    nibbleIndex = 0;
-                }
-            break;
-            case FIELD_8BIT:
-                if (nibbleIndex == 0) {
-                    blackboxWrite(values[x]);
-                } else {
-                    //Write the high bits of the value first (mask to avoid sign extension)
-                    blackboxWrite(buffer | ((values[x] >> 4) & 0x0F));
-                    //Now put the leftover low bits into the top of the next buffer entry
-                    buffer = values[x] << 4;
-                }
-            break;
-            case FIELD_16BIT:
-                if (nibbleIndex == 0) {
-                    //Write high byte first
-                    blackboxWrite(values[x] >> 8);
-                    blackboxWrite(values[x]);
-                } else {
-                    //First write the highest 4 bits
-                    blackboxWrite(buffer | ((values[x] >> 12) & 0x0F));
-                    // Then the middle 8
-                    blackboxWrite(values[x] >> 4);
-                    //Only the smallest 4 bits are still left to write
-                    buffer = values[x] << 4;
-                }
-            break;
+void blackboxWriteBuf(const uint8_t *data, int length)
+{
+    while (length > 0) {
+        if (blackboxFrameBufferPos >= BLACKBOX_FRAME_BUFFER_SIZE) {
+            blackboxFlushFrame();
         }
-    }
-    //Anything left over to write?
-    if (nibbleIndex == 1) {
-        blackboxWrite(buffer);
+        const int count = MIN(length, BLACKBOX_FRAME_BUFFER_SIZE - blackboxFrameBufferPos);
+        memcpy(&blackboxFrameBuffer[blackboxFrameBufferPos], data, count);
+        blackboxFrameBufferPos += count;
+        data += count;
+        length -= count;
     }
 }
 
-/**
- * Write `valueCount` fields from `values` to the Blackbox using signed variable byte encoding. A 1-byte header is
- * written first which specifies which fields are non-zero (so this encoding is compact when most fields are zero).
- *
- * valueCount must be 8 or less.
+static void _putc(void *p, char c)
+{
+    (void)p;
+    blackboxWrite(c);
+}
+
+static int blackboxPrintfv(const char *fmt, va_list va)
+{
+    return tfp_format(NULL, _putc, fmt, va);
+}
+
+
+//printf() to the blackbox serial port with no blocking shenanigans (so it's caller's responsibility to not write too fast!)
+int blackboxPrintf(const char *fmt, ...)
+{
+    va_list va;
+
+    va_start(va, fmt);
+
+    int written = blackboxPrintfv(fmt, va);
+
+    va_end(va);
+
+    return written;
+}
+
+/*
+ * printf a Blackbox header line with a leading "H " and trailing "\n" added automatically. blackboxHeaderBudget is
+ * decreased to account for the number of bytes written.
  */
-void blackboxWriteTag8_8SVB(int32_t *values, int valueCount)
+void blackboxPrintfHeaderLine(const char *fmt, ...)
 {
-    uint8_t header;
-    int i;
+    va_list va;
 
-    if (valueCount > 0) {
-        //If we're only writing one field then we can skip the header
-        if (valueCount == 1) {
-            blackboxWriteSignedVB(values[0]);
-        } else {
-            //First write a one-byte header that marks which fields are non-zero
-            header = 0;
+    blackboxWrite('H');
+    blackboxWrite(' ');
 
-            // First field should be in low bits of header
-            for (i = valueCount - 1; i >= 0; i--) {
-                header <<= 1;
+    va_start(va, fmt);
 
-                if (values[i] != 0) {
-                    header |= 0x01;
-                }
-            }
+    int written = blackboxPrintfv(fmt, va);
+
+    va_end(va);
 
-            blackboxWrite(header);
+    blackboxWrite('\n');
 
-            for (i = 0; i < valueCount; i++) {
-                if (values[i] != 0) {
-                    blackboxWriteSignedVB(values[i]);
-                }
-            }
-        }
-    }
+    blackboxHeaderBudget -= written + 3;
 }
 
-/** Write unsigned integer **/
-void blackboxWriteU32(int32_t value)
+// Print the null-terminated string 's' to the blackbox device and return the number of bytes written
+int blackboxPrint(const char *s)
 {
-    blackboxWrite(value & 0xFF);
-    blackboxWrite((value >> 8) & 0xFF);
-    blackboxWrite((value >> 16) & 0xFF);
-    blackboxWrite((value >> 24) & 0xFF);
+    const int length = strlen(s);
+
+    blackboxWriteBuf((const uint8_t*) s, length);
+
+    return length;
 }
 
-/** Write float value in the integer form **/
-void blackboxWriteFloat(float value)
+#ifdef USE_BLACKBOX_HEADER_CACHE
+/**
+ * Send everything written from now on to the given buffer instead of the sinks, until blackboxCaptureEnd().
+ */
+void blackboxCaptureBegin(uint8_t *buffer, int32_t size)
+{
+    blackboxFlushFrame();
+
+    blackboxCapture.buffer = buffer;
+    blackboxCapture.size = size;
+    blackboxCapture.length = 0;
+}
+
+/**
+ * Stop capturing, returns the number of bytes captured or -1 if they didn't fit in the buffer.
+ */
+int32_t blackboxCaptureEnd(void)
 {
-    blackboxWriteU32(castFloatBytesToInt(value));
+    blackboxFlushFrame();
+    blackboxCapture.buffer = NULL;
+
+    return blackboxCapture.length;
 }
+#endif
 
 /**
  * If there is data waiting to be written to the blackbox device, attempt to write (a portion of) that now.
@@ -479,30 +500,31 @@ void blackboxWriteFloat(float value)
  */
 void blackboxDeviceFlush(void)
 {
-    switch (blackboxConfig()->device) {
+#ifdef USE_BLACKBOX_PREROLL
+    blackboxPrerollDrain();
+#endif
+
+    for (int i = 0; i < BLACKBOX_SINK_COUNT; i++) {
+        switch (blackboxSinks[i].device) {
 #ifdef USE_FLASHFS
-        /*
-         * This is our only output device which requires us to call flush() in order for it to write anything. The other
-         * devices will progressively write in the background without Blackbox calling anything.
-         */
-        case BLACKBOX_DEVICE_FLASH:
-            flashfsFlushAsync();
-        break;
+            /*
+             * This is our only output device which requires us to call flush() in order for it to write anything. The
+             * other devices will progressively write in the background without Blackbox calling anything.
+             */
+            case BLACKBOX_DEVICE_FLASH:
+                flashfsFlushAsync();
+            break;
 #endif
 
-        default:
-            ;
+            default:
+                ;
+        }
     }
 }
 
-/**
- * If there is data waiting to be written to the blackbox device, attempt to write (a portion of) that now.
- *
- * Returns true if all data has been written to the device.
- */
-bool blackboxDeviceFlushForce(void)
+static bool blackboxDeviceFlushForceDevice(uint8_t device)
 {
-    switch (blackboxConfig()->device) {
+    switch (device) {
         case BLACKBOX_DEVICE_SERIAL:
             // Nothing to speed up flushing on serial, as serial is continuously being drained out of its buffer
             return isSerialTransmitBufferEmpty(blackboxPort);
@@ -526,11 +548,36 @@ bool blackboxDeviceFlushForce(void)
 }
 
 /**
- * Attempt to open the logging device. Returns true if successful.
+ * If there is data waiting to be written to the blackbox devices, attempt to write (a portion of) that now.
+ *
+ * Returns true if all data has been written to the devices.
  */
-bool blackboxDeviceOpen(void)
+bool blackboxDeviceFlushForce(void)
 {
-    switch (blackboxConfig()->device) {
+    blackboxFlushFrame();
+
+#ifdef USE_BLACKBOX_PREROLL
+    if (!blackboxPrerollDrain()) {
+        // The rest of the ring is written as the device makes room for it
+        blackboxDeviceFlush();
+        return false;
+    }
+#endif
+
+    bool flushed = true;
+
+    for (int i = 0; i < BLACKBOX_SINK_COUNT; i++) {
+        if (blackboxSinks[i].device != BLACKBOX_DEVICE_NONE) {
+            flushed = blackboxDeviceFlushForceDevice(blackboxSinks[i].device) && flushed;
+        }
+    }
+
+    return flushed;
+}
+
+static bool blackboxDeviceOpenDevice(uint8_t device)
+{
+    switch (device) {
         case BLACKBOX_DEVICE_SERIAL:
             {
                 serialPortConfig_t *portConfig = findSerialPortConfig(FUNCTION_BLACKBOX);
@@ -562,12 +609,13 @@ bool blackboxDeviceOpen(void)
                  * bytes. In order for its buffer to be able to absorb this latency we must write slower than 6000 B/s.
                  *
                  * So:
-                 *     Bytes per loop iteration = floor((looptime_ns / 1000000.0) * 6000)
-                 *                              = floor((looptime_ns * 6000) / 1000000.0)
-                 *                              = floor((looptime_ns * 3) / 500.0)
-                 *                              = (looptime_ns * 3) / 500
+                 *     Bytes per task iteration = floor((taskperiod_us / 1000000.0) * 6000)
+                 *                              = floor((taskperiod_us * 6000) / 1000000.0)
+                 *                              = floor((taskperiod_us * 3) / 500.0)
+                 *                              = (taskperiod_us * 3) / 500
                  */
-                blackboxMaxHeaderBytesPerIteration = constrain((targetPidLooptime * 3) / 500, 1, BLACKBOX_TARGET_HEADER_BUDGET_PER_ITERATION);
+                blackboxMaxHeaderBytesPerIteration = MIN(blackboxMaxHeaderBytesPerIteration,
+                    constrain((BLACKBOX_TASK_PERIOD_US * 3) / 500, 1, BLACKBOX_TARGET_HEADER_BUDGET_PER_ITERATION));
 
                 return blackboxPort != NULL;
             }
@@ -578,8 +626,6 @@ bool blackboxDeviceOpen(void)
                 return false;
             }
 
-            blackboxMaxHeaderBytesPerIteration = BLACKBOX_TARGET_HEADER_BUDGET_PER_ITERATION;
-
             return true;
         break;
 #endif
@@ -589,8 +635,6 @@ bool blackboxDeviceOpen(void)
                 return false;
             }
 
-            blackboxMaxHeaderBytesPerIteration = BLACKBOX_TARGET_HEADER_BUDGET_PER_ITERATION;
-
             return true;
         break;
 #endif
@@ -600,11 +644,30 @@ bool blackboxDeviceOpen(void)
 }
 
 /**
- * Close the Blackbox logging device immediately without attempting to flush any remaining data.
+ * Attempt to open the logging device, and the stream device if there is one. Returns true if the logging device was
+ * opened, the log goes ahead without the stream if its device can't be opened.
  */
-void blackboxDeviceClose(void)
+bool blackboxDeviceOpen(void)
 {
-    switch (blackboxConfig()->device) {
+    blackboxMaxHeaderBytesPerIteration = BLACKBOX_TARGET_HEADER_BUDGET_PER_ITERATION;
+
+    if (!blackboxDeviceOpenDevice(blackboxConfig()->device)) {
+        return false;
+    }
+
+    blackboxSinks[BLACKBOX_SINK_PRIMARY].device = blackboxConfig()->device;
+    blackboxSinks[BLACKBOX_SINK_STREAM].device = BLACKBOX_DEVICE_NONE;
+
+    if (blackboxConfig()->stream_device != BLACKBOX_DEVICE_NONE && blackboxDeviceOpenDevice(blackboxConfig()->stream_device)) {
+        blackboxSinks[BLACKBOX_SINK_STREAM].device = blackboxConfig()->stream_device;
+    }
+
+    return true;
+}
+
+static void blackboxDeviceCloseDevice(uint8_t device)
+{
+    switch (device) {
         case BLACKBOX_DEVICE_SERIAL:
             // Since the serial port could be shared with other processes, we have to give it back here
             closeSerialPort(blackboxPort);
@@ -623,6 +686,24 @@ void blackboxDeviceClose(void)
     }
 }
 
+/**
+ * Close the Blackbox logging devices immediately without attempting to flush any remaining data.
+ */
+void blackboxDeviceClose(void)
+{
+    blackboxFrameBufferPos = 0;
+#ifdef USE_BLACKBOX_PREROLL
+    blackboxPrerollStop();
+#endif
+
+    for (int i = 0; i < BLACKBOX_SINK_COUNT; i++) {
+        if (blackboxSinks[i].device != BLACKBOX_DEVICE_NONE) {
+            blackboxDeviceCloseDevice(blackboxSinks[i].device);
+            blackboxSinks[i].device = BLACKBOX_DEVICE_NONE;
+        }
+    }
+}
+
 #ifdef USE_SDCARD
 
 static void blackboxLogDirCreated(afatfsFilePtr_t directory)
@@ -748,31 +829,31 @@ static bool blackboxSDCardBeginLog()
  */
 bool blackboxDeviceBeginLog(void)
 {
-    switch (blackboxConfig()->device) {
+    bool begun = true;
+
+    for (int i = 0; i < BLACKBOX_SINK_COUNT; i++) {
+        switch (blackboxSinks[i].device) {
 #ifdef USE_SDCARD
-        case BLACKBOX_DEVICE_SDCARD:
-            return blackboxSDCardBeginLog();
+            case BLACKBOX_DEVICE_SDCARD:
+                begun = blackboxSDCardBeginLog() && begun;
+            break;
 #endif
-        default:
-            return true;
+            default:
+                ;
+        }
+        blackboxSinks[i].logEnded = false;
     }
 
+    return begun;
 }
 
-/**
- * Terminate the current log (for devices which support separations between the logs of multiple flights).
- *
- * retainLog - Pass true if the log should be kept, or false if the log should be discarded (if supported).
- *
- * Keep calling until this returns true
- */
-bool blackboxDeviceEndLog(bool retainLog)
+static bool blackboxDeviceEndLogDevice(uint8_t device, bool retainLog)
 {
 #ifndef USE_SDCARD
     (void) retainLog;
 #endif
 
-    switch (blackboxConfig()->device) {
+    switch (device) {
 #ifdef USE_SDCARD
         case BLACKBOX_DEVICE_SDCARD:
             // Keep retrying until the close operation queues
@@ -792,6 +873,36 @@ bool blackboxDeviceEndLog(bool retainLog)
     }
 }
 
+/**
+ * Terminate the current log (for devices which support separations between the logs of multiple flights).
+ *
+ * retainLog - Pass true if the log should be kept, or false if the log should be discarded (if supported). The
+ * stream's log is always kept.
+ *
+ * Keep calling until this returns true
+ */
+bool blackboxDeviceEndLog(bool retainLog)
+{
+#ifdef USE_BLACKBOX_PREROLL
+    // The committed frames still held in the pre-roll ring belong to this log
+    if (!blackboxPrerollDrain()) {
+        blackboxDeviceFlush();
+        return false;
+    }
+#endif
+
+    bool ended = true;
+
+    for (int i = 0; i < BLACKBOX_SINK_COUNT; i++) {
+        if (!blackboxSinks[i].logEnded) {
+            blackboxSinks[i].logEnded = blackboxDeviceEndLogDevice(blackboxSinks[i].device, retainLog || i != BLACKBOX_SINK_PRIMARY);
+            ended = ended && blackboxSinks[i].logEnded;
+        }
+    }
+
+    return ended;
+}
+
 bool isBlackboxDeviceFull(void)
 {
     switch (blackboxConfig()->device) {
@@ -814,60 +925,97 @@ bool isBlackboxDeviceFull(void)
 }
 
 /**
- * Call once every loop iteration in order to maintain the global blackboxHeaderBudget with the number of bytes we can
- * transmit this iteration.
+ * Get the percentage of the logging device's buffers which is free, which drops as the device falls behind the log.
  */
-void blackboxReplenishHeaderBudget()
+uint8_t blackboxDeviceHeadroom(void)
 {
-    int32_t freeSpace;
+    const uint8_t device = blackboxSinks[BLACKBOX_SINK_PRIMARY].device;
+    uint32_t bufferSize;
+
+#ifdef USE_BLACKBOX_PREROLL
+    switch (blackboxPreroll.state) {
+        case BLACKBOX_PREROLL_BUFFERING:
+            // Nothing is written to the device, and the ring makes its own room
+            return 100;
+        case BLACKBOX_PREROLL_COMMITTED:
+            // The ring keeps the device as full as it can take, what backs up in the ring is how far behind it is
+            return (BLACKBOX_PREROLL_BUFFER_SIZE - (blackboxPreroll.head - blackboxPreroll.tail)) * 100 / BLACKBOX_PREROLL_BUFFER_SIZE;
+        default:
+            ;
+    }
+#endif
 
-    switch (blackboxConfig()->device) {
+    switch (device) {
         case BLACKBOX_DEVICE_SERIAL:
-            freeSpace = serialTxBytesFree(blackboxPort);
+            bufferSize = blackboxPort->txBufferSize;
         break;
 #ifdef USE_FLASHFS
         case BLACKBOX_DEVICE_FLASH:
-            freeSpace = flashfsGetWriteBufferFreeSpace();
+            bufferSize = flashfsGetWriteBufferSize();
         break;
 #endif
 #ifdef USE_SDCARD
         case BLACKBOX_DEVICE_SDCARD:
-            freeSpace = afatfs_getFreeBufferSpace();
+            bufferSize = afatfs_getBufferSize();
         break;
 #endif
         default:
-            freeSpace = 0;
+            bufferSize = 0;
+    }
+
+    // The USB VCP has no Tx buffer to fill up
+    if (bufferSize == 0) {
+        return 100;
+    }
+
+    return MIN(blackboxDeviceFreeSpace(device), (int32_t)bufferSize) * 100 / bufferSize;
+}
+
+/**
+ * Call once every loop iteration in order to maintain the global blackboxHeaderBudget with the number of bytes we can
+ * transmit this iteration. The header goes to every sink, so the budget is that of the fullest one.
+ */
+void blackboxReplenishHeaderBudget()
+{
+    int32_t freeSpace = BLACKBOX_MAX_ACCUMULATED_HEADER_BUDGET;
+
+    for (int i = 0; i < BLACKBOX_SINK_COUNT; i++) {
+        if (blackboxSinks[i].device != BLACKBOX_DEVICE_NONE) {
+            freeSpace = MIN(freeSpace, blackboxDeviceFreeSpace(blackboxSinks[i].device));
+        }
     }
 
     blackboxHeaderBudget = MIN(MIN(freeSpace, blackboxHeaderBudget + blackboxMaxHeaderBytesPerIteration), BLACKBOX_MAX_ACCUMULATED_HEADER_BUDGET);
 }
 
+#ifdef USE_BLACKBOX_HEADER_CACHE
 /**
- * You must call this function before attempting to write Blackbox header bytes to ensure that the write will not
- * cause buffers to overflow. The number of bytes you can write is capped by the blackboxHeaderBudget. Calling this
- * reservation function doesn't decrease blackboxHeaderBudget, so you must manually decrement that variable by the
- * number of bytes you actually wrote.
- *
- * When the Blackbox device is FlashFS, a successful return code guarantees that no data will be lost if you write that
- * many bytes to the device (i.e. FlashFS's buffers won't overflow).
- *
- * When the device is a serial port, a successful return code guarantees that Cleanflight's serial Tx buffer will not
- * overflow, and the outgoing bandwidth is likely to be small enough to give the OpenLog time to absorb MicroSD card
- * latency. However the OpenLog could still end up silently dropping data.
- *
- * Returns:
- *  BLACKBOX_RESERVE_SUCCESS - Upon success
- *  BLACKBOX_RESERVE_TEMPORARY_FAILURE - The buffer is currently too full to service the request, try again later
- *  BLACKBOX_RESERVE_PERMANENT_FAILURE - The buffer is too small to ever service this request
+ * Get how much of a pre-rendered header can be written to the sinks now. A serial sink is held to the header budget
+ * so the logger at the other end keeps up, the other devices take as much as they have room for.
  */
-blackboxBufferReserveStatus_e blackboxDeviceReserveBufferSpace(int32_t bytes)
+int32_t blackboxDeviceHeaderSpace(void)
 {
-    if (bytes <= blackboxHeaderBudget) {
-        return BLACKBOX_RESERVE_SUCCESS;
+    int32_t space = BLACKBOX_CACHED_HEADER_BYTES_PER_ITERATION;
+
+    for (int i = 0; i < BLACKBOX_SINK_COUNT; i++) {
+        switch (blackboxSinks[i].device) {
+            case BLACKBOX_DEVICE_NONE:
+            break;
+            case BLACKBOX_DEVICE_SERIAL:
+                space = MIN(space, blackboxHeaderBudget);
+            break;
+            default:
+                space = MIN(space, blackboxDeviceFreeSpace(blackboxSinks[i].device));
+        }
     }
 
-    // Handle failure:
-    switch (blackboxConfig()->device) {
+    return MAX(space, 0);
+}
+#endif
+
+static blackboxBufferReserveStatus_e blackboxDeviceReserveBufferSpaceDevice(uint8_t device, int32_t bytes)
+{
+    switch (device) {
         case BLACKBOX_DEVICE_SERIAL:
             /*
              * One byte of the tx buffer isn't available for user data (due to its circular list implementation),
@@ -908,4 +1056,50 @@ blackboxBufferReserveStatus_e blackboxDeviceReserveBufferSpace(int32_t bytes)
     }
 }
 
+/**
+ * You must call this function before attempting to write Blackbox header bytes to ensure that the write will not
+ * cause buffers to overflow. The number of bytes you can write is capped by the blackboxHeaderBudget. Calling this
+ * reservation function doesn't decrease blackboxHeaderBudget, so you must manually decrement that variable by the
+ * number of bytes you actually wrote.
+ *
+ * When the Blackbox device is FlashFS, a successful return code guarantees that no data will be lost if you write that
+ * many bytes to the device (i.e. FlashFS's buffers won't overflow).
+ *
+ * When the device is a serial port, a successful return code guarantees that Cleanflight's serial Tx buffer will not
+ * overflow, and the outgoing bandwidth is likely to be small enough to give the OpenLog time to absorb MicroSD card
+ * latency. However the OpenLog could still end up silently dropping data.
+ *
+ * With a stream open the reservation has to fit both sinks, and fails permanently if either can never take it.
+ *
+ * Returns:
+ *  BLACKBOX_RESERVE_SUCCESS - Upon success
+ *  BLACKBOX_RESERVE_TEMPORARY_FAILURE - The buffer is currently too full to service the request, try again later
+ *  BLACKBOX_RESERVE_PERMANENT_FAILURE - The buffer is too small to ever service this request
+ */
+blackboxBufferReserveStatus_e blackboxDeviceReserveBufferSpace(int32_t bytes)
+{
+#ifdef USE_BLACKBOX_HEADER_CACHE
+    // Running out of capture buffer is found out at the end
+    if (blackboxCapture.buffer) {
+        return BLACKBOX_RESERVE_SUCCESS;
+    }
+#endif
+
+    if (bytes <= blackboxHeaderBudget) {
+        return BLACKBOX_RESERVE_SUCCESS;
+    }
+
+    // Handle failure:
+    blackboxBufferReserveStatus_e status = BLACKBOX_RESERVE_TEMPORARY_FAILURE;
+
+    for (int i = 0; i < BLACKBOX_SINK_COUNT; i++) {
+        if (blackboxSinks[i].device != BLACKBOX_DEVICE_NONE
+            && blackboxDeviceReserveBufferSpaceDevice(blackboxSinks[i].device, bytes) == BLACKBOX_RESERVE_PERMANENT_FAILURE) {
+            status = BLACKBOX_RESERVE_PERMANENT_FAILURE;
+        }
+    }
+
+    return status;
+}
+
 #endif
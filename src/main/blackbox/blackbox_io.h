@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include "common/time.h"
+
 typedef enum BlackboxDevice {
     BLACKBOX_DEVICE_SERIAL = 0,
 
@@ -27,8 +29,23 @@ typedef enum BlackboxDevice {
     BLACKBOX_DEVICE_SDCARD = 2,
 #endif
 
+    BLACKBOX_DEVICE_NONE = 3
 } BlackboxDevice;
 
+/*
+ * The primary sink gets the whole log, the stream sink on blackbox_stream_device a decimated copy of it for a ground
+ * logger: the header, some of the "I" frames and the "S", "E" and "H" frames. Frames predicted from others, including
+ * "G" frames whose time is predicted from the last main frame, go to the primary sink only.
+ */
+typedef enum {
+    BLACKBOX_SINK_PRIMARY = 0,
+    BLACKBOX_SINK_STREAM,
+    BLACKBOX_SINK_COUNT
+} blackboxSink_e;
+
+#define BLACKBOX_SINK_MASK(sink) (1 << (sink))
+#define BLACKBOX_SINK_MASK_ALL ((1 << BLACKBOX_SINK_COUNT) - 1)
+
 typedef enum {
     BLACKBOX_RESERVE_SUCCESS,
     BLACKBOX_RESERVE_TEMPORARY_FAILURE,
@@ -47,25 +64,43 @@ typedef enum {
  */
 #define BLACKBOX_TARGET_HEADER_BUDGET_PER_ITERATION 64
 
+#ifdef USE_BLACKBOX_HEADER_CACHE
+// A pre-rendered header only needs copying, so it's written in much bigger chunks
+#define BLACKBOX_CACHED_HEADER_BYTES_PER_ITERATION 1024
+#endif
+
+/*
+ * Frames are staged in a buffer of this size before being written to the device, larger writes are split. This holds
+ * the biggest frame we write (an I-frame with every field) and a full header chunk.
+ */
+#define BLACKBOX_FRAME_BUFFER_SIZE 256
+
+#ifdef USE_BLACKBOX_PREROLL
+/*
+ * In pre-roll mode the frames are held in a RAM ring of this size (a power of two) until a trigger commits them to the
+ * device. The ring is cut into at most BLACKBOX_PREROLL_SEGMENT_COUNT segments, each starting at an "I" frame.
+ *
+ * How much flight the pre-roll covers depends on the logging rate, not on the settings: at 8kHz with every iteration
+ * logged it is a few hundred milliseconds, and at most BLACKBOX_PREROLL_SEGMENT_COUNT "I" frame intervals.
+ */
+#define BLACKBOX_PREROLL_BUFFER_SIZE (32 * 1024)
+#define BLACKBOX_PREROLL_SEGMENT_COUNT 256
+
+// Limits how much of a committed ring is written to the device per blackbox task iteration
+#define BLACKBOX_PREROLL_DRAIN_PER_ITERATION 1024
+#endif
+
 extern int32_t blackboxHeaderBudget;
 
 void blackboxWrite(uint8_t value);
+void blackboxWriteBuf(const uint8_t *data, int length);
+void blackboxFlushFrame(void);
+void blackboxFlushFrameTo(uint8_t sinks);
 
 int blackboxPrintf(const char *fmt, ...);
 void blackboxPrintfHeaderLine(const char *fmt, ...);
 int blackboxPrint(const char *s);
 
-void blackboxWriteUnsignedVB(uint32_t value);
-void blackboxWriteSignedVB(int32_t value);
-void blackboxWriteSignedVBArray(int32_t *array, int count);
-void blackboxWriteSigned16VBArray(int16_t *array, int count);
-void blackboxWriteS16(int16_t value);
-void blackboxWriteTag2_3S32(int32_t *values);
-void blackboxWriteTag8_4S16(int32_t *values);
-void blackboxWriteTag8_8SVB(int32_t *values, int valueCount);
-void blackboxWriteU32(int32_t value);
-void blackboxWriteFloat(float value);
-
 void blackboxDeviceFlush(void);
 bool blackboxDeviceFlushForce(void);
 bool blackboxDeviceOpen(void);
@@ -75,6 +110,22 @@ bool blackboxDeviceBeginLog(void);
 bool blackboxDeviceEndLog(bool retainLog);
 
 bool isBlackboxDeviceFull(void);
+uint8_t blackboxDeviceHeadroom(void);
+
+#ifdef USE_BLACKBOX_PREROLL
+void blackboxPrerollStart(void);
+void blackboxPrerollStop(void);
+void blackboxPrerollBeginSegment(void);
+timeMs_t blackboxPrerollCommit(void);
+bool blackboxPrerollRelease(void);
+bool blackboxPrerollIsBuffering(void);
+#endif
+
+#ifdef USE_BLACKBOX_HEADER_CACHE
+void blackboxCaptureBegin(uint8_t *buffer, int32_t size);
+int32_t blackboxCaptureEnd(void);
+int32_t blackboxDeviceHeaderSpace(void);
+#endif
 
 void blackboxReplenishHeaderBudget();
 blackboxBufferReserveStatus_e blackboxDeviceReserveBufferSpace(int32_t bytes);
@@ -0,0 +1,175 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "encoding.h"
+#include "golomb_rice.h"
+
+void golombRiceContextInit(golombRiceContext_t *context)
+{
+    context->sum = 4;
+    context->count = 1;
+}
+
+/**
+ * Returns the smallest Rice parameter k for which count * 2^k reaches the context's sum, i.e. about log2 of the
+ * average value.
+ */
+uint8_t golombRiceParameter(const golombRiceContext_t *context)
+{
+    uint8_t k = 0;
+
+    while (((uint32_t)context->count << k) < context->sum && k < 31) {
+        k++;
+    }
+
+    return k;
+}
+
+static void golombRiceContextUpdate(golombRiceContext_t *context, uint32_t value)
+{
+    context->sum += value;
+    context->count++;
+
+    if (context->count >= GOLOMB_RICE_CONTEXT_RESET) {
+        context->sum >>= 1;
+        context->count >>= 1;
+    }
+}
+
+void golombRiceWriterInit(golombRiceWriter_t *writer, void (*putByte)(uint8_t byte))
+{
+    writer->putByte = putByte;
+    writer->bits = 0;
+    writer->bitCount = 0;
+}
+
+// Append the low "count" bits of value, most significant first, count must be 24 or less
+static void golombRiceWriteBits(golombRiceWriter_t *writer, uint32_t value, uint8_t count)
+{
+    writer->bits = (writer->bits << count) | (value & ((1u << count) - 1));
+    writer->bitCount += count;
+
+    while (writer->bitCount >= 8) {
+        writer->bitCount -= 8;
+        writer->putByte(writer->bits >> writer->bitCount);
+    }
+}
+
+void golombRiceWrite(golombRiceWriter_t *writer, golombRiceContext_t *context, int32_t value)
+{
+    const uint32_t u = zigzagEncode(value);
+    const uint8_t k = golombRiceParameter(context);
+    const uint32_t quotient = u >> k;
+
+    if (quotient < GOLOMB_RICE_ESCAPE_LENGTH) {
+        // Unary quotient as ones closed by a zero, then the k low bits
+        golombRiceWriteBits(writer, ((1u << quotient) - 1) << 1, quotient + 1);
+        if (k > 16) {
+            golombRiceWriteBits(writer, u >> 16, k - 16);
+            golombRiceWriteBits(writer, u, 16);
+        } else if (k) {
+            golombRiceWriteBits(writer, u, k);
+        }
+    } else {
+        golombRiceWriteBits(writer, (1u << GOLOMB_RICE_ESCAPE_LENGTH) - 1, GOLOMB_RICE_ESCAPE_LENGTH);
+        golombRiceWriteBits(writer, u >> 16, 16);
+        golombRiceWriteBits(writer, u, 16);
+    }
+
+    golombRiceContextUpdate(context, u);
+}
+
+/**
+ * Write out the last partial byte, padded with zeros.
+ */
+void golombRiceWriterFlush(golombRiceWriter_t *writer)
+{
+    if (writer->bitCount) {
+        writer->putByte(writer->bits << (8 - writer->bitCount));
+        writer->bitCount = 0;
+    }
+    writer->bits = 0;
+}
+
+void golombRiceReaderInit(golombRiceReader_t *reader, const uint8_t *data, int length)
+{
+    reader->ptr = data;
+    reader->end = data + length;
+    reader->bits = 0;
+    reader->bitCount = 0;
+    reader->overrun = false;
+}
+
+static uint32_t golombRiceReadBits(golombRiceReader_t *reader, uint8_t count)
+{
+    while (reader->bitCount < count) {
+        uint8_t byte = 0;
+        if (reader->ptr < reader->end) {
+            byte = *reader->ptr++;
+        } else {
+            reader->overrun = true;
+        }
+        reader->bits = (reader->bits << 8) | byte;
+        reader->bitCount += 8;
+    }
+
+    reader->bitCount -= count;
+
+    return (reader->bits >> reader->bitCount) & ((1u << count) - 1);
+}
+
+int32_t golombRiceRead(golombRiceReader_t *reader, golombRiceContext_t *context)
+{
+    const uint8_t k = golombRiceParameter(context);
+    uint32_t quotient = 0;
+    uint32_t u;
+
+    while (quotient < GOLOMB_RICE_ESCAPE_LENGTH && golombRiceReadBits(reader, 1)) {
+        quotient++;
+    }
+
+    if (quotient < GOLOMB_RICE_ESCAPE_LENGTH) {
+        u = quotient << k;
+        if (k > 16) {
+            u |= golombRiceReadBits(reader, k - 16) << 16;
+            u |= golombRiceReadBits(reader, 16);
+        } else if (k) {
+            u |= golombRiceReadBits(reader, k);
+        }
+    } else {
+        u = golombRiceReadBits(reader, 16) << 16;
+        u |= golombRiceReadBits(reader, 16);
+    }
+
+    golombRiceContextUpdate(context, u);
+
+    return (int32_t)(u >> 1) ^ -(int32_t)(u & 1);
+}
+
+/**
+ * Skip the padding up to the next byte boundary, leaving reader->ptr at the first byte after the coded values.
+ */
+void golombRiceReaderAlign(golombRiceReader_t *reader)
+{
+    // Give back any whole bytes which were fetched but not used
+    reader->ptr -= reader->bitCount / 8;
+    reader->bitCount = 0;
+    reader->bits = 0;
+}
@@ -0,0 +1,62 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Adaptive Golomb-Rice coding of signed residuals. Each coded field keeps a context with the running average of its
+ * (zigzag encoded) values, and the Rice parameter for the next value is chosen from that average, so the code adapts
+ * to how noisy each field is. The encoder and decoder update their contexts identically.
+ */
+
+// Unary prefixes this long are followed by the value stored verbatim in 32 bits
+#define GOLOMB_RICE_ESCAPE_LENGTH   24
+// The context sums and counts are halved when the count reaches this, so the average follows recent values
+#define GOLOMB_RICE_CONTEXT_RESET   64
+
+typedef struct golombRiceContext_s {
+    uint32_t sum;
+    uint16_t count;
+} golombRiceContext_t;
+
+typedef struct golombRiceWriter_s {
+    void (*putByte)(uint8_t byte);
+    uint32_t bits;
+    uint8_t bitCount;
+} golombRiceWriter_t;
+
+typedef struct golombRiceReader_s {
+    const uint8_t *ptr;
+    const uint8_t *end;
+    uint32_t bits;
+    uint8_t bitCount;
+    bool overrun;           // set if the reader ran past the end of the data
+} golombRiceReader_t;
+
+void golombRiceContextInit(golombRiceContext_t *context);
+uint8_t golombRiceParameter(const golombRiceContext_t *context);
+
+void golombRiceWriterInit(golombRiceWriter_t *writer, void (*putByte)(uint8_t byte));
+void golombRiceWrite(golombRiceWriter_t *writer, golombRiceContext_t *context, int32_t value);
+void golombRiceWriterFlush(golombRiceWriter_t *writer);
+
+void golombRiceReaderInit(golombRiceReader_t *reader, const uint8_t *data, int length);
+int32_t golombRiceRead(golombRiceReader_t *reader, golombRiceContext_t *context);
+void golombRiceReaderAlign(golombRiceReader_t *reader);
@@ -34,4 +34,7 @@ typedef uint32_t timeUs_t;
 #define TIMEUS_MAX UINT32_MAX
 #endif
 
+// CPU clock cycles, for timing short code paths, wraps after a few tens of seconds
+typedef uint32_t timeCycles_t;
+
 static inline timeDelta_t cmpTimeUs(timeUs_t a, timeUs_t b) { return (timeDelta_t)(a - b); }
@@ -65,6 +65,7 @@ typedef struct accDev_s {
     sensorAccReadFuncPtr read;                              // read 3 axis data function
     uint16_t acc_1G;
     int16_t ADCRaw[XYZ_AXIS_COUNT];
+    gyroRateKHz_e gyroRateKHz;                              // sample rate of the shared MPU, sets the FIFO fill rate
     char revisionCode;                                      // a revision code for the sensor, if known
     sensor_align_e accAlign;
     mpuDetectionResult_t mpuDetectionResult;
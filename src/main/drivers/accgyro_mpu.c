@@ -133,6 +133,7 @@ static bool detectSPISensorsAndUpdateDetectionResult(gyroDev_t *gyro)
         gyro->mpuConfiguration.gyroReadXRegister = MPU_RA_GYRO_XOUT_H;
         gyro->mpuConfiguration.read = mpu6500ReadRegister;
         gyro->mpuConfiguration.write = mpu6500WriteRegister;
+        gyro->mpuConfiguration.slowwrite = mpu6500SlowWriteRegister;
         return true;
     }
 #endif
@@ -143,6 +144,7 @@ static bool detectSPISensorsAndUpdateDetectionResult(gyroDev_t *gyro)
         gyro->mpuConfiguration.gyroReadXRegister = MPU_RA_GYRO_XOUT_H;
         gyro->mpuConfiguration.read = icm20689ReadRegister;
         gyro->mpuConfiguration.write = icm20689WriteRegister;
+        gyro->mpuConfiguration.slowwrite = icm20689SlowWriteRegister;
         return true;
     }
 #endif
@@ -153,6 +155,7 @@ static bool detectSPISensorsAndUpdateDetectionResult(gyroDev_t *gyro)
         gyro->mpuConfiguration.gyroReadXRegister = MPU_RA_GYRO_XOUT_H;
         gyro->mpuConfiguration.read = mpu6000ReadRegister;
         gyro->mpuConfiguration.write = mpu6000WriteRegister;
+        gyro->mpuConfiguration.slowwrite = mpu6000SlowWriteRegister;
         return true;
     }
 #endif
@@ -301,6 +304,156 @@ bool mpuAccRead(accDev_t *acc)
     return true;
 }
 
+/*
+ * Accelerometer samples collected by mpuGyroReadBurst(), the gyro may be read in the data ready ISR.
+ */
+typedef struct mpuBurstAccSample_s {
+    bool enabled;
+    uint8_t count;
+    int32_t sum[XYZ_AXIS_COUNT];
+} mpuBurstAccSample_t;
+
+static volatile mpuBurstAccSample_t mpuBurstAccSample;
+
+/*
+ * Read the accelerometer and gyro in a single transfer whenever the gyro is read, so that the
+ * accelerometer task does not need a bus transaction of its own. At 32kHz the extra bytes on every
+ * gyro read cost more than a separate accelerometer read, so the burst is limited to 8kHz and below.
+ */
+void mpuGyroBurstInit(gyroDev_t *gyro)
+{
+    if (gyro->gyroRateKHz > GYRO_RATE_8_kHz) {
+        return;
+    }
+
+    mpuBurstAccSample.enabled = true;
+    gyro->read = mpuGyroReadBurst;
+}
+
+bool mpuGyroReadBurst(gyroDev_t *gyro)
+{
+    uint8_t data[MPU_BURST_SIZE];
+
+    const bool ack = gyro->mpuConfiguration.read(MPU_RA_ACCEL_XOUT_H, MPU_BURST_SIZE, data);
+    if (!ack) {
+        return false;
+    }
+
+    if (mpuBurstAccSample.count < UINT8_MAX) {
+        mpuBurstAccSample.sum[X] += (int16_t)((data[0] << 8) | data[1]);
+        mpuBurstAccSample.sum[Y] += (int16_t)((data[2] << 8) | data[3]);
+        mpuBurstAccSample.sum[Z] += (int16_t)((data[4] << 8) | data[5]);
+        mpuBurstAccSample.count++;
+    }
+
+    const uint8_t *gyroData = &data[MPU_BURST_GYRO_OFFSET];
+    gyro->gyroADCRaw[X] = (int16_t)((gyroData[0] << 8) | gyroData[1]);
+    gyro->gyroADCRaw[Y] = (int16_t)((gyroData[2] << 8) | gyroData[3]);
+    gyro->gyroADCRaw[Z] = (int16_t)((gyroData[4] << 8) | gyroData[5]);
+
+    return true;
+}
+
+bool mpuAccBurstInit(accDev_t *acc)
+{
+    if (!mpuBurstAccSample.enabled) {
+        return false;
+    }
+
+    acc->read = mpuAccReadBurst;
+    return true;
+}
+
+bool mpuAccReadBurst(accDev_t *acc)
+{
+    int32_t sum[XYZ_AXIS_COUNT];
+    uint8_t count;
+
+    ATOMIC_BLOCK(NVIC_PRIO_MPU_INT_EXTI) {
+        count = mpuBurstAccSample.count;
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            sum[axis] = mpuBurstAccSample.sum[axis];
+            mpuBurstAccSample.sum[axis] = 0;
+        }
+        mpuBurstAccSample.count = 0;
+    }
+
+    if (count == 0) {
+        // the gyro has not been read since the last call
+        return false;
+    }
+
+    acc->ADCRaw[X] = sum[X] / count;
+    acc->ADCRaw[Y] = sum[Y] / count;
+    acc->ADCRaw[Z] = sum[Z] / count;
+
+    return true;
+}
+
+static void mpuAccFifoReset(accDev_t *acc)
+{
+    acc->mpuConfiguration.slowwrite(MPU_RA_USER_CTRL, MPU_RF_I2C_IF_DIS | MPU_RF_FIFO_RESET);
+    acc->mpuConfiguration.slowwrite(MPU_RA_USER_CTRL, MPU_RF_I2C_IF_DIS | MPU_RF_FIFO_EN);
+}
+
+/*
+ * Route the accelerometer samples through the FIFO so that mpuAccReadFifo() can collect
+ * everything produced since the last call in one burst. Only used on SPI sensors and
+ * when the FIFO fills slowly enough for the accelerometer task to keep up with it.
+ */
+void mpuAccFifoInit(accDev_t *acc)
+{
+    if (!acc->mpuConfiguration.slowwrite || acc->gyroRateKHz > GYRO_RATE_8_kHz) {
+        return;
+    }
+
+    acc->mpuConfiguration.slowwrite(MPU_RA_FIFO_EN, MPU_RF_ACCEL_FIFO_EN);
+    mpuAccFifoReset(acc);
+
+    acc->read = mpuAccReadFifo;
+}
+
+bool mpuAccReadFifo(accDev_t *acc)
+{
+    uint8_t data[MPU_FIFO_ACC_MAX_SAMPLES * MPU_FIFO_ACC_SAMPLE_SIZE];
+
+    bool ack = acc->mpuConfiguration.read(MPU_RA_FIFO_COUNTH, 2, data);
+    if (!ack) {
+        return false;
+    }
+
+    const uint16_t fifoCount = (data[0] << 8) | data[1];
+    const int sampleCount = fifoCount / MPU_FIFO_ACC_SAMPLE_SIZE;
+    if (sampleCount == 0) {
+        // nothing new since the last call, keep the previous sample
+        return true;
+    }
+    if (sampleCount > MPU_FIFO_ACC_MAX_SAMPLES) {
+        // the task has stalled and the FIFO may have overflowed and lost sample alignment, so start afresh
+        mpuAccFifoReset(acc);
+        return mpuAccRead(acc);
+    }
+
+    ack = acc->mpuConfiguration.read(MPU_RA_FIFO_R_W, sampleCount * MPU_FIFO_ACC_SAMPLE_SIZE, data);
+    if (!ack) {
+        return false;
+    }
+
+    int32_t accSum[XYZ_AXIS_COUNT] = { 0, 0, 0 };
+    for (int i = 0; i < sampleCount; i++) {
+        const uint8_t *sample = &data[i * MPU_FIFO_ACC_SAMPLE_SIZE];
+        accSum[X] += (int16_t)((sample[0] << 8) | sample[1]);
+        accSum[Y] += (int16_t)((sample[2] << 8) | sample[3]);
+        accSum[Z] += (int16_t)((sample[4] << 8) | sample[5]);
+    }
+
+    acc->ADCRaw[X] = accSum[X] / sampleCount;
+    acc->ADCRaw[Y] = accSum[Y] / sampleCount;
+    acc->ADCRaw[Z] = accSum[Z] / sampleCount;
+
+    return true;
+}
+
 void mpuGyroSetIsrUpdate(gyroDev_t *gyro, sensorGyroUpdateFuncPtr updateFn)
 {
     ATOMIC_BLOCK(NVIC_PRIO_MPU_INT_EXTI) {
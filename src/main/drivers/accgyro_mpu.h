@@ -123,6 +123,16 @@
 
 // RF = Register Flag
 #define MPU_RF_DATA_RDY_EN (1 << 0)
+#define MPU_RF_ACCEL_FIFO_EN (1 << 3)   // FIFO_EN
+#define MPU_RF_FIFO_EN (1 << 6)         // USER_CTRL
+#define MPU_RF_I2C_IF_DIS (1 << 4)      // USER_CTRL
+#define MPU_RF_FIFO_RESET (1 << 2)      // USER_CTRL
+
+#define MPU_FIFO_ACC_SAMPLE_SIZE 6      // ACCEL_XOUT to ACCEL_ZOUT
+#define MPU_FIFO_ACC_MAX_SAMPLES 16     // 2ms of backlog at 8kHz, anything beyond that restarts the FIFO
+
+#define MPU_BURST_SIZE 14               // ACCEL_XOUT to GYRO_ZOUT, including TEMP_OUT
+#define MPU_BURST_GYRO_OFFSET 8
 
 typedef bool (*mpuReadRegisterFunc)(uint8_t reg, uint8_t length, uint8_t* data);
 typedef bool (*mpuWriteRegisterFunc)(uint8_t reg, uint8_t data);
@@ -135,6 +145,7 @@ typedef struct mpuConfiguration_s {
     mpuWriteRegisterFunc write;
     mpuReadRegisterFunc slowread;
     mpuWriteRegisterFunc verifywrite;
+    mpuWriteRegisterFunc slowwrite;     // write at a clock rate safe for the configuration registers, SPI only
     mpuResetFuncPtr reset;
     uint8_t gyroReadXRegister; // Y and Z must registers follow this, 2 words each
 } mpuConfiguration_t;
@@ -194,7 +205,13 @@ struct gyroDev_s;
 void mpuGyroInit(struct gyroDev_s *gyro);
 struct accDev_s;
 bool mpuAccRead(struct accDev_s *acc);
+void mpuAccFifoInit(struct accDev_s *acc);
+bool mpuAccReadFifo(struct accDev_s *acc);
+bool mpuAccBurstInit(struct accDev_s *acc);
+bool mpuAccReadBurst(struct accDev_s *acc);
 bool mpuGyroRead(struct gyroDev_s *gyro);
+void mpuGyroBurstInit(struct gyroDev_s *gyro);
+bool mpuGyroReadBurst(struct gyroDev_s *gyro);
 mpuDetectionResult_t *mpuDetect(struct gyroDev_s *gyro);
 bool mpuCheckDataReady(struct gyroDev_s *gyro);
 void mpuGyroSetIsrUpdate(struct gyroDev_s *gyro, sensorGyroUpdateFuncPtr updateFn);
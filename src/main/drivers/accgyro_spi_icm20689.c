@@ -36,29 +36,26 @@
 #include "accgyro_mpu.h"
 #include "accgyro_spi_icm20689.h"
 
-#define DISABLE_ICM20689       IOHi(icmSpi20689CsPin)
-#define ENABLE_ICM20689        IOLo(icmSpi20689CsPin)
-
-static IO_t icmSpi20689CsPin = IO_NONE;
+static spiBusDevice_t icm20689SpiDevice;
 
 bool icm20689WriteRegister(uint8_t reg, uint8_t data)
 {
-    ENABLE_ICM20689;
-    spiTransferByte(ICM20689_SPI_INSTANCE, reg);
-    spiTransferByte(ICM20689_SPI_INSTANCE, data);
-    DISABLE_ICM20689;
+    return spiBusWriteRegister(&icm20689SpiDevice, reg, data);
+}
+
+bool icm20689SlowWriteRegister(uint8_t reg, uint8_t data)
+{
+    spiBusSetDivisor(&icm20689SpiDevice, SPI_CLOCK_INITIALIZATON);
+    icm20689WriteRegister(reg, data);
+    delayMicroseconds(15);
+    spiBusSetDivisor(&icm20689SpiDevice, SPI_CLOCK_STANDARD);
 
     return true;
 }
 
 bool icm20689ReadRegister(uint8_t reg, uint8_t length, uint8_t *data)
 {
-    ENABLE_ICM20689;
-    spiTransferByte(ICM20689_SPI_INSTANCE, reg | 0x80); // read transaction
-    spiTransfer(ICM20689_SPI_INSTANCE, data, NULL, length);
-    DISABLE_ICM20689;
-
-    return true;
+    return spiBusReadRegisterBuffer(&icm20689SpiDevice, reg, data, length);
 }
 
 static void icm20689SpiInit(void)
@@ -69,11 +66,11 @@ static void icm20689SpiInit(void)
         return;
     }
 
-    icmSpi20689CsPin = IOGetByTag(IO_TAG(ICM20689_CS_PIN));
+    IO_t icmSpi20689CsPin = IOGetByTag(IO_TAG(ICM20689_CS_PIN));
     IOInit(icmSpi20689CsPin, OWNER_MPU_CS, 0);
     IOConfigGPIO(icmSpi20689CsPin, SPI_IO_CS_CFG);
 
-    spiSetDivisor(ICM20689_SPI_INSTANCE, SPI_CLOCK_STANDARD);
+    spiBusDeviceInit(&icm20689SpiDevice, ICM20689_SPI_INSTANCE, icmSpi20689CsPin, SPI_CLOCK_STANDARD);
 
     hardwareInitialised = true;
 }
@@ -85,7 +82,7 @@ bool icm20689SpiDetect(void)
 
     icm20689SpiInit();
 
-    spiSetDivisor(ICM20689_SPI_INSTANCE, SPI_CLOCK_INITIALIZATON); //low speed
+    spiBusSetDivisor(&icm20689SpiDevice, SPI_CLOCK_INITIALIZATON); //low speed
 
     icm20689WriteRegister(MPU_RA_PWR_MGMT_1, ICM20689_BIT_RESET);
 
@@ -101,7 +98,7 @@ bool icm20689SpiDetect(void)
         }
     } while (attemptsRemaining--);
 
-    spiSetDivisor(ICM20689_SPI_INSTANCE, SPI_CLOCK_STANDARD);
+    spiBusSetDivisor(&icm20689SpiDevice, SPI_CLOCK_STANDARD);
 
     return true;
 
@@ -110,6 +107,8 @@ bool icm20689SpiDetect(void)
 void icm20689AccInit(accDev_t *acc)
 {
     acc->acc_1G = 512 * 4;
+
+    mpuAccFifoInit(acc);
 }
 
 bool icm20689SpiAccDetect(accDev_t *acc)
@@ -128,7 +127,7 @@ void icm20689GyroInit(gyroDev_t *gyro)
 {
     mpuGyroInit(gyro);
 
-    spiSetDivisor(ICM20689_SPI_INSTANCE, SPI_CLOCK_INITIALIZATON);
+    spiBusSetDivisor(&icm20689SpiDevice, SPI_CLOCK_INITIALIZATON);
 
     gyro->mpuConfiguration.write(MPU_RA_PWR_MGMT_1, ICM20689_BIT_RESET);
     delay(100);
@@ -158,7 +157,7 @@ void icm20689GyroInit(gyroDev_t *gyro)
     gyro->mpuConfiguration.write(MPU_RA_INT_ENABLE, 0x01); // RAW_RDY_EN interrupt enable
 #endif
 
-    spiSetDivisor(ICM20689_SPI_INSTANCE, SPI_CLOCK_STANDARD);
+    spiBusSetDivisor(&icm20689SpiDevice, SPI_CLOCK_STANDARD);
 }
 
 bool icm20689SpiGyroDetect(gyroDev_t *gyro)
@@ -31,4 +31,5 @@ bool icm20689SpiAccDetect(accDev_t *acc);
 bool icm20689SpiGyroDetect(gyroDev_t *gyro);
 
 bool icm20689WriteRegister(uint8_t reg, uint8_t data);
+bool icm20689SlowWriteRegister(uint8_t reg, uint8_t data);
 bool icm20689ReadRegister(uint8_t reg, uint8_t length, uint8_t *data);
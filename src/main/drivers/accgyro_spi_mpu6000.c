@@ -99,29 +99,26 @@ static bool mpuSpi6000InitDone = false;
 #define MPU6000_REV_D9 0x59
 #define MPU6000_REV_D10 0x5A
 
-#define DISABLE_MPU6000       IOHi(mpuSpi6000CsPin)
-#define ENABLE_MPU6000        IOLo(mpuSpi6000CsPin)
-
-static IO_t mpuSpi6000CsPin = IO_NONE;
+static spiBusDevice_t mpu6000SpiDevice;
 
 bool mpu6000WriteRegister(uint8_t reg, uint8_t data)
 {
-    ENABLE_MPU6000;
-    spiTransferByte(MPU6000_SPI_INSTANCE, reg);
-    spiTransferByte(MPU6000_SPI_INSTANCE, data);
-    DISABLE_MPU6000;
+    return spiBusWriteRegister(&mpu6000SpiDevice, reg, data);
+}
+
+bool mpu6000SlowWriteRegister(uint8_t reg, uint8_t data)
+{
+    spiBusSetDivisor(&mpu6000SpiDevice, SPI_CLOCK_INITIALIZATON);
+    mpu6000WriteRegister(reg, data);
+    delayMicroseconds(15);
+    spiBusSetDivisor(&mpu6000SpiDevice, SPI_CLOCK_FAST);
 
     return true;
 }
 
 bool mpu6000ReadRegister(uint8_t reg, uint8_t length, uint8_t *data)
 {
-    ENABLE_MPU6000;
-    spiTransferByte(MPU6000_SPI_INSTANCE, reg | 0x80); // read transaction
-    spiTransfer(MPU6000_SPI_INSTANCE, data, NULL, length);
-    DISABLE_MPU6000;
-
-    return true;
+    return spiBusReadRegisterBuffer(&mpu6000SpiDevice, reg, data, length);
 }
 
 void mpu6000SpiGyroInit(gyroDev_t *gyro)
@@ -130,30 +127,37 @@ void mpu6000SpiGyroInit(gyroDev_t *gyro)
 
     mpu6000AccAndGyroInit(gyro);
 
-    spiSetDivisor(MPU6000_SPI_INSTANCE, SPI_CLOCK_INITIALIZATON);
+    spiBusSetDivisor(&mpu6000SpiDevice, SPI_CLOCK_INITIALIZATON);
 
     // Accel and Gyro DLPF Setting
     mpu6000WriteRegister(MPU6000_CONFIG, gyro->lpf);
     delayMicroseconds(1);
 
-    spiSetDivisor(MPU6000_SPI_INSTANCE, SPI_CLOCK_FAST);  // 18 MHz SPI clock
+    spiBusSetDivisor(&mpu6000SpiDevice, SPI_CLOCK_FAST);  // 18 MHz SPI clock
 
     mpuGyroRead(gyro);
 
     if (((int8_t)gyro->gyroADCRaw[1]) == -1 && ((int8_t)gyro->gyroADCRaw[0]) == -1) {
         failureMode(FAILURE_GYRO_INIT_FAILED);
     }
+
+    mpuGyroBurstInit(gyro);
 }
 
 void mpu6000SpiAccInit(accDev_t *acc)
 {
     acc->acc_1G = 512 * 4;
+
+    if (!mpuAccBurstInit(acc)) {
+        mpuAccFifoInit(acc);
+    }
 }
 
 bool mpu6000SpiDetect(void)
 {
     uint8_t in;
     uint8_t attemptsRemaining = 5;
+    IO_t mpuSpi6000CsPin = IO_NONE;
 
 #ifdef MPU6000_CS_PIN
     mpuSpi6000CsPin = IOGetByTag(IO_TAG(MPU6000_CS_PIN));
@@ -161,7 +165,7 @@ bool mpu6000SpiDetect(void)
     IOInit(mpuSpi6000CsPin, OWNER_MPU_CS, 0);
     IOConfigGPIO(mpuSpi6000CsPin, SPI_IO_CS_CFG);
 
-    spiSetDivisor(MPU6000_SPI_INSTANCE, SPI_CLOCK_INITIALIZATON);
+    spiBusDeviceInit(&mpu6000SpiDevice, MPU6000_SPI_INSTANCE, mpuSpi6000CsPin, SPI_CLOCK_INITIALIZATON);
 
     mpu6000WriteRegister(MPU_RA_PWR_MGMT_1, BIT_H_RESET);
 
@@ -207,7 +211,7 @@ static void mpu6000AccAndGyroInit(gyroDev_t *gyro)
         return;
     }
 
-    spiSetDivisor(MPU6000_SPI_INSTANCE, SPI_CLOCK_INITIALIZATON);
+    spiBusSetDivisor(&mpu6000SpiDevice, SPI_CLOCK_INITIALIZATON);
 
     // Device Reset
     mpu6000WriteRegister(MPU_RA_PWR_MGMT_1, BIT_H_RESET);
@@ -248,7 +252,7 @@ static void mpu6000AccAndGyroInit(gyroDev_t *gyro)
     delayMicroseconds(15);
 #endif
 
-    spiSetDivisor(MPU6000_SPI_INSTANCE, SPI_CLOCK_FAST);
+    spiBusSetDivisor(&mpu6000SpiDevice, SPI_CLOCK_FAST);
     delayMicroseconds(1);
 
     mpuSpi6000InitDone = true;
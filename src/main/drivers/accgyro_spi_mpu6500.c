@@ -34,29 +34,26 @@
 #include "accgyro_mpu6500.h"
 #include "accgyro_spi_mpu6500.h"
 
-#define DISABLE_MPU6500       IOHi(mpuSpi6500CsPin)
-#define ENABLE_MPU6500        IOLo(mpuSpi6500CsPin)
-
-static IO_t mpuSpi6500CsPin = IO_NONE;
+static spiBusDevice_t mpu6500SpiDevice;
 
 bool mpu6500WriteRegister(uint8_t reg, uint8_t data)
 {
-    ENABLE_MPU6500;
-    spiTransferByte(MPU6500_SPI_INSTANCE, reg);
-    spiTransferByte(MPU6500_SPI_INSTANCE, data);
-    DISABLE_MPU6500;
+    return spiBusWriteRegister(&mpu6500SpiDevice, reg, data);
+}
+
+bool mpu6500SlowWriteRegister(uint8_t reg, uint8_t data)
+{
+    spiBusSetDivisor(&mpu6500SpiDevice, SPI_CLOCK_SLOW);
+    mpu6500WriteRegister(reg, data);
+    delayMicroseconds(15);
+    spiBusSetDivisor(&mpu6500SpiDevice, SPI_CLOCK_FAST);
 
     return true;
 }
 
 bool mpu6500ReadRegister(uint8_t reg, uint8_t length, uint8_t *data)
 {
-    ENABLE_MPU6500;
-    spiTransferByte(MPU6500_SPI_INSTANCE, reg | 0x80); // read transaction
-    spiTransfer(MPU6500_SPI_INSTANCE, data, NULL, length);
-    DISABLE_MPU6500;
-
-    return true;
+    return spiBusReadRegisterBuffer(&mpu6500SpiDevice, reg, data, length);
 }
 
 static void mpu6500SpiInit(void)
@@ -67,11 +64,11 @@ static void mpu6500SpiInit(void)
         return;
     }
 
-    mpuSpi6500CsPin = IOGetByTag(IO_TAG(MPU6500_CS_PIN));
+    IO_t mpuSpi6500CsPin = IOGetByTag(IO_TAG(MPU6500_CS_PIN));
     IOInit(mpuSpi6500CsPin, OWNER_MPU_CS, 0);
     IOConfigGPIO(mpuSpi6500CsPin, SPI_IO_CS_CFG);
 
-    spiSetDivisor(MPU6500_SPI_INSTANCE, SPI_CLOCK_FAST);
+    spiBusDeviceInit(&mpu6500SpiDevice, MPU6500_SPI_INSTANCE, mpuSpi6500CsPin, SPI_CLOCK_FAST);
 
     hardwareInitialised = true;
 }
@@ -107,11 +104,15 @@ uint8_t mpu6500SpiDetect(void)
 void mpu6500SpiAccInit(accDev_t *acc)
 {
     mpu6500AccInit(acc);
+
+    if (!mpuAccBurstInit(acc)) {
+        mpuAccFifoInit(acc);
+    }
 }
 
 void mpu6500SpiGyroInit(gyroDev_t *gyro)
 {
-    spiSetDivisor(MPU6500_SPI_INSTANCE, SPI_CLOCK_SLOW);
+    spiBusSetDivisor(&mpu6500SpiDevice, SPI_CLOCK_SLOW);
     delayMicroseconds(1);
 
     mpu6500GyroInit(gyro);
@@ -120,8 +121,10 @@ void mpu6500SpiGyroInit(gyroDev_t *gyro)
     mpu6500WriteRegister(MPU_RA_USER_CTRL, MPU6500_BIT_I2C_IF_DIS);
     delay(100);
 
-    spiSetDivisor(MPU6500_SPI_INSTANCE, SPI_CLOCK_FAST);
+    spiBusSetDivisor(&mpu6500SpiDevice, SPI_CLOCK_FAST);
     delayMicroseconds(1);
+
+    mpuGyroBurstInit(gyro);
 }
 
 bool mpu6500SpiAccDetect(accDev_t *acc)
@@ -26,4 +26,5 @@ bool mpu6500SpiAccDetect(accDev_t *acc);
 bool mpu6500SpiGyroDetect(gyroDev_t *gyro);
 
 bool mpu6500WriteRegister(uint8_t reg, uint8_t data);
+bool mpu6500SlowWriteRegister(uint8_t reg, uint8_t data);
 bool mpu6500ReadRegister(uint8_t reg, uint8_t length, uint8_t *data);
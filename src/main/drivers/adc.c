@@ -27,6 +27,7 @@
 
 #include "adc.h"
 #include "adc_impl.h"
+#include "dma.h"
 
 #include "common/utils.h"
 
@@ -35,6 +36,7 @@
 #ifdef USE_ADC
 adcOperatingConfig_t adcOperatingConfig[ADC_CHANNEL_COUNT];
 volatile uint16_t adcValues[ADC_CHANNEL_COUNT];
+volatile uint16_t adcSampleBuffer[ADC_SAMPLE_BUFFER_SIZE(ADC_CHANNEL_COUNT)] __attribute__ ((aligned(32)));  // cache line aligned for the F7 DMA
 
 uint8_t adcChannelByTag(ioTag_t ioTag)
 {
@@ -45,6 +47,34 @@ uint8_t adcChannelByTag(ioTag_t ioTag)
     return 0;
 }
 
+void adcAverageSamples(const volatile uint16_t *samples, uint8_t channelCount)
+{
+    for (int channel = 0; channel < channelCount; channel++) {
+        uint32_t sum = 0;
+        for (int i = 0; i < ADC_OVERSAMPLE_COUNT; i++) {
+            sum += samples[i * channelCount + channel];
+        }
+        adcValues[channel] = sum / ADC_OVERSAMPLE_COUNT;
+    }
+}
+
+#if !defined(STM32F7)
+// userParam holds the number of channels in each scan
+void adcDmaIRQHandler(dmaChannelDescriptor_t *descriptor)
+{
+    const uint8_t channelCount = descriptor->userParam;
+
+    if (DMA_GET_FLAG_STATUS(descriptor, DMA_IT_HTIF)) {
+        DMA_CLEAR_FLAG(descriptor, DMA_IT_HTIF);
+        adcAverageSamples(&adcSampleBuffer[0], channelCount);
+    }
+    if (DMA_GET_FLAG_STATUS(descriptor, DMA_IT_TCIF)) {
+        DMA_CLEAR_FLAG(descriptor, DMA_IT_TCIF);
+        adcAverageSamples(&adcSampleBuffer[ADC_OVERSAMPLE_COUNT * channelCount], channelCount);
+    }
+}
+#endif
+
 uint16_t adcGetChannel(uint8_t channel)
 {
 #ifdef DEBUG_ADC_CHANNELS
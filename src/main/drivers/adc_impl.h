@@ -62,4 +62,17 @@ extern const adcTagMap_t adcTagMap[ADC_TAG_MAP_COUNT];
 extern adcOperatingConfig_t adcOperatingConfig[ADC_CHANNEL_COUNT];
 extern volatile uint16_t adcValues[ADC_CHANNEL_COUNT];
 
+// Scans of all channels averaged into adcValues, the DMA fills one half of adcSampleBuffer while the other is averaged
+#ifndef ADC_OVERSAMPLE_COUNT
+#define ADC_OVERSAMPLE_COUNT 16
+#endif
+
+#define ADC_SAMPLE_BUFFER_SIZE(channelCount) (2 * ADC_OVERSAMPLE_COUNT * (channelCount))
+
+extern volatile uint16_t adcSampleBuffer[ADC_SAMPLE_BUFFER_SIZE(ADC_CHANNEL_COUNT)];
+
 uint8_t adcChannelByTag(ioTag_t ioTag);
+void adcAverageSamples(const volatile uint16_t *samples, uint8_t channelCount);
+
+struct dmaChannelDescriptor_s;
+void adcDmaIRQHandler(struct dmaChannelDescriptor_s *descriptor);
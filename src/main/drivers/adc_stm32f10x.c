@@ -33,6 +33,7 @@
 #include "io.h"
 #include "rcc.h"
 #include "dma.h"
+#include "nvic.h"
 
 #ifndef ADC_INSTANCE
 #define ADC_INSTANCE   ADC1
@@ -127,23 +128,27 @@ void adcInit(adcConfig_t *config)
     RCC_ADCCLKConfig(RCC_PCLK2_Div8);  // 9MHz from 72MHz APB2 clock(HSE), 8MHz from 64MHz (HSI)
     RCC_ClockCmd(adc.rccADC, ENABLE);
 
-    dmaInit(dmaGetIdentifier(adc.DMAy_Channelx), OWNER_ADC, 0);
+    if (!dmaInit(dmaGetIdentifier(adc.DMAy_Channelx), OWNER_ADC, 0)) {
+        return;
+    }
+    dmaSetHandler(dmaGetIdentifier(adc.DMAy_Channelx), adcDmaIRQHandler, NVIC_PRIO_ADC_DMA, configuredAdcChannels);
 
     DMA_DeInit(adc.DMAy_Channelx);
     DMA_InitTypeDef DMA_InitStructure;
     DMA_StructInit(&DMA_InitStructure);
     DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&adc.ADCx->DR;
-    DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)adcValues;
+    DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)adcSampleBuffer;
     DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
-    DMA_InitStructure.DMA_BufferSize = configuredAdcChannels;
+    DMA_InitStructure.DMA_BufferSize = ADC_SAMPLE_BUFFER_SIZE(configuredAdcChannels);
     DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
-    DMA_InitStructure.DMA_MemoryInc = configuredAdcChannels > 1 ? DMA_MemoryInc_Enable : DMA_MemoryInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
     DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_HalfWord;
     DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_HalfWord;
     DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
     DMA_InitStructure.DMA_Priority = DMA_Priority_High;
     DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
     DMA_Init(adc.DMAy_Channelx, &DMA_InitStructure);
+    DMA_ITConfig(adc.DMAy_Channelx, DMA_IT_HT | DMA_IT_TC, ENABLE);
     DMA_Cmd(adc.DMAy_Channelx, ENABLE);
 
     ADC_InitTypeDef ADC_InitStructure;
@@ -31,6 +31,7 @@
 #include "io.h"
 #include "rcc.h"
 #include "dma.h"
+#include "nvic.h"
 
 #include "common/utils.h"
 
@@ -166,17 +167,20 @@ void adcInit(adcConfig_t *config)
 
     RCC_ClockCmd(adc.rccADC, ENABLE);
 
-    dmaInit(dmaGetIdentifier(adc.DMAy_Channelx), OWNER_ADC, 0);
+    if (!dmaInit(dmaGetIdentifier(adc.DMAy_Channelx), OWNER_ADC, 0)) {
+        return;
+    }
+    dmaSetHandler(dmaGetIdentifier(adc.DMAy_Channelx), adcDmaIRQHandler, NVIC_PRIO_ADC_DMA, adcChannelCount);
 
     DMA_DeInit(adc.DMAy_Channelx);
 
     DMA_StructInit(&DMA_InitStructure);
     DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&adc.ADCx->DR;
-    DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)adcValues;
+    DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)adcSampleBuffer;
     DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
-    DMA_InitStructure.DMA_BufferSize = adcChannelCount;
+    DMA_InitStructure.DMA_BufferSize = ADC_SAMPLE_BUFFER_SIZE(adcChannelCount);
     DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
-    DMA_InitStructure.DMA_MemoryInc = adcChannelCount > 1 ? DMA_MemoryInc_Enable : DMA_MemoryInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
     DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_HalfWord;
     DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_HalfWord;
     DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
@@ -184,6 +188,7 @@ void adcInit(adcConfig_t *config)
     DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
 
     DMA_Init(adc.DMAy_Channelx, &DMA_InitStructure);
+    DMA_ITConfig(adc.DMAy_Channelx, DMA_IT_HT | DMA_IT_TC, ENABLE);
 
     DMA_Cmd(adc.DMAy_Channelx, ENABLE);
 
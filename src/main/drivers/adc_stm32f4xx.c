@@ -26,6 +26,7 @@
 #include "io_impl.h"
 #include "rcc.h"
 #include "dma.h"
+#include "nvic.h"
 
 #include "sensor.h"
 #include "accgyro.h"
@@ -139,23 +140,27 @@ void adcInit(adcConfig_t *config)
 
     RCC_ClockCmd(adc.rccADC, ENABLE);
 
-    dmaInit(dmaGetIdentifier(adc.DMAy_Streamx), OWNER_ADC, 0);
+    if (!dmaInit(dmaGetIdentifier(adc.DMAy_Streamx), OWNER_ADC, 0)) {
+        return;
+    }
+    dmaSetHandler(dmaGetIdentifier(adc.DMAy_Streamx), adcDmaIRQHandler, NVIC_PRIO_ADC_DMA, configuredAdcChannels);
 
     DMA_DeInit(adc.DMAy_Streamx);
 
     DMA_StructInit(&DMA_InitStructure);
     DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&adc.ADCx->DR;
     DMA_InitStructure.DMA_Channel = adc.channel;
-    DMA_InitStructure.DMA_Memory0BaseAddr = (uint32_t)adcValues;
+    DMA_InitStructure.DMA_Memory0BaseAddr = (uint32_t)adcSampleBuffer;
     DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralToMemory;
-    DMA_InitStructure.DMA_BufferSize = configuredAdcChannels;
+    DMA_InitStructure.DMA_BufferSize = ADC_SAMPLE_BUFFER_SIZE(configuredAdcChannels);
     DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
-    DMA_InitStructure.DMA_MemoryInc = configuredAdcChannels > 1 ? DMA_MemoryInc_Enable : DMA_MemoryInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
     DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_HalfWord;
     DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_HalfWord;
     DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
     DMA_InitStructure.DMA_Priority = DMA_Priority_High;
     DMA_Init(adc.DMAy_Streamx, &DMA_InitStructure);
+    DMA_ITConfig(adc.DMAy_Streamx, DMA_IT_HT | DMA_IT_TC, ENABLE);
 
     DMA_Cmd(adc.DMAy_Streamx, ENABLE);
 
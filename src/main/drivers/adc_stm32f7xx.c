@@ -26,6 +26,7 @@
 #include "io_impl.h"
 #include "rcc.h"
 #include "dma.h"
+#include "nvic.h"
 
 #include "sensor.h"
 #include "accgyro.h"
@@ -33,6 +34,8 @@
 #include "adc.h"
 #include "adc_impl.h"
 
+#include "common/utils.h"
+
 #ifndef ADC_INSTANCE
 #define ADC_INSTANCE                ADC1
 #endif
@@ -72,6 +75,35 @@ const adcTagMap_t adcTagMap[] = {
     { DEFIO_TAG_E__PA7, ADC_CHANNEL_7  },
 };
 
+// the HAL keeps pointers to the handles for the DMA interrupt
+static adcDevice_t adc;
+static uint8_t configuredAdcChannels;
+
+static void adcDmaHalIRQHandler(dmaChannelDescriptor_t *descriptor)
+{
+    UNUSED(descriptor);
+    HAL_DMA_IRQHandler(adc.ADCHandle.DMA_Handle);
+}
+
+static void adcAverageSampleBuffer(const volatile uint16_t *samples)
+{
+    // the buffer is cache line aligned and only written by the DMA, so no dirty lines are cleaned over the samples
+    HAL_CLEANINVALIDATECACHE((const uint8_t *)samples, ADC_OVERSAMPLE_COUNT * configuredAdcChannels * sizeof(uint16_t));
+    adcAverageSamples(samples, configuredAdcChannels);
+}
+
+void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef *hadc)
+{
+    UNUSED(hadc);
+    adcAverageSampleBuffer(&adcSampleBuffer[0]);
+}
+
+void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc)
+{
+    UNUSED(hadc);
+    adcAverageSampleBuffer(&adcSampleBuffer[ADC_OVERSAMPLE_COUNT * configuredAdcChannels]);
+}
+
 ADCDevice adcDeviceByInstance(ADC_TypeDef *instance)
 {
     if (instance == ADC1)
@@ -86,7 +118,8 @@ ADCDevice adcDeviceByInstance(ADC_TypeDef *instance)
 void adcInit(adcConfig_t *config)
 {
     uint8_t i;
-    uint8_t configuredAdcChannels = 0;
+
+    configuredAdcChannels = 0;
 
     memset(&adcOperatingConfig, 0, sizeof(adcOperatingConfig));
 
@@ -110,7 +143,7 @@ void adcInit(adcConfig_t *config)
     if (device == ADCINVALID)
         return;
 
-    adcDevice_t adc = adcHardware[device];
+    adc = adcHardware[device];
 
     bool adcActive = false;
     for (int i = 0; i < ADC_CHANNEL_COUNT; i++) {
@@ -131,7 +164,10 @@ void adcInit(adcConfig_t *config)
     }
 
     RCC_ClockCmd(adc.rccADC, ENABLE);
-    dmaInit(dmaGetIdentifier(adc.DMAy_Streamx), OWNER_ADC, 0);
+    if (!dmaInit(dmaGetIdentifier(adc.DMAy_Streamx), OWNER_ADC, 0)) {
+        return;
+    }
+    dmaSetHandler(dmaGetIdentifier(adc.DMAy_Streamx), adcDmaHalIRQHandler, NVIC_PRIO_ADC_DMA, 0);
 
     adc.ADCHandle.Init.ClockPrescaler        = ADC_CLOCK_SYNC_PCLK_DIV8;
     adc.ADCHandle.Init.ContinuousConvMode    = ENABLE;
@@ -156,7 +192,7 @@ void adcInit(adcConfig_t *config)
     adc.DmaHandle.Init.Channel = adc.channel;
     adc.DmaHandle.Init.Direction = DMA_PERIPH_TO_MEMORY;
     adc.DmaHandle.Init.PeriphInc = DMA_PINC_DISABLE;
-    adc.DmaHandle.Init.MemInc = configuredAdcChannels > 1 ? DMA_MINC_ENABLE : DMA_MINC_DISABLE;
+    adc.DmaHandle.Init.MemInc = DMA_MINC_ENABLE;
     adc.DmaHandle.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
     adc.DmaHandle.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
     adc.DmaHandle.Init.Mode = DMA_CIRCULAR;
@@ -193,9 +229,9 @@ void adcInit(adcConfig_t *config)
         }
     }
 
-    HAL_CLEANINVALIDATECACHE((uint32_t*)&adcValues, configuredAdcChannels);
+    HAL_CLEANINVALIDATECACHE((uint32_t*)&adcSampleBuffer, ADC_SAMPLE_BUFFER_SIZE(configuredAdcChannels));
     /*##-4- Start the conversion process #######################################*/
-    if(HAL_ADC_Start_DMA(&adc.ADCHandle, (uint32_t*)&adcValues, configuredAdcChannels) != HAL_OK)
+    if(HAL_ADC_Start_DMA(&adc.ADCHandle, (uint32_t*)&adcSampleBuffer, ADC_SAMPLE_BUFFER_SIZE(configuredAdcChannels)) != HAL_OK)
     {
         /* Start Conversation Error */
     }
@@ -62,6 +62,13 @@ static void bmp280_get_ut(void);
 #ifndef USE_BARO_SPI_BMP280
 static void bmp280_start_up(void);
 static void bmp280_get_up(void);
+static void bmp280_read_complete(i2cTransaction_t *transaction);
+
+// the measurement start and data read are queued, the data is collected by the read callback
+static i2cTransaction_t bmp280_measure;
+static i2cTransaction_t bmp280_read;
+static uint8_t bmp280_mode = BMP280_MODE;
+static uint8_t bmp280_data[BMP280_DATA_FRAME_SIZE];
 #endif
 STATIC_UNIT_TESTED void bmp280_calculate(int32_t *pressure, int32_t *temperature);
 
@@ -106,6 +113,7 @@ bool bmp280Detect(baroDev_t *baro)
     baro->start_up = bmp280_spi_start_up;
     baro->get_up = bmp280_spi_get_up;
 #else
+    bmp280_read.callback = bmp280_read_complete;
     baro->start_up = bmp280_start_up;
     baro->get_up = bmp280_get_up;
 #endif
@@ -129,18 +137,25 @@ static void bmp280_start_up(void)
 {
     // start measurement
     // set oversampling + power mode (forced), and start sampling
-    i2cWrite(BARO_I2C_INSTANCE, BMP280_I2C_ADDR, BMP280_CTRL_MEAS_REG, BMP280_MODE);
+    i2cQueueWrite(&bmp280_measure, BARO_I2C_INSTANCE, BMP280_I2C_ADDR, BMP280_CTRL_MEAS_REG, 1, &bmp280_mode);
 }
 
-static void bmp280_get_up(void)
+static void bmp280_read_complete(i2cTransaction_t *transaction)
 {
-    uint8_t data[BMP280_DATA_FRAME_SIZE];
+    if (transaction->error) {
+        return;
+    }
 
-    // read data from sensor
-    i2cRead(BARO_I2C_INSTANCE, BMP280_I2C_ADDR, BMP280_PRESSURE_MSB_REG, BMP280_DATA_FRAME_SIZE, data);
+    const uint8_t *data = bmp280_data;
     bmp280_up = (int32_t)((((uint32_t)(data[0])) << 12) | (((uint32_t)(data[1])) << 4) | ((uint32_t)data[2] >> 4));
     bmp280_ut = (int32_t)((((uint32_t)(data[3])) << 12) | (((uint32_t)(data[4])) << 4) | ((uint32_t)data[5] >> 4));
 }
+
+static void bmp280_get_up(void)
+{
+    // read data from sensor
+    i2cQueueRead(&bmp280_read, BARO_I2C_INSTANCE, BMP280_I2C_ADDR, BMP280_PRESSURE_MSB_REG, BMP280_DATA_FRAME_SIZE, bmp280_data);
+}
 #endif
 
 // Returns temperature in DegC, resolution is 0.01 DegC. Output value of "5123" equals 51.23 DegC
@@ -47,7 +47,6 @@
 static void ms5611_reset(void);
 static uint16_t ms5611_prom(int8_t coef_num);
 STATIC_UNIT_TESTED int8_t ms5611_crc(uint16_t *prom);
-static uint32_t ms5611_read_adc(void);
 static void ms5611_start_ut(void);
 static void ms5611_get_ut(void);
 static void ms5611_start_up(void);
@@ -59,6 +58,33 @@ STATIC_UNIT_TESTED uint32_t ms5611_up;  // static result of pressure measurement
 STATIC_UNIT_TESTED uint16_t ms5611_c[PROM_NB];  // on-chip ROM
 static uint8_t ms5611_osr = CMD_ADC_4096;
 
+// ADC reads and conversion starts are queued, the results are collected by the read callbacks
+static i2cTransaction_t ms5611_ut_read;
+static i2cTransaction_t ms5611_up_read;
+static i2cTransaction_t ms5611_conversion;
+static uint8_t ms5611_ut_buf[3];
+static uint8_t ms5611_up_buf[3];
+static uint8_t ms5611_conversion_data = 1;
+
+static uint32_t ms5611_adc_value(const uint8_t *rxbuf)
+{
+    return (rxbuf[0] << 16) | (rxbuf[1] << 8) | rxbuf[2];
+}
+
+static void ms5611_ut_read_complete(i2cTransaction_t *transaction)
+{
+    if (!transaction->error) {
+        ms5611_ut = ms5611_adc_value(ms5611_ut_buf);
+    }
+}
+
+static void ms5611_up_read_complete(i2cTransaction_t *transaction)
+{
+    if (!transaction->error) {
+        ms5611_up = ms5611_adc_value(ms5611_up_buf);
+    }
+}
+
 bool ms5611Detect(baroDev_t *baro)
 {
     uint8_t sig;
@@ -77,6 +103,9 @@ bool ms5611Detect(baroDev_t *baro)
     if (ms5611_crc(ms5611_c) != 0)
         return false;
 
+    ms5611_ut_read.callback = ms5611_ut_read_complete;
+    ms5611_up_read.callback = ms5611_up_read_complete;
+
     // TODO prom + CRC
     baro->ut_delay = 10000;
     baro->up_delay = 10000;
@@ -132,31 +161,29 @@ STATIC_UNIT_TESTED int8_t ms5611_crc(uint16_t *prom)
     return -1;
 }
 
-static uint32_t ms5611_read_adc(void)
+static void ms5611_start_conversion(uint8_t command)
 {
-    uint8_t rxbuf[3];
-    i2cRead(BARO_I2C_INSTANCE, MS5611_ADDR, CMD_ADC_READ, 3, rxbuf); // read ADC
-    return (rxbuf[0] << 16) | (rxbuf[1] << 8) | rxbuf[2];
+    i2cQueueWrite(&ms5611_conversion, BARO_I2C_INSTANCE, MS5611_ADDR, command, 1, &ms5611_conversion_data);
 }
 
 static void ms5611_start_ut(void)
 {
-    i2cWrite(BARO_I2C_INSTANCE, MS5611_ADDR, CMD_ADC_CONV + CMD_ADC_D2 + ms5611_osr, 1); // D2 (temperature) conversion start!
+    ms5611_start_conversion(CMD_ADC_CONV + CMD_ADC_D2 + ms5611_osr); // D2 (temperature) conversion start!
 }
 
 static void ms5611_get_ut(void)
 {
-    ms5611_ut = ms5611_read_adc();
+    i2cQueueRead(&ms5611_ut_read, BARO_I2C_INSTANCE, MS5611_ADDR, CMD_ADC_READ, 3, ms5611_ut_buf); // read ADC
 }
 
 static void ms5611_start_up(void)
 {
-    i2cWrite(BARO_I2C_INSTANCE, MS5611_ADDR, CMD_ADC_CONV + CMD_ADC_D1 + ms5611_osr, 1); // D1 (pressure) conversion start!
+    ms5611_start_conversion(CMD_ADC_CONV + CMD_ADC_D1 + ms5611_osr); // D1 (pressure) conversion start!
 }
 
 static void ms5611_get_up(void)
 {
-    ms5611_up = ms5611_read_adc();
+    i2cQueueRead(&ms5611_up_read, BARO_I2C_INSTANCE, MS5611_ADDR, CMD_ADC_READ, 3, ms5611_up_buf); // read ADC
 }
 
 STATIC_UNIT_TESTED void ms5611_calculate(int32_t *pressure, int32_t *temperature)
@@ -45,10 +45,8 @@ typedef struct i2cDevice_s {
     ioTag_t sda;
     rccPeriphTag_t rcc;
     bool overClock;
-#if !defined(STM32F303xC)
     uint8_t ev_irq;
     uint8_t er_irq;
-#endif
 #if defined(STM32F7)
     uint8_t af;
 #endif
@@ -66,9 +64,34 @@ typedef struct i2cState_s {
     volatile uint8_t* read_p;
 } i2cState_t;
 
+struct i2cTransaction_s;
+typedef void (*i2cTransactionCallbackFuncPtr)(struct i2cTransaction_s *transaction);
+
+/*
+ * A register read or write. Transactions on a bus are run in the order they are queued. On the
+ * interrupt driven drivers they complete in the I2C interrupt and the callback is called from
+ * there, otherwise they complete before i2cQueue() returns.
+ */
+typedef struct i2cTransaction_s {
+    I2CDevice device;
+    uint8_t addr;
+    uint8_t reg;
+    uint8_t length;
+    uint8_t *data;
+    bool read;
+    i2cTransactionCallbackFuncPtr callback;
+    volatile bool busy;
+    volatile bool error;
+    struct i2cTransaction_s *next;
+} i2cTransaction_t;
+
 void i2cInit(I2CDevice device);
 bool i2cWriteBuffer(I2CDevice device, uint8_t addr_, uint8_t reg_, uint8_t len_, uint8_t *data);
 bool i2cWrite(I2CDevice device, uint8_t addr_, uint8_t reg, uint8_t data);
 bool i2cRead(I2CDevice device, uint8_t addr_, uint8_t reg, uint8_t len, uint8_t* buf);
 
 uint16_t i2cGetErrorCounter(void);
+
+void i2cQueue(i2cTransaction_t *transaction);
+bool i2cQueueRead(i2cTransaction_t *transaction, I2CDevice device, uint8_t addr_, uint8_t reg, uint8_t len, uint8_t *buf);
+bool i2cQueueWrite(i2cTransaction_t *transaction, I2CDevice device, uint8_t addr_, uint8_t reg, uint8_t len, uint8_t *data);
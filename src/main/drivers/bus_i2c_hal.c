@@ -23,7 +23,10 @@
 #include "io.h"
 #include "system.h"
 
+#include "common/utils.h"
+
 #include "bus_i2c.h"
+#include "bus_i2c_impl.h"
 #include "nvic.h"
 #include "io_impl.h"
 #include "rcc.h"
@@ -266,6 +269,19 @@ void i2cInit(I2CDevice device)
     HAL_NVIC_EnableIRQ(i2cHardwareMap[device].ev_irq);
 }
 
+// transactions are run on the spot by the bus_i2c_queue.c fallback
+bool i2cAsyncIsEnabled(I2CDevice device)
+{
+    UNUSED(device);
+    return false;
+}
+
+void i2cAsyncStart(I2CDevice device, const i2cTransaction_t *transaction)
+{
+    UNUSED(device);
+    UNUSED(transaction);
+}
+
 uint16_t i2cGetErrorCounter(void)
 {
     return i2cErrorCount;
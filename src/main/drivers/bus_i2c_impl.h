@@ -0,0 +1,31 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "bus_i2c.h"
+
+// Provided by the platform I2C driver for the transaction queue in bus_i2c_queue.c
+bool i2cAsyncIsEnabled(I2CDevice device);
+void i2cAsyncStart(I2CDevice device, const i2cTransaction_t *transaction);
+
+// Called by the platform I2C driver from its interrupt once the transaction started with i2cAsyncStart() is complete
+void i2cTransactionComplete(I2CDevice device, bool error);
+// Fails all queued transactions, used by the platform I2C driver when it resets the peripheral
+void i2cQueueReset(I2CDevice device);
+// Queues the transaction and waits for it, returns false on timeout with the transaction still queued
+bool i2cQueueAndWait(i2cTransaction_t *transaction);
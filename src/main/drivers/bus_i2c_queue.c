@@ -0,0 +1,173 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <platform.h>
+
+#include "build/atomic.h"
+
+#include "nvic.h"
+
+#include "bus_i2c.h"
+#include "bus_i2c_impl.h"
+
+#ifdef USE_I2C
+
+/*
+ * Per bus transaction queue.
+ *
+ * With the interrupt driven drivers the head transaction is started by i2cQueue() when the bus is
+ * idle, or by the I2C interrupt completing the previous one, so a scheduler task can queue a read
+ * and pick up the result on its next call instead of waiting for the bus. The blocking drivers run
+ * each transaction on the spot.
+ */
+typedef struct i2cQueueState_s {
+    i2cTransaction_t *head;
+    i2cTransaction_t *tail;
+} i2cQueueState_t;
+
+static i2cQueueState_t i2cQueueState[I2CDEV_COUNT];
+
+static void i2cTransactionFinish(i2cTransaction_t *transaction, bool error)
+{
+    const i2cTransactionCallbackFuncPtr callback = transaction->callback;
+
+    transaction->error = error;
+    transaction->busy = false;
+    if (callback) {
+        callback(transaction);
+    }
+}
+
+void i2cQueue(i2cTransaction_t *transaction)
+{
+    const I2CDevice device = transaction->device;
+
+    transaction->busy = true;
+    transaction->error = false;
+    transaction->next = NULL;
+
+    if (device == I2CINVALID) {
+        i2cTransactionFinish(transaction, true);
+        return;
+    }
+
+    if (!i2cAsyncIsEnabled(device)) {
+        const bool ack = transaction->read
+            ? i2cRead(device, transaction->addr, transaction->reg, transaction->length, transaction->data)
+            : i2cWriteBuffer(device, transaction->addr, transaction->reg, transaction->length, transaction->data);
+        i2cTransactionFinish(transaction, !ack);
+        return;
+    }
+
+    ATOMIC_BLOCK(NVIC_PRIO_I2C_EV) {
+        i2cQueueState_t *queue = &i2cQueueState[device];
+        if (queue->tail) {
+            queue->tail->next = transaction;
+        } else {
+            queue->head = transaction;
+        }
+        queue->tail = transaction;
+
+        if (queue->head == transaction) {
+            i2cAsyncStart(device, transaction);
+        }
+    }
+}
+
+void i2cTransactionComplete(I2CDevice device, bool error)
+{
+    i2cQueueState_t *queue = &i2cQueueState[device];
+    i2cTransaction_t *transaction = queue->head;
+
+    if (!transaction) {
+        return;
+    }
+
+    queue->head = transaction->next;
+    if (!queue->head) {
+        queue->tail = NULL;
+    }
+
+    i2cTransactionFinish(transaction, error);
+
+    if (queue->head) {
+        i2cAsyncStart(device, queue->head);
+    }
+}
+
+void i2cQueueReset(I2CDevice device)
+{
+    i2cTransaction_t *transaction;
+
+    ATOMIC_BLOCK(NVIC_PRIO_I2C_EV) {
+        transaction = i2cQueueState[device].head;
+        i2cQueueState[device].head = NULL;
+        i2cQueueState[device].tail = NULL;
+    }
+
+    while (transaction) {
+        i2cTransaction_t *next = transaction->next;
+        i2cTransactionFinish(transaction, true);
+        transaction = next;
+    }
+}
+
+bool i2cQueueAndWait(i2cTransaction_t *transaction)
+{
+    i2cQueue(transaction);
+
+    uint32_t timeout = I2C_LONG_TIMEOUT;
+    while (transaction->busy && --timeout > 0) {; }
+
+    return timeout != 0;
+}
+
+static bool i2cQueueTransaction(i2cTransaction_t *transaction, I2CDevice device, uint8_t addr_, uint8_t reg, uint8_t len, uint8_t *data, bool read)
+{
+    if (transaction->busy) {
+        // the previous request has not completed yet
+        return false;
+    }
+
+    transaction->device = device;
+    transaction->addr = addr_;
+    transaction->reg = reg;
+    transaction->length = len;
+    transaction->data = data;
+    transaction->read = read;
+
+    i2cQueue(transaction);
+
+    return true;
+}
+
+// Returns false without queueing if the transaction is still in progress
+bool i2cQueueRead(i2cTransaction_t *transaction, I2CDevice device, uint8_t addr_, uint8_t reg, uint8_t len, uint8_t *buf)
+{
+    return i2cQueueTransaction(transaction, device, addr_, reg, len, buf, true);
+}
+
+bool i2cQueueWrite(i2cTransaction_t *transaction, I2CDevice device, uint8_t addr_, uint8_t reg, uint8_t len, uint8_t *data)
+{
+    return i2cQueueTransaction(transaction, device, addr_, reg, len, data, false);
+}
+
+#endif
@@ -22,7 +22,10 @@
 
 #include "build/build_config.h"
 
+#include "common/utils.h"
+
 #include "bus_i2c.h"
+#include "bus_i2c_impl.h"
 #include "io.h"
 
 // Software I2C driver, using same pins as hardware I2C, with hw i2c module disabled.
@@ -258,6 +261,19 @@ bool i2cRead(I2CDevice device, uint8_t addr, uint8_t reg, uint8_t len, uint8_t *
     return true;
 }
 
+// transactions are run on the spot by the bus_i2c_queue.c fallback
+bool i2cAsyncIsEnabled(I2CDevice device)
+{
+    UNUSED(device);
+    return false;
+}
+
+void i2cAsyncStart(I2CDevice device, const i2cTransaction_t *transaction)
+{
+    UNUSED(device);
+    UNUSED(transaction);
+}
+
 uint16_t i2cGetErrorCounter(void)
 {
     return i2cErrorCount;
@@ -24,7 +24,10 @@
 #include "io.h"
 #include "system.h"
 
+#include "common/utils.h"
+
 #include "bus_i2c.h"
+#include "bus_i2c_impl.h"
 #include "nvic.h"
 #include "io_impl.h"
 #include "rcc.h"
@@ -128,17 +131,20 @@ void I2C3_EV_IRQHandler(void) {
 static bool i2cHandleHardwareFailure(I2CDevice device)
 {
     i2cErrorCount++;
-    // reinit peripheral + clock out garbage
+    // reinit peripheral + clock out garbage, this fails any queued transactions
     i2cInit(device);
     return false;
 }
 
-bool i2cWriteBuffer(I2CDevice device, uint8_t addr_, uint8_t reg_, uint8_t len_, uint8_t *data)
+bool i2cAsyncIsEnabled(I2CDevice device)
 {
+    UNUSED(device);
+    return true;
+}
 
-    if (device == I2CINVALID)
-        return false;
-
+// called with the I2C interrupts masked, or from them
+void i2cAsyncStart(I2CDevice device, const i2cTransaction_t *transaction)
+{
     uint32_t timeout = I2C_DEFAULT_TIMEOUT;
 
     I2C_TypeDef *I2Cx;
@@ -147,32 +153,52 @@ bool i2cWriteBuffer(I2CDevice device, uint8_t addr_, uint8_t reg_, uint8_t len_,
     i2cState_t *state;
     state = &(i2cState[device]);
 
-    state->addr = addr_ << 1;
-    state->reg = reg_;
-    state->writing = 1;
-    state->reading = 0;
-    state->write_p = data;
-    state->read_p = data;
-    state->bytes = len_;
+    state->addr = transaction->addr << 1;
+    state->reg = transaction->reg;
+    state->writing = !transaction->read;
+    state->reading = transaction->read;
+    state->write_p = transaction->data;
+    state->read_p = transaction->data;
+    state->bytes = transaction->length;
     state->busy = 1;
     state->error = false;
 
     if (!(I2Cx->CR2 & I2C_IT_EVT)) {                                    // if we are restarting the driver
         if (!(I2Cx->CR1 & I2C_CR1_START)) {                             // ensure sending a start
             while (I2Cx->CR1 & I2C_CR1_STOP && --timeout > 0) {; }     // wait for any stop to finish sending
-            if (timeout == 0)
-                return i2cHandleHardwareFailure(device);
+            if (timeout == 0) {
+                i2cHandleHardwareFailure(device);
+                return;
+            }
             I2C_GenerateSTART(I2Cx, ENABLE);                            // send the start for the new job
         }
         I2C_ITConfig(I2Cx, I2C_IT_EVT | I2C_IT_ERR, ENABLE);            // allow the interrupts to fire off again
     }
+}
+
+static bool i2cTransfer(I2CDevice device, uint8_t addr_, uint8_t reg_, uint8_t len_, uint8_t *data, bool read)
+{
+    if (device == I2CINVALID)
+        return false;
+
+    i2cTransaction_t transaction = {
+        .device = device,
+        .addr = addr_,
+        .reg = reg_,
+        .length = len_,
+        .data = data,
+        .read = read,
+    };
 
-    timeout = I2C_DEFAULT_TIMEOUT;
-    while (state->busy && --timeout > 0) {; }
-    if (timeout == 0)
+    if (!i2cQueueAndWait(&transaction))
         return i2cHandleHardwareFailure(device);
 
-    return !(state->error);
+    return !transaction.error;
+}
+
+bool i2cWriteBuffer(I2CDevice device, uint8_t addr_, uint8_t reg_, uint8_t len_, uint8_t *data)
+{
+    return i2cTransfer(device, addr_, reg_, len_, data, false);
 }
 
 bool i2cWrite(I2CDevice device, uint8_t addr_, uint8_t reg_, uint8_t data)
@@ -182,43 +208,7 @@ bool i2cWrite(I2CDevice device, uint8_t addr_, uint8_t reg_, uint8_t data)
 
 bool i2cRead(I2CDevice device, uint8_t addr_, uint8_t reg_, uint8_t len, uint8_t* buf)
 {
-    if (device == I2CINVALID)
-        return false;
-
-    uint32_t timeout = I2C_DEFAULT_TIMEOUT;
-
-    I2C_TypeDef *I2Cx;
-    I2Cx = i2cHardwareMap[device].dev;
-
-    i2cState_t *state;
-    state = &(i2cState[device]);
-
-    state->addr = addr_ << 1;
-    state->reg = reg_;
-    state->writing = 0;
-    state->reading = 1;
-    state->read_p = buf;
-    state->write_p = buf;
-    state->bytes = len;
-    state->busy = 1;
-    state->error = false;
-
-    if (!(I2Cx->CR2 & I2C_IT_EVT)) {                                    // if we are restarting the driver
-        if (!(I2Cx->CR1 & I2C_CR1_START)) {                             // ensure sending a start
-            while (I2Cx->CR1 & I2C_CR1_STOP && --timeout > 0) {; }     // wait for any stop to finish sending
-            if (timeout == 0)
-                return i2cHandleHardwareFailure(device);
-            I2C_GenerateSTART(I2Cx, ENABLE);                            // send the start for the new job
-        }
-        I2C_ITConfig(I2Cx, I2C_IT_EVT | I2C_IT_ERR, ENABLE);            // allow the interrupts to fire off again
-    }
-
-    timeout = I2C_DEFAULT_TIMEOUT;
-    while (state->busy && --timeout > 0) {; }
-    if (timeout == 0)
-        return i2cHandleHardwareFailure(device);
-
-    return !(state->error);
+    return i2cTransfer(device, addr_, reg_, len, buf, true);
 }
 
 static void i2c_er_handler(I2CDevice device) {
@@ -253,7 +243,10 @@ static void i2c_er_handler(I2CDevice device) {
         }
     }
     I2Cx->SR1 &= ~0x0F00;                                                       // reset all the error bits to clear the interrupt
-    state->busy = 0;
+    if (state->busy) {
+        state->busy = 0;
+        i2cTransactionComplete(device, state->error);
+    }
 }
 
 void i2c_ev_handler(I2CDevice device) {
@@ -370,6 +363,7 @@ void i2c_ev_handler(I2CDevice device) {
         if (final_stop)                                                 // If there is a final stop and no more jobs, bus is inactive, disable interrupts to prevent BTF
             I2C_ITConfig(I2Cx, I2C_IT_EVT | I2C_IT_ERR, DISABLE);       // Disable EVT and ERR interrupts while bus inactive
         state->busy = 0;
+        i2cTransactionComplete(device, state->error);                   // start the next queued job, if any
     }
 }
 
@@ -394,6 +388,8 @@ void i2cInit(I2CDevice device)
     RCC_ClockCmd(i2c->rcc, ENABLE);
 
     I2C_ITConfig(i2c->dev, I2C_IT_EVT | I2C_IT_ERR, DISABLE);
+    i2cState[device].busy = 0;
+    i2cQueueReset(device);
 
     i2cUnstick(scl, sda);
 
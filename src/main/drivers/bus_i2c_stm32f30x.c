@@ -20,12 +20,16 @@
 
 #include <platform.h>
 
+#include "common/utils.h"
+
 #include "system.h"
 #include "io.h"
 #include "io_impl.h"
+#include "nvic.h"
 #include "rcc.h"
 
 #include "bus_i2c.h"
+#include "bus_i2c_impl.h"
 
 #ifndef SOFT_I2C
 
@@ -38,8 +42,6 @@
 #define I2C_HIGHSPEED_TIMING  0x00500E30  // 1000 Khz, 72Mhz Clock, Analog Filter Delay ON, Setup 40, Hold 4.
 #define I2C_STANDARD_TIMING   0x00E0257A  // 400 Khz, 72Mhz Clock, Analog Filter Delay ON, Rise 100, Fall 10.
 
-#define I2C_SHORT_TIMEOUT   ((uint32_t)0x1000)
-#define I2C_LONG_TIMEOUT    ((uint32_t)(10 * I2C_SHORT_TIMEOUT))
 #define I2C_GPIO_AF         GPIO_AF_4
 
 #ifndef I2C1_SCL
@@ -55,24 +57,45 @@
 #define I2C2_SDA PA10
 #endif
 
-static uint32_t i2cTimeout;
-
 static volatile uint16_t i2cErrorCount = 0;
 //static volatile uint16_t i2c2ErrorCount = 0;
 
 static i2cDevice_t i2cHardwareMap[] = {
-    { .dev = I2C1, .scl = IO_TAG(I2C1_SCL), .sda = IO_TAG(I2C1_SDA), .rcc = RCC_APB1(I2C1), .overClock = I2C1_OVERCLOCK },
-    { .dev = I2C2, .scl = IO_TAG(I2C2_SCL), .sda = IO_TAG(I2C2_SDA), .rcc = RCC_APB1(I2C2), .overClock = I2C2_OVERCLOCK }
+    { .dev = I2C1, .scl = IO_TAG(I2C1_SCL), .sda = IO_TAG(I2C1_SDA), .rcc = RCC_APB1(I2C1), .overClock = I2C1_OVERCLOCK, .ev_irq = I2C1_EV_IRQn, .er_irq = I2C1_ER_IRQn },
+    { .dev = I2C2, .scl = IO_TAG(I2C2_SCL), .sda = IO_TAG(I2C2_SDA), .rcc = RCC_APB1(I2C2), .overClock = I2C2_OVERCLOCK, .ev_irq = I2C2_EV_IRQn, .er_irq = I2C2_ER_IRQn }
 };
 
-///////////////////////////////////////////////////////////////////////////////
-// I2C TimeoutUserCallback
-///////////////////////////////////////////////////////////////////////////////
+// transaction in progress on each bus, run from the I2C interrupts
+typedef struct i2cAsyncState_s {
+    const i2cTransaction_t *transaction;
+    uint8_t index;
+    bool regSent;
+    bool error;
+} i2cAsyncState_t;
+
+static i2cAsyncState_t i2cAsyncState[I2CDEV_COUNT];
 
-uint32_t i2cTimeoutUserCallback(void)
+static void i2c_ev_handler(I2CDevice device);
+static void i2c_er_handler(I2CDevice device);
+
+void I2C1_EV_IRQHandler(void)
 {
-    i2cErrorCount++;
-    return false;
+    i2c_ev_handler(I2CDEV_1);
+}
+
+void I2C1_ER_IRQHandler(void)
+{
+    i2c_er_handler(I2CDEV_1);
+}
+
+void I2C2_EV_IRQHandler(void)
+{
+    i2c_ev_handler(I2CDEV_2);
+}
+
+void I2C2_ER_IRQHandler(void)
+{
+    i2c_er_handler(I2CDEV_2);
 }
 
 void i2cInit(I2CDevice device)
@@ -106,11 +129,30 @@ void i2cInit(I2CDevice device)
         .I2C_Timing = (i2c->overClock ? I2C_HIGHSPEED_TIMING : I2C_STANDARD_TIMING)
     };
 
+    I2C_ITConfig(I2Cx, I2C_IT_TXI | I2C_IT_RXI | I2C_IT_TCI | I2C_IT_STOPI | I2C_IT_NACKI | I2C_IT_ERRI, DISABLE);
+    i2cAsyncState[device].transaction = NULL;
+    i2cQueueReset(device);
+
     I2C_Init(I2Cx, &i2cInit);
 
     I2C_StretchClockCmd(I2Cx, ENABLE);
 
     I2C_Cmd(I2Cx, ENABLE);
+
+    I2C_ITConfig(I2Cx, I2C_IT_TXI | I2C_IT_RXI | I2C_IT_TCI | I2C_IT_STOPI | I2C_IT_NACKI | I2C_IT_ERRI, ENABLE);
+
+    NVIC_InitTypeDef nvic;
+
+    nvic.NVIC_IRQChannel = i2c->er_irq;
+    nvic.NVIC_IRQChannelPreemptionPriority = NVIC_PRIORITY_BASE(NVIC_PRIO_I2C_ER);
+    nvic.NVIC_IRQChannelSubPriority = NVIC_PRIORITY_SUB(NVIC_PRIO_I2C_ER);
+    nvic.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&nvic);
+
+    nvic.NVIC_IRQChannel = i2c->ev_irq;
+    nvic.NVIC_IRQChannelPreemptionPriority = NVIC_PRIORITY_BASE(NVIC_PRIO_I2C_EV);
+    nvic.NVIC_IRQChannelSubPriority = NVIC_PRIORITY_SUB(NVIC_PRIO_I2C_EV);
+    NVIC_Init(&nvic);
 }
 
 uint16_t i2cGetErrorCounter(void)
@@ -118,144 +160,138 @@ uint16_t i2cGetErrorCounter(void)
     return i2cErrorCount;
 }
 
-bool i2cWrite(I2CDevice device, uint8_t addr_, uint8_t reg, uint8_t data)
+static bool i2cHandleHardwareFailure(I2CDevice device)
 {
-    addr_ <<= 1;
+    i2cErrorCount++;
+    // reset the peripheral, this fails any queued transactions
+    i2cInit(device);
+    return false;
+}
 
-    I2C_TypeDef *I2Cx;
-    I2Cx = i2cHardwareMap[device].dev;
+bool i2cAsyncIsEnabled(I2CDevice device)
+{
+    UNUSED(device);
+    return true;
+}
 
-    /* Test on BUSY Flag */
-    i2cTimeout = I2C_LONG_TIMEOUT;
-    while (I2C_GetFlagStatus(I2Cx, I2C_ISR_BUSY) != RESET) {
-        if ((i2cTimeout--) == 0) {
-            return i2cTimeoutUserCallback();
-        }
+// called with the I2C interrupts masked, or from them
+void i2cAsyncStart(I2CDevice device, const i2cTransaction_t *transaction)
+{
+    I2C_TypeDef *I2Cx = i2cHardwareMap[device].dev;
+    i2cAsyncState_t *state = &i2cAsyncState[device];
+
+    state->transaction = transaction;
+    state->index = 0;
+    state->regSent = false;
+    state->error = false;
+
+    if (transaction->read) {
+        // send the register address, then restart in read mode once it is out (TC)
+        I2C_TransferHandling(I2Cx, transaction->addr << 1, 1, I2C_SoftEnd_Mode, I2C_Generate_Start_Write);
+    } else {
+        I2C_TransferHandling(I2Cx, transaction->addr << 1, 1 + transaction->length, I2C_AutoEnd_Mode, I2C_Generate_Start_Write);
     }
+}
 
-    /* Configure slave address, nbytes, reload, end mode and start or stop generation */
-    I2C_TransferHandling(I2Cx, addr_, 1, I2C_Reload_Mode, I2C_Generate_Start_Write);
+static void i2cAsyncComplete(I2CDevice device)
+{
+    i2cAsyncState_t *state = &i2cAsyncState[device];
 
-    /* Wait until TXIS flag is set */
-    i2cTimeout = I2C_LONG_TIMEOUT;
-    while (I2C_GetFlagStatus(I2Cx, I2C_ISR_TXIS) == RESET) {
-        if ((i2cTimeout--) == 0) {
-            return i2cTimeoutUserCallback();
-        }
+    if (!state->transaction) {
+        return;
     }
-
-    /* Send Register address */
-    I2C_SendData(I2Cx, (uint8_t) reg);
-
-    /* Wait until TCR flag is set */
-    i2cTimeout = I2C_LONG_TIMEOUT;
-    while (I2C_GetFlagStatus(I2Cx, I2C_ISR_TCR) == RESET)
-    {
-        if ((i2cTimeout--) == 0) {
-            return i2cTimeoutUserCallback();
-        }
+    state->transaction = NULL;
+    if (state->error) {
+        i2cErrorCount++;
     }
+    i2cTransactionComplete(device, state->error);
+}
 
-    /* Configure slave address, nbytes, reload, end mode and start or stop generation */
-    I2C_TransferHandling(I2Cx, addr_, 1, I2C_AutoEnd_Mode, I2C_No_StartStop);
+static void i2c_ev_handler(I2CDevice device)
+{
+    I2C_TypeDef *I2Cx = i2cHardwareMap[device].dev;
+    i2cAsyncState_t *state = &i2cAsyncState[device];
+    const i2cTransaction_t *transaction = state->transaction;
+    const uint32_t isr = I2Cx->ISR;
+
+    if (isr & I2C_ISR_NACKF) {
+        // the peripheral sends the stop, the job completes on STOPF
+        I2C_ClearFlag(I2Cx, I2C_ICR_NACKCF);
+        state->error = true;
+    }
 
-    /* Wait until TXIS flag is set */
-    i2cTimeout = I2C_LONG_TIMEOUT;
-    while (I2C_GetFlagStatus(I2Cx, I2C_ISR_TXIS) == RESET) {
-        if ((i2cTimeout--) == 0) {
-            return i2cTimeoutUserCallback();
+    if (transaction && (isr & I2C_ISR_TXIS)) {
+        if (!state->regSent) {
+            I2C_SendData(I2Cx, transaction->reg);
+            state->regSent = true;
+        } else {
+            I2C_SendData(I2Cx, transaction->data[state->index++]);
         }
     }
 
-    /* Write data to TXDR */
-    I2C_SendData(I2Cx, data);
+    if (transaction && (isr & I2C_ISR_RXNE)) {
+        transaction->data[state->index++] = I2C_ReceiveData(I2Cx);
+    }
 
-    /* Wait until STOPF flag is set */
-    i2cTimeout = I2C_LONG_TIMEOUT;
-    while (I2C_GetFlagStatus(I2Cx, I2C_ISR_STOPF) == RESET) {
-        if ((i2cTimeout--) == 0) {
-            return i2cTimeoutUserCallback();
+    if (isr & I2C_ISR_TC) {
+        if (transaction && transaction->read) {
+            I2C_TransferHandling(I2Cx, transaction->addr << 1, transaction->length, I2C_AutoEnd_Mode, I2C_Generate_Start_Read);
+        } else {
+            I2C_GenerateSTOP(I2Cx, ENABLE);
         }
     }
 
-    /* Clear STOPF flag */
-    I2C_ClearFlag(I2Cx, I2C_ICR_STOPCF);
-
-    return true;
+    if (isr & I2C_ISR_STOPF) {
+        I2C_ClearFlag(I2Cx, I2C_ICR_STOPCF);
+        i2cAsyncComplete(device);
+    }
 }
 
-bool i2cRead(I2CDevice device, uint8_t addr_, uint8_t reg, uint8_t len, uint8_t* buf)
+static void i2c_er_handler(I2CDevice device)
 {
-    addr_ <<= 1;
+    I2C_TypeDef *I2Cx = i2cHardwareMap[device].dev;
 
-    I2C_TypeDef *I2Cx;
-    I2Cx = i2cHardwareMap[device].dev;
-
-    /* Test on BUSY Flag */
-    i2cTimeout = I2C_LONG_TIMEOUT;
-    while (I2C_GetFlagStatus(I2Cx, I2C_ISR_BUSY) != RESET) {
-        if ((i2cTimeout--) == 0) {
-            return i2cTimeoutUserCallback();
-        }
-    }
-
-    /* Configure slave address, nbytes, reload, end mode and start or stop generation */
-    I2C_TransferHandling(I2Cx, addr_, 1, I2C_SoftEnd_Mode, I2C_Generate_Start_Write);
+    // bus error, arbitration lost or overrun, the peripheral has released the bus
+    I2C_ClearFlag(I2Cx, I2C_ICR_BERRCF | I2C_ICR_ARLOCF | I2C_ICR_OVRCF);
+    i2cAsyncState[device].error = true;
+    i2cAsyncComplete(device);
+}
 
-    /* Wait until TXIS flag is set */
-    i2cTimeout = I2C_LONG_TIMEOUT;
-    while (I2C_GetFlagStatus(I2Cx, I2C_ISR_TXIS) == RESET) {
-        if ((i2cTimeout--) == 0) {
-            return i2cTimeoutUserCallback();
-        }
+static bool i2cTransfer(I2CDevice device, uint8_t addr_, uint8_t reg, uint8_t len, uint8_t *data, bool read)
+{
+    if (device == I2CINVALID) {
+        return false;
     }
 
-    /* Send Register address */
-    I2C_SendData(I2Cx, (uint8_t) reg);
+    i2cTransaction_t transaction = {
+        .device = device,
+        .addr = addr_,
+        .reg = reg,
+        .length = len,
+        .data = data,
+        .read = read,
+    };
 
-    /* Wait until TC flag is set */
-    i2cTimeout = I2C_LONG_TIMEOUT;
-    while (I2C_GetFlagStatus(I2Cx, I2C_ISR_TC) == RESET) {
-        if ((i2cTimeout--) == 0) {
-            return i2cTimeoutUserCallback();
-        }
+    if (!i2cQueueAndWait(&transaction)) {
+        return i2cHandleHardwareFailure(device);
     }
 
-    /* Configure slave address, nbytes, reload, end mode and start or stop generation */
-    I2C_TransferHandling(I2Cx, addr_, len, I2C_AutoEnd_Mode, I2C_Generate_Start_Read);
-
-    /* Wait until all data are received */
-    while (len) {
-        /* Wait until RXNE flag is set */
-        i2cTimeout = I2C_LONG_TIMEOUT;
-        while (I2C_GetFlagStatus(I2Cx, I2C_ISR_RXNE) == RESET) {
-            if ((i2cTimeout--) == 0) {
-                return i2cTimeoutUserCallback();
-            }
-        }
-
-        /* Read data from RXDR */
-        *buf = I2C_ReceiveData(I2Cx);
-        /* Point to the next location where the byte read will be saved */
-        buf++;
-
-        /* Decrement the read bytes counter */
-        len--;
-    }
+    return !transaction.error;
+}
 
-    /* Wait until STOPF flag is set */
-    i2cTimeout = I2C_LONG_TIMEOUT;
-    while (I2C_GetFlagStatus(I2Cx, I2C_ISR_STOPF) == RESET) {
-        if ((i2cTimeout--) == 0) {
-            return i2cTimeoutUserCallback();
-        }
-    }
+bool i2cWriteBuffer(I2CDevice device, uint8_t addr_, uint8_t reg, uint8_t len, uint8_t *data)
+{
+    return i2cTransfer(device, addr_, reg, len, data, false);
+}
 
-    /* Clear STOPF flag */
-    I2C_ClearFlag(I2Cx, I2C_ICR_STOPCF);
+bool i2cWrite(I2CDevice device, uint8_t addr_, uint8_t reg, uint8_t data)
+{
+    return i2cWriteBuffer(device, addr_, reg, 1, &data);
+}
 
-    /* If all operations OK */
-    return true;
+bool i2cRead(I2CDevice device, uint8_t addr_, uint8_t reg, uint8_t len, uint8_t* buf)
+{
+    return i2cTransfer(device, addr_, reg, len, buf, true);
 }
 
 #endif
@@ -20,10 +20,15 @@
 
 #include <platform.h>
 
+#include "common/utils.h"
+
 #include "bus_spi.h"
+#include "bus_spi_impl.h"
+#include "dma.h"
 #include "exti.h"
 #include "io.h"
 #include "io_impl.h"
+#include "nvic.h"
 #include "rcc.h"
 
 /* for F30x processors */
@@ -97,6 +102,223 @@ SPIDevice spiDeviceByInstance(SPI_TypeDef *instance)
     return SPIINVALID;
 }
 
+#ifdef USE_SPI_DMA
+static dmaIdentifier_e spiTxDmaIdentifier[SPIDEV_COUNT];
+static dmaIdentifier_e spiRxDmaIdentifier[SPIDEV_COUNT];
+
+static void spiDmaIrqHandler(dmaChannelDescriptor_t *descriptor)
+{
+    const SPIDevice device = descriptor->userParam;
+
+    if (DMA_GET_FLAG_STATUS(descriptor, DMA_IT_HTIF)) {
+        DMA_CLEAR_FLAG(descriptor, DMA_IT_HTIF);
+    }
+    if (DMA_GET_FLAG_STATUS(descriptor, DMA_IT_TEIF)) {
+        DMA_CLEAR_FLAG(descriptor, DMA_IT_TEIF);
+        DMA_CLEAR_FLAG(descriptor, DMA_IT_TCIF);
+
+        // the stream has been disabled by the controller, fail the transaction rather than wait for it
+        spiDmaStop(device);
+        spiBusSegmentComplete(device, true);
+    } else if (DMA_GET_FLAG_STATUS(descriptor, DMA_IT_TCIF)) {
+        DMA_CLEAR_FLAG(descriptor, DMA_IT_TCIF);
+
+        // the last byte has been received, so the transmission is also complete
+        spiDmaStop(device);
+        spiBusSegmentComplete(device, false);
+    }
+}
+
+static void spiInitDma(SPIDevice device)
+{
+    spiDevice_t *spi = &(spiHardwareMap[device]);
+
+    switch (device) {
+#ifdef SPI1_DMA_CHANNEL_TX
+    case SPIDEV_1:
+        spi->txDmaChannel = SPI1_DMA_CHANNEL_TX;
+        spi->rxDmaChannel = SPI1_DMA_CHANNEL_RX;
+        break;
+#endif
+#ifdef SPI2_DMA_CHANNEL_TX
+    case SPIDEV_2:
+        spi->txDmaChannel = SPI2_DMA_CHANNEL_TX;
+        spi->rxDmaChannel = SPI2_DMA_CHANNEL_RX;
+        break;
+#endif
+#ifdef SPI3_DMA_CHANNEL_TX
+    case SPIDEV_3:
+        spi->txDmaChannel = SPI3_DMA_CHANNEL_TX;
+        spi->rxDmaChannel = SPI3_DMA_CHANNEL_RX;
+        break;
+#endif
+    default:
+        return;
+    }
+
+#ifdef STM32F4
+    // the DMA request channel is fixed for each SPI on the F4
+    spi->dmaChannel = (device == SPIDEV_1) ? DMA_Channel_3 : DMA_Channel_0;
+#endif
+
+    spiTxDmaIdentifier[device] = dmaGetIdentifier(spi->txDmaChannel);
+    spiRxDmaIdentifier[device] = dmaGetIdentifier(spi->rxDmaChannel);
+
+    // the streams are time-shared with drivers using DMA while they hold the bus, eg the SD card
+    if (!dmaInitShared(spiTxDmaIdentifier[device], OWNER_SPI_MOSI, RESOURCE_INDEX(device))
+        || !dmaInitShared(spiRxDmaIdentifier[device], OWNER_SPI_MISO, RESOURCE_INDEX(device))) {
+        // fall back to polled transfers
+        spi->txDmaChannel = NULL;
+        spi->rxDmaChannel = NULL;
+        return;
+    }
+    dmaSetHandler(spiRxDmaIdentifier[device], spiDmaIrqHandler, NVIC_PRIO_SPI_DMA, device);
+}
+
+bool spiDmaIsEnabled(SPIDevice device)
+{
+    if (device == SPIINVALID) {
+        return false;
+    }
+
+    return spiHardwareMap[device].rxDmaChannel != NULL;
+}
+
+bool spiDmaAcquire(SPIDevice device)
+{
+    if (!dmaAcquire(spiTxDmaIdentifier[device])) {
+        return false;
+    }
+    if (!dmaAcquire(spiRxDmaIdentifier[device])) {
+        dmaRelease(spiTxDmaIdentifier[device]);
+        return false;
+    }
+
+    return true;
+}
+
+void spiDmaRelease(SPIDevice device)
+{
+    dmaRelease(spiRxDmaIdentifier[device]);
+    dmaRelease(spiTxDmaIdentifier[device]);
+}
+
+/*
+ * Start a full duplex DMA transfer, completion is signalled by the RX channel interrupt.
+ */
+void spiDmaStart(SPIDevice device, const uint8_t *txData, uint8_t *rxData, uint16_t length)
+{
+    static uint8_t dummyTx = 0xFF;
+    static uint8_t dummyRx;
+
+    spiDevice_t *spi = &(spiHardwareMap[device]);
+    DMA_InitTypeDef DMA_InitStructure;
+
+    // discard anything left over from polled transfers
+    while (SPI_I2S_GetFlagStatus(spi->dev, SPI_I2S_FLAG_RXNE) == SET) {
+        spi->dev->DR;
+    }
+
+    DMA_DeInit(spi->rxDmaChannel);
+    DMA_DeInit(spi->txDmaChannel);
+
+    DMA_StructInit(&DMA_InitStructure);
+#ifdef STM32F4
+    DMA_InitStructure.DMA_Channel = spi->dmaChannel;
+#endif
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)(&(spi->dev->DR));
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_BufferSize = length;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_Low;
+
+    // Rx channel
+#ifdef STM32F4
+    DMA_InitStructure.DMA_Memory0BaseAddr = rxData ? (uint32_t)rxData : (uint32_t)&dummyRx;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralToMemory;
+#else
+    DMA_InitStructure.DMA_MemoryBaseAddr = rxData ? (uint32_t)rxData : (uint32_t)&dummyRx;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
+#endif
+    DMA_InitStructure.DMA_MemoryInc = rxData ? DMA_MemoryInc_Enable : DMA_MemoryInc_Disable;
+    DMA_Init(spi->rxDmaChannel, &DMA_InitStructure);
+
+    // Tx channel
+#ifdef STM32F4
+    DMA_InitStructure.DMA_Memory0BaseAddr = txData ? (uint32_t)txData : (uint32_t)&dummyTx;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_MemoryToPeripheral;
+#else
+    DMA_InitStructure.DMA_MemoryBaseAddr = txData ? (uint32_t)txData : (uint32_t)&dummyTx;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralDST;
+#endif
+    DMA_InitStructure.DMA_MemoryInc = txData ? DMA_MemoryInc_Enable : DMA_MemoryInc_Disable;
+    DMA_Init(spi->txDmaChannel, &DMA_InitStructure);
+
+    DMA_ITConfig(spi->rxDmaChannel, DMA_IT_TC | DMA_IT_TE, ENABLE);
+
+    DMA_Cmd(spi->rxDmaChannel, ENABLE);
+    DMA_Cmd(spi->txDmaChannel, ENABLE);
+
+    SPI_I2S_DMACmd(spi->dev, SPI_I2S_DMAReq_Rx | SPI_I2S_DMAReq_Tx, ENABLE);
+}
+
+void spiDmaStop(SPIDevice device)
+{
+    spiDevice_t *spi = &(spiHardwareMap[device]);
+
+    DMA_Cmd(spi->rxDmaChannel, DISABLE);
+    DMA_Cmd(spi->txDmaChannel, DISABLE);
+    SPI_I2S_DMACmd(spi->dev, SPI_I2S_DMAReq_Rx | SPI_I2S_DMAReq_Tx, DISABLE);
+}
+
+// the core coupled memory at 0x10000000 holding the stack on the F3 and F4 is not on the DMA bus matrix
+bool spiDmaCanAccess(const void *data)
+{
+    return ((uint32_t)data & 0xFFFF0000) != 0x10000000;
+}
+#else
+bool spiDmaIsEnabled(SPIDevice device)
+{
+    UNUSED(device);
+
+    return false;
+}
+
+bool spiDmaAcquire(SPIDevice device)
+{
+    UNUSED(device);
+
+    return false;
+}
+
+void spiDmaRelease(SPIDevice device)
+{
+    UNUSED(device);
+}
+
+void spiDmaStart(SPIDevice device, const uint8_t *txData, uint8_t *rxData, uint16_t length)
+{
+    UNUSED(device);
+    UNUSED(txData);
+    UNUSED(rxData);
+    UNUSED(length);
+}
+
+void spiDmaStop(SPIDevice device)
+{
+    UNUSED(device);
+}
+
+bool spiDmaCanAccess(const void *data)
+{
+    UNUSED(data);
+
+    return true;
+}
+#endif
+
 void spiInitDevice(SPIDevice device)
 {
     spiDevice_t *spi = &(spiHardwareMap[device]);
@@ -173,6 +395,10 @@ void spiInitDevice(SPIDevice device)
         // Drive NSS high to disable connected SPI device.
         IOHi(IOGetByTag(spi->nss));
     }
+
+#ifdef USE_SPI_DMA
+    spiInitDma(device);
+#endif
 }
 
 bool spiInit(SPIDevice device)
@@ -20,6 +20,10 @@
 #include "io_types.h"
 #include "rcc_types.h"
 
+#if defined(SPI1_DMA_CHANNEL_TX) || defined(SPI2_DMA_CHANNEL_TX) || defined(SPI3_DMA_CHANNEL_TX)
+#define USE_SPI_DMA
+#endif
+
 #if defined(STM32F4) || defined(STM32F3)
 #define SPI_IO_AF_CFG      IO_CONFIG(GPIO_Mode_AF,  GPIO_Speed_50MHz, GPIO_OType_PP, GPIO_PuPd_NOPULL)
 #define SPI_IO_AF_SCK_CFG  IO_CONFIG(GPIO_Mode_AF,  GPIO_Speed_50MHz, GPIO_OType_PP, GPIO_PuPd_DOWN)
@@ -68,6 +72,8 @@ typedef enum SPIDevice {
     SPIDEV_4
 } SPIDevice;
 
+#define SPIDEV_COUNT (SPIDEV_4 + 1)
+
 typedef struct SPIDevice_s {
     SPI_TypeDef *dev;
     ioTag_t nss;
@@ -82,9 +88,49 @@ typedef struct SPIDevice_s {
     SPI_HandleTypeDef hspi;
     DMA_HandleTypeDef hdma;
     uint8_t dmaIrqHandler;
+#elif defined(STM32F4)
+    DMA_Stream_TypeDef *txDmaChannel;
+    DMA_Stream_TypeDef *rxDmaChannel;
+    uint32_t dmaChannel;
+#else
+    DMA_Channel_TypeDef *txDmaChannel;
+    DMA_Channel_TypeDef *rxDmaChannel;
 #endif
 } spiDevice_t;
 
+/*
+ * A device on a (possibly shared) SPI bus, with its own chip select and clock divisor.
+ */
+typedef struct spiBusDevice_s {
+    SPI_TypeDef *instance;
+    IO_t csPin;
+    uint16_t divisor;
+} spiBusDevice_t;
+
+typedef struct spiSegment_s {
+    const uint8_t *txData;      // NULL to clock out 0xFF
+    uint8_t *rxData;            // NULL to discard the received bytes
+    uint16_t length;
+} spiSegment_t;
+
+struct spiTransaction_s;
+typedef void (*spiTransactionCallbackFuncPtr)(struct spiTransaction_s *transaction);
+
+/*
+ * One or more segments sent with the chip select held low. Transactions on a bus are run in the
+ * order they are queued. With DMA channels assigned to the bus they complete in the DMA interrupt
+ * and the callback is called from there, otherwise they complete before spiBusQueue() returns.
+ */
+typedef struct spiTransaction_s {
+    const spiBusDevice_t *device;
+    const spiSegment_t *segments;
+    uint8_t segmentCount;
+    spiTransactionCallbackFuncPtr callback;
+    volatile bool busy;
+    volatile bool error;        // set when the transaction completes, true if it failed or was cancelled
+    struct spiTransaction_s *next;
+} spiTransaction_t;
+
 bool spiInit(SPIDevice device);
 void spiSetDivisor(SPI_TypeDef *instance, uint16_t divisor);
 uint8_t spiTransferByte(SPI_TypeDef *instance, uint8_t in);
@@ -96,6 +142,16 @@ uint16_t spiGetErrorCounter(SPI_TypeDef *instance);
 void spiResetErrorCounter(SPI_TypeDef *instance);
 SPIDevice spiDeviceByInstance(SPI_TypeDef *instance);
 
+void spiBusDeviceInit(spiBusDevice_t *device, SPI_TypeDef *instance, IO_t csPin, uint16_t divisor);
+void spiBusSetDivisor(spiBusDevice_t *device, uint16_t divisor);
+void spiBusQueue(spiTransaction_t *transaction);
+bool spiBusWait(spiTransaction_t *transaction);
+bool spiBusTransfer(const spiBusDevice_t *device, uint8_t *rxData, const uint8_t *txData, int length);
+bool spiBusWriteRegister(const spiBusDevice_t *device, uint8_t reg, uint8_t data);
+bool spiBusReadRegisterBuffer(const spiBusDevice_t *device, uint8_t reg, uint8_t *data, uint8_t length);
+void spiBusAcquire(const spiBusDevice_t *device);
+void spiBusRelease(const spiBusDevice_t *device);
+
 #if defined(USE_HAL_DRIVER)
 SPI_HandleTypeDef* spiHandleByInstance(SPI_TypeDef *instance);
 DMA_HandleTypeDef* spiSetDMATransmit(DMA_Stream_TypeDef *Stream, uint32_t Channel, SPI_TypeDef *Instance, uint8_t *pData, uint16_t Size);
@@ -20,7 +20,10 @@
 
 #include <platform.h>
 
+#include "common/utils.h"
+
 #include "bus_spi.h"
+#include "bus_spi_impl.h"
 #include "dma.h"
 #include "io.h"
 #include "io_impl.h"
@@ -396,3 +399,43 @@ DMA_HandleTypeDef* spiSetDMATransmit(DMA_Stream_TypeDef *Stream, uint32_t Channe
 
     return &spiHardwareMap[device].hdma;
 }
+
+// Transactions on the F7 are not run by DMA yet, spiBusQueue() completes them by polling
+bool spiDmaIsEnabled(SPIDevice device)
+{
+    UNUSED(device);
+
+    return false;
+}
+
+bool spiDmaAcquire(SPIDevice device)
+{
+    UNUSED(device);
+
+    return false;
+}
+
+void spiDmaRelease(SPIDevice device)
+{
+    UNUSED(device);
+}
+
+void spiDmaStart(SPIDevice device, const uint8_t *txData, uint8_t *rxData, uint16_t length)
+{
+    UNUSED(device);
+    UNUSED(txData);
+    UNUSED(rxData);
+    UNUSED(length);
+}
+
+void spiDmaStop(SPIDevice device)
+{
+    UNUSED(device);
+}
+
+bool spiDmaCanAccess(const void *data)
+{
+    UNUSED(data);
+
+    return true;
+}
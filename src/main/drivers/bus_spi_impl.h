@@ -0,0 +1,31 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "bus_spi.h"
+
+// Provided by the platform SPI driver for the transaction queue in bus_spi_queue.c
+bool spiDmaIsEnabled(SPIDevice device);
+bool spiDmaAcquire(SPIDevice device);
+void spiDmaRelease(SPIDevice device);
+void spiDmaStart(SPIDevice device, const uint8_t *txData, uint8_t *rxData, uint16_t length);
+void spiDmaStop(SPIDevice device);
+bool spiDmaCanAccess(const void *data);
+
+// Called by the platform SPI driver from the DMA interrupt once a transfer started with spiDmaStart() is complete or has failed
+void spiBusSegmentComplete(SPIDevice device, bool error);
@@ -0,0 +1,351 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <platform.h>
+
+#include "build/atomic.h"
+
+#include "common/maths.h"
+
+#include "io.h"
+#include "nvic.h"
+
+#include "bus_spi.h"
+#include "bus_spi_impl.h"
+
+/*
+ * Per bus transaction queue.
+ *
+ * On buses with DMA every transaction is run by DMA, started either by spiBusQueue() when the bus
+ * is idle or by the DMA interrupt of the previous transaction, so a caller waiting for its
+ * transaction in interrupt context (eg the gyro data ready ISR) is never waiting on code it has
+ * preempted. Buses without DMA keep the original behaviour and run each transaction on the spot.
+ *
+ * Segment buffers the DMA controller cannot reach, such as the stack in the F3 and F4 core coupled
+ * memory, are sent through a bounce buffer in main RAM, SPI_BUS_BOUNCE_BUFFER_SIZE bytes at a time.
+ */
+#define SPI_BUS_BOUNCE_BUFFER_SIZE 32
+
+// spiBusWait() polls for this many loops before cancelling the transaction, tens of milliseconds
+#define SPI_BUS_WAIT_TIMEOUT 0x100000
+
+typedef struct spiBusState_s {
+    spiTransaction_t *head;
+    spiTransaction_t *tail;
+    const spiBusDevice_t *owner;    // device holding the bus with spiBusAcquire()
+    uint8_t segmentIndex;
+    uint16_t segmentOffset;         // bytes of the current segment already transferred
+    uint16_t chunkLength;           // bytes in the DMA transfer in progress
+    bool bounced;                   // DMA transfer in progress uses bounceBuffer
+    bool active;                    // head transaction is in progress
+    uint8_t bounceBuffer[SPI_BUS_BOUNCE_BUFFER_SIZE];
+} spiBusState_t;
+
+static spiBusState_t spiBusState[SPIDEV_COUNT];
+
+void spiBusDeviceInit(spiBusDevice_t *device, SPI_TypeDef *instance, IO_t csPin, uint16_t divisor)
+{
+    device->instance = instance;
+    device->csPin = csPin;
+    device->divisor = divisor;
+
+    IOHi(csPin);
+}
+
+void spiBusSetDivisor(spiBusDevice_t *device, uint16_t divisor)
+{
+    device->divisor = divisor;
+
+    const SPIDevice spi = spiDeviceByInstance(device->instance);
+    if (spi != SPIINVALID && spiBusState[spi].owner == device) {
+        spiSetDivisor(device->instance, divisor);
+    }
+}
+
+static void spiBusSelect(const spiBusDevice_t *device)
+{
+    spiSetDivisor(device->instance, device->divisor);
+    IOLo(device->csPin);
+}
+
+static void spiBusDeselect(const spiBusDevice_t *device)
+{
+    IOHi(device->csPin);
+}
+
+static void spiBusTransactionFinish(spiTransaction_t *transaction, bool error)
+{
+    transaction->error = error;
+    transaction->busy = false;
+    if (transaction->callback) {
+        transaction->callback(transaction);
+    }
+}
+
+static void spiBusRunPolled(spiTransaction_t *transaction)
+{
+    bool error = false;
+
+    spiBusSelect(transaction->device);
+    for (int i = 0; i < transaction->segmentCount && !error; i++) {
+        const spiSegment_t *segment = &transaction->segments[i];
+        error = !spiTransfer(transaction->device->instance, segment->rxData, segment->txData, segment->length);
+    }
+    spiBusDeselect(transaction->device);
+
+    spiBusTransactionFinish(transaction, error);
+}
+
+// must be called with the SPI DMA interrupt masked, or from it
+static void spiBusStartSegment(SPIDevice spi)
+{
+    spiBusState_t *bus = &spiBusState[spi];
+    const spiSegment_t *segment = &bus->head->segments[bus->segmentIndex];
+    const uint8_t *txData = segment->txData ? segment->txData + bus->segmentOffset : NULL;
+    uint8_t *rxData = segment->rxData ? segment->rxData + bus->segmentOffset : NULL;
+    uint16_t length = segment->length - bus->segmentOffset;
+
+    bus->bounced = (txData && !spiDmaCanAccess(txData)) || (rxData && !spiDmaCanAccess(rxData));
+    if (bus->bounced) {
+        // each byte is sent before its reply is received, so both directions can share the buffer
+        length = MIN(length, SPI_BUS_BOUNCE_BUFFER_SIZE);
+        if (txData && !spiDmaCanAccess(txData)) {
+            memcpy(bus->bounceBuffer, txData, length);
+            txData = bus->bounceBuffer;
+        }
+        if (rxData && !spiDmaCanAccess(rxData)) {
+            rxData = bus->bounceBuffer;
+        }
+    }
+    bus->chunkLength = length;
+
+    spiDmaStart(spi, txData, rxData, length);
+}
+
+static void spiBusStartNext(SPIDevice spi)
+{
+    spiBusState_t *bus = &spiBusState[spi];
+
+    // the streams are only taken by other drivers while they hold the bus, spiBusRelease() restarts the queue
+    if (bus->active || bus->owner || !bus->head || !spiDmaAcquire(spi)) {
+        return;
+    }
+
+    bus->active = true;
+    bus->segmentIndex = 0;
+    bus->segmentOffset = 0;
+    spiBusSelect(bus->head->device);
+    spiBusStartSegment(spi);
+}
+
+// an error ends the transaction, the remaining segments are not sent
+void spiBusSegmentComplete(SPIDevice spi, bool error)
+{
+    spiBusState_t *bus = &spiBusState[spi];
+    spiTransaction_t *transaction = bus->head;
+
+    if (!bus->active) {
+        return;
+    }
+
+    if (!error) {
+        const spiSegment_t *segment = &transaction->segments[bus->segmentIndex];
+
+        if (bus->bounced && segment->rxData && !spiDmaCanAccess(segment->rxData)) {
+            memcpy(segment->rxData + bus->segmentOffset, bus->bounceBuffer, bus->chunkLength);
+        }
+        bus->segmentOffset += bus->chunkLength;
+        if (bus->segmentOffset >= segment->length) {
+            bus->segmentIndex++;
+            bus->segmentOffset = 0;
+        }
+        if (bus->segmentIndex < transaction->segmentCount) {
+            spiBusStartSegment(spi);
+            return;
+        }
+    }
+
+    spiBusDeselect(transaction->device);
+
+    bus->head = transaction->next;
+    if (!bus->head) {
+        bus->tail = NULL;
+    }
+    bus->active = false;
+    spiDmaRelease(spi);
+
+    spiBusTransactionFinish(transaction, error);
+
+    spiBusStartNext(spi);
+}
+
+// takes a transaction that has not completed off its bus, it finishes with an error
+static void spiBusCancel(spiTransaction_t *transaction)
+{
+    const SPIDevice spi = spiDeviceByInstance(transaction->device->instance);
+    spiBusState_t *bus = &spiBusState[spi];
+
+    ATOMIC_BLOCK(NVIC_PRIO_SPI_DMA) {
+        if (!transaction->busy) {
+            // completed while the caller gave up on it
+        } else if (bus->head == transaction && bus->active) {
+            spiDmaStop(spi);
+            spiBusSegmentComplete(spi, true);
+        } else {
+            spiTransaction_t *previous = NULL;
+            spiTransaction_t *queued = bus->head;
+            while (queued && queued != transaction) {
+                previous = queued;
+                queued = queued->next;
+            }
+            if (queued) {
+                if (previous) {
+                    previous->next = transaction->next;
+                } else {
+                    bus->head = transaction->next;
+                }
+                if (bus->tail == transaction) {
+                    bus->tail = previous;
+                }
+            }
+            spiBusTransactionFinish(transaction, true);
+        }
+    }
+}
+
+void spiBusQueue(spiTransaction_t *transaction)
+{
+    const SPIDevice spi = spiDeviceByInstance(transaction->device->instance);
+
+    transaction->busy = true;
+    transaction->error = false;
+    transaction->next = NULL;
+
+    if (!spiDmaIsEnabled(spi)) {
+        spiBusRunPolled(transaction);
+        return;
+    }
+
+    ATOMIC_BLOCK(NVIC_PRIO_SPI_DMA) {
+        spiBusState_t *bus = &spiBusState[spi];
+        if (bus->tail) {
+            bus->tail->next = transaction;
+        } else {
+            bus->head = transaction;
+        }
+        bus->tail = transaction;
+
+        spiBusStartNext(spi);
+    }
+}
+
+/*
+ * Returns false if the transaction failed, or did not complete in time and was cancelled.
+ */
+bool spiBusWait(spiTransaction_t *transaction)
+{
+    uint32_t timeout = SPI_BUS_WAIT_TIMEOUT;
+    while (transaction->busy && --timeout > 0) {
+    }
+
+    if (transaction->busy) {
+        spiBusCancel(transaction);
+    }
+
+    return !transaction->error;
+}
+
+bool spiBusTransfer(const spiBusDevice_t *device, uint8_t *rxData, const uint8_t *txData, int length)
+{
+    const spiSegment_t segment = { .txData = txData, .rxData = rxData, .length = length };
+    spiTransaction_t transaction = { .device = device, .segments = &segment, .segmentCount = 1 };
+
+    spiBusQueue(&transaction);
+
+    return spiBusWait(&transaction);
+}
+
+bool spiBusWriteRegister(const spiBusDevice_t *device, uint8_t reg, uint8_t data)
+{
+    const uint8_t txData[2] = { reg, data };
+
+    return spiBusTransfer(device, NULL, txData, sizeof(txData));
+}
+
+bool spiBusReadRegisterBuffer(const spiBusDevice_t *device, uint8_t reg, uint8_t *data, uint8_t length)
+{
+    const uint8_t command = reg | 0x80; // read transaction
+    const spiSegment_t segments[] = {
+        { .txData = &command, .rxData = NULL, .length = 1 },
+        { .txData = NULL, .rxData = data, .length = length },
+    };
+    spiTransaction_t transaction = { .device = device, .segments = segments, .segmentCount = 2 };
+
+    spiBusQueue(&transaction);
+
+    return spiBusWait(&transaction);
+}
+
+/*
+ * Hold the chip select low for a sequence of direct spiTransfer() calls, for devices whose protocol
+ * does not map onto transactions. Queued transactions of other devices wait until spiBusRelease(),
+ * so a device holding the bus across scheduler calls must not share a DMA bus with devices that
+ * wait for their transactions.
+ */
+void spiBusAcquire(const spiBusDevice_t *device)
+{
+    const SPIDevice spi = spiDeviceByInstance(device->instance);
+
+    if (spiDmaIsEnabled(spi)) {
+        spiBusState_t *bus = &spiBusState[spi];
+        bool acquired = false;
+        while (!acquired) {
+            ATOMIC_BLOCK(NVIC_PRIO_SPI_DMA) {
+                if (!bus->head) {
+                    bus->owner = device;
+                    acquired = true;
+                }
+            }
+        }
+    } else if (spi != SPIINVALID) {
+        spiBusState[spi].owner = device;
+    }
+
+    spiBusSelect(device);
+}
+
+void spiBusRelease(const spiBusDevice_t *device)
+{
+    const SPIDevice spi = spiDeviceByInstance(device->instance);
+
+    spiBusDeselect(device);
+
+    if (spi == SPIINVALID) {
+        return;
+    }
+
+    ATOMIC_BLOCK(NVIC_PRIO_SPI_DMA) {
+        spiBusState[spi].owner = NULL;
+        if (spiDmaIsEnabled(spi)) {
+            spiBusStartNext(spi);
+        }
+    }
+}
@@ -167,7 +167,16 @@ static void hmc5883lConfigureDataReadyInterruptHandling(void)
 #endif
 }
 
-static bool hmc5883lRead(int16_t *magData)
+static void hmc5883lConvert(const uint8_t *buf, int16_t *magData)
+{
+    // During calibration, magGain is 1.0, so the read returns normal non-calibrated values.
+    // After calibration is done, magGain is set to calculated gain values.
+    magData[X] = (int16_t)(buf[0] << 8 | buf[1]) * magGain[X];
+    magData[Z] = (int16_t)(buf[2] << 8 | buf[3]) * magGain[Z];
+    magData[Y] = (int16_t)(buf[4] << 8 | buf[5]) * magGain[Y];
+}
+
+static bool hmc5883lReadBlocking(int16_t *magData)
 {
     uint8_t buf[6];
 
@@ -175,15 +184,32 @@ static bool hmc5883lRead(int16_t *magData)
     if (!ack) {
         return false;
     }
-    // During calibration, magGain is 1.0, so the read returns normal non-calibrated values.
-    // After calibration is done, magGain is set to calculated gain values.
-    magData[X] = (int16_t)(buf[0] << 8 | buf[1]) * magGain[X];
-    magData[Z] = (int16_t)(buf[2] << 8 | buf[3]) * magGain[Z];
-    magData[Y] = (int16_t)(buf[4] << 8 | buf[5]) * magGain[Y];
+    hmc5883lConvert(buf, magData);
 
     return true;
 }
 
+static i2cTransaction_t hmc5883lDataRead;
+static uint8_t hmc5883lDataBuf[6];
+static bool hmc5883lDataValid = false;
+
+// Returns the sample read on the previous call and queues the next read, so the compass task does not wait for the bus
+static bool hmc5883lRead(int16_t *magData)
+{
+    if (hmc5883lDataRead.busy) {
+        return false;
+    }
+
+    const bool ack = hmc5883lDataValid && !hmc5883lDataRead.error;
+    if (ack) {
+        hmc5883lConvert(hmc5883lDataBuf, magData);
+    }
+
+    hmc5883lDataValid = i2cQueueRead(&hmc5883lDataRead, MAG_I2C_INSTANCE, MAG_ADDRESS, MAG_DATA_REGISTER, 6, hmc5883lDataBuf);
+
+    return ack;
+}
+
 static bool hmc5883lInit(void)
 {
     int16_t magADC[3];
@@ -197,12 +223,12 @@ static bool hmc5883lInit(void)
     // The new gain setting is effective from the second measurement and on.
     i2cWrite(MAG_I2C_INSTANCE, MAG_ADDRESS, HMC58X3_R_CONFB, 0x60); // Set the Gain to 2.5Ga (7:5->011)
     delay(100);
-    hmc5883lRead(magADC);
+    hmc5883lReadBlocking(magADC);
 
     for (i = 0; i < 10; i++) {  // Collect 10 samples
         i2cWrite(MAG_I2C_INSTANCE, MAG_ADDRESS, HMC58X3_R_MODE, 1);
         delay(50);
-        hmc5883lRead(magADC);       // Get the raw values in case the scales have already been changed.
+        hmc5883lReadBlocking(magADC);       // Get the raw values in case the scales have already been changed.
 
         // Since the measurements are noisy, they should be averaged rather than taking the max.
         xyz_total[X] += magADC[X];
@@ -222,7 +248,7 @@ static bool hmc5883lInit(void)
     for (i = 0; i < 10; i++) {
         i2cWrite(MAG_I2C_INSTANCE, MAG_ADDRESS, HMC58X3_R_MODE, 1);
         delay(50);
-        hmc5883lRead(magADC);               // Get the raw values in case the scales have already been changed.
+        hmc5883lReadBlocking(magADC);               // Get the raw values in case the scales have already been changed.
 
         // Since the measurements are noisy, they should be averaged.
         xyz_total[X] -= magADC[X];
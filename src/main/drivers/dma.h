@@ -34,8 +34,6 @@ typedef struct dmaChannelDescriptor_s {
     IRQn_Type                   irqN;
     uint32_t                    rcc;
     uint32_t                    userParam;
-    resourceOwner_e             owner;
-    uint8_t                     resourceIndex;
 } dmaChannelDescriptor_t;
 
 #if defined(STM32F7)
@@ -71,7 +69,7 @@ typedef enum {
 #define DMA_OUTPUT_INDEX    0
 #define DMA_OUTPUT_STRING   "DMA%d Stream %d:"
 
-#define DEFINE_DMA_CHANNEL(d, s, f, i, r) {.dma = d, .stream = s, .irqHandlerCallback = NULL, .flagsShift = f, .irqN = i, .rcc = r, .userParam = 0, .owner = 0, .resourceIndex = 0 }
+#define DEFINE_DMA_CHANNEL(d, s, f, i, r) {.dma = d, .stream = s, .irqHandlerCallback = NULL, .flagsShift = f, .irqN = i, .rcc = r, .userParam = 0 }
 #define DEFINE_DMA_IRQ_HANDLER(d, s, i) void DMA ## d ## _Stream ## s ## _IRQHandler(void) {\
                                                                 if (dmaDescriptors[i].irqHandlerCallback)\
                                                                     dmaDescriptors[i].irqHandlerCallback(&dmaDescriptors[i]);\
@@ -115,7 +113,7 @@ typedef enum {
 #define DMA_OUTPUT_INDEX    0
 #define DMA_OUTPUT_STRING   "DMA%d Channel %d:"
 
-#define DEFINE_DMA_CHANNEL(d, c, f, i, r) {.dma = d, .channel = c, .irqHandlerCallback = NULL, .flagsShift = f, .irqN = i, .rcc = r, .userParam = 0, .owner = 0, .resourceIndex = 0 }
+#define DEFINE_DMA_CHANNEL(d, c, f, i, r) {.dma = d, .channel = c, .irqHandlerCallback = NULL, .flagsShift = f, .irqN = i, .rcc = r, .userParam = 0 }
 #define DEFINE_DMA_IRQ_HANDLER(d, c, i) void DMA ## d ## _Channel ## c ## _IRQHandler(void) {\
                                                                         if (dmaDescriptors[i].irqHandlerCallback)\
                                                                             dmaDescriptors[i].irqHandlerCallback(&dmaDescriptors[i]);\
@@ -132,8 +130,51 @@ dmaIdentifier_e dmaGetIdentifier(const DMA_Channel_TypeDef* channel);
 dmaChannelDescriptor_t* getDmaDescriptor(const DMA_Channel_TypeDef* channel);
 #endif
 
-void dmaInit(dmaIdentifier_e identifier, resourceOwner_e owner, uint8_t resourceIndex);
-void dmaSetHandler(dmaIdentifier_e identifier, dmaCallbackHandlerFuncPtr callback, uint32_t priority, uint32_t userParam);
-
+/*
+ * Stream allocation.
+ *
+ * A stream is either held by one driver, or time-shared by drivers that never use it at the same time
+ * and bracket each use with dmaAcquire() and dmaRelease(). A request for a held stream fails, unless
+ * the holder has a lower priority and registered a revoke callback to fall back to a non-DMA mode.
+ * Refused requests are recorded on the stream for the CLI 'dma' report.
+ */
+typedef enum {
+    DMA_ALLOC_PRIORITY_LOW = 0,
+    DMA_ALLOC_PRIORITY_NORMAL,
+    DMA_ALLOC_PRIORITY_HIGH
+} dmaAllocPriority_e;
+
+typedef void (*dmaRevokeFuncPtr)(dmaIdentifier_e identifier, uint32_t revokeParam);
+
+#define DMA_MAX_SHARED_USERS 3
+
+typedef struct dmaUser_s {
+    resourceOwner_e owner;
+    uint8_t resourceIndex;
+} dmaUser_t;
+
+typedef struct dmaAllocation_s {
+    dmaUser_t users[DMA_MAX_SHARED_USERS];
+    uint8_t userCount;
+    bool shared;
+    volatile bool busy;                 // a shared stream is in use
+    dmaAllocPriority_e priority;
+    dmaRevokeFuncPtr revoke;
+    uint32_t revokeParam;
+    dmaUser_t conflict;                 // last refused or revoked user
+} dmaAllocation_t;
+
+bool dmaInit(dmaIdentifier_e identifier, resourceOwner_e owner, uint8_t resourceIndex);
+bool dmaAllocate(dmaIdentifier_e identifier, resourceOwner_e owner, uint8_t resourceIndex, dmaAllocPriority_e priority, dmaRevokeFuncPtr revoke, uint32_t revokeParam);
+bool dmaIsAvailable(dmaIdentifier_e identifier, resourceOwner_e owner, uint8_t resourceIndex, dmaAllocPriority_e priority);
+bool dmaInitShared(dmaIdentifier_e identifier, resourceOwner_e owner, uint8_t resourceIndex);
+bool dmaAcquire(dmaIdentifier_e identifier);
+void dmaRelease(dmaIdentifier_e identifier);
+
+const dmaAllocation_t *dmaGetAllocation(dmaIdentifier_e identifier);
 resourceOwner_e dmaGetOwner(dmaIdentifier_e identifier);
 uint8_t dmaGetResourceIndex(dmaIdentifier_e identifier);
+
+// Provided by the platform DMA driver
+void dmaEnable(dmaIdentifier_e identifier);
+void dmaSetHandler(dmaIdentifier_e identifier, dmaCallbackHandlerFuncPtr callback, uint32_t priority, uint32_t userParam);
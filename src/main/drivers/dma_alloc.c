@@ -0,0 +1,151 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <platform.h>
+
+#include "build/atomic.h"
+
+#include "nvic.h"
+#include "dma.h"
+#include "resource.h"
+
+static dmaAllocation_t dmaAllocations[DMA_MAX_DESCRIPTORS];
+
+static bool dmaIsUser(const dmaAllocation_t *allocation, resourceOwner_e owner, uint8_t resourceIndex)
+{
+    for (int i = 0; i < allocation->userCount; i++) {
+        if (allocation->users[i].owner == owner && allocation->users[i].resourceIndex == resourceIndex) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool dmaCanRevoke(const dmaAllocation_t *allocation, dmaAllocPriority_e priority)
+{
+    return allocation->revoke && allocation->priority < priority;
+}
+
+// returns true if the stream is free for the request, or can be given to it
+static bool dmaCanGrant(const dmaAllocation_t *allocation, resourceOwner_e owner, uint8_t resourceIndex, dmaAllocPriority_e priority, bool shared)
+{
+    if (allocation->userCount == 0 || dmaCanRevoke(allocation, priority)) {
+        return true;
+    }
+    if (allocation->shared != shared) {
+        return false;
+    }
+    // a driver reopening its own stream, or one more user of a time-shared stream
+    return dmaIsUser(allocation, owner, resourceIndex) || (shared && allocation->userCount < DMA_MAX_SHARED_USERS);
+}
+
+static bool dmaRequest(dmaIdentifier_e identifier, resourceOwner_e owner, uint8_t resourceIndex, dmaAllocPriority_e priority, bool shared, dmaRevokeFuncPtr revoke, uint32_t revokeParam)
+{
+    dmaAllocation_t *allocation = &dmaAllocations[identifier];
+
+    if (!dmaCanGrant(allocation, owner, resourceIndex, priority, shared)) {
+        allocation->conflict.owner = owner;
+        allocation->conflict.resourceIndex = resourceIndex;
+        return false;
+    }
+
+    if (allocation->userCount && dmaCanRevoke(allocation, priority) && !dmaIsUser(allocation, owner, resourceIndex)) {
+        // the holder carries on without DMA
+        allocation->conflict = allocation->users[0];
+        allocation->revoke(identifier, allocation->revokeParam);
+        allocation->userCount = 0;
+    }
+
+    if (!dmaIsUser(allocation, owner, resourceIndex)) {
+        if (!shared) {
+            allocation->userCount = 0;
+        }
+        allocation->users[allocation->userCount].owner = owner;
+        allocation->users[allocation->userCount].resourceIndex = resourceIndex;
+        allocation->userCount++;
+    }
+    allocation->shared = shared;
+    allocation->priority = priority;
+    allocation->revoke = revoke;
+    allocation->revokeParam = revokeParam;
+
+    dmaEnable(identifier);
+
+    return true;
+}
+
+bool dmaAllocate(dmaIdentifier_e identifier, resourceOwner_e owner, uint8_t resourceIndex, dmaAllocPriority_e priority, dmaRevokeFuncPtr revoke, uint32_t revokeParam)
+{
+    return dmaRequest(identifier, owner, resourceIndex, priority, false, revoke, revokeParam);
+}
+
+bool dmaInit(dmaIdentifier_e identifier, resourceOwner_e owner, uint8_t resourceIndex)
+{
+    return dmaAllocate(identifier, owner, resourceIndex, DMA_ALLOC_PRIORITY_NORMAL, NULL, 0);
+}
+
+bool dmaIsAvailable(dmaIdentifier_e identifier, resourceOwner_e owner, uint8_t resourceIndex, dmaAllocPriority_e priority)
+{
+    return dmaCanGrant(&dmaAllocations[identifier], owner, resourceIndex, priority, false);
+}
+
+bool dmaInitShared(dmaIdentifier_e identifier, resourceOwner_e owner, uint8_t resourceIndex)
+{
+    return dmaRequest(identifier, owner, resourceIndex, DMA_ALLOC_PRIORITY_NORMAL, true, NULL, 0);
+}
+
+/*
+ * Take a time-shared stream for one transfer, returns false if another user has it.
+ */
+bool dmaAcquire(dmaIdentifier_e identifier)
+{
+    dmaAllocation_t *allocation = &dmaAllocations[identifier];
+    bool acquired = false;
+
+    ATOMIC_BLOCK(NVIC_PRIO_MAX) {
+        if (!allocation->busy) {
+            allocation->busy = true;
+            acquired = true;
+        }
+    }
+
+    return acquired;
+}
+
+void dmaRelease(dmaIdentifier_e identifier)
+{
+    dmaAllocations[identifier].busy = false;
+}
+
+const dmaAllocation_t *dmaGetAllocation(dmaIdentifier_e identifier)
+{
+    return &dmaAllocations[identifier];
+}
+
+resourceOwner_e dmaGetOwner(dmaIdentifier_e identifier)
+{
+    return dmaAllocations[identifier].userCount ? dmaAllocations[identifier].users[0].owner : OWNER_FREE;
+}
+
+uint8_t dmaGetResourceIndex(dmaIdentifier_e identifier)
+{
+    return dmaAllocations[identifier].userCount ? dmaAllocations[identifier].users[0].resourceIndex : 0;
+}
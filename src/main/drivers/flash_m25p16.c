@@ -22,6 +22,8 @@
 
 #ifdef USE_FLASH_M25P16
 
+#include <string.h>
+
 #include "flash.h"
 #include "flash_m25p16.h"
 #include "io.h"
@@ -51,8 +53,7 @@
 #define JEDEC_ID_WINBOND_W25Q128       0xEF4018
 #define JEDEC_ID_MACRONIX_MX25L25635E  0xC22019
 
-#define DISABLE_M25P16       IOHi(m25p16CsPin); __NOP()
-#define ENABLE_M25P16        __NOP(); IOLo(m25p16CsPin)
+#define M25P16_PAGE_PROGRAM_COMMAND_SIZE 4
 
 // The timeout we expect between being able to issue page program instructions
 #define DEFAULT_TIMEOUT_MILLIS       6
@@ -63,7 +64,7 @@
 
 static flashGeometry_t geometry = {.pageSize = M25P16_PAGESIZE};
 
-static IO_t m25p16CsPin = IO_NONE;
+static spiBusDevice_t m25p16SpiDevice;
 
 /*
  * Whether we've performed an action that could have made the device busy for writes.
@@ -72,16 +73,22 @@ static IO_t m25p16CsPin = IO_NONE;
  */
 static bool couldBeBusy = false;
 
+#ifdef USE_SPI_DMA
+/*
+ * Page programs are assembled here and sent in the background, so the caller's buffers are free as
+ * soon as m25p16_pageProgramContinue() returns.
+ */
+static uint8_t pageProgramBuffer[M25P16_PAGE_PROGRAM_COMMAND_SIZE + M25P16_PAGESIZE];
+static spiSegment_t pageProgramSegment = { .txData = pageProgramBuffer, .rxData = NULL, .length = 0 };
+static spiTransaction_t pageProgramTransaction = { .device = &m25p16SpiDevice, .segments = &pageProgramSegment, .segmentCount = 1 };
+#endif
+
 /**
  * Send the given command byte to the device.
  */
 static void m25p16_performOneByteCommand(uint8_t command)
 {
-    ENABLE_M25P16;
-
-    spiTransferByte(M25P16_SPI_INSTANCE, command);
-
-    DISABLE_M25P16;
+    spiBusTransfer(&m25p16SpiDevice, NULL, &command, 1);
 }
 
 /**
@@ -101,17 +108,19 @@ static uint8_t m25p16_readStatus()
     uint8_t command[2] = { M25P16_INSTRUCTION_READ_STATUS_REG, 0 };
     uint8_t in[2];
 
-    ENABLE_M25P16;
-
-    spiTransfer(M25P16_SPI_INSTANCE, in, command, sizeof(command));
-
-    DISABLE_M25P16;
+    spiBusTransfer(&m25p16SpiDevice, in, command, sizeof(command));
 
     return in[1];
 }
 
 bool m25p16_isReady()
 {
+#ifdef USE_SPI_DMA
+    if (pageProgramTransaction.busy) {
+        return false;
+    }
+#endif
+
     // If couldBeBusy is false, don't bother to poll the flash chip for its status
     couldBeBusy = couldBeBusy && ((m25p16_readStatus() & M25P16_STATUS_FLAG_WRITE_IN_PROGRESS) != 0);
 
@@ -148,12 +157,8 @@ static bool m25p16_readIdentification()
      */
     in[1] = 0;
 
-    ENABLE_M25P16;
-
-    spiTransfer(M25P16_SPI_INSTANCE, in, out, sizeof(out));
-
-    // Clearing the CS bit terminates the command early so we don't have to read the chip UID:
-    DISABLE_M25P16;
+    // Clearing the CS bit at the end of the transfer terminates the command early so we don't have to read the chip UID:
+    spiBusTransfer(&m25p16SpiDevice, in, out, sizeof(out));
 
     // Manufacturer, memory type, and capacity
     chipID = (in[1] << 16) | (in[2] << 8) | (in[3]);
@@ -217,21 +222,16 @@ bool m25p16_init(flashConfig_t *flashConfig)
         return true;
     }
 
-    if (flashConfig->csTag) {
-        m25p16CsPin = IOGetByTag(flashConfig->csTag);
-    } else {
+    if (!flashConfig->csTag) {
         return false;
     }
 
+    IO_t m25p16CsPin = IOGetByTag(flashConfig->csTag);
     IOInit(m25p16CsPin, OWNER_FLASH_CS, 0);
     IOConfigGPIO(m25p16CsPin, SPI_IO_CS_CFG);
 
-    DISABLE_M25P16;
-
-#ifndef M25P16_SPI_SHARED
     //Maximum speed for standard READ command is 20mHz, other commands tolerate 25mHz
-    spiSetDivisor(M25P16_SPI_INSTANCE, SPI_CLOCK_FAST);
-#endif
+    spiBusDeviceInit(&m25p16SpiDevice, M25P16_SPI_INSTANCE, m25p16CsPin, SPI_CLOCK_FAST);
 
     return m25p16_readIdentification();
 }
@@ -247,11 +247,7 @@ void m25p16_eraseSector(uint32_t address)
 
     m25p16_writeEnable();
 
-    ENABLE_M25P16;
-
-    spiTransfer(M25P16_SPI_INSTANCE, NULL, out, sizeof(out));
-
-    DISABLE_M25P16;
+    spiBusTransfer(&m25p16SpiDevice, NULL, out, sizeof(out));
 }
 
 void m25p16_eraseCompletely()
@@ -263,6 +259,31 @@ void m25p16_eraseCompletely()
     m25p16_performOneByteCommand(M25P16_INSTRUCTION_BULK_ERASE);
 }
 
+#ifdef USE_SPI_DMA
+void m25p16_pageProgramBegin(uint32_t address)
+{
+    m25p16_waitForReady(DEFAULT_TIMEOUT_MILLIS);
+
+    m25p16_writeEnable();
+
+    pageProgramBuffer[0] = M25P16_INSTRUCTION_PAGE_PROGRAM;
+    pageProgramBuffer[1] = (address >> 16) & 0xFF;
+    pageProgramBuffer[2] = (address >> 8) & 0xFF;
+    pageProgramBuffer[3] = address & 0xFF;
+    pageProgramSegment.length = M25P16_PAGE_PROGRAM_COMMAND_SIZE;
+}
+
+void m25p16_pageProgramContinue(const uint8_t *data, int length)
+{
+    memcpy(&pageProgramBuffer[pageProgramSegment.length], data, length);
+    pageProgramSegment.length += length;
+}
+
+void m25p16_pageProgramFinish()
+{
+    spiBusQueue(&pageProgramTransaction);
+}
+#else
 void m25p16_pageProgramBegin(uint32_t address)
 {
     uint8_t command[] = { M25P16_INSTRUCTION_PAGE_PROGRAM, (address >> 16) & 0xFF, (address >> 8) & 0xFF, address & 0xFF};
@@ -271,7 +292,7 @@ void m25p16_pageProgramBegin(uint32_t address)
 
     m25p16_writeEnable();
 
-    ENABLE_M25P16;
+    spiBusAcquire(&m25p16SpiDevice);
 
     spiTransfer(M25P16_SPI_INSTANCE, NULL, command, sizeof(command));
 }
@@ -283,8 +304,9 @@ void m25p16_pageProgramContinue(const uint8_t *data, int length)
 
 void m25p16_pageProgramFinish()
 {
-    DISABLE_M25P16;
+    spiBusRelease(&m25p16SpiDevice);
 }
+#endif
 
 /**
  * Write bytes to a flash page. Address must not cross a page boundary.
@@ -326,12 +348,16 @@ int m25p16_readBytes(uint32_t address, uint8_t *buffer, int length)
         return 0;
     }
 
-    ENABLE_M25P16;
+    const spiSegment_t segments[] = {
+        { .txData = command, .rxData = NULL, .length = sizeof(command) },
+        { .txData = NULL, .rxData = buffer, .length = length },
+    };
+    spiTransaction_t transaction = { .device = &m25p16SpiDevice, .segments = segments, .segmentCount = 2 };
 
-    spiTransfer(M25P16_SPI_INSTANCE, NULL, command, sizeof(command));
-    spiTransfer(M25P16_SPI_INSTANCE, buffer, NULL, length);
-
-    DISABLE_M25P16;
+    spiBusQueue(&transaction);
+    if (!spiBusWait(&transaction)) {
+        return 0;
+    }
 
     return length;
 }
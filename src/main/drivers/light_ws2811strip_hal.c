@@ -61,7 +61,7 @@ void ws2811LedStripHardwareInit(ioTag_t ioTag)
     TIM_TypeDef *timer = timerHardware->tim;
     timerChannel = timerHardware->channel;
 
-    if (timerHardware->dmaStream == NULL) {
+    if (timerHardware->dmaStream == NULL || !dmaInit(timerHardware->dmaIrqHandler, OWNER_LED_STRIP, 0)) {
         return;
     }
     TimHandle.Instance = timer;
@@ -106,7 +106,6 @@ void ws2811LedStripHardwareInit(ioTag_t ioTag)
     /* Link hdma_tim to hdma[x] (channelx) */
     __HAL_LINKDMA(&TimHandle, hdma[dmaSource], hdma_tim);
 
-    dmaInit(timerHardware->dmaIrqHandler, OWNER_LED_STRIP, 0);
     dmaSetHandler(timerHardware->dmaIrqHandler, WS2811_DMA_IRQHandler, NVIC_PRIO_WS2811_DMA, dmaSource);
 
     /* Initialize TIMx DMA handle */
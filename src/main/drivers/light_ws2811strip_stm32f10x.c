@@ -57,7 +57,7 @@ void ws2811LedStripHardwareInit(ioTag_t ioTag)
     const timerHardware_t *timerHardware = timerGetByTag(ioTag, TIM_USE_ANY);
     timer = timerHardware->tim;
 
-    if (timerHardware->dmaChannel == NULL) {
+    if (timerHardware->dmaChannel == NULL || !dmaInit(timerHardware->dmaIrqHandler, OWNER_LED_STRIP, 0)) {
         return;
     }
 
@@ -89,7 +89,6 @@ void ws2811LedStripHardwareInit(ioTag_t ioTag)
     TIM_CtrlPWMOutputs(timer, ENABLE);
 
     /* configure DMA */
-    dmaInit(timerHardware->dmaIrqHandler, OWNER_LED_STRIP, 0);
     dmaSetHandler(timerHardware->dmaIrqHandler, WS2811_DMA_IRQHandler, NVIC_PRIO_WS2811_DMA, 0);
 
     dmaChannel = timerHardware->dmaChannel;
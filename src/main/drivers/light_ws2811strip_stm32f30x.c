@@ -58,7 +58,7 @@ void ws2811LedStripHardwareInit(ioTag_t ioTag)
     const timerHardware_t *timerHardware = timerGetByTag(ioTag, TIM_USE_ANY);
     timer = timerHardware->tim;
 
-    if (timerHardware->dmaChannel == NULL) {
+    if (timerHardware->dmaChannel == NULL || !dmaInit(timerHardware->dmaIrqHandler, OWNER_LED_STRIP, 0)) {
         return;
     }
 
@@ -66,7 +66,6 @@ void ws2811LedStripHardwareInit(ioTag_t ioTag)
     IOInit(ws2811IO, OWNER_LED_STRIP, 0);
     IOConfigGPIOAF(ws2811IO, IO_CONFIG(GPIO_Mode_AF, GPIO_Speed_50MHz, GPIO_OType_PP, GPIO_PuPd_UP), timerHardware->alternateFunction);
 
-    dmaInit(timerHardware->dmaIrqHandler, OWNER_LED_STRIP, 0);
     dmaSetHandler(timerHardware->dmaIrqHandler, WS2811_DMA_IRQHandler, NVIC_PRIO_WS2811_DMA, 0);
     RCC_ClockCmd(timerRCC(timer), ENABLE);
 
@@ -60,7 +60,7 @@ void ws2811LedStripHardwareInit(ioTag_t ioTag)
     const timerHardware_t *timerHardware = timerGetByTag(ioTag, TIM_USE_ANY);
     timer = timerHardware->tim;
 
-    if (timerHardware->dmaStream == NULL) {
+    if (timerHardware->dmaStream == NULL || !dmaInit(timerHardware->dmaIrqHandler, OWNER_LED_STRIP, 0)) {
         return;
     }
 
@@ -107,7 +107,6 @@ void ws2811LedStripHardwareInit(ioTag_t ioTag)
     TIM_CCxCmd(timer, timerHardware->channel, TIM_CCx_Enable);
     TIM_Cmd(timer, ENABLE);
 
-    dmaInit(timerHardware->dmaIrqHandler, OWNER_LED_STRIP, 0);
     dmaSetHandler(timerHardware->dmaIrqHandler, WS2811_DMA_IRQHandler, NVIC_PRIO_WS2811_DMA, 0);
 
     stream = timerHardware->dmaStream;
@@ -31,8 +31,6 @@
 #include "drivers/light_led.h"
 #include "drivers/io.h"
 #include "drivers/system.h"
-#include "drivers/nvic.h"
-#include "drivers/dma.h"
 #include "drivers/vcd.h"
 #include "max7456.h"
 #include "max7456_symbols.h"
@@ -150,19 +148,14 @@
 
 #define CHARS_PER_LINE      30 // XXX Should be related to VIDEO_BUFFER_CHARS_*?
 
-// On shared SPI buss we want to change clock for OSD chip and restore for other devices.
+// The bus driver switches the clock for the OSD chip on shared SPI buses.
 
-#ifdef MAX7456_SPI_CLK
-    #define ENABLE_MAX7456        {spiSetDivisor(MAX7456_SPI_INSTANCE, MAX7456_SPI_CLK);IOLo(max7456CsPin);}
-#else
-    #define ENABLE_MAX7456        IOLo(max7456CsPin)
+#ifndef MAX7456_SPI_CLK
+#define MAX7456_SPI_CLK         SPI_CLOCK_STANDARD
 #endif
 
-#ifdef MAX7456_RESTORE_CLK
-    #define DISABLE_MAX7456       {IOHi(max7456CsPin);spiSetDivisor(MAX7456_SPI_INSTANCE, MAX7456_RESTORE_CLK);}
-#else
-    #define DISABLE_MAX7456       IOHi(max7456CsPin)
-#endif
+#define ENABLE_MAX7456          spiBusAcquire(&max7456SpiDevice)
+#define DISABLE_MAX7456         spiBusRelease(&max7456SpiDevice)
 
 uint16_t maxScreenSize = VIDEO_BUFFER_CHARS_PAL;
 
@@ -176,9 +169,6 @@ static uint8_t shadowBuffer[VIDEO_BUFFER_CHARS_PAL];
 //Max chars to update in one idle
 
 #define MAX_CHARS2UPDATE    100
-#ifdef MAX7456_DMA_CHANNEL_TX
-volatile bool dmaTransactionInProgress = false;
-#endif
 
 static uint8_t spiBuff[MAX_CHARS2UPDATE*6];
 
@@ -190,7 +180,12 @@ static uint8_t  vosRegValue; // VOS (Vertical offset register) value
 
 static bool  max7456Lock        = false;
 static bool fontIsLoading       = false;
-static IO_t max7456CsPin        = IO_NONE;
+
+static spiBusDevice_t max7456SpiDevice;
+
+// screen updates are sent in the background on buses with DMA
+static spiSegment_t max7456UpdateSegment = { .txData = spiBuff, .rxData = NULL, .length = 0 };
+static spiTransaction_t max7456UpdateTransaction = { .device = &max7456SpiDevice, .segments = &max7456UpdateSegment, .segmentCount = 1 };
 
 
 static uint8_t max7456Send(uint8_t add, uint8_t data)
@@ -199,121 +194,6 @@ static uint8_t max7456Send(uint8_t add, uint8_t data)
     return spiTransferByte(MAX7456_SPI_INSTANCE, data);
 }
 
-#ifdef MAX7456_DMA_CHANNEL_TX
-static void max7456SendDma(void* tx_buffer, void* rx_buffer, uint16_t buffer_size)
-{
-    DMA_InitTypeDef DMA_InitStructure;
-#ifdef MAX7456_DMA_CHANNEL_RX
-    static uint16_t dummy[] = {0xffff};
-#else
-    UNUSED(rx_buffer);
-#endif
-    while (dmaTransactionInProgress); // Wait for prev DMA transaction
-
-    DMA_DeInit(MAX7456_DMA_CHANNEL_TX);
-#ifdef MAX7456_DMA_CHANNEL_RX
-    DMA_DeInit(MAX7456_DMA_CHANNEL_RX);
-#endif
-
-    // Common to both channels
-    DMA_StructInit(&DMA_InitStructure);
-    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)(&(MAX7456_SPI_INSTANCE->DR));
-    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
-    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
-    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
-    DMA_InitStructure.DMA_BufferSize = buffer_size;
-    DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
-    DMA_InitStructure.DMA_Priority = DMA_Priority_Low;
-
-#ifdef MAX7456_DMA_CHANNEL_RX
-    // Rx Channel
-
-#ifdef STM32F4
-    DMA_InitStructure.DMA_Memory0BaseAddr = rx_buffer ? (uint32_t)rx_buffer : (uint32_t)(dummy);
-    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralToMemory;
-#else
-    DMA_InitStructure.DMA_MemoryBaseAddr = rx_buffer ? (uint32_t)rx_buffer : (uint32_t)(dummy);
-    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
-#endif
-    DMA_InitStructure.DMA_MemoryInc = rx_buffer ? DMA_MemoryInc_Enable : DMA_MemoryInc_Disable;
-
-    DMA_Init(MAX7456_DMA_CHANNEL_RX, &DMA_InitStructure);
-    DMA_Cmd(MAX7456_DMA_CHANNEL_RX, ENABLE);
-#endif
-
-    // Tx channel
-
-#ifdef STM32F4
-    DMA_InitStructure.DMA_Memory0BaseAddr = (uint32_t)tx_buffer; //max7456_screen;
-    DMA_InitStructure.DMA_DIR = DMA_DIR_MemoryToPeripheral;
-#else
-    DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)tx_buffer; //max7456_screen;
-    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralDST;
-#endif
-    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
-
-    DMA_Init(MAX7456_DMA_CHANNEL_TX, &DMA_InitStructure);
-    DMA_Cmd(MAX7456_DMA_CHANNEL_TX, ENABLE);
-
-#ifdef MAX7456_DMA_CHANNEL_RX
-    DMA_ITConfig(MAX7456_DMA_CHANNEL_RX, DMA_IT_TC, ENABLE);
-#else
-    DMA_ITConfig(MAX7456_DMA_CHANNEL_TX, DMA_IT_TC, ENABLE);
-#endif
-
-    // Enable SPI TX/RX request
-
-    ENABLE_MAX7456;
-    dmaTransactionInProgress = true;
-
-    SPI_I2S_DMACmd(MAX7456_SPI_INSTANCE,
-#ifdef MAX7456_DMA_CHANNEL_RX
-            SPI_I2S_DMAReq_Rx |
-#endif
-            SPI_I2S_DMAReq_Tx, ENABLE);
-}
-
-void max7456_dma_irq_handler(dmaChannelDescriptor_t* descriptor)
-{
-    if (DMA_GET_FLAG_STATUS(descriptor, DMA_IT_TCIF)) {
-#ifdef MAX7456_DMA_CHANNEL_RX
-        DMA_Cmd(MAX7456_DMA_CHANNEL_RX, DISABLE);
-#endif
-        // Make sure SPI DMA transfer is complete
-
-        while (SPI_I2S_GetFlagStatus (MAX7456_SPI_INSTANCE, SPI_I2S_FLAG_TXE) == RESET) {};
-        while (SPI_I2S_GetFlagStatus (MAX7456_SPI_INSTANCE, SPI_I2S_FLAG_BSY) == SET) {};
-
-        // Empty RX buffer. RX DMA takes care of it if enabled.
-        // This should be done after transmission finish!!!
-
-        while (SPI_I2S_GetFlagStatus(MAX7456_SPI_INSTANCE, SPI_I2S_FLAG_RXNE) == SET) {
-            MAX7456_SPI_INSTANCE->DR;
-        }
-
-        DMA_Cmd(MAX7456_DMA_CHANNEL_TX, DISABLE);
-
-        DMA_CLEAR_FLAG(descriptor, DMA_IT_TCIF);
-
-        SPI_I2S_DMACmd(MAX7456_SPI_INSTANCE,
-#ifdef MAX7456_DMA_CHANNEL_RX
-                SPI_I2S_DMAReq_Rx |
-#endif
-                SPI_I2S_DMAReq_Tx, DISABLE);
-
-        DISABLE_MAX7456;
-        dmaTransactionInProgress = false;
-    }
-
-    if (DMA_GET_FLAG_STATUS(descriptor, DMA_IT_HTIF)) {
-        DMA_CLEAR_FLAG(descriptor, DMA_IT_HTIF);
-    }
-    if (DMA_GET_FLAG_STATUS(descriptor, DMA_IT_TEIF)) {
-        DMA_CLEAR_FLAG(descriptor, DMA_IT_TEIF);
-    }
-}
-
-#endif
 
 uint8_t max7456GetRowsCount(void)
 {
@@ -389,13 +269,14 @@ void max7456ReInit(void)
 
 void max7456Init(const vcdProfile_t *pVcdProfile)
 {
+    IO_t max7456CsPin = IO_NONE;
 #ifdef MAX7456_SPI_CS_PIN
     max7456CsPin = IOGetByTag(IO_TAG(MAX7456_SPI_CS_PIN));
 #endif
     IOInit(max7456CsPin, OWNER_OSD_CS, 0);
     IOConfigGPIO(max7456CsPin, SPI_IO_CS_CFG);
 
-    spiSetDivisor(MAX7456_SPI_INSTANCE, SPI_CLOCK_STANDARD);
+    spiBusDeviceInit(&max7456SpiDevice, MAX7456_SPI_INSTANCE, max7456CsPin, MAX7456_SPI_CLK);
     // force soft reset on Max7456
     ENABLE_MAX7456;
     max7456Send(MAX7456ADD_VM0, MAX7456_RESET);
@@ -406,10 +287,6 @@ void max7456Init(const vcdProfile_t *pVcdProfile)
     hosRegValue = 32 - pVcdProfile->h_offset;
     vosRegValue = 16 - pVcdProfile->v_offset;
 
-#ifdef MAX7456_DMA_CHANNEL_TX
-    dmaSetHandler(MAX7456_DMA_IRQ_HANDLER_ID, max7456_dma_irq_handler, NVIC_PRIO_MAX7456_DMA, 0);
-#endif
-
     // Real init will be made later when driver detect idle.
 }
 
@@ -439,12 +316,10 @@ void max7456Write(uint8_t x, uint8_t y, const char *buff)
             screenBuffer[y*CHARS_PER_LINE+x+i] = *(buff+i);
 }
 
-#ifdef MAX7456_DMA_CHANNEL_TX
 bool max7456DmaInProgres(void)
 {
-    return dmaTransactionInProgress;
+    return max7456UpdateTransaction.busy;
 }
-#endif
 
 #include "build/debug.h"
 
@@ -530,15 +405,9 @@ void max7456DrawScreen(void)
         }
 
         if (buff_len) {
-            #ifdef MAX7456_DMA_CHANNEL_TX
-            if (buff_len > 0)
-                max7456SendDma(spiBuff, NULL, buff_len);
-            #else
-            ENABLE_MAX7456;
-            for (k=0; k < buff_len; k++)
-                spiTransferByte(MAX7456_SPI_INSTANCE, spiBuff[k]);
-            DISABLE_MAX7456;
-            #endif // MAX7456_DMA_CHANNEL_TX
+            // spiBuff is not touched again before the next ENABLE_MAX7456, which waits for this to complete
+            max7456UpdateSegment.length = buff_len;
+            spiBusQueue(&max7456UpdateTransaction);
         }
         max7456Lock = false;
     }
@@ -549,9 +418,6 @@ void max7456DrawScreen(void)
 void max7456RefreshAll(void)
 {
     if (!max7456Lock) {
-#ifdef MAX7456_DMA_CHANNEL_TX
-    while (dmaTransactionInProgress);
-#endif
         uint16_t xx;
         max7456Lock = true;
         ENABLE_MAX7456;
@@ -576,9 +442,6 @@ void max7456WriteNvm(uint8_t char_address, const uint8_t *font_data)
 {
     uint8_t x;
 
-#ifdef MAX7456_DMA_CHANNEL_TX
-    while (dmaTransactionInProgress);
-#endif
     while (max7456Lock);
     max7456Lock = true;
 
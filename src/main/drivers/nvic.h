@@ -35,15 +35,17 @@
 #define NVIC_PRIO_SERIALUART8_TXDMA        NVIC_BUILD_PRIORITY(1, 0)
 #define NVIC_PRIO_SERIALUART8_RXDMA        NVIC_BUILD_PRIORITY(1, 1)
 #define NVIC_PRIO_SERIALUART8              NVIC_BUILD_PRIORITY(1, 2)
-#define NVIC_PRIO_I2C_ER                   NVIC_BUILD_PRIORITY(0, 0)
-#define NVIC_PRIO_I2C_EV                   NVIC_BUILD_PRIORITY(0, 0)
+#define NVIC_PRIO_I2C_ER                   NVIC_BUILD_PRIORITY(0, 1)  // maskable with BASEPRI for the transaction queue
+#define NVIC_PRIO_I2C_EV                   NVIC_BUILD_PRIORITY(0, 1)
 #define NVIC_PRIO_USB                      NVIC_BUILD_PRIORITY(2, 0)
 #define NVIC_PRIO_USB_WUP                  NVIC_BUILD_PRIORITY(1, 0)
 #define NVIC_PRIO_SONAR_ECHO               NVIC_BUILD_PRIORITY(0x0f, 0x0f)
 #define NVIC_PRIO_MPU_DATA_READY           NVIC_BUILD_PRIORITY(0x0f, 0x0f)
 #define NVIC_PRIO_MAG_DATA_READY           NVIC_BUILD_PRIORITY(0x0f, 0x0f)
 #define NVIC_PRIO_CALLBACK                 NVIC_BUILD_PRIORITY(0x0f, 0x0f)
-#define NVIC_PRIO_MAX7456_DMA              NVIC_BUILD_PRIORITY(3, 0)
+#define NVIC_PRIO_SPI_DMA                  NVIC_BUILD_PRIORITY(3, 0)
+#define NVIC_PRIO_ADC_DMA                  NVIC_BUILD_PRIORITY(3, 1)
+#define NVIC_PRIO_SOFTSERIAL_DMA           NVIC_BUILD_PRIORITY(3, 2)
 
 #ifdef USE_HAL_DRIVER
 // utility macros to join/split priority
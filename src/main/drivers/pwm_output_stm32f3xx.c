@@ -61,7 +61,7 @@ void pwmWriteDigital(uint8_t index, uint16_t value)
 
     motorDmaOutput_t * const motor = &dmaMotors[index];
 
-    if (!motor->timerHardware->dmaChannel) {
+    if (!motor->dmaDescriptor) {
         return;
     }
 
@@ -170,7 +170,11 @@ void pwmDigitalMotorHardwareConfig(const timerHardware_t *timerHardware, uint8_t
         return;
     }
 
-    dmaInit(timerHardware->dmaIrqHandler, OWNER_MOTOR, RESOURCE_INDEX(motorIndex));
+    if (!dmaAllocate(timerHardware->dmaIrqHandler, OWNER_MOTOR, RESOURCE_INDEX(motorIndex), DMA_ALLOC_PRIORITY_HIGH, NULL, 0)) {
+        // the channel belongs to another driver, don't raise its DMA requests
+        dmaMotorTimers[timerIndex].timerDmaSources &= ~motor->timerDmaSource;
+        return;
+    }
     motor->dmaDescriptor = getDmaDescriptor(channel);
 
     DMA_DeInit(channel);
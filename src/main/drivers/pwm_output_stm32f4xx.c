@@ -59,7 +59,7 @@ void pwmWriteDigital(uint8_t index, uint16_t value)
 
     motorDmaOutput_t * const motor = &dmaMotors[index];
 
-    if (!motor->timerHardware->dmaStream) {
+    if (!motor->dmaDescriptor) {
         return;
     }
 
@@ -167,7 +167,11 @@ void pwmDigitalMotorHardwareConfig(const timerHardware_t *timerHardware, uint8_t
         return;
     }
 
-    dmaInit(timerHardware->dmaIrqHandler, OWNER_MOTOR, RESOURCE_INDEX(motorIndex));
+    if (!dmaAllocate(timerHardware->dmaIrqHandler, OWNER_MOTOR, RESOURCE_INDEX(motorIndex), DMA_ALLOC_PRIORITY_HIGH, NULL, 0)) {
+        // the stream belongs to another driver, don't raise its DMA requests
+        dmaMotorTimers[timerIndex].timerDmaSources &= ~motor->timerDmaSource;
+        return;
+    }
     motor->dmaDescriptor = getDmaDescriptor(stream);
 
     DMA_Cmd(stream, DISABLE);
@@ -58,7 +58,7 @@ void pwmWriteDigital(uint8_t index, uint16_t value)
 
     motorDmaOutput_t * const motor = &dmaMotors[index];
 
-    if (!motor->timerHardware->dmaStream) {
+    if (!motor->hdma_tim.Instance) {
         return;
     }
 
@@ -156,13 +156,17 @@ void pwmDigitalMotorHardwareConfig(const timerHardware_t *timerHardware, uint8_t
         /* Initialization Error */
         return;
     }
+
+    if (!dmaAllocate(timerHardware->dmaIrqHandler, OWNER_MOTOR, RESOURCE_INDEX(motorIndex), DMA_ALLOC_PRIORITY_HIGH, NULL, 0)) {
+        // the stream belongs to another driver, don't raise its DMA requests
+        dmaMotorTimers[timerIndex].timerDmaSources &= ~motor->timerDmaSource;
+        return;
+    }
     motor->hdma_tim.Instance = timerHardware->dmaStream;
 
     /* Link hdma_tim to hdma[x] (channelx) */
     __HAL_LINKDMA(&motor->TimHandle, hdma[motor->timerDmaSource], motor->hdma_tim);
 
-    dmaInit(timerHardware->dmaIrqHandler, OWNER_MOTOR, RESOURCE_INDEX(motorIndex));
-
     /* Initialize TIMx DMA handle */
     if(HAL_DMA_Init(motor->TimHandle.hdma[motor->timerDmaSource]) != HAL_OK)
     {
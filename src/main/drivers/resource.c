@@ -60,5 +60,6 @@ const char * const ownerNames[OWNER_TOTAL_COUNT] = {
     "LED_STRIP",
     "TRANSPONDER",
     "VTX",
+    "SDCARD",
 };
 
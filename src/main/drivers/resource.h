@@ -60,6 +60,7 @@ typedef enum {
     OWNER_LED_STRIP,
     OWNER_TRANSPONDER,
     OWNER_VTX,
+    OWNER_SDCARD,
     OWNER_TOTAL_COUNT
 } resourceOwner_e;
 
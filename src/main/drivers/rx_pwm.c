@@ -63,6 +63,7 @@ typedef struct {
     uint8_t channel; // only used for pwm, ignored by ppm
 
     uint8_t state;
+    bool polarityFalling;   // edge the capture interrupt is configured for
     captureCompare_t rise;
     captureCompare_t fall;
     captureCompare_t capture;
@@ -103,6 +104,46 @@ typedef struct ppmDevice_s {
 
 ppmDevice_t ppmDev;
 
+/*
+ * The capture interrupts only push the captured timer values, and the overflows, into a ring that
+ * is decoded into channel values by pwmRxDecode() in the RX task, keeping the time spent in the
+ * edge interrupts to a minimum.
+ */
+#define RX_PWM_EVENT_COUNT 32   // power of 2, the RX check function empties it every scheduler pass
+
+typedef enum {
+    RX_PWM_EVENT_RISING = 0,
+    RX_PWM_EVENT_FALLING,
+    RX_PWM_EVENT_OVERFLOW
+} rxPwmEventType_e;
+
+typedef struct rxPwmEvent_s {
+    captureCompare_t capture;
+    uint8_t port;
+    uint8_t type;
+} rxPwmEvent_t;
+
+static rxPwmEvent_t rxPwmEvents[RX_PWM_EVENT_COUNT];
+static volatile uint8_t rxPwmEventHead;    // written by the capture interrupts only
+static volatile uint8_t rxPwmEventTail;    // written by pwmRxDecode() only
+static volatile bool rxPwmEventsOverrun;
+
+static void rxPwmPushEvent(const pwmInputPort_t *pwmInputPort, rxPwmEventType_e type, captureCompare_t capture)
+{
+    const uint8_t head = rxPwmEventHead;
+    const uint8_t next = (head + 1) & (RX_PWM_EVENT_COUNT - 1);
+    if (next == rxPwmEventTail) {
+        rxPwmEventsOverrun = true;
+        return;
+    }
+
+    rxPwmEvent_t *event = &rxPwmEvents[head];
+    event->capture = capture;
+    event->port = pwmInputPort - pwmInputPorts;
+    event->type = type;
+    rxPwmEventHead = next;
+}
+
 #define PPM_IN_MIN_SYNC_PULSE_US    2700    // microseconds
 #define PPM_IN_MIN_CHANNEL_PULSE_US 750     // microseconds
 #define PPM_IN_MAX_CHANNEL_PULSE_US 2250    // microseconds
@@ -161,9 +202,8 @@ static void ppmResetDevice(void)
     ppmDev.overflowed   = false;
 }
 
-static void ppmOverflowCallback(timerOvrHandlerRec_t* cbRec, captureCompare_t capture)
+static void ppmDecodeOverflow(captureCompare_t capture)
 {
-    UNUSED(cbRec);
     ppmISREvent(SOURCE_OVERFLOW, capture);
 
     ppmDev.largeCounter += capture + 1;
@@ -172,9 +212,8 @@ static void ppmOverflowCallback(timerOvrHandlerRec_t* cbRec, captureCompare_t ca
     }
 }
 
-static void ppmEdgeCallback(timerCCHandlerRec_t* cbRec, captureCompare_t capture)
+static void ppmDecodeEdge(captureCompare_t capture)
 {
-    UNUSED(cbRec);
     ppmISREvent(SOURCE_EDGE, capture);
 
     int32_t i;
@@ -275,31 +314,20 @@ bool isPWMDataBeingReceived(void)
     return false;
 }
 
-static void pwmOverflowCallback(timerOvrHandlerRec_t* cbRec, captureCompare_t capture)
+static void pwmDecodeOverflow(pwmInputPort_t *pwmInputPort)
 {
-    UNUSED(capture);
-    pwmInputPort_t *pwmInputPort = container_of(cbRec, pwmInputPort_t, overflowCb);
-
     if (++pwmInputPort->missedEvents > MAX_MISSED_PWM_EVENTS) {
         captures[pwmInputPort->channel] = PPM_RCVR_TIMEOUT;
         pwmInputPort->missedEvents = 0;
     }
 }
 
-static void pwmEdgeCallback(timerCCHandlerRec_t *cbRec, captureCompare_t capture)
+static void pwmDecodeEdge(pwmInputPort_t *pwmInputPort, rxPwmEventType_e type, captureCompare_t capture)
 {
-    pwmInputPort_t *pwmInputPort = container_of(cbRec, pwmInputPort_t, edgeCb);
-    const timerHardware_t *timerHardwarePtr = pwmInputPort->timerHardware;
-
-    if (pwmInputPort->state == 0) {
+    if (type == RX_PWM_EVENT_RISING) {
         pwmInputPort->rise = capture;
         pwmInputPort->state = 1;
-#if defined(USE_HAL_DRIVER)
-        pwmICConfig(timerHardwarePtr->tim, timerHardwarePtr->channel, TIM_ICPOLARITY_FALLING);
-#else
-        pwmICConfig(timerHardwarePtr->tim, timerHardwarePtr->channel, TIM_ICPolarity_Falling);
-#endif
-    } else {
+    } else if (pwmInputPort->state == 1) {
         pwmInputPort->fall = capture;
 
         // compute and store capture
@@ -308,15 +336,68 @@ static void pwmEdgeCallback(timerCCHandlerRec_t *cbRec, captureCompare_t capture
 
         // switch state
         pwmInputPort->state = 0;
-#if defined(USE_HAL_DRIVER)
-        pwmICConfig(timerHardwarePtr->tim, timerHardwarePtr->channel, TIM_ICPOLARITY_RISING);
-#else
-        pwmICConfig(timerHardwarePtr->tim, timerHardwarePtr->channel, TIM_ICPolarity_Rising);
-#endif
         pwmInputPort->missedEvents = 0;
     }
 }
 
+static void rxPwmOverflowCallback(timerOvrHandlerRec_t* cbRec, captureCompare_t capture)
+{
+    const pwmInputPort_t *pwmInputPort = container_of(cbRec, pwmInputPort_t, overflowCb);
+
+    rxPwmPushEvent(pwmInputPort, RX_PWM_EVENT_OVERFLOW, capture);
+}
+
+static void rxPwmEdgeCallback(timerCCHandlerRec_t *cbRec, captureCompare_t capture)
+{
+    pwmInputPort_t *pwmInputPort = container_of(cbRec, pwmInputPort_t, edgeCb);
+
+    rxPwmPushEvent(pwmInputPort, pwmInputPort->polarityFalling ? RX_PWM_EVENT_FALLING : RX_PWM_EVENT_RISING, capture);
+
+    if (pwmInputPort->mode == INPUT_MODE_PWM) {
+        // capture the other edge of the pulse next
+        pwmInputPort->polarityFalling = !pwmInputPort->polarityFalling;
+        timerChICPolarity(pwmInputPort->timerHardware, !pwmInputPort->polarityFalling);
+    }
+}
+
+void pwmRxDecode(void)
+{
+    if (rxPwmEventsOverrun) {
+        // events were lost, drop the pulses and PPM frame in progress and resynchronise
+        rxPwmEventTail = rxPwmEventHead;
+        rxPwmEventsOverrun = false;
+        for (int i = 0; i < PWM_INPUT_PORT_COUNT; i++) {
+            pwmInputPorts[i].state = 0;
+        }
+        ppmDev.tracking = false;
+        return;
+    }
+
+    uint8_t tail = rxPwmEventTail;
+    const uint8_t head = rxPwmEventHead;
+    while (tail != head) {
+        const rxPwmEvent_t *event = &rxPwmEvents[tail];
+        pwmInputPort_t *pwmInputPort = &pwmInputPorts[event->port];
+
+        if (pwmInputPort->mode == INPUT_MODE_PPM) {
+            if (event->type == RX_PWM_EVENT_OVERFLOW) {
+                ppmDecodeOverflow(event->capture);
+            } else {
+                ppmDecodeEdge(event->capture);
+            }
+        } else {
+            if (event->type == RX_PWM_EVENT_OVERFLOW) {
+                pwmDecodeOverflow(pwmInputPort);
+            } else {
+                pwmDecodeEdge(pwmInputPort, event->type, event->capture);
+            }
+        }
+
+        tail = (tail + 1) & (RX_PWM_EVENT_COUNT - 1);
+    }
+    rxPwmEventTail = tail;
+}
+
 #ifdef USE_HAL_DRIVER
 
 void pwmICConfig(TIM_TypeDef *tim, uint8_t channel, uint16_t polarity)
@@ -375,6 +456,7 @@ void pwmRxInit(const pwmConfig_t *pwmConfig)
         }
 
         port->state = 0;
+        port->polarityFalling = false;
         port->missedEvents = 0;
         port->channel = channel;
         port->mode = INPUT_MODE_PWM;
@@ -395,8 +477,8 @@ void pwmRxInit(const pwmConfig_t *pwmConfig)
 #endif
         timerConfigure(timer, (uint16_t)PWM_TIMER_PERIOD, PWM_TIMER_MHZ);
 
-        timerChCCHandlerInit(&port->edgeCb, pwmEdgeCallback);
-        timerChOvrHandlerInit(&port->overflowCb, pwmOverflowCallback);
+        timerChCCHandlerInit(&port->edgeCb, rxPwmEdgeCallback);
+        timerChOvrHandlerInit(&port->overflowCb, rxPwmOverflowCallback);
         timerChConfigCallbacks(timer, &port->edgeCb, &port->overflowCb);
     }
 }
@@ -464,8 +546,8 @@ void ppmRxInit(const ppmConfig_t *ppmConfig, uint8_t pwmProtocol)
 
     timerConfigure(timer, (uint16_t)PPM_TIMER_PERIOD, PWM_TIMER_MHZ);
 
-    timerChCCHandlerInit(&port->edgeCb, ppmEdgeCallback);
-    timerChOvrHandlerInit(&port->overflowCb, ppmOverflowCallback);
+    timerChCCHandlerInit(&port->edgeCb, rxPwmEdgeCallback);
+    timerChOvrHandlerInit(&port->overflowCb, rxPwmOverflowCallback);
     timerChConfigCallbacks(timer, &port->edgeCb, &port->overflowCb);
 }
 
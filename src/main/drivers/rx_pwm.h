@@ -39,6 +39,8 @@ typedef struct pwmConfig_s {
 void ppmRxInit(const ppmConfig_t *ppmConfig, uint8_t pwmProtocol);
 void pwmRxInit(const pwmConfig_t *pwmConfig);
 
+void pwmRxDecode(void);
+
 uint16_t pwmRead(uint8_t channel);
 uint16_t ppmRead(uint8_t channel);
 
@@ -24,6 +24,7 @@
 
 #include "nvic.h"
 #include "io.h"
+#include "dma.h"
 
 #include "bus_spi.h"
 #include "system.h"
@@ -35,9 +36,6 @@
     #define SDCARD_PROFILING
 #endif
 
-#define SET_CS_HIGH          IOHi(sdCardCsPin)
-#define SET_CS_LOW           IOLo(sdCardCsPin)
-
 #define SDCARD_INIT_NUM_DUMMY_BYTES 10
 #define SDCARD_MAXIMUM_BYTE_DELAY_FOR_CMD_REPLY 8
 // Chosen so that CMD8 will have the same CRC as CMD0:
@@ -75,6 +73,7 @@ typedef struct sdcard_t {
         uint8_t *buffer;
         uint32_t blockIndex;
         uint8_t chunkIndex;
+        bool useDMA;
 
         sdcard_operationCompleteCallback_c callback;
         uint32_t callbackData;
@@ -108,6 +107,7 @@ static sdcard_t sdcard;
 
 #ifdef SDCARD_DMA_CHANNEL_TX
     static bool useDMAForTx;
+    static dmaIdentifier_e sdcardDmaIdentifier;
 #if defined(USE_HAL_DRIVER)
     DMA_HandleTypeDef *sdDMAHandle;
 #endif
@@ -122,7 +122,7 @@ STATIC_ASSERT(sizeof(sdcardCSD_t) == 16, sdcard_csd_bitfields_didnt_pack_properl
 static IO_t sdCardDetectPin = IO_NONE;
 #endif
 
-static IO_t sdCardCsPin = IO_NONE;
+static spiBusDevice_t sdcardSpiDevice;
 
 void sdcardInsertionDetectDeinit(void)
 {
@@ -173,7 +173,7 @@ bool sdcard_isFunctional(void)
 
 static void sdcard_select(void)
 {
-    SET_CS_LOW;
+    spiBusAcquire(&sdcardSpiDevice);
 }
 
 static void sdcard_deselect(void)
@@ -184,7 +184,7 @@ static void sdcard_deselect(void)
     while (spiIsBusBusy(SDCARD_SPI_INSTANCE)) {
     }
 
-    SET_CS_HIGH;
+    spiBusRelease(&sdcardSpiDevice);
 }
 
 /**
@@ -201,7 +201,7 @@ static void sdcard_reset(void)
     }
 
     if (sdcard.state >= SDCARD_STATE_READY) {
-        spiSetDivisor(SDCARD_SPI_INSTANCE, SDCARD_SPI_INITIALIZATION_CLOCK_DIVIDER);
+        spiBusSetDivisor(&sdcardSpiDevice, SDCARD_SPI_INITIALIZATION_CLOCK_DIVIDER);
     }
 
     sdcard.failureCount++;
@@ -404,6 +404,18 @@ static bool sdcard_sendDataBlockFinish(void)
     return (dataResponseToken & 0x1F) == 0x05;
 }
 
+/**
+ * The TX stream is time-shared with the SPI bus transaction queue, which doesn't run while we hold the bus.
+ */
+static bool sdcard_acquireDMA(void)
+{
+#ifdef SDCARD_DMA_CHANNEL_TX
+    return useDMAForTx && dmaAcquire(sdcardDmaIdentifier);
+#else
+    return useDMAForTx;
+#endif
+}
+
 /**
  * Begin sending a buffer of SDCARD_BLOCK_SIZE bytes to the SD card.
  */
@@ -414,7 +426,8 @@ static void sdcard_sendDataBlockBegin(uint8_t *buffer, bool multiBlockWrite)
 
     spiTransferByte(SDCARD_SPI_INSTANCE, multiBlockWrite ? SDCARD_MULTIPLE_BLOCK_WRITE_START_TOKEN : SDCARD_SINGLE_BLOCK_WRITE_START_TOKEN);
 
-    if (useDMAForTx) {
+    sdcard.pendingOperation.useDMA = sdcard_acquireDMA();
+    if (sdcard.pendingOperation.useDMA) {
 #ifdef SDCARD_DMA_CHANNEL_TX
 #if defined(USE_HAL_DRIVER)
         sdDMAHandle = spiSetDMATransmit(SDCARD_DMA_CHANNEL_TX, SDCARD_DMA_CHANNEL, SDCARD_SPI_INSTANCE, buffer, SDCARD_BLOCK_SIZE);
@@ -550,12 +563,14 @@ static bool sdcard_checkInitDone(void)
 void sdcard_init(bool useDMA)
 {
 #ifdef SDCARD_DMA_CHANNEL_TX
-    useDMAForTx = useDMA;
+    sdcardDmaIdentifier = dmaGetIdentifier(SDCARD_DMA_CHANNEL_TX);
+    useDMAForTx = useDMA && dmaInitShared(sdcardDmaIdentifier, OWNER_SDCARD, 0);
 #else
     // DMA is not available
     (void) useDMA;
 #endif
 
+    IO_t sdCardCsPin = IO_NONE;
 #ifdef SDCARD_SPI_CS_PIN
     sdCardCsPin = IOGetByTag(IO_TAG(SDCARD_SPI_CS_PIN));
     IOInit(sdCardCsPin, OWNER_SDCARD_CS, 0);
@@ -563,13 +578,13 @@ void sdcard_init(bool useDMA)
 #endif // SDCARD_SPI_CS_PIN
 
     // Max frequency is initially 400kHz
-    spiSetDivisor(SDCARD_SPI_INSTANCE, SDCARD_SPI_INITIALIZATION_CLOCK_DIVIDER);
+    spiBusDeviceInit(&sdcardSpiDevice, SDCARD_SPI_INSTANCE, sdCardCsPin, SDCARD_SPI_INITIALIZATION_CLOCK_DIVIDER);
 
     // SDCard wants 1ms minimum delay after power is applied to it
     delay(1000);
 
     // Transmit at least 74 dummy clock cycles with CS high so the SD card can start up
-    SET_CS_HIGH;
+    spiSetDivisor(SDCARD_SPI_INSTANCE, SDCARD_SPI_INITIALIZATION_CLOCK_DIVIDER);
 
     spiTransfer(SDCARD_SPI_INSTANCE, NULL, NULL, SDCARD_INIT_NUM_DUMMY_BYTES);
 
@@ -723,7 +738,7 @@ bool sdcard_poll(void)
                 }
 
                 // Now we're done with init and we can switch to the full speed clock (<25MHz)
-                spiSetDivisor(SDCARD_SPI_INSTANCE, SDCARD_SPI_FULL_SPEED_CLOCK_DIVIDER);
+                spiBusSetDivisor(&sdcardSpiDevice, SDCARD_SPI_FULL_SPEED_CLOCK_DIVIDER);
 
                 sdcard.multiWriteBlocksRemain = 0;
 
@@ -739,7 +754,7 @@ bool sdcard_poll(void)
 #if defined(USE_HAL_DRIVER)
             //if (useDMAForTx && __HAL_DMA_GET_FLAG(sdDMAHandle, SDCARD_DMA_CHANNEL_TX_COMPLETE_FLAG) == SET) {
             //if (useDMAForTx && HAL_DMA_PollForTransfer(sdDMAHandle, HAL_DMA_FULL_TRANSFER, HAL_MAX_DELAY) == HAL_OK) {
-            if (useDMAForTx && (sdDMAHandle->State == HAL_DMA_STATE_READY)) {
+            if (sdcard.pendingOperation.useDMA && (sdDMAHandle->State == HAL_DMA_STATE_READY)) {
                 //__HAL_DMA_CLEAR_FLAG(sdDMAHandle, SDCARD_DMA_CHANNEL_TX_COMPLETE_FLAG);
 
                 //__HAL_DMA_DISABLE(sdDMAHandle);
@@ -754,15 +769,16 @@ bool sdcard_poll(void)
                 }
 
                 HAL_SPI_DMAStop(spiHandleByInstance(SDCARD_SPI_INSTANCE));
+                dmaRelease(sdcardDmaIdentifier);
 
                 sendComplete = true;
             }
 #else
 #ifdef SDCARD_DMA_CHANNEL
-            if (useDMAForTx && DMA_GetFlagStatus(SDCARD_DMA_CHANNEL_TX, SDCARD_DMA_CHANNEL_TX_COMPLETE_FLAG) == SET) {
+            if (sdcard.pendingOperation.useDMA && DMA_GetFlagStatus(SDCARD_DMA_CHANNEL_TX, SDCARD_DMA_CHANNEL_TX_COMPLETE_FLAG) == SET) {
                 DMA_ClearFlag(SDCARD_DMA_CHANNEL_TX, SDCARD_DMA_CHANNEL_TX_COMPLETE_FLAG);
 #else
-            if (useDMAForTx && DMA_GetFlagStatus(SDCARD_DMA_CHANNEL_TX_COMPLETE_FLAG) == SET) {
+            if (sdcard.pendingOperation.useDMA && DMA_GetFlagStatus(SDCARD_DMA_CHANNEL_TX_COMPLETE_FLAG) == SET) {
                 DMA_ClearFlag(SDCARD_DMA_CHANNEL_TX_COMPLETE_FLAG);
 #endif
 
@@ -778,12 +794,13 @@ bool sdcard_poll(void)
                 }
 
                 SPI_I2S_DMACmd(SDCARD_SPI_INSTANCE, SPI_I2S_DMAReq_Tx, DISABLE);
+                dmaRelease(sdcardDmaIdentifier);
 
                 sendComplete = true;
             }
 #endif
 #endif
-            if (!useDMAForTx) {
+            if (!sdcard.pendingOperation.useDMA) {
                 // Send another chunk
                 spiTransfer(SDCARD_SPI_INSTANCE, NULL, sdcard.pendingOperation.buffer + SDCARD_NON_DMA_CHUNK_SIZE * sdcard.pendingOperation.chunkIndex, SDCARD_NON_DMA_CHUNK_SIZE);
 
@@ -71,6 +71,23 @@ uint8_t serialRead(serialPort_t *instance)
     return instance->vTable->serialRead(instance);
 }
 
+// Reads up to count bytes that are already waiting, returns the number of bytes read.
+int serialReadBuf(serialPort_t *instance, uint8_t *data, int count)
+{
+    if (instance->vTable->readBuf) {
+        return instance->vTable->readBuf(instance, data, count);
+    }
+
+    int waiting = serialRxBytesWaiting(instance);
+    if (count > waiting) {
+        count = waiting;
+    }
+    for (int i = 0; i < count; i++) {
+        data[i] = serialRead(instance);
+    }
+    return count;
+}
+
 void serialSetBaudRate(serialPort_t *instance, uint32_t baudRate)
 {
     instance->vTable->serialSetBaudRate(instance, baudRate);
@@ -86,6 +103,18 @@ void serialSetMode(serialPort_t *instance, portMode_t mode)
     instance->vTable->setMode(instance, mode);
 }
 
+/*
+ * Receive whole frames, delimited by the line going idle, instead of one callback per byte. Once
+ * set the per byte callback and serialRead() no longer see the received data.
+ */
+bool serialSetRxFrameCallback(serialPort_t *instance, serialReceiveFrameCallbackPtr callback)
+{
+    if (!instance->vTable->setRxFrameCallback) {
+        return false;
+    }
+    return instance->vTable->setRxFrameCallback(instance, callback);
+}
+
 void serialWriteBufShim(void *instance, const uint8_t *data, int count)
 {
     serialWriteBuf((serialPort_t *)instance, data, count);
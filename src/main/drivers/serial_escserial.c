@@ -821,6 +821,8 @@ const struct serialPortVTable escSerialVTable[] = {
         .isSerialTransmitBufferEmpty = isEscSerialTransmitBufferEmpty,
         .setMode = escSerialSetMode,
         .writeBuf = NULL,
+        .readBuf = NULL,
+        .setRxFrameCallback = NULL,
         .beginWrite = NULL,
         .endWrite = NULL
     }
@@ -17,6 +17,7 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "platform.h"
 
@@ -25,11 +26,14 @@
 #include "build/build_config.h"
 #include "build/atomic.h"
 
+#include "common/maths.h"
 #include "common/utils.h"
 
 #include "nvic.h"
 #include "system.h"
 #include "io.h"
+#include "io_impl.h"
+#include "dma.h"
 #include "timer.h"
 
 #include "serial.h"
@@ -38,6 +42,23 @@
 #define RX_TOTAL_BITS 10
 #define TX_TOTAL_BITS 10
 
+#if (defined(STM32F1) || defined(STM32F3)) && (defined(USE_DSHOT) || defined(LED_STRIP))
+// the timer channel DMA mapping is only compiled into timerHardware with these features
+#define USE_SOFTSERIAL_RX_DMA
+#endif
+
+#ifdef USE_SOFTSERIAL_RX_DMA
+/*
+ * With DMA the RX pin is sampled SOFTSERIAL_RX_OVERSAMPLE times per bit into a circular buffer,
+ * paced by the softserial timer, and each half of the buffer is decoded in the DMA interrupt.
+ * The half length follows the baud rate so the interrupt runs at about SOFTSERIAL_RX_DECODE_RATE_HZ,
+ * and the bit timer interrupt only runs while transmitting.
+ */
+#define SOFTSERIAL_RX_OVERSAMPLE        3
+#define SOFTSERIAL_RX_DECODE_RATE_HZ    500
+#define SOFTSERIAL_RX_SAMPLE_COUNT      256
+#endif
+
 #if defined(USE_SOFTSERIAL1) && defined(USE_SOFTSERIAL2)
 #define MAX_SOFTSERIAL_PORTS 2
 #else
@@ -73,6 +94,15 @@ typedef struct softSerial_s {
 
     timerCCHandlerRec_t timerCb;
     timerCCHandlerRec_t edgeCb;
+
+#ifdef USE_SOFTSERIAL_RX_DMA
+    bool             rxDmaEnabled;
+    uint8_t          txTickCount;
+    uint8_t          rxSampleCountdown;
+    uint16_t         rxPinMask;
+    uint16_t         rxSampleHalfLength;
+    volatile uint16_t rxSamples[SOFTSERIAL_RX_SAMPLE_COUNT];
+#endif
 } softSerial_t;
 
 extern timerHardware_t* serialTimerHardware;
@@ -122,6 +152,13 @@ static bool isTimerPeriodTooLarge(uint32_t timerPeriod)
 
 static void serialTimerTxConfig(const timerHardware_t *timerHardwarePtr, uint8_t reference, uint32_t baud)
 {
+#ifdef USE_SOFTSERIAL_RX_DMA
+    if (softSerialPorts[reference].rxDmaEnabled) {
+        // the timer ticks at the RX sample rate
+        baud *= SOFTSERIAL_RX_OVERSAMPLE;
+    }
+#endif
+
     uint32_t clock = SystemCoreClock;
     uint32_t timerPeriod;
     do {
@@ -164,6 +201,123 @@ static void serialTimerRxConfig(const timerHardware_t *timerHardwarePtr, uint8_t
     timerChConfigCallbacks(timerHardwarePtr, &softSerialPorts[reference].edgeCb, NULL);
 }
 
+static void storeRxByte(softSerial_t *softSerial, uint8_t rxByte)
+{
+    if (softSerial->port.rxCallback) {
+        softSerial->port.rxCallback(rxByte);
+    } else {
+        softSerial->port.rxBuffer[softSerial->port.rxBufferHead] = rxByte;
+        softSerial->port.rxBufferHead = (softSerial->port.rxBufferHead + 1) % softSerial->port.rxBufferSize;
+    }
+}
+
+#ifdef USE_SOFTSERIAL_RX_DMA
+// rxBitIndex is the number of bits sampled so far plus one, zero while searching for a start bit
+static void decodeRxSamples(softSerial_t *softSerial, const volatile uint16_t *samples, int count)
+{
+    const uint16_t markLevel = (softSerial->port.options & SERIAL_INVERTED) ? 0 : softSerial->rxPinMask;
+
+    for (int i = 0; i < count; i++) {
+        const bool mark = (samples[i] & softSerial->rxPinMask) == markLevel;
+
+        if (!softSerial->rxBitIndex) {
+            if (!mark) {
+                // the start bit edge was in the last sample period, its middle is the next sample
+                softSerial->rxBitIndex = 1;
+                softSerial->rxSampleCountdown = 1;
+                softSerial->internalRxBuffer = 0;
+            }
+            continue;
+        }
+
+        if (--softSerial->rxSampleCountdown) {
+            continue;
+        }
+        softSerial->rxSampleCountdown = SOFTSERIAL_RX_OVERSAMPLE;
+
+        const uint8_t bitIndex = softSerial->rxBitIndex - 1;
+        if (bitIndex == 0 && mark) {
+            // glitch, not a start bit
+            softSerial->rxBitIndex = 0;
+            continue;
+        }
+        softSerial->internalRxBuffer |= mark << bitIndex;
+
+        if (bitIndex < RX_TOTAL_BITS - 1) {
+            softSerial->rxBitIndex++;
+            continue;
+        }
+
+        softSerial->rxBitIndex = 0;
+        if (!mark) {
+            softSerial->receiveErrors++;    // no stop bit
+        } else if (softSerial->port.mode & MODE_RX) {
+            storeRxByte(softSerial, (softSerial->internalRxBuffer >> 1) & 0xFF);
+        }
+    }
+}
+
+static void softSerialRxDmaIrqHandler(dmaChannelDescriptor_t *descriptor)
+{
+    softSerial_t *softSerial = (softSerial_t *)descriptor->userParam;
+
+    if (DMA_GET_FLAG_STATUS(descriptor, DMA_IT_HTIF)) {
+        DMA_CLEAR_FLAG(descriptor, DMA_IT_HTIF);
+        decodeRxSamples(softSerial, &softSerial->rxSamples[0], softSerial->rxSampleHalfLength);
+    }
+    if (DMA_GET_FLAG_STATUS(descriptor, DMA_IT_TCIF)) {
+        DMA_CLEAR_FLAG(descriptor, DMA_IT_TCIF);
+        decodeRxSamples(softSerial, &softSerial->rxSamples[softSerial->rxSampleHalfLength], softSerial->rxSampleHalfLength);
+    }
+}
+
+static bool serialRxDmaAvailable(const timerHardware_t *timerHardwarePtr, uint8_t portIndex)
+{
+    return timerHardwarePtr->dmaChannel && dmaIsAvailable(timerHardwarePtr->dmaIrqHandler, OWNER_SERIAL_RX, RESOURCE_INDEX(portIndex) + RESOURCE_SOFT_OFFSET, DMA_ALLOC_PRIORITY_NORMAL);
+}
+
+// call after the timer is configured
+static void serialRxDmaConfig(softSerial_t *softSerial, uint8_t portIndex, uint32_t baud)
+{
+    const timerHardware_t *timerHardwarePtr = softSerial->rxTimerHardware;
+
+    softSerial->rxPinMask = IO_Pin(softSerial->rxIO);
+    softSerial->rxSampleHalfLength = constrain(baud * SOFTSERIAL_RX_OVERSAMPLE / SOFTSERIAL_RX_DECODE_RATE_HZ, 8, SOFTSERIAL_RX_SAMPLE_COUNT / 2);
+    softSerial->rxBitIndex = 0;
+
+    // no capture interrupt, the channel only raises a DMA request on every timer period
+    timerChConfigCallbacks(timerHardwarePtr, NULL, NULL);
+    timerChConfigOC(timerHardwarePtr, false, false);
+
+    // checked by serialRxDmaUsable()
+    dmaInit(timerHardwarePtr->dmaIrqHandler, OWNER_SERIAL_RX, RESOURCE_INDEX(portIndex) + RESOURCE_SOFT_OFFSET);
+    dmaSetHandler(timerHardwarePtr->dmaIrqHandler, softSerialRxDmaIrqHandler, NVIC_PRIO_SOFTSERIAL_DMA, (uint32_t)softSerial);
+
+    DMA_Cmd(timerHardwarePtr->dmaChannel, DISABLE);
+    DMA_DeInit(timerHardwarePtr->dmaChannel);
+
+    DMA_InitTypeDef DMA_InitStructure;
+    DMA_StructInit(&DMA_InitStructure);
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&IO_GPIO(softSerial->rxIO)->IDR;
+    DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)softSerial->rxSamples;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
+    DMA_InitStructure.DMA_BufferSize = softSerial->rxSampleHalfLength * 2;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_HalfWord;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_HalfWord;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_Medium;
+    DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+    DMA_Init(timerHardwarePtr->dmaChannel, &DMA_InitStructure);
+
+    DMA_ITConfig(timerHardwarePtr->dmaChannel, DMA_IT_HT | DMA_IT_TC, ENABLE);
+    DMA_Cmd(timerHardwarePtr->dmaChannel, ENABLE);
+
+    TIM_DMACmd(timerHardwarePtr->tim, timerDmaSource(timerHardwarePtr->channel), ENABLE);
+}
+#endif
+
 static void resetBuffers(softSerial_t *softSerial)
 {
     softSerial->port.rxBufferSize = SOFTSERIAL_BUFFER_SIZE;
@@ -177,23 +331,54 @@ static void resetBuffers(softSerial_t *softSerial)
     softSerial->port.txBufferHead = 0;
 }
 
-serialPort_t *openSoftSerial(softSerialPortIndex_e portIndex, serialReceiveCallbackPtr rxCallback, uint32_t baud, portOptions_t options)
+static void getTimerHardware(softSerialPortIndex_e portIndex, const timerHardware_t **rxTimerHardware, const timerHardware_t **txTimerHardware)
 {
-    softSerial_t *softSerial = &(softSerialPorts[portIndex]);
-
 #ifdef USE_SOFTSERIAL1
     if (portIndex == SOFTSERIAL1) {
-        softSerial->rxTimerHardware = &(timerHardware[SOFTSERIAL_1_TIMER_RX_HARDWARE]);
-        softSerial->txTimerHardware = &(timerHardware[SOFTSERIAL_1_TIMER_TX_HARDWARE]);
+        *rxTimerHardware = &(timerHardware[SOFTSERIAL_1_TIMER_RX_HARDWARE]);
+        *txTimerHardware = &(timerHardware[SOFTSERIAL_1_TIMER_TX_HARDWARE]);
     }
 #endif
 
 #ifdef USE_SOFTSERIAL2
     if (portIndex == SOFTSERIAL2) {
-        softSerial->rxTimerHardware = &(timerHardware[SOFTSERIAL_2_TIMER_RX_HARDWARE]);
-        softSerial->txTimerHardware = &(timerHardware[SOFTSERIAL_2_TIMER_TX_HARDWARE]);
+        *rxTimerHardware = &(timerHardware[SOFTSERIAL_2_TIMER_RX_HARDWARE]);
+        *txTimerHardware = &(timerHardware[SOFTSERIAL_2_TIMER_TX_HARDWARE]);
     }
 #endif
+}
+
+#ifdef USE_SOFTSERIAL_RX_DMA
+// the DMA receiver changes the timer rate, so all ports on the timer must be able to use it
+static bool serialRxDmaUsable(const softSerial_t *softSerial)
+{
+    static const softSerialPortIndex_e portIndexes[] = {
+#ifdef USE_SOFTSERIAL1
+        SOFTSERIAL1,
+#endif
+#ifdef USE_SOFTSERIAL2
+        SOFTSERIAL2,
+#endif
+    };
+
+    for (unsigned i = 0; i < ARRAYLEN(portIndexes); i++) {
+        const timerHardware_t *rxTimerHardware;
+        const timerHardware_t *txTimerHardware;
+        getTimerHardware(portIndexes[i], &rxTimerHardware, &txTimerHardware);
+        if (txTimerHardware->tim == softSerial->txTimerHardware->tim && !serialRxDmaAvailable(rxTimerHardware, portIndexes[i])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+#endif
+
+serialPort_t *openSoftSerial(softSerialPortIndex_e portIndex, serialReceiveCallbackPtr rxCallback, uint32_t baud, portOptions_t options)
+{
+    softSerial_t *softSerial = &(softSerialPorts[portIndex]);
+
+    getTimerHardware(portIndex, &softSerial->rxTimerHardware, &softSerial->txTimerHardware);
 
     softSerial->port.vTable = softSerialVTable;
     softSerial->port.baudRate = baud;
@@ -219,10 +404,25 @@ serialPort_t *openSoftSerial(softSerialPortIndex_e portIndex, serialReceiveCallb
     softSerial->rxIO = IOGetByTag(softSerial->rxTimerHardware->tag);
     serialInputPortConfig(softSerial->rxTimerHardware->tag, portIndex);
 
+#ifdef USE_SOFTSERIAL_RX_DMA
+    softSerial->rxDmaEnabled = serialRxDmaUsable(softSerial);
+    softSerial->txTickCount = 0;
+    if (softSerial->rxDmaEnabled) {
+        // sampled as a GPIO, the timer channel is not connected to the pin
+        IOConfigGPIO(softSerial->rxIO, IOCFG_IPU);
+    }
+#endif
+
     setTxSignal(softSerial, ENABLE);
     delay(50);
 
     serialTimerTxConfig(softSerial->txTimerHardware, portIndex, baud);
+#ifdef USE_SOFTSERIAL_RX_DMA
+    if (softSerial->rxDmaEnabled) {
+        serialRxDmaConfig(softSerial, portIndex, baud);
+        return &softSerial->port;
+    }
+#endif
     serialTimerRxConfig(softSerial->rxTimerHardware, portIndex, options);
 
     return &softSerial->port;
@@ -315,12 +515,7 @@ void extractAndStoreRxByte(softSerial_t *softSerial)
 
     uint8_t rxByte = (softSerial->internalRxBuffer >> 1) & 0xFF;
 
-    if (softSerial->port.rxCallback) {
-        softSerial->port.rxCallback(rxByte);
-    } else {
-        softSerial->port.rxBuffer[softSerial->port.rxBufferHead] = rxByte;
-        softSerial->port.rxBufferHead = (softSerial->port.rxBufferHead + 1) % softSerial->port.rxBufferSize;
-    }
+    storeRxByte(softSerial, rxByte);
 }
 
 void processRxState(softSerial_t *softSerial)
@@ -352,10 +547,40 @@ void onSerialTimer(timerCCHandlerRec_t *cbRec, captureCompare_t capture)
     UNUSED(capture);
     softSerial_t *softSerial = container_of(cbRec, softSerial_t, timerCb);
 
+#ifdef USE_SOFTSERIAL_RX_DMA
+    if (softSerial->rxDmaEnabled) {
+        // the timer runs at the RX sample rate and the receiver does not need it
+        if (++softSerial->txTickCount < SOFTSERIAL_RX_OVERSAMPLE) {
+            return;
+        }
+        softSerial->txTickCount = 0;
+
+        processTxState(softSerial);
+        if (!softSerial->isTransmittingData && isSoftSerialTransmitBufferEmpty(&softSerial->port)) {
+            timerChITConfig(softSerial->txTimerHardware, DISABLE);
+        }
+        return;
+    }
+#endif
+
     processTxState(softSerial);
     processRxState(softSerial);
 }
 
+// the bit timer interrupt stops when there is nothing to send on the DMA receiver
+static void startTx(softSerial_t *softSerial)
+{
+#ifdef USE_SOFTSERIAL_RX_DMA
+    if (softSerial->rxDmaEnabled) {
+        ATOMIC_BLOCK(NVIC_PRIO_TIMER) {
+            timerChITConfig(softSerial->txTimerHardware, ENABLE);
+        }
+    }
+#else
+    UNUSED(softSerial);
+#endif
+}
+
 void onSerialRxPinChange(timerCCHandlerRec_t *cbRec, captureCompare_t capture)
 {
     UNUSED(capture);
@@ -450,6 +675,48 @@ void softSerialWriteByte(serialPort_t *s, uint8_t ch)
 
     s->txBuffer[s->txBufferHead] = ch;
     s->txBufferHead = (s->txBufferHead + 1) % s->txBufferSize;
+
+    startTx((softSerial_t *)s);
+}
+
+int softSerialReadBuf(serialPort_t *instance, uint8_t *data, int count)
+{
+    const uint32_t waiting = softSerialRxBytesWaiting(instance);
+    if ((uint32_t)count > waiting) {
+        count = waiting;
+    }
+
+    for (int remaining = count; remaining > 0; ) {
+        const uint32_t length = MIN((uint32_t)remaining, instance->rxBufferSize - instance->rxBufferTail);
+        memcpy(data, (const uint8_t *)&instance->rxBuffer[instance->rxBufferTail], length);
+        data += length;
+        remaining -= length;
+        instance->rxBufferTail = (instance->rxBufferTail + length) % instance->rxBufferSize;
+    }
+
+    return count;
+}
+
+void softSerialWriteBuf(serialPort_t *instance, const void *data, int count)
+{
+    if ((instance->mode & MODE_TX) == 0) {
+        return;
+    }
+
+    const uint8_t *p = data;
+    while (count > 0) {
+        uint32_t bytesFree;
+        while (!(bytesFree = softSerialTxBytesFree(instance))) {
+        };
+
+        const uint32_t length = MIN((uint32_t)count, MIN(bytesFree, instance->txBufferSize - instance->txBufferHead));
+        memcpy((uint8_t *)&instance->txBuffer[instance->txBufferHead], p, length);
+        p += length;
+        count -= length;
+        instance->txBufferHead = (instance->txBufferHead + length) % instance->txBufferSize;
+
+        startTx((softSerial_t *)instance);
+    }
 }
 
 void softSerialSetBaudRate(serialPort_t *s, uint32_t baudRate)
@@ -477,7 +744,9 @@ const struct serialPortVTable softSerialVTable[] = {
         .serialSetBaudRate = softSerialSetBaudRate,
         .isSerialTransmitBufferEmpty = isSoftSerialTransmitBufferEmpty,
         .setMode = softSerialSetMode,
-        .writeBuf = NULL,
+        .writeBuf = softSerialWriteBuf,
+        .readBuf = softSerialReadBuf,
+        .setRxFrameCallback = NULL,
         .beginWrite = NULL,
         .endWrite = NULL
     }
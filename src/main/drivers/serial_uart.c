@@ -22,12 +22,15 @@
 */
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "platform.h"
 
 #include "build/build_config.h"
 
+#include "common/maths.h"
 #include "common/utils.h"
+#include "dma.h"
 #include "gpio.h"
 #include "inverter.h"
 
@@ -141,6 +144,7 @@ serialPort_t *uartOpen(USART_TypeDef *USARTx, serialReceiveCallbackPtr rxCallbac
     s->port.txBufferHead = s->port.txBufferTail = 0;
     // callback works for IRQ-based RX ONLY
     s->port.rxCallback = rxCallback;
+    s->port.rxFrameCallback = NULL;
     s->port.mode = mode;
     s->port.baudRate = baudRate;
     s->port.options = options;
@@ -272,6 +276,71 @@ void uartSetMode(serialPort_t *instance, portMode_t mode)
     uartReconfigure(uartPort);
 }
 
+// start the next frame at the beginning of the receive buffer, so frames are delivered without copying
+static void uartRxFrameRestart(uartPort_t *s)
+{
+#ifdef STM32F4
+    if (s->rxDMAStream) {
+        DMA_Cmd(s->rxDMAStream, DISABLE);
+        while (s->rxDMAStream->CR & DMA_SxCR_EN) {
+        }
+        dmaChannelDescriptor_t *descriptor = getDmaDescriptor(s->rxDMAStream);
+        DMA_CLEAR_FLAG(descriptor, DMA_IT_TCIF | DMA_IT_HTIF | DMA_IT_TEIF | DMA_IT_DMEIF | DMA_IT_FEIF);
+        s->rxDMAStream->NDTR = s->port.rxBufferSize;
+        DMA_Cmd(s->rxDMAStream, ENABLE);
+        s->rxDMAPos = s->port.rxBufferSize;
+        return;
+    }
+#else
+    if (s->rxDMAChannel) {
+        DMA_Cmd(s->rxDMAChannel, DISABLE);
+        s->rxDMAChannel->CNDTR = s->port.rxBufferSize;
+        DMA_Cmd(s->rxDMAChannel, ENABLE);
+        s->rxDMAPos = s->port.rxBufferSize;
+        return;
+    }
+#endif
+    s->port.rxBufferHead = s->port.rxBufferTail = 0;
+}
+
+// called from the USART interrupt when the line goes idle after receiving data
+void uartRxFrameComplete(uartPort_t *s)
+{
+    if (!s->port.rxFrameCallback) {
+        return;
+    }
+
+#ifdef STM32F4
+    const uint32_t length = s->rxDMAStream ? s->port.rxBufferSize - s->rxDMAStream->NDTR : s->port.rxBufferHead;
+#else
+    const uint32_t length = s->rxDMAChannel ? s->port.rxBufferSize - s->rxDMAChannel->CNDTR : s->port.rxBufferHead;
+#endif
+    if (length) {
+        s->port.rxFrameCallback((const uint8_t *)s->port.rxBuffer, length);
+    }
+
+    uartRxFrameRestart(s);
+}
+
+static bool uartSetRxFrameCallback(serialPort_t *instance, serialReceiveFrameCallbackPtr callback)
+{
+    uartPort_t *s = (uartPort_t *)instance;
+
+    if (!(s->port.mode & MODE_RX)) {
+        return false;
+    }
+
+    USART_ITConfig(s->USARTx, USART_IT_IDLE, DISABLE);
+
+    s->port.rxFrameCallback = callback;
+    if (callback) {
+        uartRxFrameRestart(s);
+        USART_ITConfig(s->USARTx, USART_IT_IDLE, ENABLE);
+    }
+
+    return true;
+}
+
 void uartStartTxDMA(uartPort_t *s)
 {
 #ifdef STM32F4
@@ -302,6 +371,49 @@ void uartStartTxDMA(uartPort_t *s)
 #endif
 }
 
+/*
+ * A driver without a non-DMA mode has taken one of the port's streams, carry on interrupt driven.
+ * Anything in flight on the stream is lost, streams are only contested while the drivers are initialised.
+ */
+void uartDmaRevoke(dmaIdentifier_e identifier, uint32_t revokeParam)
+{
+    uartPort_t *s = (uartPort_t *)revokeParam;
+
+#ifdef STM32F4
+    if (s->rxDMAStream && dmaGetIdentifier(s->rxDMAStream) == identifier) {
+        USART_DMACmd(s->USARTx, USART_DMAReq_Rx, DISABLE);
+        DMA_Cmd(s->rxDMAStream, DISABLE);
+        s->rxDMAStream = NULL;
+#else
+    if (s->rxDMAChannel && dmaGetIdentifier(s->rxDMAChannel) == identifier) {
+        USART_DMACmd(s->USARTx, USART_DMAReq_Rx, DISABLE);
+        DMA_Cmd(s->rxDMAChannel, DISABLE);
+        s->rxDMAChannel = NULL;
+#endif
+        s->port.rxBufferHead = s->port.rxBufferTail = 0;
+        if (s->port.mode & MODE_RX) {
+            USART_ClearITPendingBit(s->USARTx, USART_IT_RXNE);
+            USART_ITConfig(s->USARTx, USART_IT_RXNE, ENABLE);
+        }
+        return;
+    }
+
+    USART_DMACmd(s->USARTx, USART_DMAReq_Tx, DISABLE);
+#ifdef STM32F4
+    DMA_ITConfig(s->txDMAStream, DMA_IT_TC | DMA_IT_FE | DMA_IT_TE | DMA_IT_DME, DISABLE);
+    DMA_Cmd(s->txDMAStream, DISABLE);
+    s->txDMAStream = NULL;
+#else
+    DMA_ITConfig(s->txDMAChannel, DMA_IT_TC, DISABLE);
+    DMA_Cmd(s->txDMAChannel, DISABLE);
+    s->txDMAChannel = NULL;
+#endif
+    s->txDMAEmpty = true;
+    if (s->port.txBufferHead != s->port.txBufferTail) {
+        USART_ITConfig(s->USARTx, USART_IT_TXE, ENABLE);
+    }
+}
+
 uint32_t uartTotalRxBytesWaiting(const serialPort_t *instance)
 {
     const uartPort_t *s = (const uartPort_t*)instance;
@@ -407,16 +519,46 @@ uint8_t uartRead(serialPort_t *instance)
     return ch;
 }
 
-void uartWrite(serialPort_t *instance, uint8_t ch)
+int uartReadBuf(serialPort_t *instance, uint8_t *data, int count)
 {
     uartPort_t *s = (uartPort_t *)instance;
-    s->port.txBuffer[s->port.txBufferHead] = ch;
-    if (s->port.txBufferHead + 1 >= s->port.txBufferSize) {
-        s->port.txBufferHead = 0;
+
+    const uint32_t waiting = uartTotalRxBytesWaiting(instance);
+    if ((uint32_t)count > waiting) {
+        count = waiting;
+    }
+
+#ifdef STM32F4
+    const bool rxDMA = s->rxDMAStream != NULL;
+#else
+    const bool rxDMA = s->rxDMAChannel != NULL;
+#endif
+    uint32_t tail = rxDMA ? s->port.rxBufferSize - s->rxDMAPos : s->port.rxBufferTail;
+
+    // at most two spans, the second one starting from the beginning of the buffer
+    int remaining = count;
+    while (remaining > 0) {
+        const uint32_t length = MIN((uint32_t)remaining, s->port.rxBufferSize - tail);
+        memcpy(data, (const uint8_t *)&s->port.rxBuffer[tail], length);
+        data += length;
+        remaining -= length;
+        tail += length;
+        if (tail >= s->port.rxBufferSize) {
+            tail = 0;
+        }
+    }
+
+    if (rxDMA) {
+        s->rxDMAPos = s->port.rxBufferSize - tail;
     } else {
-        s->port.txBufferHead++;
+        s->port.rxBufferTail = tail;
     }
 
+    return count;
+}
+
+static void uartStartTx(uartPort_t *s)
+{
 #ifdef STM32F4
     if (s->txDMAStream) {
         if (!(s->txDMAStream->CR & 1))
@@ -430,6 +572,42 @@ void uartWrite(serialPort_t *instance, uint8_t ch)
     }
 }
 
+void uartWrite(serialPort_t *instance, uint8_t ch)
+{
+    uartPort_t *s = (uartPort_t *)instance;
+    s->port.txBuffer[s->port.txBufferHead] = ch;
+    if (s->port.txBufferHead + 1 >= s->port.txBufferSize) {
+        s->port.txBufferHead = 0;
+    } else {
+        s->port.txBufferHead++;
+    }
+
+    uartStartTx(s);
+}
+
+void uartWriteBuf(serialPort_t *instance, const void *data, int count)
+{
+    uartPort_t *s = (uartPort_t *)instance;
+    const uint8_t *p = data;
+
+    while (count > 0) {
+        uint32_t bytesFree;
+        while (!(bytesFree = uartTotalTxBytesFree(instance))) {
+        };
+
+        // copy up to the end of the buffer, the remainder goes in on the next pass
+        uint32_t length = MIN((uint32_t)count, MIN(bytesFree, s->port.txBufferSize - s->port.txBufferHead));
+        memcpy((uint8_t *)&s->port.txBuffer[s->port.txBufferHead], p, length);
+        p += length;
+        count -= length;
+
+        const uint32_t head = s->port.txBufferHead + length;
+        s->port.txBufferHead = (head >= s->port.txBufferSize) ? 0 : head;
+
+        uartStartTx(s);
+    }
+}
+
 const struct serialPortVTable uartVTable[] = {
     {
         .serialWrite = uartWrite,
@@ -439,7 +617,9 @@ const struct serialPortVTable uartVTable[] = {
         .serialSetBaudRate = uartSetBaudRate,
         .isSerialTransmitBufferEmpty = isUartTransmitBufferEmpty,
         .setMode = uartSetMode,
-        .writeBuf = NULL,
+        .writeBuf = uartWriteBuf,
+        .readBuf = uartReadBuf,
+        .setRxFrameCallback = uartSetRxFrameCallback,
         .beginWrite = NULL,
         .endWrite = NULL,
     }
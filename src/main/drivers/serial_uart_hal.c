@@ -23,11 +23,13 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "platform.h"
 
 #include "build/build_config.h"
 
+#include "common/maths.h"
 #include "common/utils.h"
 #include "io.h"
 #include "nvic.h"
@@ -359,16 +361,41 @@ uint8_t uartRead(serialPort_t *instance)
     return ch;
 }
 
-void uartWrite(serialPort_t *instance, uint8_t ch)
+int uartReadBuf(serialPort_t *instance, uint8_t *data, int count)
 {
     uartPort_t *s = (uartPort_t *)instance;
-    s->port.txBuffer[s->port.txBufferHead] = ch;
-    if (s->port.txBufferHead + 1 >= s->port.txBufferSize) {
-        s->port.txBufferHead = 0;
+
+    const uint32_t waiting = uartTotalRxBytesWaiting(instance);
+    if ((uint32_t)count > waiting) {
+        count = waiting;
+    }
+
+    uint32_t tail = s->rxDMAStream ? s->port.rxBufferSize - s->rxDMAPos : s->port.rxBufferTail;
+
+    // at most two spans, the second one starting from the beginning of the buffer
+    int remaining = count;
+    while (remaining > 0) {
+        const uint32_t length = MIN((uint32_t)remaining, s->port.rxBufferSize - tail);
+        memcpy(data, (const uint8_t *)&s->port.rxBuffer[tail], length);
+        data += length;
+        remaining -= length;
+        tail += length;
+        if (tail >= s->port.rxBufferSize) {
+            tail = 0;
+        }
+    }
+
+    if (s->rxDMAStream) {
+        s->rxDMAPos = s->port.rxBufferSize - tail;
     } else {
-        s->port.txBufferHead++;
+        s->port.rxBufferTail = tail;
     }
 
+    return count;
+}
+
+static void uartStartTx(uartPort_t *s)
+{
     if (s->txDMAStream) {
         if (!(s->txDMAStream->CR & 1))
             uartStartTxDMA(s);
@@ -377,6 +404,42 @@ void uartWrite(serialPort_t *instance, uint8_t ch)
     }
 }
 
+void uartWrite(serialPort_t *instance, uint8_t ch)
+{
+    uartPort_t *s = (uartPort_t *)instance;
+    s->port.txBuffer[s->port.txBufferHead] = ch;
+    if (s->port.txBufferHead + 1 >= s->port.txBufferSize) {
+        s->port.txBufferHead = 0;
+    } else {
+        s->port.txBufferHead++;
+    }
+
+    uartStartTx(s);
+}
+
+void uartWriteBuf(serialPort_t *instance, const void *data, int count)
+{
+    uartPort_t *s = (uartPort_t *)instance;
+    const uint8_t *p = data;
+
+    while (count > 0) {
+        uint32_t bytesFree;
+        while (!(bytesFree = uartTotalTxBytesFree(instance))) {
+        };
+
+        // copy up to the end of the buffer, the remainder goes in on the next pass
+        uint32_t length = MIN((uint32_t)count, MIN(bytesFree, s->port.txBufferSize - s->port.txBufferHead));
+        memcpy((uint8_t *)&s->port.txBuffer[s->port.txBufferHead], p, length);
+        p += length;
+        count -= length;
+
+        const uint32_t head = s->port.txBufferHead + length;
+        s->port.txBufferHead = (head >= s->port.txBufferSize) ? 0 : head;
+
+        uartStartTx(s);
+    }
+}
+
 const struct serialPortVTable uartVTable[] = {
     {
         .serialWrite = uartWrite,
@@ -386,7 +449,9 @@ const struct serialPortVTable uartVTable[] = {
         .serialSetBaudRate = uartSetBaudRate,
         .isSerialTransmitBufferEmpty = isUartTransmitBufferEmpty,
         .setMode = uartSetMode,
-        .writeBuf = NULL,
+        .writeBuf = uartWriteBuf,
+        .readBuf = uartReadBuf,
+        .setRxFrameCallback = NULL,
         .beginWrite = NULL,
         .endWrite = NULL,
     }
@@ -17,11 +17,15 @@
 
 #pragma once
 
+#include "dma.h"
+
 // device specific uart implementation is defined here
 
 extern const struct serialPortVTable uartVTable[];
 
 void uartStartTxDMA(uartPort_t *s);
+void uartRxFrameComplete(uartPort_t *s);
+void uartDmaRevoke(dmaIdentifier_e identifier, uint32_t revokeParam);
 
 uartPort_t *serialUART1(uint32_t baudRate, portMode_t mode, portOptions_t options);
 uartPort_t *serialUART2(uint32_t baudRate, portMode_t mode, portOptions_t options);
@@ -55,7 +55,7 @@ void uartIrqCallback(uartPort_t *s)
 
     if (SR & USART_FLAG_RXNE && !s->rxDMAChannel) {
         // If we registered a callback, pass crap there
-        if (s->port.rxCallback) {
+        if (s->port.rxCallback && !s->port.rxFrameCallback) {
             s->port.rxCallback(s->USARTx->DR);
         } else {
             s->port.rxBuffer[s->port.rxBufferHead++] = s->USARTx->DR;
@@ -64,7 +64,7 @@ void uartIrqCallback(uartPort_t *s)
             }
         }
     }
-    if (SR & USART_FLAG_TXE) {
+    if (SR & USART_FLAG_TXE && !s->txDMAChannel) {
         if (s->port.txBufferTail != s->port.txBufferHead) {
             s->USARTx->DR = s->port.txBuffer[s->port.txBufferTail++];
             if (s->port.txBufferTail >= s->port.txBufferSize) {
@@ -74,6 +74,11 @@ void uartIrqCallback(uartPort_t *s)
             USART_ITConfig(s->USARTx, USART_IT_TXE, DISABLE);
         }
     }
+    if ((SR & USART_FLAG_IDLE) && s->port.rxFrameCallback) {
+        // the status register read above followed by a data register read clears IDLE
+        (void)s->USARTx->DR;
+        uartRxFrameComplete(s);
+    }
 }
 
 // USART1 Tx DMA Handler
@@ -110,11 +115,14 @@ uartPort_t *serialUART1(uint32_t baudRate, portMode_t mode, portOptions_t option
     s->USARTx = USART1;
 
 #ifdef USE_UART1_RX_DMA
-    dmaInit(DMA1_CH5_HANDLER, OWNER_SERIAL_RX, 1);
-    s->rxDMAChannel = DMA1_Channel5;
+    if (dmaAllocate(DMA1_CH5_HANDLER, OWNER_SERIAL_RX, 1, DMA_ALLOC_PRIORITY_LOW, uartDmaRevoke, (uint32_t)s)) {
+        s->rxDMAChannel = DMA1_Channel5;
+    }
     s->rxDMAPeripheralBaseAddr = (uint32_t)&s->USARTx->DR;
 #endif
-    s->txDMAChannel = DMA1_Channel4;
+    if (dmaAllocate(DMA1_CH4_HANDLER, OWNER_SERIAL_TX, 1, DMA_ALLOC_PRIORITY_LOW, uartDmaRevoke, (uint32_t)s)) {
+        s->txDMAChannel = DMA1_Channel4;
+    }
     s->txDMAPeripheralBaseAddr = (uint32_t)&s->USARTx->DR;
 
     RCC_ClockCmd(RCC_APB2(USART1), ENABLE);
@@ -137,10 +145,10 @@ uartPort_t *serialUART1(uint32_t baudRate, portMode_t mode, portOptions_t option
     }
 
     // DMA TX Interrupt
-    dmaInit(DMA1_CH4_HANDLER, OWNER_SERIAL_TX, 1);
-    dmaSetHandler(DMA1_CH4_HANDLER, uart_tx_dma_IRQHandler, NVIC_PRIO_SERIALUART1_TXDMA, (uint32_t)&uartPort1);
+    if (s->txDMAChannel) {
+        dmaSetHandler(DMA1_CH4_HANDLER, uart_tx_dma_IRQHandler, NVIC_PRIO_SERIALUART1_TXDMA, (uint32_t)&uartPort1);
+    }
 
-#ifndef USE_UART1_RX_DMA
     // RX/TX Interrupt
     NVIC_InitTypeDef NVIC_InitStructure;
 
@@ -149,7 +157,6 @@ uartPort_t *serialUART1(uint32_t baudRate, portMode_t mode, portOptions_t option
     NVIC_InitStructure.NVIC_IRQChannelSubPriority = NVIC_PRIORITY_SUB(NVIC_PRIO_SERIALUART1);
     NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
     NVIC_Init(&NVIC_InitStructure);
-#endif
 
     return s;
 }
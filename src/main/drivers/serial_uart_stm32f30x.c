@@ -160,12 +160,15 @@ uartPort_t *serialUART1(uint32_t baudRate, portMode_t mode, portOptions_t option
     s->USARTx = USART1;
 
 #ifdef USE_UART1_RX_DMA
-    dmaInit(DMA1_CH5_HANDLER, OWNER_SERIAL, 1);
-    s->rxDMAChannel = DMA1_Channel5;
+    if (dmaAllocate(DMA1_CH5_HANDLER, OWNER_SERIAL_RX, 1, DMA_ALLOC_PRIORITY_LOW, uartDmaRevoke, (uint32_t)s)) {
+        s->rxDMAChannel = DMA1_Channel5;
+    }
     s->rxDMAPeripheralBaseAddr = (uint32_t)&s->USARTx->RDR;
 #endif
 #ifdef USE_UART1_TX_DMA
-    s->txDMAChannel = DMA1_Channel4;
+    if (dmaAllocate(DMA1_CH4_HANDLER, OWNER_SERIAL_TX, 1, DMA_ALLOC_PRIORITY_LOW, uartDmaRevoke, (uint32_t)s)) {
+        s->txDMAChannel = DMA1_Channel4;
+    }
     s->txDMAPeripheralBaseAddr = (uint32_t)&s->USARTx->TDR;
 #endif
 
@@ -178,11 +181,11 @@ uartPort_t *serialUART1(uint32_t baudRate, portMode_t mode, portOptions_t option
     serialUARTInit(IOGetByTag(IO_TAG(UART1_TX_PIN)), IOGetByTag(IO_TAG(UART1_RX_PIN)), mode, options, GPIO_AF_7, 1);
 
 #ifdef USE_UART1_TX_DMA
-    dmaInit(DMA1_CH4_HANDLER, OWNER_SERIAL, 1);
-    dmaSetHandler(DMA1_CH4_HANDLER, handleUsartTxDma, NVIC_PRIO_SERIALUART1_TXDMA, (uint32_t)&uartPort1);
+    if (s->txDMAChannel) {
+        dmaSetHandler(DMA1_CH4_HANDLER, handleUsartTxDma, NVIC_PRIO_SERIALUART1_TXDMA, (uint32_t)&uartPort1);
+    }
 #endif
 
-#ifndef USE_UART1_RX_DMA
     NVIC_InitTypeDef NVIC_InitStructure;
 
     NVIC_InitStructure.NVIC_IRQChannel = USART1_IRQn;
@@ -190,7 +193,6 @@ uartPort_t *serialUART1(uint32_t baudRate, portMode_t mode, portOptions_t option
     NVIC_InitStructure.NVIC_IRQChannelSubPriority = NVIC_PRIORITY_SUB(NVIC_PRIO_SERIALUART1_RXDMA);
     NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
     NVIC_Init(&NVIC_InitStructure);
-#endif
 
     return s;
 }
@@ -216,13 +218,15 @@ uartPort_t *serialUART2(uint32_t baudRate, portMode_t mode, portOptions_t option
     s->USARTx = USART2;
 
 #ifdef USE_UART2_RX_DMA
-    dmaInit(DMA1_CH6_HANDLER, OWNER_SERIAL, 2);
-    s->rxDMAChannel = DMA1_Channel6;
+    if (dmaAllocate(DMA1_CH6_HANDLER, OWNER_SERIAL_RX, 2, DMA_ALLOC_PRIORITY_LOW, uartDmaRevoke, (uint32_t)s)) {
+        s->rxDMAChannel = DMA1_Channel6;
+    }
     s->rxDMAPeripheralBaseAddr = (uint32_t)&s->USARTx->RDR;
 #endif
 #ifdef USE_UART2_TX_DMA
-    dmaInit(DMA1_CH7_HANDLER, OWNER_SERIAL, 2);
-    s->txDMAChannel = DMA1_Channel7;
+    if (dmaAllocate(DMA1_CH7_HANDLER, OWNER_SERIAL_TX, 2, DMA_ALLOC_PRIORITY_LOW, uartDmaRevoke, (uint32_t)s)) {
+        s->txDMAChannel = DMA1_Channel7;
+    }
     s->txDMAPeripheralBaseAddr = (uint32_t)&s->USARTx->TDR;
 #endif
 
@@ -236,10 +240,11 @@ uartPort_t *serialUART2(uint32_t baudRate, portMode_t mode, portOptions_t option
 
 #ifdef USE_UART2_TX_DMA
     // DMA TX Interrupt
-    dmaSetHandler(DMA1_CH7_HANDLER, handleUsartTxDma, NVIC_PRIO_SERIALUART2_TXDMA, (uint32_t)&uartPort2);
+    if (s->txDMAChannel) {
+        dmaSetHandler(DMA1_CH7_HANDLER, handleUsartTxDma, NVIC_PRIO_SERIALUART2_TXDMA, (uint32_t)&uartPort2);
+    }
 #endif
 
-#ifndef USE_UART2_RX_DMA
     NVIC_InitTypeDef NVIC_InitStructure;
 
     NVIC_InitStructure.NVIC_IRQChannel = USART2_IRQn;
@@ -247,7 +252,6 @@ uartPort_t *serialUART2(uint32_t baudRate, portMode_t mode, portOptions_t option
     NVIC_InitStructure.NVIC_IRQChannelSubPriority = NVIC_PRIORITY_SUB(NVIC_PRIO_SERIALUART2_RXDMA);
     NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
     NVIC_Init(&NVIC_InitStructure);
-#endif
 
     return s;
 }
@@ -273,30 +277,33 @@ uartPort_t *serialUART3(uint32_t baudRate, portMode_t mode, portOptions_t option
     s->USARTx = USART3;
 
 #ifdef USE_UART3_RX_DMA
-    dmaInit(DMA1_CH3_HANDLER, OWNER_SERIAL, 3);
-    s->rxDMAChannel = DMA1_Channel3;
+    if (dmaAllocate(DMA1_CH3_HANDLER, OWNER_SERIAL_RX, 3, DMA_ALLOC_PRIORITY_LOW, uartDmaRevoke, (uint32_t)s)) {
+        s->rxDMAChannel = DMA1_Channel3;
+    }
     s->rxDMAPeripheralBaseAddr = (uint32_t)&s->USARTx->RDR;
 #endif
 #ifdef USE_UART3_TX_DMA
-    dmaInit(DMA1_CH2_HANDLER, OWNER_SERIAL, 3);
-    s->txDMAChannel = DMA1_Channel2;
+    if (dmaAllocate(DMA1_CH2_HANDLER, OWNER_SERIAL_TX, 3, DMA_ALLOC_PRIORITY_LOW, uartDmaRevoke, (uint32_t)s)) {
+        s->txDMAChannel = DMA1_Channel2;
+    }
     s->txDMAPeripheralBaseAddr = (uint32_t)&s->USARTx->TDR;
 #endif
 
     RCC_ClockCmd(RCC_APB1(USART3), ENABLE);
 
 #if defined(USE_UART3_TX_DMA) || defined(USE_UART3_RX_DMA)
-    RCC_AHBClockCmd(RCC_AHB(DMA1), ENABLE);
+    RCC_ClockCmd(RCC_AHB(DMA1), ENABLE);
 #endif
 
     serialUARTInit(IOGetByTag(IO_TAG(UART3_TX_PIN)), IOGetByTag(IO_TAG(UART3_RX_PIN)), mode, options, GPIO_AF_7, 3);
 
 #ifdef USE_UART3_TX_DMA
     // DMA TX Interrupt
-    dmaSetHandler(DMA1_CH2_HANDLER, handleUsartTxDma, NVIC_PRIO_SERIALUART3_TXDMA, (uint32_t)&uartPort3);
+    if (s->txDMAChannel) {
+        dmaSetHandler(DMA1_CH2_HANDLER, handleUsartTxDma, NVIC_PRIO_SERIALUART3_TXDMA, (uint32_t)&uartPort3);
+    }
 #endif
 
-#ifndef USE_UART3_RX_DMA
     NVIC_InitTypeDef NVIC_InitStructure;
 
     NVIC_InitStructure.NVIC_IRQChannel = USART3_IRQn;
@@ -304,7 +311,6 @@ uartPort_t *serialUART3(uint32_t baudRate, portMode_t mode, portOptions_t option
     NVIC_InitStructure.NVIC_IRQChannelSubPriority = NVIC_PRIORITY_SUB(NVIC_PRIO_SERIALUART3_RXDMA);
     NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
     NVIC_Init(&NVIC_InitStructure);
-#endif
 
     return s;
 }
@@ -383,7 +389,7 @@ void usartIrqHandler(uartPort_t *s)
     uint32_t ISR = s->USARTx->ISR;
 
     if (!s->rxDMAChannel && (ISR & USART_FLAG_RXNE)) {
-        if (s->port.rxCallback) {
+        if (s->port.rxCallback && !s->port.rxFrameCallback) {
             s->port.rxCallback(s->USARTx->RDR);
         } else {
             s->port.rxBuffer[s->port.rxBufferHead++] = s->USARTx->RDR;
@@ -408,6 +414,11 @@ void usartIrqHandler(uartPort_t *s)
     {
         USART_ClearITPendingBit (s->USARTx, USART_IT_ORE);
     }
+
+    if ((ISR & USART_FLAG_IDLE) && s->port.rxFrameCallback) {
+        USART_ClearITPendingBit(s->USARTx, USART_IT_IDLE);
+        uartRxFrameComplete(s);
+    }
 }
 
 #ifdef USE_UART1
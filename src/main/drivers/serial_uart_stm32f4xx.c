@@ -222,7 +222,7 @@ static uartDevice_t* uartHardwareMap[] = {
 void uartIrqHandler(uartPort_t *s)
 {
     if (!s->rxDMAStream && (USART_GetITStatus(s->USARTx, USART_IT_RXNE) == SET)) {
-        if (s->port.rxCallback) {
+        if (s->port.rxCallback && !s->port.rxFrameCallback) {
             s->port.rxCallback(s->USARTx->DR);
         } else {
             s->port.rxBuffer[s->port.rxBufferHead] = s->USARTx->DR;
@@ -243,6 +243,12 @@ void uartIrqHandler(uartPort_t *s)
     {
         USART_ClearITPendingBit (s->USARTx, USART_IT_ORE);
     }
+
+    if (USART_GetITStatus(s->USARTx, USART_IT_IDLE) == SET) {
+        // the status register read above followed by a data register read clears IDLE
+        USART_ReceiveData(s->USARTx);
+        uartRxFrameComplete(s);
+    }
 }
 
 static void handleUsartTxDma(uartPort_t *s)
@@ -297,18 +303,19 @@ uartPort_t *serialUART(UARTDevice device, uint32_t baudRate, portMode_t mode, po
     s->port.txBufferSize = sizeof(uart->txBuffer);
 
     s->USARTx = uart->dev;
-    if (uart->rxDMAStream) {
+    // the streams are given up to drivers that can't work without DMA
+    if (uart->rxDMAStream && dmaAllocate(dmaGetIdentifier(uart->rxDMAStream), OWNER_SERIAL_RX, RESOURCE_INDEX(device), DMA_ALLOC_PRIORITY_LOW, uartDmaRevoke, (uint32_t)s)) {
         s->rxDMAChannel = uart->DMAChannel;
         s->rxDMAStream = uart->rxDMAStream;
-        dmaInit(dmaGetIdentifier(uart->rxDMAStream), OWNER_SERIAL_RX, RESOURCE_INDEX(device));
     }
     if (uart->txDMAStream) {
-        s->txDMAChannel = uart->DMAChannel;
-        s->txDMAStream = uart->txDMAStream;
         const dmaIdentifier_e identifier = dmaGetIdentifier(uart->txDMAStream);
-        dmaInit(identifier, OWNER_SERIAL_TX, RESOURCE_INDEX(device));
-        // DMA TX Interrupt
-        dmaSetHandler(identifier, dmaIRQHandler, uart->txPriority, (uint32_t)uart);
+        if (dmaAllocate(identifier, OWNER_SERIAL_TX, RESOURCE_INDEX(device), DMA_ALLOC_PRIORITY_LOW, uartDmaRevoke, (uint32_t)s)) {
+            s->txDMAChannel = uart->DMAChannel;
+            s->txDMAStream = uart->txDMAStream;
+            // DMA TX Interrupt
+            dmaSetHandler(identifier, dmaIRQHandler, uart->txPriority, (uint32_t)uart);
+        }
     }
 
     s->txDMAPeripheralBaseAddr = (uint32_t)&s->USARTx->DR;
@@ -340,13 +347,12 @@ uartPort_t *serialUART(UARTDevice device, uint32_t baudRate, portMode_t mode, po
         }
     }
 
-    if (!(s->rxDMAChannel)) {
-        NVIC_InitStructure.NVIC_IRQChannel = uart->rxIrq;
-        NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = NVIC_PRIORITY_BASE(uart->rxPriority);
-        NVIC_InitStructure.NVIC_IRQChannelSubPriority = NVIC_PRIORITY_SUB(uart->rxPriority);
-        NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
-        NVIC_Init(&NVIC_InitStructure);
-    }
+    // RX/TX interrupt, also used for idle line frame delivery on RX DMA ports
+    NVIC_InitStructure.NVIC_IRQChannel = uart->rxIrq;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = NVIC_PRIORITY_BASE(uart->rxPriority);
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = NVIC_PRIORITY_SUB(uart->rxPriority);
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
 
     return s;
 }
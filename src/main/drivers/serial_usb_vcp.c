@@ -88,42 +88,24 @@ static uint8_t usbVcpRead(serialPort_t *instance)
     }
 }
 
-static void usbVcpWriteBuf(serialPort_t *instance, const void *data, int count)
+static int usbVcpReadBuf(serialPort_t *instance, uint8_t *data, int count)
 {
     UNUSED(instance);
 
-    if (!(usbIsConnected() && usbIsConfigured())) {
-        return;
-    }
-
-    uint32_t start = millis();
-    const uint8_t *p = data;
-    while (count > 0) {
-        uint32_t txed = CDC_Send_DATA(p, count);
-        count -= txed;
-        p += txed;
-
-        if (millis() - start > USB_TIMEOUT) {
-            break;
-        }
-    }
+    return CDC_Receive_DATA(data, count);
 }
 
-static bool usbVcpFlush(vcpPort_t *port)
+static void usbVcpWriteBuf(serialPort_t *instance, const void *data, int count)
 {
-    uint32_t count = port->txAt;
-    port->txAt = 0;
-
-    if (count == 0) {
-        return true;
-    }
+    UNUSED(instance);
 
-    if (!usbIsConnected() || !usbIsConfigured()) {
-        return false;
+    if (!(usbIsConnected() && usbIsConfigured())) {
+        return;
     }
 
+    // the stack queues what fits and hands it to the endpoint in full packets while more is copied in
     uint32_t start = millis();
-    uint8_t *p = port->txBuf;
+    const uint8_t *p = data;
     while (count > 0) {
         uint32_t txed = CDC_Send_DATA(p, count);
         count -= txed;
@@ -133,23 +115,11 @@ static bool usbVcpFlush(vcpPort_t *port)
             break;
         }
     }
-    return count == 0;
 }
 
 static void usbVcpWrite(serialPort_t *instance, uint8_t c)
 {
-    vcpPort_t *port = container_of(instance, vcpPort_t, port);
-
-    port->txBuf[port->txAt++] = c;
-    if (!port->buffering || port->txAt >= ARRAYLEN(port->txBuf)) {
-        usbVcpFlush(port);
-    }
-}
-
-static void usbVcpBeginWrite(serialPort_t *instance)
-{
-    vcpPort_t *port = container_of(instance, vcpPort_t, port);
-    port->buffering = true;
+    usbVcpWriteBuf(instance, &c, sizeof(c));
 }
 
 uint32_t usbTxBytesFree()
@@ -157,13 +127,6 @@ uint32_t usbTxBytesFree()
     return CDC_Send_FreeBytes();
 }
 
-static void usbVcpEndWrite(serialPort_t *instance)
-{
-    vcpPort_t *port = container_of(instance, vcpPort_t, port);
-    port->buffering = false;
-    usbVcpFlush(port);
-}
-
 static const struct serialPortVTable usbVTable[] = {
     {
         .serialWrite = usbVcpWrite,
@@ -174,8 +137,10 @@ static const struct serialPortVTable usbVTable[] = {
         .isSerialTransmitBufferEmpty = isUsbVcpTransmitBufferEmpty,
         .setMode = usbVcpSetMode,
         .writeBuf = usbVcpWriteBuf,
-        .beginWrite = usbVcpBeginWrite,
-        .endWrite = usbVcpEndWrite
+        .readBuf = usbVcpReadBuf,
+        .setRxFrameCallback = NULL,
+        .beginWrite = NULL,
+        .endWrite = NULL
     }
 };
 
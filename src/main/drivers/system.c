@@ -28,6 +28,8 @@
 
 #include "system.h"
 
+#define DWT_LAR_UNLOCK_VALUE 0xC5ACCE55
+
 // cycles per microsecond
 static uint32_t usTicks = 0;
 // current uptime for 1kHz systick timer. will rollover after 49 days. hopefully we won't care.
@@ -44,6 +46,40 @@ void cycleCounterInit(void)
     RCC_GetClocksFreq(&clocks);
     usTicks = clocks.SYSCLK_Frequency / 1000000;
 #endif
+
+#ifdef USE_DWT
+    // start the DWT cycle counter read by getCycleCounter()
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+#if defined(STM32F7)
+    DWT->LAR = DWT_LAR_UNLOCK_VALUE;
+#endif
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+}
+
+#ifndef USE_DWT
+// the CMSIS for the F1 does not describe the DWT, count in whole microseconds instead
+timeCycles_t getCycleCounter(void)
+{
+    return micros() * usTicks;
+}
+#endif
+
+uint32_t clockCyclesToMicros(timeCycles_t cycles)
+{
+    return cycles / usTicks;
+}
+
+uint32_t clockCyclesToNanos(timeCycles_t cycles)
+{
+    // split to avoid overflow, wraps like micros() after 4.29 seconds
+    return (cycles / usTicks) * 1000 + (cycles % usTicks) * 1000 / usTicks;
+}
+
+timeCycles_t clockMicrosToCycles(uint32_t us)
+{
+    return us * usTicks;
 }
 
 // SysTick
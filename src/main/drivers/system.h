@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include "common/time.h"
+
 void systemInit(void);
 void delayMicroseconds(uint32_t us);
 void delay(uint32_t ms);
@@ -25,6 +27,24 @@ uint32_t micros(void);
 uint32_t microsISR(void);
 uint32_t millis(void);
 
+// cycle counter, a few cycles per read, for timing code paths shorter than a microsecond
+#ifdef UNIT_TEST
+// host stand-in, counts one cycle per microsecond of the micros() provided by the test
+static inline timeCycles_t getCycleCounter(void) { return micros(); }
+static inline uint32_t clockCyclesToMicros(timeCycles_t cycles) { return cycles; }
+static inline uint32_t clockCyclesToNanos(timeCycles_t cycles) { return cycles * 1000; }
+static inline timeCycles_t clockMicrosToCycles(uint32_t us) { return us; }
+#else
+#ifdef USE_DWT
+static inline timeCycles_t getCycleCounter(void) { return DWT->CYCCNT; }
+#else
+timeCycles_t getCycleCounter(void);
+#endif
+uint32_t clockCyclesToMicros(timeCycles_t cycles);
+uint32_t clockCyclesToNanos(timeCycles_t cycles);
+timeCycles_t clockMicrosToCycles(uint32_t us);
+#endif
+
 typedef enum {
     FAILURE_DEVELOPER = 0,
     FAILURE_MISSING_ACC,
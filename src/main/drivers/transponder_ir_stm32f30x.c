@@ -56,7 +56,7 @@ void transponderIrHardwareInit(ioTag_t ioTag)
     const timerHardware_t *timerHardware = timerGetByTag(ioTag, TIM_USE_ANY);
     timer = timerHardware->tim;
 
-    if (timerHardware->dmaChannel == NULL) {
+    if (timerHardware->dmaChannel == NULL || !dmaInit(timerHardware->dmaIrqHandler, OWNER_TRANSPONDER, 0)) {
         return;
     }
 
@@ -64,7 +64,6 @@ void transponderIrHardwareInit(ioTag_t ioTag)
     IOInit(transponderIO, OWNER_TRANSPONDER, 0);
     IOConfigGPIOAF(transponderIO, IO_CONFIG(GPIO_Mode_AF, GPIO_Speed_50MHz, GPIO_OType_PP, GPIO_PuPd_DOWN), timerHardware->alternateFunction);
 
-    dmaInit(timerHardware->dmaIrqHandler, OWNER_TRANSPONDER, 0);
     dmaSetHandler(timerHardware->dmaIrqHandler, TRANSPONDER_DMA_IRQHandler, NVIC_PRIO_TRANSPONDER_DMA, 0);
     RCC_ClockCmd(timerRCC(timer), ENABLE);
 
@@ -254,7 +254,11 @@ static const char * const lookupTableGimbalMode[] = {
 
 #ifdef BLACKBOX
 static const char * const lookupTableBlackboxDevice[] = {
-    "SERIAL", "SPIFLASH", "SDCARD"
+    "SERIAL", "SPIFLASH", "SDCARD", "NONE"
+};
+
+static const char * const lookupTableBlackboxPEncoding[] = {
+    "TAG", "GOLOMB_RICE"
 };
 #endif
 
@@ -368,6 +372,7 @@ typedef enum {
 #endif
 #ifdef BLACKBOX
     TABLE_BLACKBOX_DEVICE,
+    TABLE_BLACKBOX_P_ENCODING,
 #endif
     TABLE_CURRENT_SENSOR,
     TABLE_BATTERY_SENSOR,
@@ -410,6 +415,7 @@ static const lookupTableEntry_t lookupTables[] = {
 #endif
 #ifdef BLACKBOX
     { lookupTableBlackboxDevice, sizeof(lookupTableBlackboxDevice) / sizeof(char *) },
+    { lookupTableBlackboxPEncoding, sizeof(lookupTableBlackboxPEncoding) / sizeof(char *) },
 #endif
     { lookupTableCurrentSensor, sizeof(lookupTableCurrentSensor) / sizeof(char *) },
     { lookupTableBatterySensor, sizeof(lookupTableBatterySensor) / sizeof(char *) },
@@ -515,6 +521,7 @@ const clivalue_t valueTable[] = {
 #ifdef USE_DSHOT
     { "digital_idle_percent",       VAR_FLOAT  | MASTER_VALUE,  &motorConfig()->digitalIdleOffsetPercent, .config.minmax = { 0,  20} },
 #endif
+    { "thrust_linear",              VAR_UINT8  | MASTER_VALUE,  &motorConfig()->thrustLinearization, .config.minmax = { 0,  100 } },
     { "3d_deadband_low",            VAR_UINT16 | MASTER_VALUE,  &flight3DConfig()->deadband3d_low, .config.minmax = { PWM_RANGE_ZERO,  PWM_RANGE_MAX } }, // FIXME upper limit should match code in the mixer, 1500 currently
     { "3d_deadband_high",           VAR_UINT16 | MASTER_VALUE,  &flight3DConfig()->deadband3d_high, .config.minmax = { PWM_RANGE_ZERO,  PWM_RANGE_MAX } }, // FIXME lower limit should match code in the mixer, 1500 currently,
     { "3d_neutral",                 VAR_UINT16 | MASTER_VALUE,  &flight3DConfig()->neutral3d, .config.minmax = { PWM_RANGE_ZERO,  PWM_RANGE_MAX } },
@@ -740,6 +747,17 @@ const clivalue_t valueTable[] = {
     { "blackbox_rate_denom",        VAR_UINT8  | MASTER_VALUE,  &blackboxConfig()->rate_denom, .config.minmax = { 1,  32 } },
     { "blackbox_device",            VAR_UINT8  | MASTER_VALUE | MODE_LOOKUP,  &blackboxConfig()->device, .config.lookup = { TABLE_BLACKBOX_DEVICE } },
     { "blackbox_on_motor_test",     VAR_UINT8  | MASTER_VALUE | MODE_LOOKUP,  &blackboxConfig()->on_motor_test, .config.lookup = { TABLE_OFF_ON } },
+    { "blackbox_gyro_rate_denom",   VAR_UINT8  | MASTER_VALUE,  &blackboxConfig()->gyro_rate_denom, .config.minmax = { 0,  32 } },
+    { "blackbox_p_encoding",        VAR_UINT8  | MASTER_VALUE | MODE_LOOKUP,  &blackboxConfig()->p_encoding, .config.lookup = { TABLE_BLACKBOX_P_ENCODING } },
+    { "blackbox_cross_field_predictors", VAR_UINT8 | MASTER_VALUE | MODE_LOOKUP, &blackboxConfig()->cross_field_predictors, .config.lookup = { TABLE_OFF_ON } },
+    { "blackbox_rate_control",      VAR_UINT8  | MASTER_VALUE | MODE_LOOKUP,  &blackboxConfig()->rate_control, .config.lookup = { TABLE_OFF_ON } },
+    { "blackbox_stream_device",     VAR_UINT8  | MASTER_VALUE | MODE_LOOKUP,  &blackboxConfig()->stream_device, .config.lookup = { TABLE_BLACKBOX_DEVICE } },
+    { "blackbox_stream_rate_denom", VAR_UINT8  | MASTER_VALUE,  &blackboxConfig()->stream_rate_denom, .config.minmax = { 1,  128 } },
+#ifdef USE_BLACKBOX_PREROLL
+    // The time logged after the last trigger, the pre-roll before it is as much as fits in the RAM ring
+    { "blackbox_preroll_hold_seconds", VAR_UINT8 | MASTER_VALUE, &blackboxConfig()->preroll_hold_seconds, .config.minmax = { 0,  60 } },
+    { "blackbox_preroll_gyro_trigger", VAR_UINT16 | MASTER_VALUE, &blackboxConfig()->preroll_gyro_trigger, .config.minmax = { 0,  2000 } },
+#endif
 #endif
 
 #ifdef VTX
@@ -3259,14 +3277,16 @@ static void cliTasks(char *cmdline)
                 cliPrintf("%02d - (%13s) ", taskId, taskInfo.taskName);
             }
             const int maxLoad = taskInfo.maxExecutionTime == 0 ? 0 :(taskInfo.maxExecutionTime * taskFrequency + 5000) / 1000;
-            const int averageLoad = taskInfo.averageExecutionTime == 0 ? 0 : (taskInfo.averageExecutionTime * taskFrequency + 5000) / 1000;
+            // in units of 0.1us, so tasks shorter than a microsecond still show their time and load
+            const int averageTime = taskInfo.averageExecutionTimeNs / 100;
+            const int averageLoad = (averageTime * taskFrequency + 5000) / 10000;
             if (taskId != TASK_SERIAL) {
                 maxLoadSum += maxLoad;
                 averageLoadSum += averageLoad;
             }
             if (masterConfig.task_statistics) {
-                cliPrintf("%6d %7d %7d %4d.%1d%% %4d.%1d%% %9d\r\n",
-                        taskFrequency, taskInfo.maxExecutionTime, taskInfo.averageExecutionTime,
+                cliPrintf("%6d %7d %5d.%1d %4d.%1d%% %4d.%1d%% %9d\r\n",
+                        taskFrequency, taskInfo.maxExecutionTime, averageTime / 10, averageTime % 10,
                         maxLoad/10, maxLoad%10, averageLoad/10, averageLoad%10, taskInfo.totalExecutionTime / 1000);
             } else {
                 cliPrintf("%6d\r\n", taskFrequency);
@@ -3279,7 +3299,8 @@ static void cliTasks(char *cmdline)
     if (masterConfig.task_statistics) {
         cfCheckFuncInfo_t checkFuncInfo;
         getCheckFuncInfo(&checkFuncInfo);
-        cliPrintf("RX Check Function %17d %7d %25d\r\n", checkFuncInfo.maxExecutionTime, checkFuncInfo.averageExecutionTime, checkFuncInfo.totalExecutionTime / 1000);
+        const int checkFuncAverageTime = checkFuncInfo.averageExecutionTimeNs / 100;
+        cliPrintf("RX Check Function %17d %5d.%1d %25d\r\n", checkFuncInfo.maxExecutionTime, checkFuncAverageTime / 10, checkFuncAverageTime % 10, checkFuncInfo.totalExecutionTime / 1000);
         cliPrintf("Total (excluding SERIAL) %23d.%1d%% %4d.%1d%%\r\n", maxLoadSum/10, maxLoadSum%10, averageLoadSum/10, averageLoadSum%10);
     }
 }
@@ -3299,6 +3320,49 @@ static void cliVersion(char *cmdline)
     );
 }
 
+static void printDmaUser(const dmaUser_t *user)
+{
+    if (user->resourceIndex > 0) {
+        cliPrintf(" %s %d", ownerNames[user->owner], user->resourceIndex);
+    } else {
+        cliPrintf(" %s", ownerNames[user->owner]);
+    }
+}
+
+static void printDma(void)
+{
+    cliPrintf("Currently active DMA:\r\n");
+#ifndef CLI_MINIMAL_VERBOSITY
+    cliRepeat('-', 20);
+#endif
+    for (int i = 0; i < DMA_MAX_DESCRIPTORS; i++) {
+        const dmaAllocation_t *allocation = dmaGetAllocation(i);
+
+        cliPrintf(DMA_OUTPUT_STRING, i / DMA_MOD_VALUE + 1, (i % DMA_MOD_VALUE) + DMA_MOD_OFFSET);
+        if (allocation->userCount == 0) {
+            cliPrintf(" %s", ownerNames[OWNER_FREE]);
+        }
+        for (int j = 0; j < allocation->userCount; j++) {
+            printDmaUser(&allocation->users[j]);
+        }
+        if (allocation->shared) {
+            cliPrintf(" (shared)");
+        }
+        if (allocation->conflict.owner != OWNER_FREE) {
+            cliPrintf(" CONFLICT:");
+            printDmaUser(&allocation->conflict);
+        }
+        cliPrintf("\r\n");
+    }
+}
+
+static void cliDma(char *cmdline)
+{
+    UNUSED(cmdline);
+
+    printDma();
+}
+
 #if defined(USE_RESOURCE_MGMT)
 
 typedef struct {
@@ -3432,22 +3496,8 @@ static void cliResource(char *cmdline)
             }
         }
 
-        cliPrintf("\r\n\r\nCurrently active DMA:\r\n");
-#ifndef CLI_MINIMAL_VERBOSITY
-        cliRepeat('-', 20);
-#endif
-        for (int i = 0; i < DMA_MAX_DESCRIPTORS; i++) {
-            const char* owner;
-            owner = ownerNames[dmaGetOwner(i)];
-
-            cliPrintf(DMA_OUTPUT_STRING, i / DMA_MOD_VALUE + 1, (i % DMA_MOD_VALUE) + DMA_MOD_OFFSET);
-            uint8_t resourceIndex = dmaGetResourceIndex(i);
-            if (resourceIndex > 0) {
-                cliPrintf(" %s %d\r\n", owner, resourceIndex);
-            } else {
-                cliPrintf(" %s\r\n", owner);
-            }
-        }
+        cliPrintf("\r\n\r\n");
+        printDma();
 
 #ifndef CLI_MINIMAL_VERBOSITY
         cliPrintf("\r\nUse: 'resource' to see how to change resources.\r\n");
@@ -3726,6 +3776,7 @@ const clicmd_t cmdTable[] = {
     CLI_COMMAND_DEF("dfu", "DFU mode on reboot", NULL, cliDfu),
     CLI_COMMAND_DEF("diff", "list configuration changes from default",
         "[master|profile|rates|all] {showdefaults}", cliDiff),
+    CLI_COMMAND_DEF("dma", "list DMA stream allocation", NULL, cliDma),
     CLI_COMMAND_DEF("dump", "dump configuration",
         "[master|profile|rates|all] {showdefaults}", cliDump),
 #ifdef USE_ESCSERIAL
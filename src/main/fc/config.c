@@ -25,6 +25,8 @@
 #include "build/build_config.h"
 #include "build/debug.h"
 
+#include "blackbox/blackbox.h"
+#include "blackbox/blackbox_encoding.h"
 #include "blackbox/blackbox_io.h"
 
 #include "cms/cms.h"
@@ -281,6 +283,7 @@ void resetMotorConfig(motorConfig_t *motorConfig)
     motorConfig->maxthrottle = 2000;
     motorConfig->mincommand = 1000;
     motorConfig->digitalIdleOffsetPercent = 3.0f;
+    motorConfig->thrustLinearization = 0;
 
     int motorIndex = 0;
     for (int i = 0; i < USABLE_TIMER_CHANNEL_COUNT && motorIndex < MAX_SUPPORTED_MOTORS; i++) {
@@ -816,6 +819,14 @@ void createDefaultConfig(master_t *config)
     config->blackboxConfig.rate_num = 1;
     config->blackboxConfig.rate_denom = 1;
     config->blackboxConfig.on_motor_test = 0; // default off
+    config->blackboxConfig.gyro_rate_denom = 0;
+    config->blackboxConfig.p_encoding = BLACKBOX_P_ENCODING_TAG;
+    config->blackboxConfig.cross_field_predictors = 0;
+    config->blackboxConfig.preroll_hold_seconds = 0;
+    config->blackboxConfig.preroll_gyro_trigger = 1900;
+    config->blackboxConfig.stream_device = BLACKBOX_DEVICE_NONE;
+    config->blackboxConfig.stream_rate_denom = 4;
+    config->blackboxConfig.rate_control = 0;
 #endif // BLACKBOX
 
 #ifdef SERIALRX_UART
@@ -916,6 +927,10 @@ void activateConfig(void)
 #ifdef BARO
     useBarometerConfig(&masterConfig.barometerConfig);
 #endif
+
+#if defined(BLACKBOX) && defined(USE_BLACKBOX_HEADER_CACHE)
+    blackboxRenderHeader();
+#endif
 }
 
 void validateAndFixConfig(void)
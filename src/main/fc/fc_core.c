@@ -64,6 +64,7 @@
 #include "flight/pid.h"
 #include "flight/failsafe.h"
 #include "flight/altitudehold.h"
+#include "flight/imu.h"
 
 #include "config/config_profile.h"
 #include "config/config_master.h"
@@ -337,7 +338,7 @@ void updateRcCommands(void)
     }
 
     if (FLIGHT_MODE(HEADFREE_MODE)) {
-        const float radDiff = degreesToRadians(DECIDEGREES_TO_DEGREES(attitude.values.yaw) - headFreeModeHold);
+        const float radDiff = degreesToRadians(DECIDEGREES_TO_DEGREES(imuGetAttitude()->values.yaw) - headFreeModeHold);
         const float cosDiff = cos_approx(radDiff);
         const float sinDiff = sin_approx(radDiff);
         const int16_t rcCommand_PITCH = rcCommand[PITCH] * cosDiff + rcCommand[ROLL] * sinDiff;
@@ -413,7 +414,7 @@ void mwArm(void)
         if (!ARMING_FLAG(PREVENT_ARMING)) {
             ENABLE_ARMING_FLAG(ARMED);
             ENABLE_ARMING_FLAG(WAS_EVER_ARMED);
-            headFreeModeHold = DECIDEGREES_TO_DEGREES(attitude.values.yaw);
+            headFreeModeHold = DECIDEGREES_TO_DEGREES(imuGetAttitude()->values.yaw);
 
 #ifdef BLACKBOX
             if (feature(FEATURE_BLACKBOX)) {
@@ -487,7 +488,7 @@ static void updateInflightCalibrationState(void)
 void updateMagHold(void)
 {
     if (ABS(rcCommand[YAW]) < 15 && FLIGHT_MODE(MAG_MODE)) {
-        int16_t dif = DECIDEGREES_TO_DEGREES(attitude.values.yaw) - magHold;
+        int16_t dif = DECIDEGREES_TO_DEGREES(imuGetAttitude()->values.yaw) - magHold;
         if (dif <= -180)
             dif += 360;
         if (dif >= +180)
@@ -496,7 +497,7 @@ void updateMagHold(void)
         if (STATE(SMALL_ANGLE))
             rcCommand[YAW] -= dif * currentProfile->pidProfile.P8[PIDMAG] / 30;    // 18 deg
     } else
-        magHold = DECIDEGREES_TO_DEGREES(attitude.values.yaw);
+        magHold = DECIDEGREES_TO_DEGREES(imuGetAttitude()->values.yaw);
 }
 
 void processRx(timeUs_t currentTimeUs)
@@ -637,7 +638,7 @@ void processRx(timeUs_t currentTimeUs)
         if (IS_RC_MODE_ACTIVE(BOXMAG)) {
             if (!FLIGHT_MODE(MAG_MODE)) {
                 ENABLE_FLIGHT_MODE(MAG_MODE);
-                magHold = DECIDEGREES_TO_DEGREES(attitude.values.yaw);
+                magHold = DECIDEGREES_TO_DEGREES(imuGetAttitude()->values.yaw);
             }
         } else {
             DISABLE_FLIGHT_MODE(MAG_MODE);
@@ -650,7 +651,7 @@ void processRx(timeUs_t currentTimeUs)
             DISABLE_FLIGHT_MODE(HEADFREE_MODE);
         }
         if (IS_RC_MODE_ACTIVE(BOXHEADADJ)) {
-            headFreeModeHold = DECIDEGREES_TO_DEGREES(attitude.values.yaw); // acquire new heading
+            headFreeModeHold = DECIDEGREES_TO_DEGREES(imuGetAttitude()->values.yaw); // acquire new heading
         }
     }
 #endif
@@ -690,19 +691,25 @@ void processRx(timeUs_t currentTimeUs)
 #endif
 }
 
+// DEBUG_PIDLOOP timings are measured with the cycle counter and reported in units of 0.1us, up to 3.2ms
+static int16_t pidLoopDebugTime(timeCycles_t startCycles)
+{
+    return MIN(clockCyclesToNanos(getCycleCounter() - startCycles) / 100, (uint32_t)INT16_MAX);
+}
+
 static void subTaskPidController(void)
 {
-    uint32_t startTime;
-    if (debugMode == DEBUG_PIDLOOP) {startTime = micros();}
+    timeCycles_t startCycles;
+    if (debugMode == DEBUG_PIDLOOP) {startCycles = getCycleCounter();}
     // PID - note this is function pointer set by setPIDController()
     pidController(&currentProfile->pidProfile, &accelerometerConfig()->accelerometerTrims, throttlePIDAttenuation);
-    DEBUG_SET(DEBUG_PIDLOOP, 1, micros() - startTime);
+    DEBUG_SET(DEBUG_PIDLOOP, 1, pidLoopDebugTime(startCycles));
 }
 
 static void subTaskMainSubprocesses(timeUs_t currentTimeUs)
 {
-    uint32_t startTime;
-    if (debugMode == DEBUG_PIDLOOP) {startTime = micros();}
+    timeCycles_t startCycles;
+    if (debugMode == DEBUG_PIDLOOP) {startCycles = getCycleCounter();}
 
     // Read out gyro temperature if used for telemmetry
     if (feature(FEATURE_TELEMETRY) && gyro.dev.temperature) {
@@ -762,28 +769,28 @@ static void subTaskMainSubprocesses(timeUs_t currentTimeUs)
 
 #ifdef BLACKBOX
     if (!cliMode && feature(FEATURE_BLACKBOX)) {
-        handleBlackbox(currentTimeUs);
+        blackboxSampleIteration(currentTimeUs);
     }
 #endif
 
 #ifdef TRANSPONDER
     transponderUpdate(currentTimeUs);
 #endif
-    DEBUG_SET(DEBUG_PIDLOOP, 2, micros() - startTime);
+    DEBUG_SET(DEBUG_PIDLOOP, 2, pidLoopDebugTime(startCycles));
 }
 
 static void subTaskMotorUpdate(void)
 {
-    uint32_t startTime;
+    timeCycles_t startCycles;
     if (debugMode == DEBUG_CYCLETIME) {
-        startTime = micros();
+        const uint32_t startTime = micros();
         static uint32_t previousMotorUpdateTime;
         const uint32_t currentDeltaTime = startTime - previousMotorUpdateTime;
         debug[2] = currentDeltaTime;
         debug[3] = currentDeltaTime - targetPidLooptime;
         previousMotorUpdateTime = startTime;
     } else if (debugMode == DEBUG_PIDLOOP) {
-        startTime = micros();
+        startCycles = getCycleCounter();
     }
 
     mixTable(&currentProfile->pidProfile);
@@ -800,7 +807,7 @@ static void subTaskMotorUpdate(void)
     if (motorControlEnable) {
         writeMotors();
     }
-    DEBUG_SET(DEBUG_PIDLOOP, 3, micros() - startTime);
+    DEBUG_SET(DEBUG_PIDLOOP, 3, pidLoopDebugTime(startCycles));
 }
 
 uint8_t setPidUpdateCountDown(void)
@@ -828,20 +835,27 @@ void taskMainPidLoop(timeUs_t currentTimeUs)
         runTaskMainSubprocesses = false;
     }
 
-    // DEBUG_PIDLOOP, timings for:
+    // DEBUG_PIDLOOP, timings in 0.1us for:
     // 0 - gyroUpdate()
     // 1 - pidController()
     // 2 - subTaskMainSubprocesses()
     // 3 - subTaskMotorUpdate()
-    uint32_t startTime;
-    if (debugMode == DEBUG_PIDLOOP) {startTime = micros();}
+    timeCycles_t startCycles;
+    if (debugMode == DEBUG_PIDLOOP) {startCycles = getCycleCounter();}
     gyroUpdate();
-    DEBUG_SET(DEBUG_PIDLOOP, 0, micros() - startTime);
+    DEBUG_SET(DEBUG_PIDLOOP, 0, pidLoopDebugTime(startCycles));
+
+#ifdef BLACKBOX
+    if (!cliMode && feature(FEATURE_BLACKBOX)) {
+        blackboxSampleGyro();
+    }
+#endif
 
     if (pidUpdateCountdown) {
         pidUpdateCountdown--;
     } else {
         pidUpdateCountdown = setPidUpdateCountDown();
+        imuUpdateGyroAttitude(currentTimeUs);
         subTaskPidController();
         subTaskMotorUpdate();
         runTaskMainSubprocesses = true;
@@ -567,6 +567,11 @@ void init(void)
     latchActiveFeatures();
     motorControlEnable = true;
 
+#if defined(BLACKBOX) && defined(USE_BLACKBOX_HEADER_CACHE)
+    // The log header needs the sensors, the mixer and the features, so it's first rendered here
+    blackboxRenderHeader();
+#endif
+
     fcTasksInit();
     systemState |= SYSTEM_STATE_READY;
 }
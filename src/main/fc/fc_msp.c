@@ -714,9 +714,9 @@ static bool mspFcProcessOutCommand(uint8_t cmdMSP, sbuf_t *dst, mspPostProcessFn
         break;
 
     case MSP_ATTITUDE:
-        sbufWriteU16(dst, attitude.values.roll);
-        sbufWriteU16(dst, attitude.values.pitch);
-        sbufWriteU16(dst, DECIDEGREES_TO_DEGREES(attitude.values.yaw));
+        sbufWriteU16(dst, imuGetAttitude()->values.roll);
+        sbufWriteU16(dst, imuGetAttitude()->values.pitch);
+        sbufWriteU16(dst, DECIDEGREES_TO_DEGREES(imuGetAttitude()->values.yaw));
         break;
 
     case MSP_ALTITUDE:
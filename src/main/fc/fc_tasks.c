@@ -21,6 +21,8 @@
 
 #include <platform.h>
 
+#include "blackbox/blackbox.h"
+
 #include "cms/cms.h"
 
 #include "common/axis.h"
@@ -205,6 +207,15 @@ static void taskTelemetry(timeUs_t currentTimeUs)
 }
 #endif
 
+#ifdef BLACKBOX
+static void taskBlackbox(timeUs_t currentTimeUs)
+{
+    if (!cliMode) {
+        handleBlackbox(currentTimeUs);
+    }
+}
+#endif
+
 #ifdef VTX_CONTROL
 // Everything that listens to VTX devices
 void taskVtxControl(uint32_t currentTime)
@@ -274,6 +285,9 @@ void fcTasksInit(void)
         }
     }
 #endif
+#ifdef BLACKBOX
+    setTaskEnabled(TASK_BLACKBOX, feature(FEATURE_BLACKBOX));
+#endif
 #ifdef LED_STRIP
     setTaskEnabled(TASK_LEDSTRIP, feature(FEATURE_LED_STRIP));
 #endif
@@ -453,6 +467,15 @@ cfTask_t cfTasks[TASK_COUNT] = {
     },
 #endif
 
+#ifdef BLACKBOX
+    [TASK_BLACKBOX] = {
+        .taskName = "BLACKBOX",
+        .taskFunc = taskBlackbox,
+        .desiredPeriod = TASK_PERIOD_US(BLACKBOX_TASK_PERIOD_US),
+        .staticPriority = TASK_PRIORITY_MEDIUM,
+    },
+#endif
+
 #ifdef LED_STRIP
     [TASK_LEDSTRIP] = {
         .taskName = "LEDSTRIP",
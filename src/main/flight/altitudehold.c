@@ -163,7 +163,7 @@ void updateSonarAltHoldState(void)
     }
 }
 
-bool isThrustFacingDownwards(attitudeEulerAngles_t *attitude)
+bool isThrustFacingDownwards(const attitudeEulerAngles_t *attitude)
 {
     return ABS(attitude->values.roll) < DEGREES_80_IN_DECIDEGREES && ABS(attitude->values.pitch) < DEGREES_80_IN_DECIDEGREES;
 }
@@ -174,7 +174,7 @@ int32_t calculateAltHoldThrottleAdjustment(int32_t vel_tmp, float accZ_tmp, floa
     int32_t error;
     int32_t setVel;
 
-    if (!isThrustFacingDownwards(&attitude)) {
+    if (!isThrustFacingDownwards(imuGetAttitude())) {
         return result;
     }
 
@@ -72,7 +72,11 @@ static pidProfile_t *pidProfile;
 STATIC_UNIT_TESTED float q0 = 1.0f, q1 = 0.0f, q2 = 0.0f, q3 = 0.0f;    // quaternion of sensor frame relative to earth frame
 static float rMat[3][3];
 
-attitudeEulerAngles_t attitude = { { 0, 0, 0 } };     // absolute angle inclination in multiple of 0.1 degree    180 deg = 1800
+static attitudeEulerAngles_t attitude = { { 0, 0, 0 } };     // absolute angle inclination in multiple of 0.1 degree    180 deg = 1800
+
+// The quaternion is the primary attitude state, rMat and attitude are derived from it on demand
+static bool rMatValid = false;
+static bool attitudeValid = false;
 
 STATIC_UNIT_TESTED void imuComputeRotationMatrix(void)
 {
@@ -98,6 +102,21 @@ STATIC_UNIT_TESTED void imuComputeRotationMatrix(void)
     rMat[2][0] = 2.0f * (q1q3 + -q0q2);
     rMat[2][1] = 2.0f * (q2q3 - -q0q1);
     rMat[2][2] = 1.0f - 2.0f * q1q1 - 2.0f * q2q2;
+
+    rMatValid = true;
+}
+
+static void imuQuaternionUpdated(void)
+{
+    rMatValid = false;
+    attitudeValid = false;
+}
+
+static void imuUpdateRotationMatrix(void)
+{
+    if (!rMatValid) {
+        imuComputeRotationMatrix();
+    }
 }
 
 void imuConfigure(
@@ -121,7 +140,7 @@ void imuInit(void)
     smallAngleCosZ = cos_approx(degreesToRadians(imuRuntimeConfig.small_angle));
     accVelScale = 9.80665f / acc.dev.acc_1G / 10000.0f;
 
-    imuComputeRotationMatrix();
+    imuQuaternionUpdated();
 }
 
 float calculateThrottleAngleScale(uint16_t throttle_correction_angle)
@@ -150,6 +169,8 @@ void imuTransformVectorBodyToEarth(t_fp_vector * v)
 {
     float x,y,z;
 
+    imuUpdateRotationMatrix();
+
     /* From body frame to earth frame */
     x = rMat[0][0] * v->V.X + rMat[0][1] * v->V.Y + rMat[0][2] * v->V.Z;
     y = rMat[1][0] * v->V.X + rMat[1][1] * v->V.Y + rMat[1][2] * v->V.Z;
@@ -218,6 +239,26 @@ static float imuGetPGainScaleFactor(void)
     }
 }
 
+// First order quaternion integration of a body rate (rad/s), normalisation is left to the caller
+static void imuIntegrateQuaternion(float dt, float gx, float gy, float gz)
+{
+    gx *= (0.5f * dt);
+    gy *= (0.5f * dt);
+    gz *= (0.5f * dt);
+
+    const float qa = q0;
+    const float qb = q1;
+    const float qc = q2;
+    q0 += (-qb * gx - qc * gy - q3 * gz);
+    q1 += (qa * gx + qc * gz - q3 * gy);
+    q2 += (qa * gy - qb * gz + q3 * gx);
+    q3 += (qa * gz + qb * gy - qc * gx);
+
+    imuQuaternionUpdated();
+}
+
+// The gyro rate is integrated into the quaternion by imuUpdateGyroAttitude() every PID loop,
+// so this only applies the acc/mag/yaw correction at the attitude task rate
 static void imuMahonyAHRSupdate(float dt, float gx, float gy, float gz,
                                 bool useAcc, float ax, float ay, float az,
                                 bool useMag, float mx, float my, float mz,
@@ -227,7 +268,6 @@ static void imuMahonyAHRSupdate(float dt, float gx, float gy, float gz,
     float recipNorm;
     float hx, hy, bx;
     float ex = 0, ey = 0, ez = 0;
-    float qa, qb, qc;
 
     // Calculate general spin rate (rad/s)
     float spin_rate = sqrtf(sq(gx) + sq(gy) + sq(gz));
@@ -254,6 +294,7 @@ static void imuMahonyAHRSupdate(float dt, float gx, float gy, float gz,
 
         // (hx; hy; 0) - measured mag field vector in EF (assuming Z-component is zero)
         // (bx; 0; 0) - reference mag field vector heading due North in EF (assuming Z-component is zero)
+        imuUpdateRotationMatrix();
         hx = rMat[0][0] * mx + rMat[0][1] * my + rMat[0][2] * mz;
         hy = rMat[1][0] * mx + rMat[1][1] * my + rMat[1][2] * mz;
         bx = sqrtf(hx * hx + hy * hy);
@@ -276,10 +317,15 @@ static void imuMahonyAHRSupdate(float dt, float gx, float gy, float gz,
         ay *= recipNorm;
         az *= recipNorm;
 
+        // Estimated direction of gravity in BF, this is the last row of rMat taken straight from the quaternion
+        const float vx = 2.0f * (q1 * q3 - q0 * q2);
+        const float vy = 2.0f * (q2 * q3 + q0 * q1);
+        const float vz = 1.0f - 2.0f * (sq(q1) + sq(q2));
+
         // Error is sum of cross product between estimated direction and measured direction of gravity
-        ex += (ay * rMat[2][2] - az * rMat[2][1]);
-        ey += (az * rMat[2][0] - ax * rMat[2][2]);
-        ez += (ax * rMat[2][1] - ay * rMat[2][0]);
+        ex += (ay * vz - az * vy);
+        ey += (az * vx - ax * vz);
+        ez += (ax * vy - ay * vx);
     }
 
     // Compute and apply integral feedback if enabled
@@ -302,22 +348,7 @@ static void imuMahonyAHRSupdate(float dt, float gx, float gy, float gz,
     float dcmKpGain = imuRuntimeConfig.dcm_kp * imuGetPGainScaleFactor();
 
     // Apply proportional and integral feedback
-    gx += dcmKpGain * ex + integralFBx;
-    gy += dcmKpGain * ey + integralFBy;
-    gz += dcmKpGain * ez + integralFBz;
-
-    // Integrate rate of change of quaternion
-    gx *= (0.5f * dt);
-    gy *= (0.5f * dt);
-    gz *= (0.5f * dt);
-
-    qa = q0;
-    qb = q1;
-    qc = q2;
-    q0 += (-qb * gx - qc * gy - q3 * gz);
-    q1 += (qa * gx + qc * gz - q3 * gy);
-    q2 += (qa * gy - qb * gz + q3 * gx);
-    q3 += (qa * gz + qb * gy - qc * gx);
+    imuIntegrateQuaternion(dt, dcmKpGain * ex + integralFBx, dcmKpGain * ey + integralFBy, dcmKpGain * ez + integralFBz);
 
     // Normalise quaternion
     recipNorm = invSqrt(sq(q0) + sq(q1) + sq(q2) + sq(q3));
@@ -326,12 +357,13 @@ static void imuMahonyAHRSupdate(float dt, float gx, float gy, float gz,
     q2 *= recipNorm;
     q3 *= recipNorm;
 
-    // Pre-compute rotation matrix from quaternion
-    imuComputeRotationMatrix();
+    imuQuaternionUpdated();
 }
 
 STATIC_UNIT_TESTED void imuUpdateEulerAngles(void)
 {
+    imuUpdateRotationMatrix();
+
     /* Compute pitch/roll angles */
     attitude.values.roll = lrintf(atan2f(rMat[2][1], rMat[2][2]) * (1800.0f / M_PIf));
     attitude.values.pitch = lrintf(((0.5f * M_PIf) - acosf(-rMat[2][0])) * (1800.0f / M_PIf));
@@ -340,8 +372,12 @@ STATIC_UNIT_TESTED void imuUpdateEulerAngles(void)
     if (attitude.values.yaw < 0)
         attitude.values.yaw += 3600;
 
-    /* Update small angle state */
-    if (rMat[2][2] > smallAngleCosZ) {
+    attitudeValid = true;
+}
+
+static void imuUpdateSmallAngleState(void)
+{
+    if (getCosTiltAngle() > smallAngleCosZ) {
         ENABLE_STATE(SMALL_ANGLE);
     } else {
         DISABLE_STATE(SMALL_ANGLE);
@@ -389,7 +425,7 @@ static void imuCalculateEstimatedAttitude(timeUs_t currentTimeUs)
 #if defined(GPS)
     else if (STATE(FIXED_WING) && sensors(SENSOR_GPS) && STATE(GPS_FIX) && GPS_numSat >= 5 && GPS_speed >= 300) {
         // In case of a fixed-wing aircraft we can use GPS course over ground to correct heading
-        rawYawError = DECIDEGREES_TO_RADIANS(attitude.values.yaw - GPS_ground_course);
+        rawYawError = DECIDEGREES_TO_RADIANS(imuGetAttitude()->values.yaw - GPS_ground_course);
         useYaw = true;
     }
 #endif
@@ -400,14 +436,40 @@ static void imuCalculateEstimatedAttitude(timeUs_t currentTimeUs)
                         useMag, mag.magADC[X], mag.magADC[Y], mag.magADC[Z],
                         useYaw, rawYawError);
 
-    imuUpdateEulerAngles();
+    imuUpdateSmallAngleState();
+
+#if defined(BARO) || defined(SONAR)
+    // accSum is only consumed by the altitude estimation
+    if (sensors(SENSOR_BARO) || sensors(SENSOR_SONAR)) {
+        imuCalculateAcceleration(deltaT); // rotate acc vector into earth frame
+    }
+#else
+    UNUSED(deltaT);
+#endif
+}
+
+static bool imuIsAttitudeEstimationActive(void)
+{
+    return sensors(SENSOR_ACC) && acc.isAccelUpdatedAtLeastOnce;
+}
+
+// Gyro-only propagation of the attitude, called every PID loop so the level modes act on a current attitude
+void imuUpdateGyroAttitude(timeUs_t currentTimeUs)
+{
+    static timeUs_t previousGyroUpdateTime;
+
+    const timeDelta_t deltaT = cmpTimeUs(currentTimeUs, previousGyroUpdateTime);
+    previousGyroUpdateTime = currentTimeUs;
 
-    imuCalculateAcceleration(deltaT); // rotate acc vector into earth frame
+    if (imuIsAttitudeEstimationActive()) {
+        imuIntegrateQuaternion(deltaT * 1e-6f,
+                               DEGREES_TO_RADIANS(gyro.gyroADCf[X]), DEGREES_TO_RADIANS(gyro.gyroADCf[Y]), DEGREES_TO_RADIANS(gyro.gyroADCf[Z]));
+    }
 }
 
 void imuUpdateAttitude(timeUs_t currentTimeUs)
 {
-    if (sensors(SENSOR_ACC) && acc.isAccelUpdatedAtLeastOnce) {
+    if (imuIsAttitudeEstimationActive()) {
         imuCalculateEstimatedAttitude(currentTimeUs);
     } else {
         acc.accSmooth[X] = 0;
@@ -416,9 +478,33 @@ void imuUpdateAttitude(timeUs_t currentTimeUs)
     }
 }
 
+const attitudeEulerAngles_t *imuGetAttitude(void)
+{
+    if (!attitudeValid) {
+        imuUpdateEulerAngles();
+    }
+    return &attitude;
+}
+
+void imuGetInclination(float inclination[2])
+{
+    // Same as imuUpdateEulerAngles() for roll and pitch, but using the fast approximations and no rMat
+    inclination[FD_ROLL] = atan2_approx(2.0f * (q2 * q3 + q0 * q1), 1.0f - 2.0f * (sq(q1) + sq(q2))) * (1800.0f / M_PIf);
+    inclination[FD_PITCH] = ((0.5f * M_PIf) - acos_approx(-2.0f * (q1 * q3 - q0 * q2))) * (1800.0f / M_PIf);
+}
+
+void imuGetQuaternion(quaternion_t *quat)
+{
+    quat->w = q0;
+    quat->x = q1;
+    quat->y = q2;
+    quat->z = q3;
+}
+
 float getCosTiltAngle(void)
 {
-    return rMat[2][2];
+    // rMat[2][2] computed directly from the quaternion
+    return 1.0f - 2.0f * (sq(q1) + sq(q2));
 }
 
 int16_t calculateThrottleAngleCorrection(uint8_t throttle_correction_value)
@@ -428,10 +514,11 @@ int16_t calculateThrottleAngleCorrection(uint8_t throttle_correction_value)
     * small angle < 0.86 deg
     * TODO: Define this small angle in config.
     */
-    if (rMat[2][2] <= 0.015f) {
+    const float cosTiltAngle = getCosTiltAngle();
+    if (cosTiltAngle <= 0.015f) {
         return 0;
     }
-    int angle = lrintf(acosf(rMat[2][2]) * throttleAngleScale);
+    int angle = lrintf(acosf(cosTiltAngle) * throttleAngleScale);
     if (angle > 900)
         angle = 900;
     return lrintf(throttle_correction_value * sin_approx(angle / (900.0f * M_PIf / 2.0f)));
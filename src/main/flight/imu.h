@@ -45,7 +45,13 @@ typedef union {
     } values;
 } attitudeEulerAngles_t;
 
-extern attitudeEulerAngles_t attitude;
+// Quaternion of sensor frame relative to earth frame
+typedef struct quaternion_s {
+    float w;
+    float x;
+    float y;
+    float z;
+} quaternion_t;
 
 typedef struct accDeadband_s {
     uint8_t xy;                 // set the acc deadband for xy-Axis
@@ -96,9 +102,13 @@ void imuConfigure(
     uint16_t throttle_correction_angle
 );
 
+const attitudeEulerAngles_t *imuGetAttitude(void);
+void imuGetInclination(float inclination[2]);
+void imuGetQuaternion(quaternion_t *quat);
 float getCosTiltAngle(void);
 void calculateEstimatedAltitude(timeUs_t currentTimeUs);
 void imuUpdateAttitude(timeUs_t currentTimeUs);
+void imuUpdateGyroAttitude(timeUs_t currentTimeUs);
 float calculateThrottleAngleScale(uint16_t throttle_correction_angle);
 int16_t calculateThrottleAngleCorrection(uint8_t throttle_correction_value);
 float calculateAccZLowPassFilterRCTimeConstant(float accz_lpf_hz);
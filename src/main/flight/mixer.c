@@ -240,6 +240,10 @@ static uint16_t disarmMotorOutput, deadbandMotor3dHigh, deadbandMotor3dLow;
 uint16_t motorOutputHigh, motorOutputLow;
 static float rcCommandThrottleRange, rcCommandThrottleRange3dLow, rcCommandThrottleRange3dHigh;
 
+#define THRUST_LINEARIZATION_LOOKUP_LENGTH 33
+static float lookupThrustLinearization[THRUST_LINEARIZATION_LOOKUP_LENGTH];    // lookup table for mixer output -> motor command
+static bool thrustLinearizationEnabled;
+
 uint8_t getMotorCount()
 {
     return motorCount;
@@ -288,6 +292,31 @@ void initEscEndpoints(void) {
     rcCommandThrottleRange3dHigh = PWM_RANGE_MAX - rxConfig->midrc - flight3DConfig->deadband3d_throttle;
 }
 
+// Thrust is modelled as T = (1 - k) * c + k * c^2 for a normalised motor command c, where k is the
+// configured thrust_linear percentage. The table holds the inverse of that curve so that the mixer
+// output maps to a command giving proportional thrust.
+STATIC_UNIT_TESTED void generateThrustLinearizationCurve(void)
+{
+    thrustLinearizationEnabled = motorConfig->thrustLinearization > 0;
+    if (!thrustLinearizationEnabled) {
+        return;
+    }
+
+    const float k = motorConfig->thrustLinearization / 100.0f;
+    const float b = (1.0f - k) / (2.0f * k);
+    for (int i = 0; i < THRUST_LINEARIZATION_LOOKUP_LENGTH; i++) {
+        const float thrust = (float)i / (THRUST_LINEARIZATION_LOOKUP_LENGTH - 1);
+        lookupThrustLinearization[i] = sqrtf(thrust / k + b * b) - b;
+    }
+}
+
+STATIC_UNIT_TESTED float applyThrustLinearization(float motorOutput)
+{
+    motorOutput = constrainf(motorOutput, 0.0f, 1.0f) * (THRUST_LINEARIZATION_LOOKUP_LENGTH - 1);
+    const int index = MIN((int)motorOutput, THRUST_LINEARIZATION_LOOKUP_LENGTH - 2);
+    return lookupThrustLinearization[index] + (motorOutput - index) * (lookupThrustLinearization[index + 1] - lookupThrustLinearization[index]);
+}
+
 void mixerUseConfigs(
         flight3DConfig_t *flight3DConfigToUse,
         motorConfig_t *motorConfigToUse,
@@ -309,6 +338,7 @@ void mixerInit(mixerMode_e mixerMode, motorMixer_t *initialCustomMixers)
     customMixers = initialCustomMixers;
 
     initEscEndpoints();
+    generateThrustLinearizationCurve();
 }
 
 #ifndef USE_QUAD_MIXER_ONLY
@@ -431,6 +461,7 @@ void mixTable(pidProfile_t *pidProfile)
     uint16_t motorOutputMin, motorOutputMax;
     static uint16_t throttlePrevious = 0;   // Store the last throttle direction for deadband transitions
     bool mixerInversion = false;
+    bool reverseThrust = false;     // in the lower 3D range, where the thrust grows towards a motor output of 0
 
     // Find min and max throttle based on condition.
     if (feature(FEATURE_3D)) {
@@ -443,6 +474,7 @@ void mixTable(pidProfile_t *pidProfile)
             throttle = rcCommand[THROTTLE] - rxConfig->mincheck;
             currentThrottleInputRange = rcCommandThrottleRange3dLow;
             if(isMotorProtocolDshot()) mixerInversion = true;
+            reverseThrust = true;
         } else if (rcCommand[THROTTLE] >= (rxConfig->midrc + flight3DConfig->deadband3d_throttle)) { // Positive handling
             motorOutputMax = motorOutputHigh;
             motorOutputMin = deadbandMotor3dHigh;
@@ -455,6 +487,7 @@ void mixTable(pidProfile_t *pidProfile)
             throttle = rxConfig->midrc - flight3DConfig->deadband3d_throttle;
             currentThrottleInputRange = rcCommandThrottleRange3dLow;
             if(isMotorProtocolDshot()) mixerInversion = true;
+            reverseThrust = true;
         } else {  // Deadband handling from positive to negative
             motorOutputMax = motorOutputHigh;
             motorOutputMin = deadbandMotor3dHigh;
@@ -517,7 +550,15 @@ void mixTable(pidProfile_t *pidProfile)
     // roll/pitch/yaw. This could move throttle down, but also up for those low throttle flips.
     uint32_t i = 0;
     for (i = 0; i < motorCount; i++) {
-        motor[i] = motorOutputMin + lrintf(motorOutputRange * (motorMix[i] + (throttle * currentMixer[i].throttle)));
+        float motorOutput = motorMix[i] + (throttle * currentMixer[i].throttle);
+        if (thrustLinearizationEnabled) {
+            if (reverseThrust) {
+                motorOutput = 1.0f - applyThrustLinearization(1.0f - motorOutput);
+            } else {
+                motorOutput = applyThrustLinearization(motorOutput);
+            }
+        }
+        motor[i] = motorOutputMin + lrintf(motorOutputRange * motorOutput);
 
         // Dshot works exactly opposite in lower 3D section.
         if (mixerInversion) {
@@ -572,3 +613,18 @@ uint16_t convertMotorToExternal(uint16_t motorValue)
 
     return externalValue;
 }
+
+/*
+ * The change in a motor's output for a unit change of each PID sum and of the throttle rcCommand, leaving out the
+ * airmode scaling, thrust linearization and voltage compensation which mixTable() applies on top.
+ */
+void mixerGetMotorGains(uint8_t motorIndex, motorMixer_t *gains)
+{
+    const float motorOutputRange = motorOutputHigh - motorOutputLow;
+    const motorMixer_t *mix = &currentMixer[motorIndex];
+
+    gains->throttle = mix->throttle * motorOutputRange / rcCommandThrottleRange;
+    gains->roll = mix->roll * motorOutputRange / PID_MIXER_SCALING;
+    gains->pitch = mix->pitch * motorOutputRange / PID_MIXER_SCALING;
+    gains->yaw = mix->yaw * (-mixerConfig->yaw_motor_direction) * motorOutputRange / PID_MIXER_SCALING;
+}
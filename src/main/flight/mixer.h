@@ -141,3 +141,4 @@ void stopPwmAllMotors(void);
 bool isMotorProtocolDshot(void);
 uint16_t convertExternalToMotor(uint16_t externalValue);
 uint16_t convertMotorToExternal(uint16_t motorValue);
+void mixerGetMotorGains(uint8_t motorIndex, motorMixer_t *gains);
@@ -3645,6 +3645,14 @@ bool afatfs_destroy(bool dirty)
     return true;
 }
 
+/**
+ * Get the size of the sector cache which buffers file writes, the most afatfs_getFreeBufferSpace() can report.
+ */
+uint32_t afatfs_getBufferSize()
+{
+    return AFATFS_NUM_CACHE_SECTORS * AFATFS_SECTOR_SIZE;
+}
+
 /**
  * Get a pessimistic estimate of the amount of buffer space that we have available to write to immediately.
  */
@@ -511,7 +511,7 @@ void showSensorsPage(void)
     }
 #endif
 
-    tfp_sprintf(lineBuffer, format, "I&H", attitude.values.roll, attitude.values.pitch, DECIDEGREES_TO_DEGREES(attitude.values.yaw));
+    tfp_sprintf(lineBuffer, format, "I&H", imuGetAttitude()->values.roll, imuGetAttitude()->values.pitch, DECIDEGREES_TO_DEGREES(imuGetAttitude()->values.yaw));
     padLineBuffer();
     i2c_OLED_set_line(rowIndex++);
     i2c_OLED_send_string(lineBuffer);
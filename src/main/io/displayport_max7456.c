@@ -90,11 +90,7 @@ static int writeChar(displayPort_t *displayPort, uint8_t x, uint8_t y, uint8_t c
 static bool isTransferInProgress(const displayPort_t *displayPort)
 {
     UNUSED(displayPort);
-#ifdef MAX7456_DMA_CHANNEL_TX
     return max7456DmaInProgres();
-#else
-    return false;
-#endif
 }
 
 static void resync(displayPort_t *displayPort)
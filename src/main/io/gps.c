@@ -408,8 +408,13 @@ void gpsUpdate(timeUs_t currentTimeUs)
 {
     // read out available GPS bytes
     if (gpsPort) {
-        while (serialRxBytesWaiting(gpsPort))
-            gpsNewData(serialRead(gpsPort));
+        uint8_t buf[32];
+        int count;
+        while ((count = serialReadBuf(gpsPort, buf, sizeof(buf))) > 0) {
+            for (int i = 0; i < count; i++) {
+                gpsNewData(buf[i]);
+            }
+        }
     }
 
     switch (gpsData.state) {
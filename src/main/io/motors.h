@@ -28,5 +28,6 @@ typedef struct motorConfig_s {
     uint8_t  motorPwmProtocol;              // Pwm Protocol
     uint8_t  useUnsyncedPwm;
     float    digitalIdleOffsetPercent;
+    uint8_t  thrustLinearization;           // Amount of quadratic thrust compensation applied to the mixer output in percent (0 = off)
     ioTag_t  ioTags[MAX_SUPPORTED_MOTORS];
 } motorConfig_t;
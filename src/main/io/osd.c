@@ -282,8 +282,8 @@ static void osdDrawSingleElement(uint8_t item)
             elemPosX = 14;
             elemPosY = 6 - 4; // Top center of the AH area
 
-            int rollAngle = attitude.values.roll;
-            int pitchAngle = attitude.values.pitch;
+            int rollAngle = imuGetAttitude()->values.roll;
+            int pitchAngle = imuGetAttitude()->values.pitch;
 
             if (displayScreenSize(osdDisplayPort) == VIDEO_BUFFER_CHARS_PAL) {
                 ++elemPosY;
@@ -676,12 +676,10 @@ static void osdRefresh(timeUs_t currentTimeUs)
 void osdUpdate(timeUs_t currentTimeUs)
 {
     static uint32_t counter = 0;
-#ifdef MAX7456_DMA_CHANNEL_TX
     // don't touch buffers if DMA transaction is in progress
     if (displayIsTransferInProgress(osdDisplayPort)) {
         return;
     }
-#endif // MAX7456_DMA_CHANNEL_TX
 
     // redraw values in buffer
 #ifdef USE_MAX7456
@@ -135,6 +135,27 @@ STATIC_UNIT_TESTED void crsfDataReceive(uint16_t c)
     }
 }
 
+// Receive ISR callback for ports delivering complete frames
+STATIC_UNIT_TESTED void crsfFrameReceive(const uint8_t *data, int length)
+{
+    // the frame ended now, so make it look to the telemetry timing as if it started one frame time ago
+    crsfFrameStartAt = micros() - CRSF_TIME_NEEDED_PER_FRAME_US;
+
+    // a burst may hold several back to back frames, prefer the RC channels frame
+    while (length >= CRSF_FRAME_LENGTH_ADDRESS + CRSF_FRAME_LENGTH_FRAMELENGTH) {
+        const int fullFrameLength = data[1] + CRSF_FRAME_LENGTH_ADDRESS + CRSF_FRAME_LENGTH_FRAMELENGTH;
+        if (fullFrameLength > length || fullFrameLength > CRSF_FRAME_SIZE_MAX) {
+            return;
+        }
+        if (!crsfFrameDone || data[2] == CRSF_FRAMETYPE_RC_CHANNELS_PACKED) {
+            memcpy(crsfFrame.bytes, data, fullFrameLength);
+            crsfFrameDone = true;
+        }
+        data += fullFrameLength;
+        length -= fullFrameLength;
+    }
+}
+
 STATIC_UNIT_TESTED uint8_t crsfFrameCRC(void)
 {
     // CRC includes type and payload
@@ -237,6 +258,9 @@ bool crsfRxInit(const rxConfig_t *rxConfig, rxRuntimeConfig_t *rxRuntimeConfig)
     }
 
     serialPort = openSerialPort(portConfig->identifier, FUNCTION_RX_SERIAL, crsfDataReceive, CRSF_BAUDRATE, CRSF_PORT_MODE, CRSF_PORT_OPTIONS);
+    if (serialPort) {
+        serialSetRxFrameCallback(serialPort, crsfFrameReceive);
+    }
 
     return serialPort != NULL;
 }
@@ -24,6 +24,7 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "platform.h"
 
@@ -63,6 +64,30 @@ static uint32_t ibusChannelData[IBUS_MAX_CHANNEL];
 
 static uint8_t ibus[IBUS_BUFFSIZE] = { 0, };
 
+static bool ibusFrameStart(uint8_t c)
+{
+    if (ibusSyncByte == 0) {
+        // detect the frame type based on the STX byte.
+        if (c == 0x55) {
+            ibusModel = IBUS_MODEL_IA6;
+            ibusSyncByte = 0x55;
+            ibusFrameSize = 31;
+            ibusChecksum = 0x0000;
+            ibusChannelOffset = 1;
+        } else if (c == 0x20) {
+            ibusModel = IBUS_MODEL_IA6B;
+            ibusSyncByte = 0x20;
+            ibusFrameSize = 32;
+            ibusChannelOffset = 2;
+            ibusChecksum = 0xFFFF;
+        } else
+            return false;
+    } else if (ibusSyncByte != c) {
+        return false;
+    }
+    return true;
+}
+
 // Receive ISR callback
 static void ibusDataReceive(uint16_t c)
 {
@@ -77,26 +102,8 @@ static void ibusDataReceive(uint16_t c)
 
     ibusTimeLast = ibusTime;
 
-    if (ibusFramePosition == 0) {
-        if (ibusSyncByte == 0) {
-            // detect the frame type based on the STX byte.
-            if (c == 0x55) {
-                ibusModel = IBUS_MODEL_IA6;
-                ibusSyncByte = 0x55;
-                ibusFrameSize = 31;
-                ibusChecksum = 0x0000;
-                ibusChannelOffset = 1;
-            } else if (c == 0x20) {
-                ibusModel = IBUS_MODEL_IA6B;
-                ibusSyncByte = 0x20;
-                ibusFrameSize = 32;
-                ibusChannelOffset = 2;
-                ibusChecksum = 0xFFFF;
-            } else
-                return;
-        } else if (ibusSyncByte != c) {
-            return;
-        }
+    if (ibusFramePosition == 0 && !ibusFrameStart(c)) {
+        return;
     }
 
     ibus[ibusFramePosition] = (uint8_t)c;
@@ -108,6 +115,17 @@ static void ibusDataReceive(uint16_t c)
     }
 }
 
+// Receive ISR callback for ports delivering complete frames
+static void ibusFrameReceive(const uint8_t *data, int length)
+{
+    if (!ibusFrameStart(data[0]) || length != ibusFrameSize) {
+        return;
+    }
+
+    memcpy(ibus, data, ibusFrameSize);
+    ibusFrameDone = true;
+}
+
 static uint8_t ibusFrameStatus(void)
 {
     uint8_t i, offset;
@@ -169,6 +187,10 @@ bool ibusInit(const rxConfig_t *rxConfig, rxRuntimeConfig_t *rxRuntimeConfig)
 
     serialPort_t *ibusPort = openSerialPort(portConfig->identifier, FUNCTION_RX_SERIAL, ibusDataReceive, IBUS_BAUDRATE, portShared ? MODE_RXTX : MODE_RX, SERIAL_NOT_INVERTED);
 
+    if (ibusPort && !portShared) {
+        serialSetRxFrameCallback(ibusPort, ibusFrameReceive);
+    }
+
 #ifdef TELEMETRY
     if (portShared) {
         telemetrySharedPort = ibusPort;
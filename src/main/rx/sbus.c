@@ -18,6 +18,7 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "platform.h"
 
@@ -154,6 +155,17 @@ static void sbusDataReceive(uint16_t c)
     }
 }
 
+// Receive ISR callback for ports delivering complete frames
+static void sbusFrameReceive(const uint8_t *data, int length)
+{
+    if (length != SBUS_FRAME_SIZE || data[0] != SBUS_FRAME_BEGIN_BYTE) {
+        return;
+    }
+
+    memcpy(sbusFrame.bytes, data, SBUS_FRAME_SIZE);
+    sbusFrameDone = true;
+}
+
 static uint8_t sbusFrameStatus(void)
 {
     if (!sbusFrameDone) {
@@ -251,6 +263,10 @@ bool sbusInit(const rxConfig_t *rxConfig, rxRuntimeConfig_t *rxRuntimeConfig)
     portOptions_t options = (rxConfig->sbus_inversion) ? (SBUS_PORT_OPTIONS | SERIAL_INVERTED) : SBUS_PORT_OPTIONS;
     serialPort_t *sBusPort = openSerialPort(portConfig->identifier, FUNCTION_RX_SERIAL, sbusDataReceive, SBUS_BAUDRATE, portShared ? MODE_RXTX : MODE_RX, options);
 
+    if (sBusPort && !portShared) {
+        serialSetRxFrameCallback(sBusPort, sbusFrameReceive);
+    }
+
 #ifdef TELEMETRY
     if (portShared) {
         telemetrySharedPort = sBusPort;
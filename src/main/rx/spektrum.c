@@ -113,6 +113,19 @@ static void spektrumDataReceive(uint16_t c)
     }
 }
 
+// Receive ISR callback for ports delivering complete frames
+static void spektrumFrameReceive(const uint8_t *data, int length)
+{
+    if (length != SPEK_FRAME_SIZE) {
+        return;
+    }
+
+    for (int i = 0; i < SPEK_FRAME_SIZE; i++) {
+        spekFrame[i] = data[i];
+    }
+    rcFrameComplete = true;
+}
+
 static uint32_t spekChannelData[SPEKTRUM_MAX_SUPPORTED_CHANNEL_COUNT];
 static dispatchEntry_t srxlTelemetryDispatch = { .dispatch = srxlRxSendTelemetryDataDispatch};
 
@@ -305,6 +318,10 @@ bool spektrumInit(const rxConfig_t *rxConfig, rxRuntimeConfig_t *rxRuntimeConfig
         portShared || srxlEnabled ? MODE_RXTX : MODE_RX, 
         SERIAL_NOT_INVERTED | (srxlEnabled ? SERIAL_BIDIR : 0));
 
+    if (serialPort && !portShared) {
+        serialSetRxFrameCallback(serialPort, spektrumFrameReceive);
+    }
+
 #ifdef TELEMETRY
     if (portShared) {
         telemetrySharedPort = serialPort;
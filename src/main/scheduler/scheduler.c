@@ -130,15 +130,22 @@ void taskSystem(timeUs_t currentTimeUs)
 
 #ifndef SKIP_TASK_STATISTICS
 #define MOVING_SUM_COUNT 32
-timeUs_t checkFuncMaxExecutionTime;
-timeUs_t checkFuncTotalExecutionTime;
-timeUs_t checkFuncMovingSumExecutionTime;
+// execution times are measured with the cycle counter so short tasks are not rounded down to zero
+timeCycles_t checkFuncMaxExecutionCycles;
+uint64_t checkFuncTotalExecutionCycles;
+timeCycles_t checkFuncMovingSumExecutionCycles;
+
+static timeUs_t totalCyclesToMicros(uint64_t cycles)
+{
+    return cycles / clockMicrosToCycles(1);
+}
 
 void getCheckFuncInfo(cfCheckFuncInfo_t *checkFuncInfo)
 {
-    checkFuncInfo->maxExecutionTime = checkFuncMaxExecutionTime;
-    checkFuncInfo->totalExecutionTime = checkFuncTotalExecutionTime;
-    checkFuncInfo->averageExecutionTime = checkFuncMovingSumExecutionTime / MOVING_SUM_COUNT;
+    checkFuncInfo->maxExecutionTime = clockCyclesToMicros(checkFuncMaxExecutionCycles);
+    checkFuncInfo->totalExecutionTime = totalCyclesToMicros(checkFuncTotalExecutionCycles);
+    checkFuncInfo->averageExecutionTime = clockCyclesToMicros(checkFuncMovingSumExecutionCycles / MOVING_SUM_COUNT);
+    checkFuncInfo->averageExecutionTimeNs = clockCyclesToNanos(checkFuncMovingSumExecutionCycles / MOVING_SUM_COUNT);
 }
 
 void getTaskInfo(cfTaskId_e taskId, cfTaskInfo_t * taskInfo)
@@ -148,9 +155,10 @@ void getTaskInfo(cfTaskId_e taskId, cfTaskInfo_t * taskInfo)
     taskInfo->isEnabled = queueContains(&cfTasks[taskId]);
     taskInfo->desiredPeriod = cfTasks[taskId].desiredPeriod;
     taskInfo->staticPriority = cfTasks[taskId].staticPriority;
-    taskInfo->maxExecutionTime = cfTasks[taskId].maxExecutionTime;
-    taskInfo->totalExecutionTime = cfTasks[taskId].totalExecutionTime;
-    taskInfo->averageExecutionTime = cfTasks[taskId].movingSumExecutionTime / MOVING_SUM_COUNT;
+    taskInfo->maxExecutionTime = clockCyclesToMicros(cfTasks[taskId].maxExecutionCycles);
+    taskInfo->totalExecutionTime = totalCyclesToMicros(cfTasks[taskId].totalExecutionCycles);
+    taskInfo->averageExecutionTime = clockCyclesToMicros(cfTasks[taskId].movingSumExecutionCycles / MOVING_SUM_COUNT);
+    taskInfo->averageExecutionTimeNs = clockCyclesToNanos(cfTasks[taskId].movingSumExecutionCycles / MOVING_SUM_COUNT);
     taskInfo->latestDeltaTime = cfTasks[taskId].taskLatestDeltaTime;
 }
 #endif
@@ -200,13 +208,13 @@ void schedulerResetTaskStatistics(cfTaskId_e taskId)
     UNUSED(taskId);
 #else
     if (taskId == TASK_SELF) {
-        currentTask->movingSumExecutionTime = 0;
-        currentTask->totalExecutionTime = 0;
-        currentTask->maxExecutionTime = 0;
+        currentTask->movingSumExecutionCycles = 0;
+        currentTask->totalExecutionCycles = 0;
+        currentTask->maxExecutionCycles = 0;
     } else if (taskId < TASK_COUNT) {
-        cfTasks[taskId].movingSumExecutionTime = 0;
-        cfTasks[taskId].totalExecutionTime = 0;
-        cfTasks[taskId].totalExecutionTime = 0;
+        cfTasks[taskId].movingSumExecutionCycles = 0;
+        cfTasks[taskId].totalExecutionCycles = 0;
+        cfTasks[taskId].maxExecutionCycles = 0;
     }
 #endif
 }
@@ -249,6 +257,9 @@ void scheduler(void)
             const timeUs_t currentTimeBeforeCheckFuncCall = micros();
 #else
             const timeUs_t currentTimeBeforeCheckFuncCall = currentTimeUs;
+#endif
+#ifndef SKIP_TASK_STATISTICS
+            const timeCycles_t checkFuncStartCycles = getCycleCounter();
 #endif
             // Increase priority for event driven tasks
             if (task->dynamicPriority > 0) {
@@ -261,10 +272,10 @@ void scheduler(void)
 #endif
 #ifndef SKIP_TASK_STATISTICS
                 if (calculateTaskStatistics) {
-                    const uint32_t checkFuncExecutionTime = micros() - currentTimeBeforeCheckFuncCall;
-                    checkFuncMovingSumExecutionTime += checkFuncExecutionTime - checkFuncMovingSumExecutionTime / MOVING_SUM_COUNT;
-                    checkFuncTotalExecutionTime += checkFuncExecutionTime;   // time consumed by scheduler + task
-                    checkFuncMaxExecutionTime = MAX(checkFuncMaxExecutionTime, checkFuncExecutionTime);
+                    const timeCycles_t checkFuncExecutionCycles = getCycleCounter() - checkFuncStartCycles;
+                    checkFuncMovingSumExecutionCycles += checkFuncExecutionCycles - checkFuncMovingSumExecutionCycles / MOVING_SUM_COUNT;
+                    checkFuncTotalExecutionCycles += checkFuncExecutionCycles;   // time consumed by scheduler + task
+                    checkFuncMaxExecutionCycles = MAX(checkFuncMaxExecutionCycles, checkFuncExecutionCycles);
                 }
 #endif
                 task->lastSignaledAt = currentTimeBeforeCheckFuncCall;
@@ -313,11 +324,12 @@ void scheduler(void)
 #else
         if (calculateTaskStatistics) {
             const timeUs_t currentTimeBeforeTaskCall = micros();
+            const timeCycles_t taskStartCycles = getCycleCounter();
             selectedTask->taskFunc(currentTimeBeforeTaskCall);
-            const timeUs_t taskExecutionTime = micros() - currentTimeBeforeTaskCall;
-            selectedTask->movingSumExecutionTime += taskExecutionTime - selectedTask->movingSumExecutionTime / MOVING_SUM_COUNT;
-            selectedTask->totalExecutionTime += taskExecutionTime;   // time consumed by scheduler + task
-            selectedTask->maxExecutionTime = MAX(selectedTask->maxExecutionTime, taskExecutionTime);
+            const timeCycles_t taskExecutionCycles = getCycleCounter() - taskStartCycles;
+            selectedTask->movingSumExecutionCycles += taskExecutionCycles - selectedTask->movingSumExecutionCycles / MOVING_SUM_COUNT;
+            selectedTask->totalExecutionCycles += taskExecutionCycles;   // time consumed by scheduler + task
+            selectedTask->maxExecutionCycles = MAX(selectedTask->maxExecutionCycles, taskExecutionCycles);
         } else {
             selectedTask->taskFunc(currentTimeUs);
         }
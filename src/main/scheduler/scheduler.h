@@ -33,6 +33,7 @@ typedef struct {
     timeUs_t     maxExecutionTime;
     timeUs_t     totalExecutionTime;
     timeUs_t     averageExecutionTime;
+    uint32_t     averageExecutionTimeNs;    // resolves functions which run for less than a microsecond
 } cfCheckFuncInfo_t;
 
 typedef struct {
@@ -44,6 +45,7 @@ typedef struct {
     timeUs_t     maxExecutionTime;
     timeUs_t     totalExecutionTime;
     timeUs_t     averageExecutionTime;
+    uint32_t     averageExecutionTimeNs;    // resolves tasks which run for less than a microsecond
     timeUs_t     latestDeltaTime;
 } cfTaskInfo_t;
 
@@ -81,6 +83,9 @@ typedef enum {
 #ifdef TELEMETRY
     TASK_TELEMETRY,
 #endif
+#ifdef BLACKBOX
+    TASK_BLACKBOX,
+#endif
 #ifdef LED_STRIP
     TASK_LEDSTRIP,
 #endif
@@ -131,10 +136,10 @@ typedef struct {
     uint32_t taskLatestDeltaTime;
 
 #ifndef SKIP_TASK_STATISTICS
-    /* Statistics */
-    timeUs_t movingSumExecutionTime;  // moving sum over 32 samples
-    timeUs_t maxExecutionTime;
-    timeUs_t totalExecutionTime;    // total time consumed by task since boot
+    /* Statistics, in CPU clock cycles */
+    timeCycles_t movingSumExecutionCycles;  // moving sum over 32 samples
+    timeCycles_t maxExecutionCycles;
+    uint64_t totalExecutionCycles;          // total time consumed by task since boot
 #endif
 } cfTask_t;
 
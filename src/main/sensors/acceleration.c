@@ -249,6 +249,7 @@ bool accInit(const accelerometerConfig_t *accelerometerConfig, uint32_t gyroSamp
     // copy over the common gyro mpu settings
     acc.dev.mpuConfiguration = gyro.dev.mpuConfiguration;
     acc.dev.mpuDetectionResult = gyro.dev.mpuDetectionResult;
+    acc.dev.gyroRateKHz = gyro.dev.gyroRateKHz;
     if (!accDetect(&acc.dev, accelerometerConfig->acc_hardware)) {
         return false;
     }
@@ -199,10 +199,16 @@ bool isBaroReady(void) {
 uint32_t baroUpdate(void)
 {
     static barometerState_e state = BAROMETER_NEEDS_SAMPLES;
+    static bool samplesRead = false;
 
     switch (state) {
         default:
         case BAROMETER_NEEDS_SAMPLES:
+            // the sensor reads may be queued on the bus, so the samples read in the previous cycle are used
+            if (samplesRead) {
+                baro.dev.calculate(&baroPressure, &baroTemperature);
+                baroPressureSum = recalculateBarometerTotal(barometerConfig->baro_sample_count, baroPressureSum, baroPressure);
+            }
             baro.dev.get_ut();
             baro.dev.start_up();
             state = BAROMETER_NEEDS_CALCULATION;
@@ -212,8 +218,7 @@ uint32_t baroUpdate(void)
         case BAROMETER_NEEDS_CALCULATION:
             baro.dev.get_up();
             baro.dev.start_ut();
-            baro.dev.calculate(&baroPressure, &baroTemperature);
-            baroPressureSum = recalculateBarometerTotal(barometerConfig->baro_sample_count, baroPressureSum, baroPressure);
+            samplesRead = true;
             state = BAROMETER_NEEDS_SAMPLES;
             return baro.dev.ut_delay;
         break;
@@ -410,6 +410,7 @@ static bool gyroUpdateISR(gyroDev_t* gyroDev)
         gyroADC[axis] -= gyroZero[axis];
         // scale gyro output to degrees per second
         float gyroADCf = (float)gyroADC[axis] * gyroDev->scale;
+        gyro.gyroADCRawf[axis] = gyroADCf;
         gyroADCf = softLpfFilterApplyFn(softLpfFilter[axis], gyroADCf);
         gyroADCf = notchFilter1ApplyFn(notchFilter1[axis], gyroADCf);
         gyroADCf = notchFilter2ApplyFn(notchFilter2[axis], gyroADCf);
@@ -457,6 +458,7 @@ void gyroUpdate(void)
         gyroADC[axis] -= gyroZero[axis];
         // scale gyro output to degrees per second
         float gyroADCf = (float)gyroADC[axis] * gyro.dev.scale;
+        gyro.gyroADCRawf[axis] = gyroADCf;
 
         // Apply LPF
         DEBUG_SET(DEBUG_GYRO, axis, lrintf(gyroADCf));
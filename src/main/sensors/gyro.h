@@ -40,6 +40,7 @@ typedef struct gyro_s {
     gyroDev_t dev;
     uint32_t targetLooptime;
     float gyroADCf[XYZ_AXIS_COUNT];
+    float gyroADCRawf[XYZ_AXIS_COUNT];     // before filtering
 } gyro_t;
 
 extern gyro_t gyro;
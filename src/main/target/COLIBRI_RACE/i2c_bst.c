@@ -659,7 +659,7 @@ static bool bstSlaveProcessFeedbackCommand(uint8_t bstRequest)
             break;
         case BST_ATTITUDE:
             for (i = 0; i < 2; i++)
-                bstWrite16(attitude.raw[i]);
+                bstWrite16(imuGetAttitude()->raw[i]);
             //bstWrite16(heading);
             break;
         case BST_ALTITUDE:
@@ -1616,8 +1616,8 @@ bool writeGpsPositionPrameToBST(void)
 
 bool writeRollPitchYawToBST(void)
 {
-    int16_t X = -attitude.values.pitch * (M_PIf / 1800.0f) * 10000;
-    int16_t Y = attitude.values.roll * (M_PIf / 1800.0f) * 10000;
+    int16_t X = -imuGetAttitude()->values.pitch * (M_PIf / 1800.0f) * 10000;
+    int16_t Y = imuGetAttitude()->values.roll * (M_PIf / 1800.0f) * 10000;
     int16_t Z = 0;//radiusHeading * 10000;
 
     bstMasterStartBuffer(PUBLIC_ADDRESS);
@@ -65,7 +65,6 @@
 
 #define USE_FLASHFS
 #define USE_FLASH_M25P16
-#define M25P16_SPI_SHARED
 #define M25P16_CS_PIN           PC15
 #define M25P16_SPI_INSTANCE     SPI2
 
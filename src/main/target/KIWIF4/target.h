@@ -52,9 +52,8 @@
 #define USE_MAX7456
 #define MAX7456_SPI_INSTANCE    			SPI2
 #define MAX7456_SPI_CS_PIN      			PB12
-//#define MAX7456_DMA_CHANNEL_TX              DMA1_Stream5
-//#define MAX7456_DMA_CHANNEL_RX              DMA1_Stream0
-//#define MAX7456_DMA_IRQ_HANDLER_ID          DMA1_ST0_HANDLER
+//#define SPI2_DMA_CHANNEL_TX                 DMA1_Stream4
+//#define SPI2_DMA_CHANNEL_RX                 DMA1_Stream3
 
 
 #define USE_FLASHFS
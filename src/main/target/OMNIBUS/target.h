@@ -103,10 +103,8 @@
 #define MAX7456_SPI_INSTANCE    SPI1
 #define MAX7456_SPI_CS_PIN      PB1
 #define MAX7456_SPI_CLK         (SPI_CLOCK_STANDARD*2)
-#define MAX7456_RESTORE_CLK     (SPI_CLOCK_FAST)
-//#define MAX7456_DMA_CHANNEL_TX            DMA1_Channel3
-//#define MAX7456_DMA_CHANNEL_RX            DMA1_Channel2
-//#define MAX7456_DMA_IRQ_HANDLER_ID        DMA1_CH3_HANDLER
+//#define SPI1_DMA_CHANNEL_TX               DMA1_Channel3
+//#define SPI1_DMA_CHANNEL_RX               DMA1_Channel2
 
 #define USE_SPI
 #define USE_SPI_DEVICE_2 // PB12,13,14,15 on AF5
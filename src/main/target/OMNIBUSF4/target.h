@@ -80,7 +80,6 @@
 #define MAX7456_SPI_INSTANCE    SPI3
 #define MAX7456_SPI_CS_PIN      PA15
 #define MAX7456_SPI_CLK         (SPI_CLOCK_STANDARD*2)
-#define MAX7456_RESTORE_CLK     (SPI_CLOCK_FAST)
 
 #ifdef OMNIBUSF4SD
   #define ENABLE_BLACKBOX_LOGGING_ON_SDCARD_BY_DEFAULT
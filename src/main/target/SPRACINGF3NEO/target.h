@@ -97,6 +97,8 @@
 #define SPI3_SCK_PIN            PB3
 #define SPI3_MISO_PIN           PB4
 #define SPI3_MOSI_PIN           PB5
+#define SPI3_DMA_CHANNEL_TX     DMA2_Channel2
+#define SPI3_DMA_CHANNEL_RX     DMA2_Channel1
 
 #define VTX
 #define RTC6705_CS_GPIO         GPIOF
@@ -109,10 +111,6 @@
 #define MAX7456_SPI_INSTANCE    SPI3
 #define MAX7456_SPI_CS_PIN      PA15
 
-#define MAX7456_DMA_CHANNEL_TX              DMA2_Channel2
-#define MAX7456_DMA_CHANNEL_RX              DMA2_Channel1
-#define MAX7456_DMA_IRQ_HANDLER_ID          DMA2_CH1_HANDLER
-
 #define USE_SDCARD
 #define USE_SDCARD_SPI2
 
@@ -32,6 +32,9 @@
 
 #ifdef STM32F7
 #define STM_FAST_TARGET
+#define USE_DWT
+#define USE_BLACKBOX_PREROLL
+#define USE_BLACKBOX_HEADER_CACHE
 #define I2C3_OVERCLOCK true
 #define I2C4_OVERCLOCK true
 #endif
@@ -41,11 +44,18 @@
 ****************************/
 #ifdef STM32F4
 #define STM_FAST_TARGET
+#define USE_DWT
 #define USE_DSHOT
+#ifndef STM32F411xE
+// the pre-roll ring and header cache take 42KB of RAM, more than the F411 can spare
+#define USE_BLACKBOX_PREROLL
+#define USE_BLACKBOX_HEADER_CACHE
+#endif
 #define I2C3_OVERCLOCK true
 #endif
 
 #ifdef STM32F3
+#define USE_DWT
 #define USE_DSHOT
 #endif
 
@@ -450,7 +450,7 @@ static void sendFuelLevel(void)
 static void sendHeading(void)
 {
     sendDataHead(ID_COURSE_BP);
-    serialize16(DECIDEGREES_TO_DEGREES(attitude.values.yaw));
+    serialize16(DECIDEGREES_TO_DEGREES(imuGetAttitude()->values.yaw));
     sendDataHead(ID_COURSE_AP);
     serialize16(0);
 }
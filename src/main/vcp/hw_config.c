@@ -36,6 +36,9 @@
 #include "usb_pwr.h"
 
 #include <stdbool.h>
+#include <string.h>
+#include "build/atomic.h"
+
 #include "drivers/system.h"
 #include "drivers/nvic.h"
 
@@ -48,7 +51,6 @@
 /* Private variables ---------------------------------------------------------*/
 ErrorStatus HSEStartUpStatus;
 EXTI_InitTypeDef EXTI_InitStructure;
-__IO uint32_t packetSent;                                     // HJI
 extern __IO uint32_t receiveLength;                          // HJI
 
 uint8_t receiveBuffer[64];                                   // HJI
@@ -275,31 +277,115 @@ static void IntToUnicode(uint32_t value, uint8_t *pbuf, uint8_t len)
     }
 }
 
+/*
+ * Transmit path.
+ *
+ * Data is queued in txBuffer and moved to the double buffered IN endpoint straight from the ring
+ * in packets of up to VIRTUAL_COM_PORT_DATA_SIZE bytes. One packet buffer is owned by the endpoint
+ * while the other is loaded with the next packet, which is handed over as soon as the endpoint
+ * completes the previous one, so back to back packets go out in consecutive frames.
+ *
+ * The endpoint sends from the buffer selected by DTOG_TX and NAKs while DTOG_TX equals SW_BUF,
+ * so only one packet is released ahead of the endpoint and the next one stays prepared in the
+ * buffer selected by SW_BUF until the previous has been sent.
+ */
+#define VCP_TX_BUFFER_SIZE 256  // must be a power of 2 and a multiple of the packet size
+
+static uint8_t txBuffer[VCP_TX_BUFFER_SIZE];
+static volatile uint16_t txHead;            // written by CDC_Send_DATA()
+static volatile uint16_t txTail;            // advanced as packets are loaded into the endpoint
+static volatile bool txReleased;            // a packet is owned by the endpoint
+static volatile bool txPrepared;            // the next packet is loaded in the application buffer
+static volatile bool txZlpPending;          // the last packet was full, end the transfer with a ZLP
+
+static uint32_t txBytesQueued(void)
+{
+    return (txHead - txTail) & (VCP_TX_BUFFER_SIZE - 1);
+}
+
+// load the next contiguous span of the ring into the endpoint buffer owned by the application
+static void txPreparePacket(void)
+{
+    const uint32_t tail = txTail;
+    uint32_t length = txBytesQueued();
+    if (length > VCP_TX_BUFFER_SIZE - tail) {
+        length = VCP_TX_BUFFER_SIZE - tail;
+    }
+    if (length > VIRTUAL_COM_PORT_DATA_SIZE) {
+        length = VIRTUAL_COM_PORT_DATA_SIZE;
+    }
+
+    if (GetENDPOINT(ENDP1) & EP_DTOG_RX) {
+        UserToPMABufferCopy(&txBuffer[tail], ENDP1_BUF1ADDR, length);
+        SetEPDblBuf1Count(ENDP1, EP_DBUF_IN, length);
+    } else {
+        UserToPMABufferCopy(&txBuffer[tail], ENDP1_BUF0ADDR, length);
+        SetEPDblBuf0Count(ENDP1, EP_DBUF_IN, length);
+    }
+
+    txTail = (tail + length) & (VCP_TX_BUFFER_SIZE - 1);
+    txZlpPending = (length == VIRTUAL_COM_PORT_DATA_SIZE);
+    txPrepared = true;
+}
+
+// must be called with the USB interrupt masked, or from it
+static void txKick(void)
+{
+    if (!txReleased) {
+        if (!txPrepared) {
+            if (!txBytesQueued() && !txZlpPending) {
+                return;
+            }
+            txPreparePacket();
+        }
+        // toggle SW_BUF, handing the prepared buffer to the endpoint
+        FreeUserBuffer(ENDP1, EP_DBUF_IN);
+        txPrepared = false;
+        txReleased = true;
+    }
+
+    // only full packets are prepared ahead, a partial one keeps collecting data until the endpoint is free
+    if (!txPrepared && txBytesQueued() >= VIRTUAL_COM_PORT_DATA_SIZE) {
+        txPreparePacket();
+    }
+}
+
+void CDC_Send_Complete(void)
+{
+    txReleased = false;
+    txKick();
+}
+
+void CDC_Send_Reset(void)
+{
+    txReleased = false;
+    txPrepared = false;
+    txZlpPending = false;
+}
+
 /*******************************************************************************
  * Function Name  : Send DATA .
- * Description    : send the data received from the STM32 to the PC through USB
- * Input          : None.
+ * Description    : queue data to be sent from the STM32 to the PC through USB
+ * Input          : buffer to send, and the length of the buffer.
  * Output         : None.
- * Return         : None.
+ * Return         : number of bytes queued, less than sendLength if the buffer is full.
  *******************************************************************************/
 uint32_t CDC_Send_DATA(const uint8_t *ptrBuffer, uint32_t sendLength)
 {
-    /* Last transmission hasn't finished, abort */
-    if (packetSent) {
-        return 0;
+    const uint32_t free = CDC_Send_FreeBytes();
+    if (sendLength > free) {
+        sendLength = free;
     }
 
-    // We can only put 64 bytes in the buffer
-    if (sendLength > 64 / 2) {
-        sendLength = 64 / 2;
-    }
+    // copy in up to two spans, the head is published after the data
+    const uint32_t head = txHead;
+    const uint32_t span = (sendLength < VCP_TX_BUFFER_SIZE - head) ? sendLength : VCP_TX_BUFFER_SIZE - head;
+    memcpy(&txBuffer[head], ptrBuffer, span);
+    memcpy(txBuffer, ptrBuffer + span, sendLength - span);
+    txHead = (head + sendLength) & (VCP_TX_BUFFER_SIZE - 1);
 
-    // Try to load some bytes if we can
-    if (sendLength) {
-        UserToPMABufferCopy(ptrBuffer, ENDP1_TXADDR, sendLength);
-        SetEPTxCount(ENDP1, sendLength);
-        packetSent += sendLength;
-        SetEPTxValid(ENDP1);
+    ATOMIC_BLOCK(NVIC_PRIO_USB) {
+        txKick();
     }
 
     return sendLength;
@@ -307,8 +393,7 @@ uint32_t CDC_Send_DATA(const uint8_t *ptrBuffer, uint32_t sendLength)
 
 uint32_t CDC_Send_FreeBytes(void)
 {
-    /* this driver is blocking, so the buffer is unlimited */
-    return 255;
+    return VCP_TX_BUFFER_SIZE - 1 - txBytesQueued();
 }
 
 /*******************************************************************************
@@ -321,15 +406,12 @@ uint32_t CDC_Send_FreeBytes(void)
 uint32_t CDC_Receive_DATA(uint8_t* recvBuf, uint32_t len)
 {
     static uint8_t offset = 0;
-    uint8_t i;
 
     if (len > receiveLength) {
         len = receiveLength;
     }
 
-    for (i = 0; i < len; i++) {
-        recvBuf[i] = (uint8_t)(receiveBuffer[i + offset]);
-    }
+    memcpy(recvBuf, &receiveBuffer[offset], len);
 
     receiveLength -= len;
     offset += len;
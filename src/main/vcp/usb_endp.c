@@ -40,7 +40,6 @@
 #define VCOMPORT_IN_FRAME_INTERVAL             5
 /* Private macro -------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
-extern __IO uint32_t packetSent;         // HJI
 extern __IO uint8_t receiveBuffer[64];  // HJI
 __IO uint32_t receiveLength;             // HJI
 /* Private function prototypes -----------------------------------------------*/
@@ -56,7 +55,7 @@ __IO uint32_t receiveLength;             // HJI
 
 void EP1_IN_Callback(void)
 {
-    packetSent = 0;  // HJI
+    CDC_Send_Complete();
 }
 
 /*******************************************************************************
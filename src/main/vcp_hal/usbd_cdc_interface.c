@@ -46,6 +46,8 @@
   */
 
 /* Includes ------------------------------------------------------------------*/
+#include <string.h>
+
 #include "stm32f7xx_hal.h"
 #include "usbd_core.h"
 #include "usbd_desc.h"
@@ -76,6 +78,7 @@ uint32_t UserTxBufPtrIn = 0;/* Increment this pointer or roll it back to
                                start address when data are received over USART */
 uint32_t UserTxBufPtrOut = 0; /* Increment this pointer or roll it back to
                                  start address when data are sent over USB */
+uint32_t UserTxBufInFlight = 0; /* Length of the span being sent from UserTxBufPtrOut */
 
 uint32_t rxAvailable = 0;
 uint8_t* rxBuffPtr = NULL;
@@ -224,6 +227,15 @@ void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
 {
     if(htim->Instance != TIMusb) return;
 
+    USBD_CDC_HandleTypeDef *hcdc = (USBD_CDC_HandleTypeDef*)USBD_Device.pClassData;
+    if (hcdc == NULL || hcdc->TxState != 0) {
+        return;
+    }
+
+    /* The span sent last is only released once the endpoint is done with it */
+    UserTxBufPtrOut = (UserTxBufPtrOut + UserTxBufInFlight) % APP_TX_DATA_SIZE;
+    UserTxBufInFlight = 0;
+
     uint32_t buffptr;
     uint32_t buffsize;
 
@@ -231,7 +243,7 @@ void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
     {
         if(UserTxBufPtrOut > UserTxBufPtrIn) /* Roll-back */
         {
-            buffsize = APP_RX_DATA_SIZE - UserTxBufPtrOut;
+            buffsize = APP_TX_DATA_SIZE - UserTxBufPtrOut;
         }
         else
         {
@@ -244,11 +256,7 @@ void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
 
         if(USBD_CDC_TransmitPacket(&USBD_Device) == USBD_OK)
         {
-            UserTxBufPtrOut += buffsize;
-            if (UserTxBufPtrOut == APP_TX_DATA_SIZE)
-            {
-                UserTxBufPtrOut = 0;
-            }
+            UserTxBufInFlight = buffsize;
         }
     }
 }
@@ -320,12 +328,12 @@ uint32_t CDC_Receive_DATA(uint8_t* recvBuf, uint32_t len)
     uint32_t count = 0;
     if( (rxBuffPtr != NULL))
     {
-        while ((rxAvailable > 0) && count < len)
+        if (rxAvailable > 0)
         {
-            recvBuf[count] = rxBuffPtr[0];
-            rxBuffPtr++;
-            rxAvailable--;
-            count++;
+            count = (len < rxAvailable) ? len : rxAvailable;
+            memcpy(recvBuf, rxBuffPtr, count);
+            rxBuffPtr += count;
+            rxAvailable -= count;
             if(rxAvailable < 1)
                 USBD_CDC_ReceivePacket(&USBD_Device);
         }
@@ -353,24 +361,26 @@ uint32_t CDC_Send_FreeBytes(void)
 /**
  * @brief  CDC_Send_DATA
  *         CDC received data to be send over USB IN endpoint are managed in
- *         this function.
+ *         this function. The data is queued in UserTxBuffer, from where the
+ *         contiguous spans are handed to the endpoint by the TIMusb callback.
  * @param  ptrBuffer: Buffer of data to be sent
  * @param  sendLength: Number of data to be sent (in bytes)
- * @retval Bytes sent
+ * @retval Bytes queued, less than sendLength if the buffer is full
  */
 uint32_t CDC_Send_DATA(const uint8_t *ptrBuffer, uint32_t sendLength)
 {
-    USBD_CDC_HandleTypeDef *hcdc = (USBD_CDC_HandleTypeDef*)USBD_Device.pClassData;
-    while(hcdc->TxState != 0);
-
-    for (uint32_t i = 0; i < sendLength; i++)
-    {
-        UserTxBuffer[UserTxBufPtrIn] = ptrBuffer[i];
-        UserTxBufPtrIn = (UserTxBufPtrIn + 1) % APP_TX_DATA_SIZE;
-        while (CDC_Send_FreeBytes() == 0) {
-            delay(1);
-        }
+    const uint32_t free = CDC_Send_FreeBytes();
+    if (sendLength > free) {
+        sendLength = free;
     }
+
+    // copy in up to two spans, the write pointer is published after the data
+    const uint32_t ptrIn = UserTxBufPtrIn;
+    const uint32_t span = (sendLength < APP_TX_DATA_SIZE - ptrIn) ? sendLength : APP_TX_DATA_SIZE - ptrIn;
+    memcpy(&UserTxBuffer[ptrIn], ptrBuffer, span);
+    memcpy(UserTxBuffer, ptrBuffer + span, sendLength - span);
+    UserTxBufPtrIn = (ptrIn + sendLength) % APP_TX_DATA_SIZE;
+
     return sendLength;
 }
 
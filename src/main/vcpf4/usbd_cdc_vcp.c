@@ -24,6 +24,8 @@
 #endif /* USB_OTG_HS_INTERNAL_DMA_ENABLED */
 
 /* Includes ------------------------------------------------------------------*/
+#include <string.h>
+
 #include "usbd_cdc_vcp.h"
 #include "stm32f4xx_conf.h"
 #include "stdbool.h"
@@ -31,7 +33,6 @@
 
 LINE_CODING g_lc;
 
-extern __IO uint8_t USB_Tx_State;
 __IO uint32_t bDeviceState = UNCONNECTED; /* USB device status */
 
 /* These are external variables imported from CDC core to be used for IN transfer management. */
@@ -151,14 +152,31 @@ static uint16_t VCP_Ctrl(uint32_t Cmd, uint8_t* Buf, uint32_t Len)
 
 /*******************************************************************************
  * Function Name  : Send DATA .
- * Description    : send the data received from the STM32 to the PC through USB
+ * Description    : queue data to be sent from the STM32 to the PC through USB
  * Input          : buffer to send, and the length of the buffer.
  * Output         : None.
- * Return         : None.
+ * Return         : number of bytes queued, less than sendLength if the buffer is full.
  *******************************************************************************/
 uint32_t CDC_Send_DATA(const uint8_t *ptrBuffer, uint32_t sendLength)
 {
-    VCP_DataTx(ptrBuffer, sendLength);
+    /*
+        the data is copied into APP_Rx_Buffer, from where the CDC core hands the contiguous
+        spans to the IN endpoint directly in packets of CDC_DATA_IN_PACKET_SIZE bytes.
+        the buffer is filled while the core transmits, so there is no need to wait for
+        the endpoint to become idle.
+    */
+    const uint32_t free = CDC_Send_FreeBytes();
+    if (sendLength > free) {
+        sendLength = free;
+    }
+
+    // copy in up to two spans, the write pointer is published after the data
+    const uint32_t ptrIn = APP_Rx_ptr_in;
+    const uint32_t span = (sendLength < APP_RX_DATA_SIZE - ptrIn) ? sendLength : APP_RX_DATA_SIZE - ptrIn;
+    memcpy(&APP_Rx_Buffer[ptrIn], ptrBuffer, span);
+    memcpy(APP_Rx_Buffer, ptrBuffer + span, sendLength - span);
+    APP_Rx_ptr_in = (ptrIn + sendLength) % APP_RX_DATA_SIZE;
+
     return sendLength;
 }
 
@@ -170,8 +188,12 @@ uint32_t CDC_Send_FreeBytes(void)
         functionally equivalent to:
         (APP_Rx_ptr_out > APP_Rx_ptr_in ? APP_Rx_ptr_out - APP_Rx_ptr_in : APP_RX_DATA_SIZE - APP_Rx_ptr_in + APP_Rx_ptr_in)
         but without the impact of the condition check.
+
+        the CDC core advances APP_Rx_ptr_out when it starts a packet, the packet in flight
+        is kept out of the free space so it is not overwritten before it is in the FIFO.
     */
-    return ((APP_Rx_ptr_out - APP_Rx_ptr_in) + (-((int)(APP_Rx_ptr_out <= APP_Rx_ptr_in)) & APP_RX_DATA_SIZE)) - 1;
+    const uint32_t free = ((APP_Rx_ptr_out - APP_Rx_ptr_in) + (-((int)(APP_Rx_ptr_out <= APP_Rx_ptr_in)) & APP_RX_DATA_SIZE)) - 1;
+    return free > CDC_DATA_IN_PACKET_SIZE ? free - CDC_DATA_IN_PACKET_SIZE : 0;
 }
 
 /**
@@ -183,18 +205,11 @@ uint32_t CDC_Send_FreeBytes(void)
  */
 static uint16_t VCP_DataTx(const uint8_t* Buf, uint32_t Len)
 {
-    /*
-        make sure that any paragraph end frame is not in play
-        could just check for: USB_CDC_ZLP, but better to be safe
-        and wait for any existing transmission to complete.
-    */
-    while (USB_Tx_State != 0);
-
-    for (uint32_t i = 0; i < Len; i++) {
-        APP_Rx_Buffer[APP_Rx_ptr_in] = Buf[i];
-        APP_Rx_ptr_in = (APP_Rx_ptr_in + 1) % APP_RX_DATA_SIZE;
-
-        while (CDC_Send_FreeBytes() == 0) {
+    while (Len > 0) {
+        const uint32_t sent = CDC_Send_DATA(Buf, Len);
+        Buf += sent;
+        Len -= sent;
+        if (Len > 0) {
             delay(1);
         }
     }
@@ -213,10 +228,16 @@ uint32_t CDC_Receive_DATA(uint8_t* recvBuf, uint32_t len)
 {
     uint32_t count = 0;
 
+    // copy the contiguous spans up to the write pointer or the end of the buffer
     while (APP_Tx_ptr_out != APP_Tx_ptr_in && count < len) {
-        recvBuf[count] = APP_Tx_Buffer[APP_Tx_ptr_out];
-        APP_Tx_ptr_out = (APP_Tx_ptr_out + 1) % APP_TX_DATA_SIZE;
-        count++;
+        const uint32_t ptrIn = APP_Tx_ptr_in;
+        uint32_t span = (ptrIn > APP_Tx_ptr_out ? ptrIn : APP_TX_DATA_SIZE) - APP_Tx_ptr_out;
+        if (span > len - count) {
+            span = len - count;
+        }
+        memcpy(&recvBuf[count], &APP_Tx_Buffer[APP_Tx_ptr_out], span);
+        APP_Tx_ptr_out = (APP_Tx_ptr_out + span) % APP_TX_DATA_SIZE;
+        count += span;
     }
     return count;
 }
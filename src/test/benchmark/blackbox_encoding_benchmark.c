@@ -0,0 +1,160 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Compares the size and encode time of blackbox "P" frames written with the tag encoders and with the Golomb-Rice
+ * residual coder, using the firmware's encoder sources. The residuals are synthetic: slowly changing fields plus
+ * noisy gyro, acc and motor fields whose noise level is given on the command line.
+ *
+ * usage: blackbox_encoding_benchmark [noise] [frames]
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "blackbox/blackbox_encoding.h"
+
+#define FRAME_COUNT_DEFAULT 200000
+#define NOISE_DEFAULT       8
+#define I_INTERVAL          32
+#define MOTOR_COUNT         4
+
+typedef struct residualFrame_s {
+    int32_t time;
+    int32_t pidP[3];
+    int32_t pidI[3];
+    int32_t pidD[3];
+    int32_t rcCommand[4];
+    int32_t optional[2];
+    int32_t gyro[3];
+    int32_t acc[3];
+    int32_t debug[4];
+    int32_t motor[MOTOR_COUNT];
+} residualFrame_t;
+
+static uint32_t bytesWritten;
+static volatile uint8_t lastByte;
+
+void blackboxWrite(uint8_t value)
+{
+    lastByte = value;
+    bytesWritten++;
+}
+
+static int32_t noise(int level)
+{
+    // Sum of two uniforms, roughly the triangular spread of real sensor noise
+    return (rand() % (level + 1)) + (rand() % (level + 1)) - level;
+}
+
+static void generateFrames(residualFrame_t *frames, int count, int level)
+{
+    for (int i = 0; i < count; i++) {
+        residualFrame_t *frame = &frames[i];
+
+        frame->time = noise(1);
+        for (int axis = 0; axis < 3; axis++) {
+            frame->pidP[axis] = noise(level);
+            frame->pidI[axis] = noise(1);
+            frame->pidD[axis] = noise(level * 2);
+            frame->gyro[axis] = noise(level);
+            frame->acc[axis] = noise(level * 4);
+        }
+        for (int x = 0; x < 4; x++) {
+            frame->rcCommand[x] = (i % 50 == 0) ? noise(4) : 0;
+            frame->debug[x] = 0;
+        }
+        frame->optional[0] = (i % 100 == 0) ? noise(1) : 0;
+        frame->optional[1] = 0;
+        for (int x = 0; x < MOTOR_COUNT; x++) {
+            frame->motor[x] = noise(level * 2);
+        }
+    }
+}
+
+// The same field layout and encoders as writeInterframe()
+static void writeFrame(residualFrame_t *frame, bool golombRice)
+{
+    blackboxWrite('P');
+
+    if (golombRice) {
+        blackboxResidualCoderBegin();
+    }
+
+    blackboxWriteSignedVB(frame->time);
+    blackboxWriteSignedVBArray(frame->pidP, 3);
+    blackboxWriteTag2_3S32(frame->pidI);
+    blackboxWriteSignedVBArray(frame->pidD, 3);
+    blackboxWriteTag8_4S16(frame->rcCommand);
+    blackboxWriteTag8_8SVB(frame->optional, 2);
+    blackboxWriteSignedVBArray(frame->gyro, 3);
+    blackboxWriteSignedVBArray(frame->acc, 3);
+    blackboxWriteSignedVBArray(frame->debug, 4);
+    blackboxWriteSignedVBArray(frame->motor, MOTOR_COUNT);
+
+    if (golombRice) {
+        blackboxResidualCoderEnd();
+    }
+}
+
+static void runBenchmark(const char *name, residualFrame_t *frames, int count, bool golombRice)
+{
+    bytesWritten = 0;
+
+    const clock_t start = clock();
+
+    for (int i = 0; i < count; i++) {
+        if (i % I_INTERVAL == 0) {
+            blackboxResidualCoderReset();
+        }
+        writeFrame(&frames[i], golombRice);
+    }
+
+    const double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    printf("%-12s %8.2f bytes/frame %8.1f ns/frame\n", name, (double)bytesWritten / count, seconds * 1e9 / count);
+}
+
+int main(int argc, char *argv[])
+{
+    const int level = argc > 1 ? atoi(argv[1]) : NOISE_DEFAULT;
+    const int count = argc > 2 ? atoi(argv[2]) : FRAME_COUNT_DEFAULT;
+
+    if (level < 0 || count <= 0) {
+        fprintf(stderr, "usage: %s [noise] [frames]\n", argv[0]);
+        return 1;
+    }
+
+    residualFrame_t *frames = malloc(sizeof(*frames) * count);
+    if (!frames) {
+        return 1;
+    }
+
+    srand(1);
+    generateFrames(frames, count, level);
+
+    printf("%d P frames, noise +-%d\n", count, level);
+    runBenchmark("TAG", frames, count, false);
+    runBenchmark("GOLOMB_RICE", frames, count, true);
+
+    free(frames);
+
+    return 0;
+}
@@ -0,0 +1,219 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Decode blackbox logs on the host.
+ *
+ * usage: blackbox_decode [--index n] [--stats] [--benchmark passes] file.BFL
+ *
+ * By default the main ("I" and "P") frames of each log are written to stdout as CSV. --stats prints the frame counts
+ * and sizes instead, and --benchmark decodes the file the given number of times and prints the throughput.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "blackbox_decoder.h"
+
+#define MAX_LOGS 256
+
+typedef struct decodeOptions_s {
+    int logIndex;           // -1 for all the logs
+    bool stats;
+    int benchmarkPasses;
+    const char *filename;
+} decodeOptions_t;
+
+static void printFieldNames(void *userData, const blackboxLogHeader_t *header)
+{
+    const blackboxFrameDefinition_t *def = &header->frameDefs[BLACKBOX_FRAME_INTRA];
+
+    (void)userData;
+
+    for (int i = 0; i < def->fieldCount; i++) {
+        printf(i ? ",%s" : "%s", def->names[i]);
+    }
+    printf("\n");
+}
+
+static void printMainFrame(void *userData, blackboxFrameType_e frameType, const int32_t *values, int fieldCount)
+{
+    const blackboxFrameDefinition_t *def = userData;
+
+    if (frameType != BLACKBOX_FRAME_INTRA && frameType != BLACKBOX_FRAME_INTER) {
+        return;
+    }
+
+    for (int i = 0; i < fieldCount; i++) {
+        if (def->isSigned[i]) {
+            printf(i ? ",%d" : "%d", (int)values[i]);
+        } else {
+            printf(i ? ",%u" : "%u", (unsigned)values[i]);
+        }
+    }
+    printf("\n");
+}
+
+static void printStats(int logIndex, const blackboxDecoder_t *decoder)
+{
+    const blackboxDecoderStats_t *stats = &decoder->stats;
+
+    printf("Log %d: %u header bytes, %u corrupt frames\n", logIndex + 1, stats->headerBytes, stats->corruptFrames);
+    for (int i = 0; i < BLACKBOX_FRAME_TYPE_COUNT; i++) {
+        if (stats->frameCount[i]) {
+            printf("  %c frames %8u %8.2f bytes/frame\n", blackboxFrameTypeChar(i), stats->frameCount[i],
+                (double)stats->frameBytes[i] / stats->frameCount[i]);
+        }
+    }
+}
+
+static uint8_t *readFile(const char *filename, long *length)
+{
+    FILE *file = fopen(filename, "rb");
+    if (!file) {
+        return NULL;
+    }
+
+    fseek(file, 0, SEEK_END);
+    *length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    uint8_t *data = malloc(*length > 0 ? *length : 1);
+    if (data && fread(data, 1, *length, file) != (size_t)*length) {
+        free(data);
+        data = NULL;
+    }
+    fclose(file);
+
+    return data;
+}
+
+static bool parseOptions(int argc, char *argv[], decodeOptions_t *options)
+{
+    options->logIndex = -1;
+    options->stats = false;
+    options->benchmarkPasses = 0;
+    options->filename = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--index") == 0 && i + 1 < argc) {
+            options->logIndex = atoi(argv[++i]) - 1;
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            options->stats = true;
+        } else if (strcmp(argv[i], "--benchmark") == 0 && i + 1 < argc) {
+            options->benchmarkPasses = atoi(argv[++i]);
+        } else if (argv[i][0] != '-' && !options->filename) {
+            options->filename = argv[i];
+        } else {
+            return false;
+        }
+    }
+
+    return options->filename != NULL;
+}
+
+static void runBenchmark(const uint8_t *data, long length, const int *offsets, int logCount, int passes)
+{
+    static blackboxDecoder_t decoder;
+    const blackboxDecoderHandlers_t handlers = { NULL, NULL, NULL, NULL };
+    uint64_t frames = 0;
+
+    const clock_t start = clock();
+
+    for (int pass = 0; pass < passes; pass++) {
+        for (int i = 0; i < logCount; i++) {
+            const int logEnd = i + 1 < logCount ? offsets[i + 1] : length;
+
+            blackboxDecoderInit(&decoder, &handlers);
+            blackboxDecodeLog(&decoder, data + offsets[i], logEnd - offsets[i]);
+            for (int type = 0; type < BLACKBOX_FRAME_TYPE_COUNT; type++) {
+                frames += decoder.stats.frameCount[type];
+            }
+        }
+    }
+
+    const double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+    const double bytes = (double)length * passes;
+
+    printf("%llu frames in %.3f s: %.0f frames/s, %.2f MB/s\n", (unsigned long long)frames, seconds,
+        seconds > 0 ? frames / seconds : 0, seconds > 0 ? bytes / seconds / 1e6 : 0);
+}
+
+int main(int argc, char *argv[])
+{
+    static blackboxDecoder_t decoder;
+    static int offsets[MAX_LOGS];
+    decodeOptions_t options;
+    long length;
+
+    if (!parseOptions(argc, argv, &options)) {
+        fprintf(stderr, "usage: %s [--index n] [--stats] [--benchmark passes] file.BFL\n", argv[0]);
+        return 1;
+    }
+
+    uint8_t *data = readFile(options.filename, &length);
+    if (!data) {
+        fprintf(stderr, "Can't read %s\n", options.filename);
+        return 1;
+    }
+
+    const int logCount = blackboxFindLogs(data, length, offsets, MAX_LOGS);
+    if (logCount == 0) {
+        fprintf(stderr, "No logs found in %s\n", options.filename);
+        free(data);
+        return 1;
+    }
+
+    if (options.benchmarkPasses > 0) {
+        runBenchmark(data, length, offsets, logCount, options.benchmarkPasses);
+        free(data);
+        return 0;
+    }
+
+    for (int i = 0; i < logCount; i++) {
+        if (options.logIndex >= 0 && options.logIndex != i) {
+            continue;
+        }
+
+        const int logEnd = i + 1 < logCount ? offsets[i + 1] : length;
+        blackboxDecoderHandlers_t handlers = { NULL, NULL, NULL, &decoder.header.frameDefs[BLACKBOX_FRAME_INTRA] };
+
+        if (!options.stats) {
+            handlers.header = printFieldNames;
+            handlers.frame = printMainFrame;
+        }
+
+        blackboxDecoderInit(&decoder, &handlers);
+
+        if (!blackboxDecodeLog(&decoder, data + offsets[i], logEnd - offsets[i])) {
+            fprintf(stderr, "Log %d has no field definitions\n", i + 1);
+            continue;
+        }
+
+        if (options.stats) {
+            printStats(i, &decoder);
+        }
+    }
+
+    free(data);
+
+    return 0;
+}
@@ -0,0 +1,820 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "blackbox/blackbox_fielddefs.h"
+#include "common/golomb_rice.h"
+
+#include "blackbox_decoder.h"
+
+#define LOG_START_MARKER "H Product:Blackbox flight data recorder by Nicholas Sherlock\n"
+#define HEADER_LINE_LENGTH 1024
+
+static const char frameTypeChars[BLACKBOX_FRAME_TYPE_COUNT] = { 'I', 'P', 'F', 'S', 'G', 'H', 'E' };
+
+char blackboxFrameTypeChar(blackboxFrameType_e frameType)
+{
+    return frameTypeChars[frameType];
+}
+
+static int frameTypeFromChar(char c)
+{
+    for (int i = 0; i < BLACKBOX_FRAME_TYPE_COUNT; i++) {
+        if (frameTypeChars[i] == c) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void blackboxDecoderInit(blackboxDecoder_t *decoder, const blackboxDecoderHandlers_t *handlers)
+{
+    memset(decoder, 0, sizeof(*decoder));
+
+    decoder->handlers = *handlers;
+    decoder->header.iInterval = 32;
+    decoder->header.pIntervalNum = 1;
+    decoder->header.pIntervalDenom = 1;
+    decoder->header.gyroRawGain = 256;
+
+    decoder->mainHistory[0] = decoder->mainHistoryRing[0];
+    decoder->mainHistory[1] = decoder->mainHistoryRing[1];
+    decoder->mainHistory[2] = decoder->mainHistoryRing[2];
+}
+
+/**
+ * Store the offset of each log in a file of several, returns the number of logs found.
+ */
+int blackboxFindLogs(const uint8_t *data, int length, int *offsets, int maxLogs)
+{
+    const int markerLength = strlen(LOG_START_MARKER);
+    int count = 0;
+
+    for (int i = 0; i + markerLength <= length && count < maxLogs; i++) {
+        if (data[i] == 'H' && memcmp(&data[i], LOG_START_MARKER, markerLength) == 0) {
+            offsets[count++] = i;
+            i += markerLength - 1;
+        }
+    }
+
+    return count;
+}
+
+int blackboxFieldIndex(const blackboxFrameDefinition_t *def, const char *name)
+{
+    for (int i = 0; i < def->fieldCount; i++) {
+        if (strcmp(def->names[i], name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/*
+ * Stream reading
+ */
+
+static uint8_t readByte(blackboxDecoder_t *decoder)
+{
+    if (decoder->ptr < decoder->end) {
+        return *decoder->ptr++;
+    }
+    decoder->overrun = true;
+    return 0;
+}
+
+static uint32_t readUnsignedVB(blackboxDecoder_t *decoder)
+{
+    uint32_t result = 0;
+
+    // 5 bytes is enough to encode 32 bits
+    for (int shift = 0; shift < 35; shift += 7) {
+        const uint8_t c = readByte(decoder);
+
+        result |= (uint32_t)(c & 0x7F) << shift;
+        if (c < 128) {
+            return result;
+        }
+    }
+
+    // Too many bytes, the data is corrupt
+    decoder->overrun = true;
+    return 0;
+}
+
+static int32_t zigzagDecode(uint32_t value)
+{
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+static int32_t readSignedVB(blackboxDecoder_t *decoder)
+{
+    return zigzagDecode(readUnsignedVB(decoder));
+}
+
+static int32_t signExtend(uint32_t value, int bits)
+{
+    const uint32_t signBit = 1u << (bits - 1);
+
+    value &= (signBit << 1) - 1;
+    return (int32_t)(value ^ signBit) - (int32_t)signBit;
+}
+
+static void readTag2_3S32(blackboxDecoder_t *decoder, int32_t *values)
+{
+    const uint8_t leadByte = readByte(decoder);
+    uint8_t byte1, byte2;
+
+    switch (leadByte >> 6) {
+    case 0:
+        values[0] = signExtend(leadByte >> 4, 2);
+        values[1] = signExtend(leadByte >> 2, 2);
+        values[2] = signExtend(leadByte, 2);
+        break;
+    case 1:
+        values[0] = signExtend(leadByte, 4);
+        byte1 = readByte(decoder);
+        values[1] = signExtend(byte1 >> 4, 4);
+        values[2] = signExtend(byte1, 4);
+        break;
+    case 2:
+        values[0] = signExtend(leadByte, 6);
+        byte1 = readByte(decoder);
+        byte2 = readByte(decoder);
+        values[1] = signExtend(byte1, 6);
+        values[2] = signExtend(byte2, 6);
+        break;
+    case 3: {
+        uint8_t selector = leadByte;
+
+        for (int i = 0; i < 3; i++, selector >>= 2) {
+            const int byteCount = (selector & 0x03) + 1;
+            uint32_t value = 0;
+
+            for (int j = 0; j < byteCount; j++) {
+                value |= (uint32_t)readByte(decoder) << (8 * j);
+            }
+            values[i] = byteCount == 4 ? (int32_t)value : signExtend(value, 8 * byteCount);
+        }
+        break;
+    }
+    }
+}
+
+static void readTag8_4S16(blackboxDecoder_t *decoder, int32_t *values)
+{
+    uint8_t selector = readByte(decoder);
+    uint8_t buffer = 0;
+    int nibbleIndex = 0;
+
+    for (int i = 0; i < 4; i++, selector >>= 2) {
+        uint8_t byte1, byte2;
+
+        switch (selector & 0x03) {
+        case 0:
+            values[i] = 0;
+            break;
+        case 1:
+            if (nibbleIndex == 0) {
+                buffer = readByte(decoder);
+                values[i] = signExtend(buffer >> 4, 4);
+                nibbleIndex = 1;
+            } else {
+                values[i] = signExtend(buffer, 4);
+                nibbleIndex = 0;
+            }
+            break;
+        case 2:
+            if (nibbleIndex == 0) {
+                values[i] = signExtend(readByte(decoder), 8);
+            } else {
+                byte1 = readByte(decoder);
+                values[i] = signExtend(((buffer & 0x0F) << 4) | (byte1 >> 4), 8);
+                buffer = byte1;
+            }
+            break;
+        case 3:
+            byte1 = readByte(decoder);
+            byte2 = readByte(decoder);
+            if (nibbleIndex == 0) {
+                values[i] = signExtend((byte1 << 8) | byte2, 16);
+            } else {
+                values[i] = signExtend(((buffer & 0x0F) << 12) | (byte1 << 4) | (byte2 >> 4), 16);
+                buffer = byte2;
+            }
+            break;
+        }
+    }
+}
+
+static void readTag8_8SVB(blackboxDecoder_t *decoder, int32_t *values, int valueCount)
+{
+    if (valueCount == 1) {
+        values[0] = readSignedVB(decoder);
+        return;
+    }
+
+    const uint8_t header = readByte(decoder);
+
+    for (int i = 0; i < valueCount; i++) {
+        values[i] = (header & (1 << i)) ? readSignedVB(decoder) : 0;
+    }
+}
+
+/*
+ * Header parsing
+ */
+
+static void parseFieldNames(blackboxFrameDefinition_t *def, const char *value)
+{
+    def->fieldCount = 0;
+
+    while (*value && def->fieldCount < BLACKBOX_DECODER_MAX_FIELDS) {
+        const char *comma = strchr(value, ',');
+        const int length = comma ? comma - value : (int)strlen(value);
+        const int copyLength = length < BLACKBOX_DECODER_FIELD_NAME_LENGTH - 1 ? length : BLACKBOX_DECODER_FIELD_NAME_LENGTH - 1;
+
+        memcpy(def->names[def->fieldCount], value, copyLength);
+        def->names[def->fieldCount][copyLength] = '\0';
+        def->fieldCount++;
+
+        if (!comma) {
+            break;
+        }
+        value = comma + 1;
+    }
+}
+
+static int parseIntegers(const char *value, int32_t *dest, int maxCount)
+{
+    int count = 0;
+
+    while (*value && count < maxCount) {
+        char *next;
+        dest[count++] = strtol(value, &next, 10);
+        if (*next != ',' && *next != '/') {
+            break;
+        }
+        value = next + 1;
+    }
+
+    return count;
+}
+
+static void parseFieldValues(uint8_t *dest, const char *value)
+{
+    int32_t values[BLACKBOX_DECODER_MAX_FIELDS];
+    const int count = parseIntegers(value, values, BLACKBOX_DECODER_MAX_FIELDS);
+
+    for (int i = 0; i < count; i++) {
+        dest[i] = values[i];
+    }
+}
+
+static void parseHeaderLine(blackboxLogHeader_t *header, char *line)
+{
+    char *colon = strchr(line, ':');
+    if (!colon) {
+        return;
+    }
+    *colon = '\0';
+    const char *key = line;
+    const char *value = colon + 1;
+    int32_t values[4];
+
+    if (strncmp(key, "Field ", 6) == 0 && key[6] && key[7] == ' ') {
+        const int frameType = frameTypeFromChar(key[6]);
+        const char *property = key + 8;
+
+        if (frameType < 0) {
+            return;
+        }
+
+        blackboxFrameDefinition_t *def = &header->frameDefs[frameType];
+
+        if (strcmp(property, "name") == 0) {
+            parseFieldNames(def, value);
+        } else if (strcmp(property, "signed") == 0) {
+            parseFieldValues(def->isSigned, value);
+        } else if (strcmp(property, "predictor") == 0) {
+            parseFieldValues(def->predictor, value);
+        } else if (strcmp(property, "encoding") == 0) {
+            parseFieldValues(def->encoding, value);
+        }
+    } else if (strcmp(key, "Data version") == 0) {
+        header->dataVersion = atoi(value);
+    } else if (strcmp(key, "I interval") == 0) {
+        header->iInterval = atoi(value);
+        if (header->iInterval < 1) {
+            header->iInterval = 1;
+        }
+    } else if (strcmp(key, "P interval") == 0) {
+        if (parseIntegers(value, values, 2) == 2 && values[0] > 0 && values[1] > 0) {
+            header->pIntervalNum = values[0];
+            header->pIntervalDenom = values[1];
+        }
+    } else if (strcmp(key, "minthrottle") == 0) {
+        header->minthrottle = atoi(value);
+    } else if (strcmp(key, "motorOutput") == 0) {
+        if (parseIntegers(value, values, 2) == 2) {
+            header->motorOutputLow = values[0];
+            header->motorOutputHigh = values[1];
+        }
+    } else if (strcmp(key, "vbatref") == 0) {
+        header->vbatref = atoi(value);
+    } else if (strncmp(key, "mixerWeights[", 13) == 0) {
+        const int motor = atoi(key + 13);
+        if (motor >= 0 && motor < BLACKBOX_DECODER_MAX_MOTORS) {
+            parseIntegers(value, header->mixerWeights[motor], 4);
+        }
+    } else if (strcmp(key, "gyroRawGain") == 0) {
+        header->gyroRawGain = atoi(value);
+    }
+}
+
+static void parseHeader(blackboxDecoder_t *decoder)
+{
+    const uint8_t *start = decoder->ptr;
+    char line[HEADER_LINE_LENGTH];
+
+    while (decoder->ptr + 2 <= decoder->end && decoder->ptr[0] == 'H' && decoder->ptr[1] == ' ') {
+        const uint8_t *lineStart = decoder->ptr + 2;
+        const uint8_t *lineEnd = memchr(lineStart, '\n', decoder->end - lineStart);
+
+        if (!lineEnd) {
+            decoder->ptr = decoder->end;
+            break;
+        }
+
+        const int length = lineEnd - lineStart < HEADER_LINE_LENGTH ? lineEnd - lineStart : HEADER_LINE_LENGTH - 1;
+        memcpy(line, lineStart, length);
+        line[length] = '\0';
+        parseHeaderLine(&decoder->header, line);
+
+        decoder->ptr = lineEnd + 1;
+    }
+
+    // "P" frames share the names and signedness of the "I" frame fields
+    blackboxFrameDefinition_t *intra = &decoder->header.frameDefs[BLACKBOX_FRAME_INTRA];
+    blackboxFrameDefinition_t *inter = &decoder->header.frameDefs[BLACKBOX_FRAME_INTER];
+    inter->fieldCount = intra->fieldCount;
+    memcpy(inter->names, intra->names, sizeof(inter->names));
+    memcpy(inter->isSigned, intra->isSigned, sizeof(inter->isSigned));
+
+    decoder->stats.headerBytes = decoder->ptr - start;
+}
+
+/*
+ * Frame decoding
+ */
+
+static bool isFieldGroupEncoding(uint8_t encoding)
+{
+    return encoding == FLIGHT_LOG_FIELD_ENCODING_TAG8_8SVB;
+}
+
+// Read the raw (unpredicted) values of all the fields of a frame
+static void readFrameValues(blackboxDecoder_t *decoder, const blackboxFrameDefinition_t *def, int32_t *values)
+{
+    golombRiceReader_t reader;
+    bool bitCoded = false;
+    int contextIndex = 0;
+
+    for (int i = 0; i < def->fieldCount; i++) {
+        const uint8_t encoding = def->encoding[i];
+
+        switch (encoding) {
+        case FLIGHT_LOG_FIELD_ENCODING_SIGNED_VB:
+            values[i] = readSignedVB(decoder);
+            break;
+        case FLIGHT_LOG_FIELD_ENCODING_UNSIGNED_VB:
+            values[i] = readUnsignedVB(decoder);
+            break;
+        case FLIGHT_LOG_FIELD_ENCODING_NEG_14BIT:
+            values[i] = -signExtend(readUnsignedVB(decoder), 14);
+            break;
+        case FLIGHT_LOG_FIELD_ENCODING_TAG2_3S32:
+            if (i + 3 <= def->fieldCount) {
+                readTag2_3S32(decoder, &values[i]);
+            }
+            i += 2;
+            break;
+        case FLIGHT_LOG_FIELD_ENCODING_TAG8_4S16:
+            if (i + 4 <= def->fieldCount) {
+                readTag8_4S16(decoder, &values[i]);
+            }
+            i += 3;
+            break;
+        case FLIGHT_LOG_FIELD_ENCODING_TAG8_8SVB: {
+            int count = 1;
+            while (count < 8 && i + count < def->fieldCount && isFieldGroupEncoding(def->encoding[i + count])) {
+                count++;
+            }
+            readTag8_8SVB(decoder, &values[i], count);
+            i += count - 1;
+            break;
+        }
+        case FLIGHT_LOG_FIELD_ENCODING_GOLOMB_RICE:
+            if (!bitCoded) {
+                golombRiceReaderInit(&reader, decoder->ptr, decoder->end - decoder->ptr);
+                bitCoded = true;
+            }
+            values[i] = golombRiceRead(&reader, &decoder->residualContexts[contextIndex]);
+            if (contextIndex < BLACKBOX_RESIDUAL_CONTEXT_COUNT - 1) {
+                contextIndex++;
+            }
+            break;
+        case FLIGHT_LOG_FIELD_ENCODING_NULL:
+        default:
+            values[i] = 0;
+            break;
+        }
+    }
+
+    if (bitCoded) {
+        golombRiceReaderAlign(&reader);
+        decoder->ptr = reader.ptr;
+        decoder->overrun |= reader.overrun;
+    }
+}
+
+// A frame is only taken to be good if it ran to the start of another frame or the end of the data
+static bool frameEndIsValid(blackboxDecoder_t *decoder)
+{
+    return !decoder->overrun && (decoder->ptr == decoder->end || frameTypeFromChar(*decoder->ptr) >= 0);
+}
+
+static bool shouldHaveLoggedPFrame(const blackboxLogHeader_t *header, int pFrameIndex)
+{
+    return (pFrameIndex + header->pIntervalNum - 1) % header->pIntervalDenom < header->pIntervalNum;
+}
+
+static int32_t pidSumDelta(const blackboxDecoder_t *decoder, const blackboxFrameDefinition_t *def, int axis)
+{
+    static const char * const termNames[3] = { "axisP[%d]", "axisI[%d]", "axisD[%d]" };
+    char name[BLACKBOX_DECODER_FIELD_NAME_LENGTH];
+    int32_t delta = 0;
+
+    for (int term = 0; term < 3; term++) {
+        snprintf(name, sizeof(name), termNames[term], axis);
+        const int field = blackboxFieldIndex(def, name);
+        if (field >= 0) {
+            delta += decoder->mainHistory[0][field] - decoder->mainHistory[1][field];
+        }
+    }
+
+    return delta;
+}
+
+static int32_t mixerPrediction(const blackboxDecoder_t *decoder, const blackboxFrameDefinition_t *def, int field)
+{
+    const int motorIndex = atoi(def->names[field] + strlen("motor["));
+    const int throttleField = blackboxFieldIndex(def, "rcCommand[3]");
+    int32_t deltas[4];
+
+    if (motorIndex < 0 || motorIndex >= BLACKBOX_DECODER_MAX_MOTORS) {
+        return decoder->mainHistory[1][field];
+    }
+
+    for (int axis = 0; axis < 3; axis++) {
+        deltas[axis] = pidSumDelta(decoder, def, axis);
+    }
+    deltas[3] = throttleField >= 0 ? decoder->mainHistory[0][throttleField] - decoder->mainHistory[1][throttleField] : 0;
+
+    int32_t change = 0;
+    for (int i = 0; i < 4; i++) {
+        change += decoder->header.mixerWeights[motorIndex][i] * deltas[i];
+    }
+
+    return decoder->mainHistory[1][field] + (change >> 12);
+}
+
+/**
+ * Add the prediction to a raw field value. Fields are predicted in order, so predictors may use earlier fields of the
+ * same frame in "current".
+ */
+static int32_t applyPrediction(blackboxDecoder_t *decoder, blackboxFrameType_e frameType, int field, int32_t value,
+    const int32_t *current, const int32_t *previous, const int32_t *previous2, int *homeIndex)
+{
+    const blackboxFrameDefinition_t *def = &decoder->header.frameDefs[frameType];
+    int motor0;
+
+    switch (def->predictor[field]) {
+    case FLIGHT_LOG_FIELD_PREDICTOR_0:
+        return value;
+    case FLIGHT_LOG_FIELD_PREDICTOR_PREVIOUS:
+        return value + previous[field];
+    case FLIGHT_LOG_FIELD_PREDICTOR_STRAIGHT_LINE:
+        return value + 2 * previous[field] - previous2[field];
+    case FLIGHT_LOG_FIELD_PREDICTOR_AVERAGE_2:
+        return value + (previous[field] + previous2[field]) / 2;
+    case FLIGHT_LOG_FIELD_PREDICTOR_MINTHROTTLE:
+        return value + decoder->header.minthrottle;
+    case FLIGHT_LOG_FIELD_PREDICTOR_MOTOR_0:
+        motor0 = blackboxFieldIndex(def, "motor[0]");
+        return value + (motor0 >= 0 && motor0 < field ? current[motor0] : 0);
+    case FLIGHT_LOG_FIELD_PREDICTOR_INC:
+        return value + previous[field] + 1;
+    case FLIGHT_LOG_FIELD_PREDICTOR_HOME_COORD:
+        return value + decoder->gpsHome[(*homeIndex)++ & 1];
+    case FLIGHT_LOG_FIELD_PREDICTOR_1500:
+        return value + 1500;
+    case FLIGHT_LOG_FIELD_PREDICTOR_VBATREF:
+        return value + decoder->header.vbatref;
+    case FLIGHT_LOG_FIELD_PREDICTOR_LAST_MAIN_FRAME_TIME:
+        return value + decoder->lastMainFrameTime;
+    case FLIGHT_LOG_FIELD_PREDICTOR_MINMOTOR:
+        return value + decoder->header.motorOutputLow;
+    case FLIGHT_LOG_FIELD_PREDICTOR_MIXER:
+        return value + mixerPrediction(decoder, def, field);
+    case FLIGHT_LOG_FIELD_PREDICTOR_GYRO_RAW: {
+        // The raw gyro of the same axis is logged earlier in the frame
+        char rawName[BLACKBOX_DECODER_FIELD_NAME_LENGTH];
+        snprintf(rawName, sizeof(rawName), "gyroRaw%s", def->names[field] + strlen("gyroADC"));
+        const int rawField = blackboxFieldIndex(def, rawName);
+        const int32_t raw = rawField >= 0 ? current[rawField] : previous[field];
+        return value + previous[field] + (((raw - previous[field]) * decoder->header.gyroRawGain) >> 8);
+    }
+    default:
+        return value;
+    }
+}
+
+static void rotateMainHistory(blackboxDecoder_t *decoder, bool intraframe)
+{
+    int32_t *current = decoder->mainHistory[0];
+
+    if (intraframe) {
+        decoder->mainHistory[1] = current;
+        decoder->mainHistory[2] = current;
+    } else {
+        decoder->mainHistory[2] = decoder->mainHistory[1];
+        decoder->mainHistory[1] = current;
+    }
+
+    // Pick a ring entry which is neither of the history frames
+    for (int i = 0; i < 3; i++) {
+        if (decoder->mainHistoryRing[i] != decoder->mainHistory[1] && decoder->mainHistoryRing[i] != decoder->mainHistory[2]) {
+            decoder->mainHistory[0] = decoder->mainHistoryRing[i];
+            break;
+        }
+    }
+}
+
+static void emitFrame(blackboxDecoder_t *decoder, blackboxFrameType_e frameType, const int32_t *values)
+{
+    if (decoder->handlers.frame) {
+        decoder->handlers.frame(decoder->handlers.userData, frameType, values, decoder->header.frameDefs[frameType].fieldCount);
+    }
+}
+
+static bool decodeMainFrame(blackboxDecoder_t *decoder, bool intraframe)
+{
+    const blackboxFrameType_e frameType = intraframe ? BLACKBOX_FRAME_INTRA : BLACKBOX_FRAME_INTER;
+    const blackboxFrameDefinition_t *def = &decoder->header.frameDefs[frameType];
+    int32_t *current = decoder->mainHistory[0];
+    const int32_t *previous = decoder->mainHistory[1];
+    const int32_t *previous2 = decoder->mainHistory[2];
+    int homeIndex = 0;
+
+    if (intraframe) {
+        // The residual coder starts over at every "I" frame
+        for (int i = 0; i < BLACKBOX_RESIDUAL_CONTEXT_COUNT; i++) {
+            golombRiceContextInit(&decoder->residualContexts[i]);
+        }
+    }
+
+    readFrameValues(decoder, def, current);
+
+    if (!frameEndIsValid(decoder)) {
+        return false;
+    }
+
+    int skippedFrames = 0;
+    if (!intraframe) {
+        // Count the iterations which weren't logged on purpose, which the "INC" predictor has to step over
+        decoder->pFrameIndex++;
+        while (!shouldHaveLoggedPFrame(&decoder->header, decoder->pFrameIndex) && skippedFrames < decoder->header.iInterval) {
+            decoder->pFrameIndex++;
+            skippedFrames++;
+        }
+    }
+
+    for (int i = 0; i < def->fieldCount; i++) {
+        current[i] = applyPrediction(decoder, frameType, i, current[i], current, previous, previous2, &homeIndex);
+        if (def->predictor[i] == FLIGHT_LOG_FIELD_PREDICTOR_INC) {
+            current[i] += skippedFrames;
+        }
+    }
+
+    if (intraframe) {
+        decoder->mainHistoryValid = true;
+        decoder->pFrameIndex = 0;
+        // "F" frames start over from zero after every "I" frame
+        memset(decoder->gyroHistory, 0, sizeof(decoder->gyroHistory));
+    }
+
+    // A "P" frame can't be decoded until there's been an "I" frame to predict it from
+    if (decoder->mainHistoryValid) {
+        const int timeField = blackboxFieldIndex(def, "time");
+        if (timeField >= 0) {
+            decoder->lastMainFrameTime = current[timeField];
+        }
+        emitFrame(decoder, frameType, current);
+    }
+
+    rotateMainHistory(decoder, intraframe);
+
+    return true;
+}
+
+static bool decodeSimpleFrame(blackboxDecoder_t *decoder, blackboxFrameType_e frameType, int32_t *history)
+{
+    static const int32_t noHistory[BLACKBOX_DECODER_MAX_FIELDS];
+    const blackboxFrameDefinition_t *def = &decoder->header.frameDefs[frameType];
+    int32_t values[BLACKBOX_DECODER_MAX_FIELDS];
+    int homeIndex = 0;
+
+    readFrameValues(decoder, def, values);
+
+    if (!frameEndIsValid(decoder)) {
+        return false;
+    }
+
+    for (int i = 0; i < def->fieldCount; i++) {
+        const int32_t *previous = history ? history : noHistory;
+        values[i] = applyPrediction(decoder, frameType, i, values[i], values, previous, previous, &homeIndex);
+    }
+
+    if (history) {
+        memcpy(history, values, sizeof(values[0]) * def->fieldCount);
+    }
+
+    if (frameType == BLACKBOX_FRAME_GPS_HOME && def->fieldCount >= 2) {
+        decoder->gpsHome[0] = values[0];
+        decoder->gpsHome[1] = values[1];
+    }
+
+    emitFrame(decoder, frameType, values);
+
+    return true;
+}
+
+static bool decodeEventFrame(blackboxDecoder_t *decoder)
+{
+    const uint8_t event = readByte(decoder);
+    int32_t values[BLACKBOX_DECODER_MAX_EVENT_VALUES];
+    int valueCount = 0;
+
+    switch (event) {
+    case FLIGHT_LOG_EVENT_SYNC_BEEP:
+        values[valueCount++] = readUnsignedVB(decoder);
+        break;
+    case FLIGHT_LOG_EVENT_FLIGHTMODE:
+        values[valueCount++] = readUnsignedVB(decoder);
+        values[valueCount++] = readUnsignedVB(decoder);
+        break;
+    case FLIGHT_LOG_EVENT_INFLIGHT_ADJUSTMENT:
+        values[valueCount] = readByte(decoder);
+        if (values[valueCount++] & FLIGHT_LOG_EVENT_INFLIGHT_ADJUSTMENT_FUNCTION_FLOAT_VALUE_FLAG) {
+            uint32_t bits = 0;
+            for (int i = 0; i < 4; i++) {
+                bits |= (uint32_t)readByte(decoder) << (8 * i);
+            }
+            values[valueCount++] = bits;
+        } else {
+            values[valueCount++] = readSignedVB(decoder);
+        }
+        break;
+    case FLIGHT_LOG_EVENT_LOGGING_RESUME:
+        values[valueCount++] = readUnsignedVB(decoder);
+        values[valueCount++] = readUnsignedVB(decoder);
+        // The frames before the pause can't be used for prediction
+        decoder->mainHistoryValid = false;
+        break;
+    case FLIGHT_LOG_EVENT_PREROLL_TRIGGER:
+        values[valueCount++] = readUnsignedVB(decoder);
+        values[valueCount++] = readUnsignedVB(decoder);
+        break;
+    case FLIGHT_LOG_EVENT_RATE_CHANGE:
+        values[valueCount++] = readUnsignedVB(decoder);
+        values[valueCount++] = readUnsignedVB(decoder);
+        // Takes effect from the next "I" frame, which is where the firmware changes the rate
+        if (values[0] > 0 && values[1] > 0) {
+            decoder->header.pIntervalNum = values[0];
+            decoder->header.pIntervalDenom = values[1];
+        }
+        break;
+    case FLIGHT_LOG_EVENT_LOG_END: {
+        static const char endMessage[] = "End of log";
+        for (unsigned i = 0; i < sizeof(endMessage); i++) {
+            if (readByte(decoder) != (uint8_t)endMessage[i]) {
+                return false;
+            }
+        }
+        decoder->logEnded = true;
+        break;
+    }
+    default:
+        return false;
+    }
+
+    // Anything may follow the end of the log
+    if (event == FLIGHT_LOG_EVENT_LOG_END ? decoder->overrun : !frameEndIsValid(decoder)) {
+        decoder->logEnded = false;
+        return false;
+    }
+
+    if (decoder->handlers.event) {
+        decoder->handlers.event(decoder->handlers.userData, event, values, valueCount);
+    }
+
+    return true;
+}
+
+/**
+ * Decode the log which starts at data, up to the end of the log or of the data. Frames which can't be decoded are
+ * counted and skipped, and decoding continues from the next "I" frame. Returns false if the data doesn't start with
+ * a log header.
+ */
+bool blackboxDecodeLog(blackboxDecoder_t *decoder, const uint8_t *data, int length)
+{
+    decoder->ptr = data;
+    decoder->end = data + length;
+
+    parseHeader(decoder);
+
+    if (decoder->header.frameDefs[BLACKBOX_FRAME_INTRA].fieldCount == 0) {
+        return false;
+    }
+
+    if (decoder->handlers.header) {
+        decoder->handlers.header(decoder->handlers.userData, &decoder->header);
+    }
+
+    while (decoder->ptr < decoder->end && !decoder->logEnded) {
+        const uint8_t *frameStart = decoder->ptr;
+        const int frameType = frameTypeFromChar(readByte(decoder));
+        bool valid;
+
+        decoder->overrun = false;
+
+        switch (frameType) {
+        case BLACKBOX_FRAME_INTRA:
+            valid = decodeMainFrame(decoder, true);
+            break;
+        case BLACKBOX_FRAME_INTER:
+            valid = decodeMainFrame(decoder, false);
+            break;
+        case BLACKBOX_FRAME_GYRO:
+            valid = decodeSimpleFrame(decoder, BLACKBOX_FRAME_GYRO, decoder->gyroHistory);
+            break;
+        case BLACKBOX_FRAME_SLOW:
+            valid = decodeSimpleFrame(decoder, BLACKBOX_FRAME_SLOW, NULL);
+            break;
+        case BLACKBOX_FRAME_GPS:
+            valid = decodeSimpleFrame(decoder, BLACKBOX_FRAME_GPS, decoder->gpsHistory);
+            break;
+        case BLACKBOX_FRAME_GPS_HOME:
+            valid = decodeSimpleFrame(decoder, BLACKBOX_FRAME_GPS_HOME, NULL);
+            break;
+        case BLACKBOX_FRAME_EVENT:
+            valid = decodeEventFrame(decoder);
+            break;
+        default:
+            valid = false;
+            break;
+        }
+
+        if (valid) {
+            decoder->stats.frameCount[frameType]++;
+            decoder->stats.frameBytes[frameType] += decoder->ptr - frameStart;
+        } else {
+            // Resynchronise on the next byte, nothing can be predicted from the frames before the damage
+            decoder->stats.corruptFrames++;
+            decoder->mainHistoryValid = false;
+            decoder->ptr = frameStart + 1;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,114 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "blackbox/blackbox_encoding.h"
+#include "common/golomb_rice.h"
+
+/*
+ * Host side decoder for blackbox logs, driven by the field definitions in the log header and the predictor and
+ * encoding numbers of blackbox_fielddefs.h.
+ */
+
+#define BLACKBOX_DECODER_MAX_FIELDS         64
+#define BLACKBOX_DECODER_FIELD_NAME_LENGTH  32
+#define BLACKBOX_DECODER_MAX_MOTORS         8
+#define BLACKBOX_DECODER_MAX_EVENT_VALUES   4
+
+// Frame types, in the order of the per type statistics
+typedef enum {
+    BLACKBOX_FRAME_INTRA = 0,           // 'I'
+    BLACKBOX_FRAME_INTER,               // 'P'
+    BLACKBOX_FRAME_GYRO,                // 'F'
+    BLACKBOX_FRAME_SLOW,                // 'S'
+    BLACKBOX_FRAME_GPS,                 // 'G'
+    BLACKBOX_FRAME_GPS_HOME,            // 'H'
+    BLACKBOX_FRAME_EVENT,               // 'E'
+    BLACKBOX_FRAME_TYPE_COUNT
+} blackboxFrameType_e;
+
+typedef struct blackboxFrameDefinition_s {
+    int fieldCount;
+    char names[BLACKBOX_DECODER_MAX_FIELDS][BLACKBOX_DECODER_FIELD_NAME_LENGTH];
+    uint8_t isSigned[BLACKBOX_DECODER_MAX_FIELDS];
+    uint8_t predictor[BLACKBOX_DECODER_MAX_FIELDS];
+    uint8_t encoding[BLACKBOX_DECODER_MAX_FIELDS];
+} blackboxFrameDefinition_t;
+
+typedef struct blackboxLogHeader_s {
+    blackboxFrameDefinition_t frameDefs[BLACKBOX_FRAME_TYPE_COUNT];
+    int dataVersion;
+    int iInterval;
+    int pIntervalNum;
+    int pIntervalDenom;
+    int minthrottle;
+    int motorOutputLow;
+    int motorOutputHigh;
+    int vbatref;
+    int32_t mixerWeights[BLACKBOX_DECODER_MAX_MOTORS][4]; // roll, pitch, yaw, throttle
+    int32_t gyroRawGain;
+} blackboxLogHeader_t;
+
+typedef struct blackboxDecoderStats_s {
+    uint32_t frameCount[BLACKBOX_FRAME_TYPE_COUNT];
+    uint32_t frameBytes[BLACKBOX_FRAME_TYPE_COUNT];
+    uint32_t corruptFrames;
+    uint32_t headerBytes;
+} blackboxDecoderStats_t;
+
+typedef struct blackboxDecoderHandlers_s {
+    // Called once the log header has been parsed
+    void (*header)(void *userData, const blackboxLogHeader_t *header);
+    // Called for each decoded frame with the predicted field values, not called for events
+    void (*frame)(void *userData, blackboxFrameType_e frameType, const int32_t *values, int fieldCount);
+    void (*event)(void *userData, uint8_t event, const int32_t *values, int valueCount);
+    void *userData;
+} blackboxDecoderHandlers_t;
+
+typedef struct blackboxDecoder_s {
+    blackboxLogHeader_t header;
+    blackboxDecoderStats_t stats;
+    blackboxDecoderHandlers_t handlers;
+
+    const uint8_t *ptr;
+    const uint8_t *end;
+    bool overrun;
+
+    // Main frame history, [0] is the frame being decoded
+    int32_t mainHistoryRing[3][BLACKBOX_DECODER_MAX_FIELDS];
+    int32_t *mainHistory[3];
+    bool mainHistoryValid;
+    int pFrameIndex;
+    int32_t lastMainFrameTime;
+
+    int32_t gyroHistory[BLACKBOX_DECODER_MAX_FIELDS];
+    int32_t gpsHistory[BLACKBOX_DECODER_MAX_FIELDS];
+    int32_t gpsHome[2];
+
+    golombRiceContext_t residualContexts[BLACKBOX_RESIDUAL_CONTEXT_COUNT];
+    bool logEnded;
+} blackboxDecoder_t;
+
+void blackboxDecoderInit(blackboxDecoder_t *decoder, const blackboxDecoderHandlers_t *handlers);
+int blackboxFindLogs(const uint8_t *data, int length, int *offsets, int maxLogs);
+bool blackboxDecodeLog(blackboxDecoder_t *decoder, const uint8_t *data, int length);
+int blackboxFieldIndex(const blackboxFrameDefinition_t *def, const char *name);
+char blackboxFrameTypeChar(blackboxFrameType_e frameType);
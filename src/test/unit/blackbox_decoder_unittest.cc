@@ -0,0 +1,341 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+extern "C" {
+    #include "blackbox/blackbox_encoding.h"
+    #include "blackbox/blackbox_fielddefs.h"
+    #include "blackbox_decoder.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+/*
+ * Decoder edge cases: a small log is written with the firmware's encoders in the same way as writeIntraframe() and
+ * writeInterframe(), then damaged before it's decoded. The round trip through the firmware's own encoder is tested by
+ * blackbox_unittest.cc.
+ */
+
+#define I_INTERVAL      32
+#define MINTHROTTLE     1070
+#define MOTOR_LOW       1070
+#define VBATREF         4095
+#define FIELD_COUNT     19
+
+enum {
+    FIELD_ITERATION = 0,
+    FIELD_TIME,
+    FIELD_AXIS_P,
+    FIELD_AXIS_I = FIELD_AXIS_P + 3,
+    FIELD_RC_COMMAND = FIELD_AXIS_I + 3,
+    FIELD_VBAT = FIELD_RC_COMMAND + 4,
+    FIELD_RSSI,
+    FIELD_GYRO,
+    FIELD_MOTOR = FIELD_GYRO + 3
+};
+
+static const char headerFields[] =
+    "H Field I name:loopIteration,time,axisP[0],axisP[1],axisP[2],axisI[0],axisI[1],axisI[2],"
+        "rcCommand[0],rcCommand[1],rcCommand[2],rcCommand[3],vbatLatest,rssi,gyroADC[0],gyroADC[1],gyroADC[2],motor[0],motor[1]\n"
+    "H Field I signed:0,0,1,1,1,1,1,1,1,1,1,0,0,0,1,1,1,0,0\n"
+    "H Field I predictor:0,0,0,0,0,0,0,0,0,0,0,4,9,0,0,0,0,11,5\n"
+    "H Field I encoding:1,1,0,0,0,0,0,0,0,0,0,1,3,1,0,0,0,1,0\n"
+    "H Field P predictor:6,2,1,1,1,1,1,1,1,1,1,1,1,1,3,3,3,3,3\n"
+    "H Field P encoding:9,0,0,0,0,7,7,7,8,8,8,8,6,6,0,0,0,0,0\n";
+
+static const char headerSysinfo[] =
+    "H P interval:1/2\n"
+    "H minthrottle:1070\n"
+    "H motorOutput:1070,2000\n"
+    "H vbatref:4095\n";
+
+static std::vector<uint8_t> logData;
+
+extern "C" void blackboxWrite(uint8_t value)
+{
+    logData.push_back(value);
+}
+
+static void writeString(const char *s)
+{
+    logData.insert(logData.end(), s, s + strlen(s));
+}
+
+typedef struct frame_s {
+    int32_t values[FIELD_COUNT];
+} frame_t;
+
+static void writeIntraframe(const frame_t *frame)
+{
+    const int32_t *v = frame->values;
+
+    blackboxWrite('I');
+    blackboxWriteUnsignedVB(v[FIELD_ITERATION]);
+    blackboxWriteUnsignedVB(v[FIELD_TIME]);
+    for (int i = FIELD_AXIS_P; i < FIELD_RC_COMMAND + 3; i++) {
+        blackboxWriteSignedVB(v[i]);
+    }
+    blackboxWriteUnsignedVB(v[FIELD_RC_COMMAND + 3] - MINTHROTTLE);
+    blackboxWriteUnsignedVB((VBATREF - v[FIELD_VBAT]) & 0x3FFF);
+    blackboxWriteUnsignedVB(v[FIELD_RSSI]);
+    for (int i = FIELD_GYRO; i < FIELD_GYRO + 3; i++) {
+        blackboxWriteSignedVB(v[i]);
+    }
+    blackboxWriteUnsignedVB(v[FIELD_MOTOR] - MOTOR_LOW);
+    blackboxWriteSignedVB(v[FIELD_MOTOR + 1] - v[FIELD_MOTOR]);
+}
+
+static void writeInterframe(const frame_t *frame, const frame_t *last, const frame_t *last2)
+{
+    const int32_t *v = frame->values;
+    const int32_t *l = last->values;
+    const int32_t *l2 = last2->values;
+    int32_t deltas[4];
+
+    blackboxWrite('P');
+    blackboxWriteSignedVB(v[FIELD_TIME] - 2 * l[FIELD_TIME] + l2[FIELD_TIME]);
+    for (int i = FIELD_AXIS_P; i < FIELD_AXIS_P + 3; i++) {
+        blackboxWriteSignedVB(v[i] - l[i]);
+    }
+    for (int i = 0; i < 3; i++) {
+        deltas[i] = v[FIELD_AXIS_I + i] - l[FIELD_AXIS_I + i];
+    }
+    blackboxWriteTag2_3S32(deltas);
+    for (int i = 0; i < 4; i++) {
+        deltas[i] = v[FIELD_RC_COMMAND + i] - l[FIELD_RC_COMMAND + i];
+    }
+    blackboxWriteTag8_4S16(deltas);
+    deltas[0] = v[FIELD_VBAT] - l[FIELD_VBAT];
+    deltas[1] = v[FIELD_RSSI] - l[FIELD_RSSI];
+    blackboxWriteTag8_8SVB(deltas, 2);
+    for (int i = FIELD_GYRO; i < FIELD_COUNT; i++) {
+        blackboxWriteSignedVB(v[i] - (l[i] + l2[i]) / 2);
+    }
+}
+
+static int32_t walk(int32_t value, int step, int32_t min, int32_t max)
+{
+    value += (rand() % (2 * step + 1)) - step;
+    return value < min ? min : value > max ? max : value;
+}
+
+static void nextFrame(frame_t *frame, uint32_t iteration)
+{
+    int32_t *v = frame->values;
+
+    v[FIELD_ITERATION] = iteration;
+    v[FIELD_TIME] = iteration * 125 + (rand() % 3);
+    for (int i = 0; i < 3; i++) {
+        v[FIELD_AXIS_P + i] = walk(v[FIELD_AXIS_P + i], 20, -500, 500);
+        v[FIELD_AXIS_I + i] = walk(v[FIELD_AXIS_I + i], 2, -100000, 100000);
+        v[FIELD_GYRO + i] = walk(v[FIELD_GYRO + i], 100, -2000, 2000);
+    }
+    for (int i = 0; i < 3; i++) {
+        v[FIELD_RC_COMMAND + i] = walk(v[FIELD_RC_COMMAND + i], 5, -500, 500);
+    }
+    v[FIELD_RC_COMMAND + 3] = walk(v[FIELD_RC_COMMAND + 3], 10, MINTHROTTLE, 2000);
+    v[FIELD_VBAT] = walk(v[FIELD_VBAT], 1, 3000, 4095);
+    v[FIELD_RSSI] = (rand() % 16) ? v[FIELD_RSSI] : rand() % 1024;
+    v[FIELD_MOTOR] = walk(v[FIELD_MOTOR], 30, MOTOR_LOW, 2000);
+    v[FIELD_MOTOR + 1] = walk(v[FIELD_MOTOR + 1], 30, MOTOR_LOW, 2000);
+}
+
+/*
+ * Write a log of the given number of iterations, with the "P" frames at the header's interval of 1/2, and return the
+ * frames which were logged.
+ */
+static std::vector<frame_t> writeLog(int iterations)
+{
+    std::vector<frame_t> logged;
+    frame_t frame;
+    frame_t history[2];
+
+    memset(&frame, 0, sizeof(frame));
+    frame.values[FIELD_RC_COMMAND + 3] = MINTHROTTLE;
+    frame.values[FIELD_VBAT] = 4000;
+    frame.values[FIELD_MOTOR] = MOTOR_LOW;
+    frame.values[FIELD_MOTOR + 1] = MOTOR_LOW;
+
+    logData.clear();
+    writeString("H Product:Blackbox flight data recorder by Nicholas Sherlock\n");
+    writeString("H Data version:2\n");
+    writeString("H I interval:32\n");
+    writeString(headerFields);
+    writeString(headerSysinfo);
+
+    srand(1234);
+    for (int iteration = 0; iteration < iterations; iteration++) {
+        nextFrame(&frame, iteration);
+
+        const int pFrameIndex = iteration % I_INTERVAL;
+        if (pFrameIndex == 0) {
+            writeIntraframe(&frame);
+            history[0] = frame;
+            history[1] = frame;
+        } else if (pFrameIndex % 2 == 0) {
+            writeInterframe(&frame, &history[0], &history[1]);
+            history[1] = history[0];
+            history[0] = frame;
+        } else {
+            continue;
+        }
+        logged.push_back(frame);
+    }
+
+    return logged;
+}
+
+static std::vector<frame_t> decodedFrames;
+
+static void collectFrame(void *userData, blackboxFrameType_e frameType, const int32_t *values, int fieldCount)
+{
+    (void)userData;
+
+    EXPECT_TRUE(frameType == BLACKBOX_FRAME_INTRA || frameType == BLACKBOX_FRAME_INTER);
+    EXPECT_EQ(FIELD_COUNT, fieldCount);
+
+    frame_t frame;
+    memcpy(frame.values, values, sizeof(frame.values));
+    decodedFrames.push_back(frame);
+}
+
+static blackboxDecoder_t decoder;
+
+static bool decodeLog(void)
+{
+    const blackboxDecoderHandlers_t handlers = { NULL, collectFrame, NULL, NULL };
+
+    decodedFrames.clear();
+    blackboxDecoderInit(&decoder, &handlers);
+    return blackboxDecodeLog(&decoder, logData.data(), logData.size());
+}
+
+static void expectFramesEqual(const std::vector<frame_t> &expected, const std::vector<frame_t> &actual)
+{
+    ASSERT_EQ(expected.size(), actual.size());
+
+    for (size_t i = 0; i < actual.size(); i++) {
+        for (int field = 0; field < FIELD_COUNT; field++) {
+            ASSERT_EQ(expected[i].values[field], actual[i].values[field]) << "frame " << i << " field " << field;
+        }
+    }
+}
+
+static size_t headerLength(void)
+{
+    const char *headerEnd = "H vbatref:4095\n";
+
+    return std::search(logData.begin(), logData.end(), headerEnd, headerEnd + strlen(headerEnd)) - logData.begin()
+        + strlen(headerEnd);
+}
+
+TEST(BlackboxDecoderTest, FindLogs)
+{
+    // given
+    writeLog(10);
+    std::vector<uint8_t> twoLogs(logData);
+    twoLogs.insert(twoLogs.end(), logData.begin(), logData.end());
+    int offsets[4];
+
+    // when
+    const int count = blackboxFindLogs(twoLogs.data(), twoLogs.size(), offsets, 4);
+
+    // then
+    EXPECT_EQ(2, count);
+    EXPECT_EQ(0, offsets[0]);
+    EXPECT_EQ((int)logData.size(), offsets[1]);
+}
+
+TEST(BlackboxDecoderTest, DecodesUndamagedLog)
+{
+    // given
+    const std::vector<frame_t> expected = writeLog(200);
+
+    // when
+    ASSERT_TRUE(decodeLog());
+
+    // then
+    EXPECT_EQ(0u, decoder.stats.corruptFrames);
+    EXPECT_EQ(7u, decoder.stats.frameCount[BLACKBOX_FRAME_INTRA]);
+    expectFramesEqual(expected, decodedFrames);
+}
+
+TEST(BlackboxDecoderTest, RecoversAtNextIntraframe)
+{
+    // given
+    const std::vector<frame_t> expected = writeLog(200);
+
+    // when
+    // damage the log just after its header, which destroys the first "I" frame and its "P" frames
+    logData[headerLength()] = 0xFF;
+    ASSERT_TRUE(decodeLog());
+
+    // then
+    // every frame from the second "I" frame on is decoded
+    const size_t tailCount = std::count_if(expected.begin(), expected.end(),
+        [](const frame_t &frame) { return frame.values[FIELD_ITERATION] >= I_INTERVAL; });
+    const std::vector<frame_t> expectedTail(expected.end() - tailCount, expected.end());
+
+    EXPECT_GT(decoder.stats.corruptFrames, 0u);
+    ASSERT_GE(decodedFrames.size(), tailCount);
+    const std::vector<frame_t> decodedTail(decodedFrames.end() - tailCount, decodedFrames.end());
+    expectFramesEqual(expectedTail, decodedTail);
+}
+
+TEST(BlackboxDecoderTest, DropsTruncatedFrame)
+{
+    // given
+    std::vector<frame_t> expected = writeLog(200);
+
+    // when
+    // the log was cut off in the middle of its last frame
+    logData.pop_back();
+    ASSERT_TRUE(decodeLog());
+
+    // then
+    // the frames before it are all decoded, and nothing is made up from the partial frame
+    expected.pop_back();
+    EXPECT_GT(decoder.stats.corruptFrames, 0u);
+    ASSERT_GE(decodedFrames.size(), expected.size());
+    decodedFrames.resize(expected.size());
+    expectFramesEqual(expected, decodedFrames);
+}
+
+TEST(BlackboxDecoderTest, RejectsTruncatedHeader)
+{
+    // given
+    writeLog(200);
+
+    // when
+    // the log was cut off before the "I" frame field definitions
+    logData.resize(strlen("H Product:Blackbox flight data recorder by Nicholas Sherlock\nH Data version:2\n"));
+
+    // then
+    EXPECT_FALSE(decodeLog());
+    EXPECT_EQ(0u, decodedFrames.size());
+}
+
+// STUBS
+
+extern "C" {
+}
@@ -0,0 +1,651 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdint.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <math.h>
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+extern "C" {
+    #include <platform.h>
+
+    #include "build/debug.h"
+    #include "build/version.h"
+
+    #include "common/axis.h"
+    #include "common/maths.h"
+    #include "common/printf.h"
+    #include "common/utils.h"
+
+    #include "blackbox/blackbox.h"
+    #include "blackbox/blackbox_encoding.h"
+    #include "blackbox/blackbox_io.h"
+
+    #include "drivers/system.h"
+
+    #include "fc/config.h"
+    #include "fc/rc_controls.h"
+    #include "fc/runtime_config.h"
+
+    #include "flight/failsafe.h"
+    #include "flight/mixer.h"
+    #include "flight/navigation.h"
+    #include "flight/pid.h"
+
+    #include "io/beeper.h"
+    #include "io/gps.h"
+    #include "io/serial.h"
+
+    #include "msp/msp_serial.h"
+
+    #include "rx/rx.h"
+
+    #include "sensors/sensors.h"
+    #include "sensors/acceleration.h"
+    #include "sensors/barometer.h"
+    #include "sensors/battery.h"
+    #include "sensors/compass.h"
+    #include "sensors/gyro.h"
+
+    #include "config/config_profile.h"
+    #include "config/config_master.h"
+    #include "config/feature.h"
+
+    #include "blackbox_decoder.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+/*
+ * Round trip tests of the firmware encoder: the flight loop and the blackbox task are driven as the scheduler would,
+ * and the log written to the serial port is decoded by the host decoder and compared with the logged state.
+ */
+
+#define TEST_GYRO_LOOPTIME      125     // 8kHz gyro and PID loop
+#define TEST_I_INTERVAL         32
+#define TEST_MOTOR_COUNT        4
+#define TEST_MINTHROTTLE        1070
+#define TEST_MAXTHROTTLE        2000
+#define TEST_VBAT               168
+#define TEST_MIXER_WEIGHT_SHIFT 12
+
+// Quad X gains as roll, pitch, yaw and throttle
+static const float testMotorGains[TEST_MOTOR_COUNT][4] = {
+    { -1.0f,  1.0f, -1.0f, 1.0f },
+    { -1.0f, -1.0f,  1.0f, 1.0f },
+    {  1.0f,  1.0f,  1.0f, 1.0f },
+    {  1.0f, -1.0f, -1.0f, 1.0f }
+};
+
+static uint32_t testFeatureMask;
+static timeMs_t testMillis;
+static uint32_t testTxBytesFree;
+static serialPortConfig_t testSerialPortConfig;
+static serialPort_t testSerialPort;
+static std::vector<uint8_t> serialData;
+
+// The main state logged for an iteration, in the order of the expected field names
+#define MAIN_FIELD_COUNT 17
+
+static const char * const mainFieldNames[MAIN_FIELD_COUNT] = {
+    "axisP[0]", "axisP[1]", "axisP[2]", "axisI[0]", "axisI[1]", "axisI[2]", "axisD[0]", "axisD[1]",
+    "rcCommand[0]", "rcCommand[1]", "rcCommand[2]", "rcCommand[3]",
+    "gyroADC[0]", "motor[0]", "motor[1]", "motor[2]", "motor[3]"
+};
+
+#define GYRO_FIELD_COUNT 10
+
+static const char * const gyroFieldNames[GYRO_FIELD_COUNT] = {
+    "gyroRaw[0]", "gyroRaw[1]", "gyroRaw[2]", "gyroADC[0]", "gyroADC[1]", "gyroADC[2]",
+    "motor[0]", "motor[1]", "motor[2]", "motor[3]"
+};
+
+typedef struct testFrames_s {
+    blackboxLogHeader_t header;
+    std::map<int32_t, std::vector<int32_t> > mainFrames;    // by loopIteration
+    std::vector<std::vector<int32_t> > gyroFrames;
+    std::vector<uint8_t> events;
+    std::map<uint8_t, std::vector<int32_t> > eventValues;   // of the last event of each type
+} testFrames_t;
+
+static std::map<int32_t, std::vector<int32_t> > expectedMainFrames;
+static std::map<int32_t, std::vector<int32_t> > expectedGyroFrames;   // by gyroRaw[0], which counts the gyro samples
+
+static void testHeaderHandler(void *userData, const blackboxLogHeader_t *header)
+{
+    ((testFrames_t *) userData)->header = *header;
+}
+
+static std::vector<int32_t> frameFields(const blackboxFrameDefinition_t *def, const int32_t *values,
+    const char * const *names, int count)
+{
+    std::vector<int32_t> fields;
+
+    for (int i = 0; i < count; i++) {
+        const int field = blackboxFieldIndex(def, names[i]);
+        EXPECT_GE(field, 0) << names[i];
+        fields.push_back(field >= 0 ? values[field] : 0);
+    }
+
+    return fields;
+}
+
+static void testFrameHandler(void *userData, blackboxFrameType_e frameType, const int32_t *values, int fieldCount)
+{
+    UNUSED(fieldCount);
+    testFrames_t *frames = (testFrames_t *) userData;
+    const blackboxFrameDefinition_t *def = &frames->header.frameDefs[frameType];
+
+    switch (frameType) {
+    case BLACKBOX_FRAME_INTRA:
+    case BLACKBOX_FRAME_INTER:
+        frames->mainFrames[values[blackboxFieldIndex(def, "loopIteration")]] =
+            frameFields(def, values, mainFieldNames, MAIN_FIELD_COUNT);
+        break;
+    case BLACKBOX_FRAME_GYRO:
+        frames->gyroFrames.push_back(frameFields(def, values, gyroFieldNames, GYRO_FIELD_COUNT));
+        break;
+    default:
+        break;
+    }
+}
+
+static void testEventHandler(void *userData, uint8_t event, const int32_t *values, int valueCount)
+{
+    testFrames_t *frames = (testFrames_t *) userData;
+
+    frames->events.push_back(event);
+    frames->eventValues[event] = std::vector<int32_t>(values, values + valueCount);
+}
+
+static void setupBlackbox(uint8_t gyroRateDenom, uint8_t crossFieldPredictors, uint8_t pEncoding)
+{
+    memset(&masterConfig, 0, sizeof(masterConfig));
+    currentProfile = &masterConfig.profile[0];
+
+    masterConfig.blackboxConfig.rate_num = 1;
+    masterConfig.blackboxConfig.rate_denom = 1;
+    masterConfig.blackboxConfig.device = BLACKBOX_DEVICE_SERIAL;
+    masterConfig.blackboxConfig.stream_device = BLACKBOX_DEVICE_NONE;
+    masterConfig.blackboxConfig.gyro_rate_denom = gyroRateDenom;
+    masterConfig.blackboxConfig.cross_field_predictors = crossFieldPredictors;
+    masterConfig.blackboxConfig.p_encoding = pEncoding;
+
+    masterConfig.motorConfig.minthrottle = TEST_MINTHROTTLE;
+    masterConfig.motorConfig.maxthrottle = TEST_MAXTHROTTLE;
+    masterConfig.gyroConfig.gyro_soft_lpf_hz = 90;
+
+    // A zero yaw D term leaves axisD[2] out of the log, and out of the mixer prediction with it
+    currentProfile->pidProfile.D8[ROLL] = 30;
+    currentProfile->pidProfile.D8[PITCH] = 30;
+    currentProfile->pidProfile.D8[YAW] = 0;
+
+    testFeatureMask = FEATURE_BLACKBOX | FEATURE_VBAT;
+    testMillis = 1000;
+    vbatLatest = TEST_VBAT;
+    gyro.targetLooptime = TEST_GYRO_LOOPTIME;
+    rcModeActivationMask = 0;
+    testSerialPort.txBufferSize = 256;
+    testTxBytesFree = 256;
+
+    serialData.clear();
+    expectedMainFrames.clear();
+    expectedGyroFrames.clear();
+
+    initBlackbox();
+}
+
+// Set the flight state of the given gyro sample, with the PID loop running at the gyro rate
+static void updateFlightState(uint32_t sample)
+{
+    const float t = sample * TEST_GYRO_LOOPTIME * 1e-6f;
+
+    gyro.gyroADCRawf[0] = sample;
+    gyro.gyroADCRawf[1] = 300.0f * sinf(t * 40.0f) + ((sample * 7) % 11) - 5;
+    gyro.gyroADCRawf[2] = -200.0f * cosf(t * 25.0f) + ((sample * 3) % 7) - 3;
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        gyro.gyroADCf[axis] += (gyro.gyroADCRawf[axis] - gyro.gyroADCf[axis]) * 0.3f;
+    }
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        axisPID_P[axis] = lrintf(gyro.gyroADCf[axis] * -0.2f) % 400;
+        axisPID_I[axis] = (sample / 64) % 50 - axis * 10;
+        axisPID_D[axis] = lrintf(gyro.gyroADCRawf[(axis + 1) % XYZ_AXIS_COUNT] * 0.1f) % 200;
+    }
+    rcCommand[ROLL] = lrintf(100.0f * sinf(t * 3.0f));
+    rcCommand[PITCH] = lrintf(80.0f * cosf(t * 2.0f));
+    rcCommand[YAW] = 0;
+    rcCommand[THROTTLE] = 1300 + (sample / 16) % 200;
+
+    // The mixer drives the motors from every D term, including the one which isn't logged
+    for (int i = 0; i < TEST_MOTOR_COUNT; i++) {
+        float output = rcCommand[THROTTLE];
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            output += testMotorGains[i][axis] * (axisPID_P[axis] + axisPID_I[axis] + axisPID_D[axis]);
+        }
+        motor[i] = constrain(lrintf(output), TEST_MINTHROTTLE, TEST_MAXTHROTTLE);
+    }
+}
+
+static std::vector<int32_t> expectedMainState(void)
+{
+    const int32_t values[MAIN_FIELD_COUNT] = {
+        axisPID_P[0], axisPID_P[1], axisPID_P[2], axisPID_I[0], axisPID_I[1], axisPID_I[2], axisPID_D[0], axisPID_D[1],
+        rcCommand[0], rcCommand[1], rcCommand[2], rcCommand[3],
+        (int32_t) lrintf(gyro.gyroADCf[0]), motor[0], motor[1], motor[2], motor[3]
+    };
+
+    return std::vector<int32_t>(values, values + MAIN_FIELD_COUNT);
+}
+
+static std::vector<int32_t> expectedGyroState(void)
+{
+    const int32_t values[GYRO_FIELD_COUNT] = {
+        (int32_t) lrintf(gyro.gyroADCRawf[0]), (int32_t) lrintf(gyro.gyroADCRawf[1]), (int32_t) lrintf(gyro.gyroADCRawf[2]),
+        (int32_t) lrintf(gyro.gyroADCf[0]), (int32_t) lrintf(gyro.gyroADCf[1]), (int32_t) lrintf(gyro.gyroADCf[2]),
+        motor[0], motor[1], motor[2], motor[3]
+    };
+
+    return std::vector<int32_t>(values, values + GYRO_FIELD_COUNT);
+}
+
+/*
+ * Arm and fly for the given number of gyro samples, with the blackbox task running every millisecond, then disarm and
+ * let the log finish. If given, onSample is called before each sample to change the conditions of the flight.
+ */
+static void flyAndLog(uint32_t samples, void (*onSample)(uint32_t sample) = NULL)
+{
+    timeUs_t currentTimeUs = testMillis * 1000;
+    uint32_t iteration = 0;
+
+    startBlackbox();
+
+    // The header is written out before the first iteration is logged
+    for (int i = 0; i < 1000; i++) {
+        testMillis++;
+        currentTimeUs += 1000;
+        handleBlackbox(currentTimeUs);
+    }
+
+    for (uint32_t sample = 0; sample < samples; sample++) {
+        currentTimeUs += TEST_GYRO_LOOPTIME;
+        if (onSample) {
+            onSample(sample);
+        }
+        updateFlightState(sample);
+
+        blackboxSampleGyro();
+        expectedGyroFrames[lrintf(gyro.gyroADCRawf[0])] = expectedGyroState();
+
+        blackboxSampleIteration(currentTimeUs);
+        expectedMainFrames[iteration++] = expectedMainState();
+
+        if (currentTimeUs / 1000 != testMillis) {
+            testMillis = currentTimeUs / 1000;
+            handleBlackbox(currentTimeUs);
+        }
+    }
+
+    finishBlackbox();
+    for (int i = 0; i < 1000; i++) {
+        testMillis++;
+        currentTimeUs += 1000;
+        handleBlackbox(currentTimeUs);
+    }
+}
+
+static void decodeLog(testFrames_t *frames)
+{
+    blackboxDecoder_t *decoder = new blackboxDecoder_t;
+    blackboxDecoderHandlers_t handlers;
+
+    memset(&handlers, 0, sizeof(handlers));
+    handlers.header = testHeaderHandler;
+    handlers.frame = testFrameHandler;
+    handlers.event = testEventHandler;
+    handlers.userData = frames;
+
+    blackboxDecoderInit(decoder, &handlers);
+    EXPECT_TRUE(blackboxDecodeLog(decoder, serialData.data(), serialData.size()));
+    EXPECT_EQ(0u, decoder->stats.corruptFrames);
+    EXPECT_TRUE(decoder->logEnded);
+
+    delete decoder;
+}
+
+// Every main frame holds the state of the iteration it was logged for
+static void expectLoggedMainState(const testFrames_t *frames)
+{
+    ASSERT_GT(frames->mainFrames.size(), 1000u);
+    for (std::map<int32_t, std::vector<int32_t> >::const_iterator it = frames->mainFrames.begin(); it != frames->mainFrames.end(); ++it) {
+        ASSERT_EQ(1u, expectedMainFrames.count(it->first)) << "loopIteration " << it->first;
+        EXPECT_EQ(expectedMainFrames[it->first], it->second) << "loopIteration " << it->first;
+    }
+}
+
+static void expectLoggedState(const testFrames_t *frames, bool gyroFrames)
+{
+    // Every iteration is logged, from the first "I" frame on
+    ASSERT_NO_FATAL_FAILURE(expectLoggedMainState(frames));
+    EXPECT_EQ(frames->mainFrames.rbegin()->first - frames->mainFrames.begin()->first + 1, (int32_t) frames->mainFrames.size());
+
+    if (!gyroFrames) {
+        EXPECT_EQ(0u, frames->gyroFrames.size());
+        return;
+    }
+
+    // Every other gyro sample is logged
+    ASSERT_GT(frames->gyroFrames.size(), 500u);
+    for (unsigned i = 0; i < frames->gyroFrames.size(); i++) {
+        const int32_t sample = frames->gyroFrames[i][0];
+
+        ASSERT_EQ(1u, expectedGyroFrames.count(sample)) << "gyro sample " << sample;
+        EXPECT_EQ(expectedGyroFrames[sample], frames->gyroFrames[i]) << "gyro sample " << sample;
+        if (i > 0) {
+            EXPECT_EQ(frames->gyroFrames[i - 1][0] + 2, sample);
+        }
+    }
+}
+
+TEST(BlackboxTest, LogsMainFrames)
+{
+    // given
+    setupBlackbox(0, 0, BLACKBOX_P_ENCODING_TAG);
+
+    // when
+    flyAndLog(8000);
+    testFrames_t frames;
+    decodeLog(&frames);
+
+    // then
+    EXPECT_EQ(-1, blackboxFieldIndex(&frames.header.frameDefs[BLACKBOX_FRAME_INTRA], "axisD[2]"));
+    EXPECT_EQ(0, frames.header.frameDefs[BLACKBOX_FRAME_GYRO].fieldCount);
+    EXPECT_EQ(TEST_VBAT, frames.header.vbatref);
+    EXPECT_EQ(FLIGHT_LOG_EVENT_LOG_END, frames.events.back());
+    expectLoggedState(&frames, false);
+}
+
+TEST(BlackboxTest, LogsGyroFrames)
+{
+    // given
+    setupBlackbox(2, 0, BLACKBOX_P_ENCODING_TAG);
+
+    // when
+    flyAndLog(8000);
+    testFrames_t frames;
+    decodeLog(&frames);
+
+    // then
+    const blackboxFrameDefinition_t *gyroDef = &frames.header.frameDefs[BLACKBOX_FRAME_GYRO];
+    EXPECT_EQ(FLIGHT_LOG_FIELD_PREDICTOR_PREVIOUS, gyroDef->predictor[blackboxFieldIndex(gyroDef, "gyroADC[0]")]);
+
+    expectLoggedState(&frames, true);
+}
+
+TEST(BlackboxTest, LogsGyroFramesWithCrossFieldPredictors)
+{
+    // given
+    setupBlackbox(2, 1, BLACKBOX_P_ENCODING_TAG);
+
+    // when
+    flyAndLog(8000);
+    testFrames_t frames;
+    decodeLog(&frames);
+
+    // then
+    const blackboxFrameDefinition_t *inter = &frames.header.frameDefs[BLACKBOX_FRAME_INTER];
+    const blackboxFrameDefinition_t *gyroDef = &frames.header.frameDefs[BLACKBOX_FRAME_GYRO];
+
+    for (int i = 0; i < TEST_MOTOR_COUNT; i++) {
+        char name[16];
+        snprintf(name, sizeof(name), "motor[%d]", i);
+        EXPECT_EQ(FLIGHT_LOG_FIELD_PREDICTOR_MIXER, inter->predictor[blackboxFieldIndex(inter, name)]);
+        EXPECT_EQ(FLIGHT_LOG_FIELD_PREDICTOR_PREVIOUS, gyroDef->predictor[blackboxFieldIndex(gyroDef, name)]);
+
+        for (int j = 0; j < 4; j++) {
+            EXPECT_EQ(lrintf(testMotorGains[i][j] * (1 << TEST_MIXER_WEIGHT_SHIFT)), frames.header.mixerWeights[i][j]);
+        }
+    }
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        char name[16];
+        snprintf(name, sizeof(name), "gyroADC[%d]", axis);
+        EXPECT_EQ(FLIGHT_LOG_FIELD_PREDICTOR_GYRO_RAW, gyroDef->predictor[blackboxFieldIndex(gyroDef, name)]);
+    }
+
+    // The lowpass gain at the 4kHz "F" frame rate
+    EXPECT_GT(frames.header.gyroRawGain, 0);
+    EXPECT_LT(frames.header.gyroRawGain, 256);
+
+    expectLoggedState(&frames, true);
+}
+
+TEST(BlackboxTest, LogsGyroFramesWithResidualCoder)
+{
+    // given
+    setupBlackbox(2, 1, BLACKBOX_P_ENCODING_GOLOMB_RICE);
+
+    // when
+    flyAndLog(8000);
+    testFrames_t frames;
+    decodeLog(&frames);
+
+    // then
+    const blackboxFrameDefinition_t *inter = &frames.header.frameDefs[BLACKBOX_FRAME_INTER];
+    EXPECT_EQ(FLIGHT_LOG_FIELD_ENCODING_GOLOMB_RICE, inter->encoding[blackboxFieldIndex(inter, "motor[0]")]);
+
+    expectLoggedState(&frames, true);
+}
+
+// The device falls behind from a quarter of the way through the flight
+static void backUpSerialPort(uint32_t sample)
+{
+    if (sample == 2000) {
+        testTxBytesFree = 32;
+    }
+}
+
+TEST(BlackboxTest, LowersRateWhenDeviceFallsBehind)
+{
+    // given
+    setupBlackbox(0, 0, BLACKBOX_P_ENCODING_TAG);
+    masterConfig.blackboxConfig.rate_control = 1;
+
+    // when
+    flyAndLog(8000, backUpSerialPort);
+    testFrames_t frames;
+    decodeLog(&frames);
+
+    // then
+    // the rate is lowered a step at a time, down to two "P" frames per "I" frame
+    EXPECT_EQ(4, std::count(frames.events.begin(), frames.events.end(), FLIGHT_LOG_EVENT_RATE_CHANGE));
+    EXPECT_EQ(std::vector<int32_t>({ 1, 16 }), frames.eventValues[FLIGHT_LOG_EVENT_RATE_CHANGE]);
+
+    expectLoggedMainState(&frames);
+
+    // every iteration is logged until the device falls behind, and every 16th by the end
+    for (int32_t iteration = frames.mainFrames.begin()->first; iteration < 2000; iteration++) {
+        EXPECT_EQ(1u, frames.mainFrames.count(iteration)) << "loopIteration " << iteration;
+    }
+    std::map<int32_t, std::vector<int32_t> >::const_reverse_iterator last = frames.mainFrames.rbegin();
+    const int32_t lastIteration = last->first;
+    EXPECT_EQ(16, lastIteration - (++last)->first);
+}
+
+#ifdef USE_BLACKBOX_PREROLL
+#define TEST_PREROLL_TRIGGER_SAMPLE 6000
+#define TEST_PREROLL_PULSE_SAMPLE   4000
+#define TEST_PREROLL_PULSE_LENGTH   80
+
+// The blackbox switch is turned on three quarters of the way through the flight
+static void triggerPreroll(uint32_t sample)
+{
+    if (sample == TEST_PREROLL_TRIGGER_SAMPLE) {
+        rcModeActivationMask |= 1 << BOXBLACKBOX;
+    }
+}
+
+// The blackbox switch is flicked on for 10ms
+static void pulsePreroll(uint32_t sample)
+{
+    if (sample == TEST_PREROLL_PULSE_SAMPLE) {
+        rcModeActivationMask |= 1 << BOXBLACKBOX;
+    } else if (sample == TEST_PREROLL_PULSE_SAMPLE + TEST_PREROLL_PULSE_LENGTH) {
+        rcModeActivationMask &= ~(1 << BOXBLACKBOX);
+    }
+}
+
+TEST(BlackboxTest, LogsPrerollOnTrigger)
+{
+    // given
+    setupBlackbox(2, 0, BLACKBOX_P_ENCODING_TAG);
+    masterConfig.blackboxConfig.preroll_hold_seconds = 1;
+
+    // when
+    flyAndLog(8000, triggerPreroll);
+    testFrames_t frames;
+    decodeLog(&frames);
+
+    // then
+    // the trigger is logged with the time held before it, which is as much as fitted in the ring
+    ASSERT_EQ(2u, frames.eventValues[FLIGHT_LOG_EVENT_PREROLL_TRIGGER].size());
+    const int32_t retainedMs = frames.eventValues[FLIGHT_LOG_EVENT_PREROLL_TRIGGER][1];
+
+    EXPECT_EQ(FLIGHT_LOG_PREROLL_TRIGGER_SWITCH, frames.eventValues[FLIGHT_LOG_EVENT_PREROLL_TRIGGER][0]);
+    EXPECT_GT(retainedMs, 50);
+    EXPECT_LT(retainedMs, TEST_PREROLL_TRIGGER_SAMPLE * TEST_GYRO_LOOPTIME / 1000);
+
+    // the log starts at the "I" frame that much before the trigger, and runs on from there
+    const int32_t expectedStart = TEST_PREROLL_TRIGGER_SAMPLE - retainedMs * 1000 / TEST_GYRO_LOOPTIME;
+    EXPECT_NEAR(expectedStart, frames.mainFrames.begin()->first, TEST_I_INTERVAL);
+    EXPECT_EQ(0, frames.mainFrames.begin()->first % TEST_I_INTERVAL);
+    expectLoggedState(&frames, true);
+}
+
+TEST(BlackboxTest, LogsForHoldTimeAfterPrerollTrigger)
+{
+    // given
+    setupBlackbox(0, 0, BLACKBOX_P_ENCODING_TAG);
+    masterConfig.blackboxConfig.preroll_hold_seconds = 1;
+
+    // when
+    flyAndLog(24000, pulsePreroll);
+    testFrames_t frames;
+    decodeLog(&frames);
+
+    // then
+    // logging stops a second after the switch is turned off, and the frames buffered after that are dropped
+    const int32_t holdEnd = TEST_PREROLL_PULSE_SAMPLE + TEST_PREROLL_PULSE_LENGTH + 1000 * 1000 / TEST_GYRO_LOOPTIME;
+
+    EXPECT_EQ(1, std::count(frames.events.begin(), frames.events.end(), FLIGHT_LOG_EVENT_PREROLL_TRIGGER));
+    EXPECT_LT(frames.mainFrames.begin()->first, TEST_PREROLL_PULSE_SAMPLE);
+    EXPECT_NEAR(holdEnd, frames.mainFrames.rbegin()->first, 2 * TEST_I_INTERVAL);
+    expectLoggedState(&frames, false);
+}
+#endif
+
+// STUBS
+
+extern "C" {
+
+gyro_t gyro;
+acc_t acc;
+mag_t mag;
+baro_t baro;
+
+int32_t axisPID_P[3], axisPID_I[3], axisPID_D[3];
+int16_t rcCommand[4];
+int16_t motor[MAX_SUPPORTED_MOTORS];
+int16_t motor_disarmed[MAX_SUPPORTED_MOTORS];
+int16_t servo[MAX_SUPPORTED_SERVOS];
+float motorOutputHigh = TEST_MAXTHROTTLE, motorOutputLow = TEST_MINTHROTTLE;
+
+uint16_t vbatLatest;
+uint16_t amperageLatest;
+uint16_t rssi;
+uint8_t stateFlags;
+uint32_t rcModeActivationMask;
+int16_t debug[DEBUG16_VALUE_COUNT];
+
+int32_t GPS_home[2];
+int32_t GPS_coord[2];
+uint8_t GPS_numSat;
+uint16_t GPS_altitude;
+uint16_t GPS_speed;
+uint16_t GPS_ground_course;
+
+master_t masterConfig;
+profile_t *currentProfile;
+
+const char * const buildDate = "Jan 01 2017";
+const char * const buildTime = "00:00:00";
+const char * const shortGitRevision = "test";
+const char * const targetName = "TEST";
+
+const uint32_t baudRates[] = { 0, 9600, 19200, 38400, 57600, 115200, 230400, 250000 };
+
+bool feature(uint32_t mask) {return (testFeatureMask & mask) != 0;}
+bool sensors(uint32_t) {return false;}
+uint32_t millis(void) {return testMillis;}
+
+uint8_t getMotorCount() {return TEST_MOTOR_COUNT;}
+void mixerGetMotorGains(uint8_t motorIndex, motorMixer_t *gains)
+{
+    gains->roll = testMotorGains[motorIndex][ROLL];
+    gains->pitch = testMotorGains[motorIndex][PITCH];
+    gains->yaw = testMotorGains[motorIndex][YAW];
+    gains->throttle = testMotorGains[motorIndex][3];
+}
+
+failsafePhase_e failsafePhase() {return FAILSAFE_IDLE;}
+bool failsafeIsActive(void) {return false;}
+bool rxIsReceivingSignal(void) {return true;}
+bool rxAreFlightChannelsValid(void) {return true;}
+bool isModeActivationConditionPresent(modeActivationCondition_t *, boxId_e) {return false;}
+uint32_t getArmingBeepTimeMicros(void) {return 0;}
+
+int tfp_format(void *putp, void (*putf) (void *, char), const char *fmt, va_list va)
+{
+    char buffer[256];
+    const int length = vsnprintf(buffer, sizeof(buffer), fmt, va);
+
+    for (int i = 0; i < length; i++) {
+        putf(putp, buffer[i]);
+    }
+
+    return length;
+}
+
+serialPortConfig_t *findSerialPortConfig(serialPortFunction_e) {return &testSerialPortConfig;}
+portSharing_e determinePortSharing(serialPortConfig_t *, serialPortFunction_e) {return PORTSHARING_NOT_SHARED;}
+serialPort_t *findSharedSerialPort(uint16_t, serialPortFunction_e) {return NULL;}
+serialPort_t *openSerialPort(serialPortIdentifier_e, serialPortFunction_e, serialReceiveCallbackPtr, uint32_t, portMode_t,
+    portOptions_t) {return &testSerialPort;}
+void closeSerialPort(serialPort_t *) {}
+void mspSerialAllocatePorts(void) {}
+
+// The port is drained as fast as it's written, unless a test backs it up
+uint32_t serialTxBytesFree(const serialPort_t *) {return testTxBytesFree;}
+bool isSerialTransmitBufferEmpty(const serialPort_t *) {return true;}
+void serialWrite(serialPort_t *, uint8_t ch) {serialData.push_back(ch);}
+void serialWriteBuf(serialPort_t *, const uint8_t *data, int count) {serialData.insert(serialData.end(), data, data + count);}
+}
@@ -0,0 +1,212 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <math.h>
+#include <string.h>
+
+extern "C" {
+    #include <platform.h>
+
+    #include "common/maths.h"
+    #include "common/utils.h"
+
+    #include "config/feature.h"
+
+    #include "io/motors.h"
+
+    #include "rx/rx.h"
+
+    #include "fc/config.h"
+    #include "fc/rc_controls.h"
+    #include "fc/runtime_config.h"
+
+    #include "flight/mixer.h"
+    #include "flight/pid.h"
+
+    void generateThrustLinearizationCurve(void);
+    float applyThrustLinearization(float motorOutput);
+
+    uint32_t testFeatureMask = 0;
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define TEST_MINCHECK 1100
+#define TEST_MIDRC 1500
+#define TEST_MINTHROTTLE 1070
+#define TEST_MAXTHROTTLE 2000
+#define TEST_DEADBAND3D_LOW 1406
+#define TEST_DEADBAND3D_HIGH 1514
+#define TEST_DEADBAND3D_THROTTLE 50
+
+static flight3DConfig_t flight3DConfig;
+static motorConfig_t motorConfig;
+static mixerConfig_t mixerConfig;
+static airplaneConfig_t airplaneConfig;
+static rxConfig_t rxConfig;
+static pidProfile_t pidProfile;
+
+// Thrust model the linearization inverts, T = (1 - k) * c + k * c^2
+static float modelThrust(float command, uint8_t thrustLinearization)
+{
+    const float k = thrustLinearization / 100.0f;
+    return (1.0f - k) * command + k * command * command;
+}
+
+static void setupMixer(uint8_t thrustLinearization, uint32_t features)
+{
+    memset(&flight3DConfig, 0, sizeof(flight3DConfig));
+    flight3DConfig.deadband3d_low = TEST_DEADBAND3D_LOW;
+    flight3DConfig.deadband3d_high = TEST_DEADBAND3D_HIGH;
+    flight3DConfig.neutral3d = 1460;
+    flight3DConfig.deadband3d_throttle = TEST_DEADBAND3D_THROTTLE;
+
+    memset(&motorConfig, 0, sizeof(motorConfig));
+    motorConfig.minthrottle = TEST_MINTHROTTLE;
+    motorConfig.maxthrottle = TEST_MAXTHROTTLE;
+    motorConfig.mincommand = 1000;
+    motorConfig.thrustLinearization = thrustLinearization;
+
+    memset(&mixerConfig, 0, sizeof(mixerConfig));
+    mixerConfig.yaw_motor_direction = 1;
+
+    memset(&rxConfig, 0, sizeof(rxConfig));
+    rxConfig.mincheck = TEST_MINCHECK;
+    rxConfig.midrc = TEST_MIDRC;
+
+    memset(&pidProfile, 0, sizeof(pidProfile));
+    pidProfile.pidSumLimit = 0.5f;
+
+    memset(axisPIDf, 0, sizeof(axisPIDf));
+
+    testFeatureMask = features;
+    ENABLE_ARMING_FLAG(ARMED);
+
+    mixerUseConfigs(&flight3DConfig, &motorConfig, &mixerConfig, &airplaneConfig, &rxConfig);
+    mixerInit(MIXER_QUADX, NULL);
+    mixerConfigureOutput();
+}
+
+TEST(FlightMixerTest, ThrustLinearizationInvertsThrustModel)
+{
+    const uint8_t settings[] = { 20, 50, 100 };
+
+    for (unsigned s = 0; s < ARRAYLEN(settings); s++) {
+        // given
+        motorConfig.thrustLinearization = settings[s];
+        mixerUseConfigs(&flight3DConfig, &motorConfig, &mixerConfig, &airplaneConfig, &rxConfig);
+        generateThrustLinearizationCurve();
+
+        // then
+        EXPECT_FLOAT_EQ(0.0f, applyThrustLinearization(0.0f));
+        EXPECT_NEAR(1.0f, applyThrustLinearization(1.0f), 1e-6f);
+
+        // including the outputs between the lookup table points, the curve is steepest near zero at 100%
+        float previous = 0.0f;
+        for (int i = 1; i <= 100; i++) {
+            const float thrust = i / 100.0f;
+            const float command = applyThrustLinearization(thrust);
+
+            EXPECT_NEAR(thrust, modelThrust(command, settings[s]), 0.01f);
+            EXPECT_GT(command, previous);
+            EXPECT_GE(command, thrust);
+            previous = command;
+        }
+    }
+}
+
+TEST(FlightMixerTest, ThrustLinearizationConstrainsOutput)
+{
+    // given
+    motorConfig.thrustLinearization = 50;
+    mixerUseConfigs(&flight3DConfig, &motorConfig, &mixerConfig, &airplaneConfig, &rxConfig);
+    generateThrustLinearizationCurve();
+
+    // then
+    EXPECT_FLOAT_EQ(0.0f, applyThrustLinearization(-0.5f));
+    EXPECT_NEAR(1.0f, applyThrustLinearization(1.5f), 1e-6f);
+}
+
+TEST(FlightMixerTest, ThrustLinearizationAppliedToMotorOutput)
+{
+    // given
+    setupMixer(50, 0);
+    const float thrust = 0.25f;
+    rcCommand[THROTTLE] = TEST_MINCHECK + lrintf(thrust * (PWM_RANGE_MAX - TEST_MINCHECK));
+
+    // when
+    mixTable(&pidProfile);
+
+    // then
+    const float command = applyThrustLinearization(thrust);
+    for (int i = 0; i < getMotorCount(); i++) {
+        EXPECT_NEAR(TEST_MINTHROTTLE + command * (TEST_MAXTHROTTLE - TEST_MINTHROTTLE), motor[i], 1.0f);
+    }
+}
+
+TEST(FlightMixerTest, ThrustLinearizationMirroredInReverse3D)
+{
+    const float thrusts[] = { 0.1f, 0.25f, 0.5f, 0.9f };
+
+    for (unsigned t = 0; t < ARRAYLEN(thrusts); t++) {
+        // given
+        setupMixer(50, FEATURE_3D);
+        const float command = applyThrustLinearization(thrusts[t]);
+
+        // when
+        rcCommand[THROTTLE] = TEST_MIDRC + TEST_DEADBAND3D_THROTTLE
+            + lrintf(thrusts[t] * (PWM_RANGE_MAX - TEST_MIDRC - TEST_DEADBAND3D_THROTTLE));
+        mixTable(&pidProfile);
+        const int16_t forwardMotor = motor[0];
+
+        // the reverse range runs from full reverse thrust at mincheck to none at the deadband
+        rcCommand[THROTTLE] = TEST_MINCHECK
+            + lrintf((1.0f - thrusts[t]) * (TEST_MIDRC - TEST_MINCHECK - TEST_DEADBAND3D_THROTTLE));
+        mixTable(&pidProfile);
+        const int16_t reverseMotor = motor[0];
+
+        // then
+        // both directions move away from the deadband by the linearized command, less the stick rounding
+        EXPECT_NEAR(command * (TEST_MAXTHROTTLE - TEST_DEADBAND3D_HIGH), forwardMotor - TEST_DEADBAND3D_HIGH, 2.0f);
+        EXPECT_NEAR(command * (TEST_DEADBAND3D_LOW - TEST_MINTHROTTLE), TEST_DEADBAND3D_LOW - reverseMotor, 2.0f);
+    }
+}
+
+// STUBS
+
+extern "C" {
+
+uint8_t armingFlags;
+int16_t rcCommand[4];
+int16_t rcData[MAX_SUPPORTED_RC_CHANNEL_COUNT];
+float axisPIDf[3];
+
+bool feature(uint32_t mask) {return (testFeatureMask & mask) != 0;}
+bool failsafeIsActive(void) {return false;}
+bool isAirmodeActive(void) {return false;}
+float calculateVbatPidCompensation(void) {return 1.0f;}
+void delay(uint32_t) {}
+void delayMicroseconds(uint32_t) {}
+bool pwmAreMotorsEnabled(void) {return true;}
+void pwmWriteMotor(uint8_t, uint16_t) {}
+void pwmCompleteMotorUpdate(uint8_t) {}
+void pwmShutdownPulsesForAllMotors(uint8_t) {}
+}
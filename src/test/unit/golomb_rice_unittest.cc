@@ -0,0 +1,152 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdint.h>
+#include <stdlib.h>
+
+extern "C" {
+    #include "common/golomb_rice.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define TEST_BUFFER_SIZE 4096
+
+static uint8_t testBuffer[TEST_BUFFER_SIZE];
+static int testBufferPos;
+
+static void testPutByte(uint8_t byte)
+{
+    if (testBufferPos < TEST_BUFFER_SIZE) {
+        testBuffer[testBufferPos++] = byte;
+    }
+}
+
+static void encodeValues(const int32_t *values, int count, golombRiceContext_t *contexts, int contextCount)
+{
+    golombRiceWriter_t writer;
+
+    golombRiceWriterInit(&writer, testPutByte);
+    for (int i = 0; i < count; i++) {
+        golombRiceWrite(&writer, &contexts[i % contextCount], values[i]);
+    }
+    golombRiceWriterFlush(&writer);
+}
+
+TEST(GolombRiceTest, ParameterFollowsAverage)
+{
+    // given
+    golombRiceContext_t context = { .sum = 0, .count = 1 };
+
+    // expect
+    EXPECT_EQ(0, golombRiceParameter(&context));
+
+    context.sum = 1;
+    EXPECT_EQ(0, golombRiceParameter(&context));
+
+    context.sum = 2;
+    EXPECT_EQ(1, golombRiceParameter(&context));
+
+    context.sum = 100;
+    context.count = 10;
+    EXPECT_EQ(4, golombRiceParameter(&context));
+}
+
+TEST(GolombRiceTest, SmallValuesPackIntoFewBits)
+{
+    // given
+    golombRiceContext_t context;
+    golombRiceContextInit(&context);
+    const int32_t values[] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+
+    // when
+    testBufferPos = 0;
+    encodeValues(values, 16, &context, 1);
+
+    // then
+    // the parameter soon drops to zero, where a zero costs one bit
+    EXPECT_LE(testBufferPos, 4);
+}
+
+TEST(GolombRiceTest, RoundTrip)
+{
+    // given
+    static const int CONTEXT_COUNT = 5;
+    static const int VALUE_COUNT = 1000;
+
+    int32_t values[VALUE_COUNT];
+    golombRiceContext_t encodeContexts[CONTEXT_COUNT];
+    golombRiceContext_t decodeContexts[CONTEXT_COUNT];
+
+    srand(42);
+    for (int i = 0; i < VALUE_COUNT; i++) {
+        // each context sees values of a different magnitude, with the occasional outlier
+        const int32_t range = 1 << (2 * (i % CONTEXT_COUNT));
+        values[i] = (rand() % (2 * range + 1)) - range;
+        if (i % 97 == 0) {
+            values[i] = (i & 1) ? INT32_MIN : INT32_MAX;
+        }
+    }
+    for (int i = 0; i < CONTEXT_COUNT; i++) {
+        golombRiceContextInit(&encodeContexts[i]);
+        golombRiceContextInit(&decodeContexts[i]);
+    }
+
+    // when
+    testBufferPos = 0;
+    encodeValues(values, VALUE_COUNT, encodeContexts, CONTEXT_COUNT);
+    testPutByte(0xA5);
+
+    // then
+    ASSERT_LT(testBufferPos, TEST_BUFFER_SIZE);
+
+    golombRiceReader_t reader;
+    golombRiceReaderInit(&reader, testBuffer, testBufferPos);
+    for (int i = 0; i < VALUE_COUNT; i++) {
+        EXPECT_EQ(values[i], golombRiceRead(&reader, &decodeContexts[i % CONTEXT_COUNT]));
+    }
+    golombRiceReaderAlign(&reader);
+
+    EXPECT_FALSE(reader.overrun);
+    EXPECT_EQ(&testBuffer[testBufferPos - 1], reader.ptr);
+    EXPECT_EQ(0xA5, *reader.ptr);
+}
+
+TEST(GolombRiceTest, ReaderFlagsTruncatedData)
+{
+    // given
+    golombRiceContext_t context;
+    golombRiceContextInit(&context);
+    const int32_t values[] = { 1000000 };
+
+    testBufferPos = 0;
+    encodeValues(values, 1, &context, 1);
+
+    // when
+    golombRiceContextInit(&context);
+    golombRiceReader_t reader;
+    golombRiceReaderInit(&reader, testBuffer, testBufferPos - 1);
+    golombRiceRead(&reader, &context);
+
+    // then
+    EXPECT_TRUE(reader.overrun);
+}
+
+// STUBS
+
+extern "C" {
+}
@@ -35,6 +35,7 @@ extern "C" {
     #include "rx/crsf.h"
 
     void crsfDataReceive(uint16_t c);
+    void crsfFrameReceive(const uint8_t *data, int length);
     uint8_t crsfFrameCRC(void);
     uint8_t crsfFrameStatus(void);
     uint16_t crsfReadRawRC(const rxRuntimeConfig_t *rxRuntimeConfig, uint8_t chan);
@@ -269,6 +270,26 @@ TEST(CrossFireTest, TestCrsfDataReceive)
     EXPECT_EQ(crc, crsfFrame.frame.payload[CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE]);
 }
 
+TEST(CrossFireTest, TestCrsfFrameReceive)
+{
+    crsfFrameDone = false;
+    memset(&crsfFrame, 0, sizeof(crsfFrame));
+
+    // a truncated frame is dropped
+    crsfFrameReceive(capturedData, sizeof(crsfRcChannelsFrame_t) - 1);
+    EXPECT_EQ(false, crsfFrameDone);
+
+    crsfFrameReceive(capturedData, sizeof(crsfRcChannelsFrame_t));
+    EXPECT_EQ(true, crsfFrameDone);
+    EXPECT_EQ(CRSF_ADDRESS_BROADCAST, crsfFrame.frame.deviceAddress);
+    EXPECT_EQ(CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE + CRSF_FRAME_LENGTH_TYPE_CRC, crsfFrame.frame.frameLength);
+    EXPECT_EQ(CRSF_FRAMETYPE_RC_CHANNELS_PACKED, crsfFrame.frame.type);
+    for (int ii = 0; ii < CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE; ++ii) {
+        EXPECT_EQ(capturedData[ii + 3], crsfFrame.frame.payload[ii]);
+    }
+    EXPECT_EQ(crsfFrameCRC(), crsfFrame.frame.payload[CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE]);
+}
+
 // STUBS
 
 extern "C" {
@@ -278,6 +299,7 @@ uint32_t micros(void) {return dummyTimeUs;}
 serialPort_t *openSerialPort(serialPortIdentifier_e, serialPortFunction_e, serialReceiveCallbackPtr, uint32_t, portMode_t, portOptions_t) {return NULL;}
 serialPortConfig_t *findSerialPortConfig(serialPortFunction_e ) {return NULL;}
 void serialWriteBuf(serialPort_t *, const uint8_t *, int) {}
+bool serialSetRxFrameCallback(serialPort_t *, serialReceiveFrameCallbackPtr) {return false;}
 bool telemetryCheckRxPortShared(const serialPortConfig_t *) {return false;}
 serialPort_t *telemetrySharedPort = NULL;
 }
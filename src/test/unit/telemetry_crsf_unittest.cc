@@ -55,6 +55,7 @@ extern "C" {
 
     bool airMode;
     uint16_t vbat;
+    extern attitudeEulerAngles_t attitude;
     serialPort_t *telemetrySharedPort;
 }
 
@@ -276,6 +277,7 @@ uint16_t batteryWarningVoltage;
 uint8_t useHottAlarmSoundPeriod (void) { return 0; }
 
 attitudeEulerAngles_t attitude = { { 0, 0, 0 } };     // absolute angle inclination in multiple of 0.1 degree    180 deg = 1800
+const attitudeEulerAngles_t *imuGetAttitude(void) { return &attitude; }
 
 uint8_t GPS_numSat;
 int32_t GPS_coord[2];
@@ -298,6 +300,7 @@ uint32_t serialTxBytesFree(const serialPort_t *) {return 0;}
 uint8_t serialRead(serialPort_t *) {return 0;}
 void serialWrite(serialPort_t *, uint8_t) {}
 void serialWriteBuf(serialPort_t *, const uint8_t *, int) {}
+bool serialSetRxFrameCallback(serialPort_t *, serialReceiveFrameCallbackPtr) {return false;}
 void serialSetMode(serialPort_t *, portMode_t ) {}
 serialPort_t *openSerialPort(serialPortIdentifier_e, serialPortFunction_e, serialReceiveCallbackPtr, uint32_t, portMode_t, portOptions_t) {return NULL;}
 void closeSerialPort(serialPort_t *) {}